@@ -0,0 +1,184 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_ANALYSIS_CACHE_H
+#define CHESSUCI_ANALYSIS_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+/**
+ * \brief A search limit that gives reproducible results.
+ */
+struct SearchLimit {
+    enum class Kind : std::uint8_t {
+        Depth = 0,
+        Nodes = 1,
+        Movetime = 2,
+    };
+
+    Kind kind{Kind::Depth};
+    std::uint64_t value{0}; ///< Depth in plies, number of nodes or time in milliseconds.
+
+    auto operator==(const SearchLimit &rhs) const -> bool = default;
+};
+
+/**
+ * \brief Identifies the analysis of a position.
+ */
+struct AnalysisKey {
+    std::uint64_t position{0}; ///< Zobrist hash of the position.
+    std::uint64_t engine{0};   ///< Hash of the engine identity.
+    SearchLimit limit{};
+
+    auto operator==(const AnalysisKey &rhs) const -> bool = default;
+};
+
+/**
+ * \brief The final result of a search.
+ */
+struct AnalysisResult {
+    search_info info;       ///< The infos of the search merged together.
+    bestmove_info bestmove; ///< The best move.
+};
+
+/**
+ * \brief Persistent cache of search results.
+ *
+ * Results are keyed by the position, the engine and the search limit. A
+ * result also answers requests with a smaller limit of the same kind, e.g., a
+ * depth 20 search answers a depth 12 request. Only the deepest result per
+ * position, engine and kind of limit is kept.
+ * The cache file is an append-only log of records, which is memory mapped and
+ * indexed when the cache is opened. A record that was cut off (e.g., by a
+ * crash) is dropped. All functions are thread safe.
+ */
+class AnalysisCache {
+public:
+    /**
+     * \brief Open a cache file.
+     *
+     * The file is created, if it does not exist or is empty. Other files
+     * that are not cache files are left untouched; the cache then only keeps
+     * its results in memory and is_open() is false.
+     * \param path Path of the cache file.
+     */
+    explicit AnalysisCache(const std::filesystem::path &path);
+
+    AnalysisCache(const AnalysisCache &) = delete;
+    auto operator=(const AnalysisCache &) -> AnalysisCache & = delete;
+
+    /**
+     * \brief If results are written to the cache file.
+     */
+    auto is_open() const -> bool;
+    auto last_error() const -> std::string;
+
+    /**
+     * \brief Look up a result.
+     *
+     * \param key The position, engine and limit.
+     * \return The stored result, if there is one with at least the requested
+     *   limit.
+     */
+    auto lookup(const AnalysisKey &key) const -> std::optional<AnalysisResult>;
+
+    /**
+     * \brief Store a result.
+     *
+     * Results with a smaller limit than an existing result are ignored. If
+     * the cache file cannot be written, the result is only kept in memory,
+     * last_error() describes the failure and is_open() becomes false.
+     * \param key The position, engine and limit.
+     * \param result The result of the search.
+     * \return If the result was stored and written to the cache file.
+     */
+    auto store(const AnalysisKey &key, const AnalysisResult &result) -> bool;
+
+    /**
+     * \brief Number of cached results.
+     *
+     * \return The number of distinct positions, engines and kinds of limits.
+     */
+    auto size() const -> std::size_t;
+
+    /**
+     * \brief Build the key for a search.
+     *
+     * \param engine Identity of the engine, e.g., name and options.
+     * \param position The position command.
+     * \param go The go command.
+     * \return The key, if the search is cacheable.
+     */
+    static auto make_key(std::string_view engine, const position_command &position, const go_command &go) -> std::optional<AnalysisKey>;
+
+    /**
+     * \brief Extract the limit of a search.
+     *
+     * A search is only cacheable, if it is limited by exactly one of depth,
+     * nodes or movetime. Clocks, infinite and ponder searches, mate searches
+     * and searches with searchmoves are not cacheable.
+     * \param go The go command.
+     * \return The limit, if the search is cacheable.
+     */
+    static auto normalize(const go_command &go) -> std::optional<SearchLimit>;
+
+    /**
+     * \brief Zobrist hash of a position.
+     *
+     * The hash covers the pieces, the side to move, the castling rights and the
+     * en passant square, but not the move counters.
+     * \param position The position command.
+     * \return The hash, if the FEN is valid and all moves are legal.
+     */
+    static auto position_hash(const position_command &position) -> std::optional<std::uint64_t>;
+
+    /**
+     * \brief Hash of an engine identity.
+     *
+     * \param identity Identity of the engine.
+     * \return The hash.
+     */
+    static auto engine_hash(std::string_view identity) -> std::uint64_t;
+private:
+    // results are indexed without the limit value
+    struct IndexKey {
+        std::uint64_t position;
+        std::uint64_t engine;
+        SearchLimit::Kind kind;
+
+        auto operator==(const IndexKey &rhs) const -> bool = default;
+    };
+    struct IndexKeyHash {
+        auto operator()(const IndexKey &key) const -> std::size_t;
+    };
+    struct Entry {
+        std::uint64_t limit;
+        AnalysisResult result;
+    };
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<IndexKey, Entry, IndexKeyHash> m_entries;
+    std::ofstream m_stream;
+    std::string m_record;
+    std::string m_last_error;
+
+    auto load(const std::filesystem::path &path) -> std::size_t;
+    auto insert(const AnalysisKey &key, AnalysisResult result) -> bool;
+};
+
+} // namespace chessuci
+
+#endif
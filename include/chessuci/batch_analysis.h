@@ -0,0 +1,203 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_BATCH_ANALYSIS_H
+#define CHESSUCI_BATCH_ANALYSIS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "chessuci/engine_process.h"
+#include "chessuci/engine_supervisor.h"
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+class AnalysisCache;
+
+/**
+ * \brief A position of a batch analysis.
+ */
+struct BatchPosition {
+    std::size_t index{0}; ///< Index of the position in the input, starting at 0.
+    std::string fen;      ///< The position as FEN.
+    std::string id;       ///< Value of the EPD "id" operation, if present.
+};
+
+/**
+ * \brief Result of analysing a single position.
+ */
+struct BatchResult {
+    BatchPosition position;
+    search_info info;         ///< All infos of the first pv line merged together.
+    bestmove_info bestmove;   ///< The best move of the search.
+    std::string error{};      ///< Reason, why the position could not be analysed.
+
+    auto ok() const -> bool { return error.empty(); }
+};
+
+/**
+ * \brief Settings of a batch analysis.
+ */
+struct BatchSettings {
+    ProcessParams engine;                   ///< The engine to start.
+    std::vector<setoption_command> options; ///< Options to set in every engine.
+    go_command go;                          ///< Search limits for every position, e.g., depth or nodes.
+    std::size_t engine_count{1};            ///< Number of engine processes.
+    std::size_t chunk_size{8};              ///< Number of positions a worker takes from the input at once.
+    AnalysisCache *cache{nullptr};          ///< Cache to take results from and to add results to, if any.
+    RestartPolicy restart{};                ///< Restarting engines that crashed.
+};
+
+/**
+ * \brief Statistics of a batch analysis.
+ */
+struct BatchStatistics {
+    std::uint64_t positions{0};  ///< Number of analysed positions.
+    std::uint64_t errors{0};     ///< Number of positions that could not be analysed.
+    std::uint64_t stolen{0};     ///< Number of positions taken from another worker.
+    std::uint64_t cache_hits{0}; ///< Number of positions answered by the analysis cache.
+    std::uint64_t restarts{0};   ///< Number of engine restarts after crashes.
+    std::chrono::nanoseconds elapsed{0};
+
+    auto positions_per_second() const -> double;
+};
+
+/**
+ * \brief Analyses a stream of positions with several engines in parallel.
+ *
+ * The input is memory mapped and cut into chunks on demand. Every engine is
+ * driven by its own worker thread, which takes chunks of positions from the
+ * input into its own queue. When the input is exhausted, idle workers steal
+ * the oldest positions of the other workers, so the slowest engine does not
+ * determine the end of the run and the results can be emitted early.
+ * Results are passed to the result callback in input order, each position is
+ * analysed with a single "position fen" and "go" command. With an analysis
+ * cache, cached results are used instead of searching, and new results are
+ * added to the cache. The engine is identified by its id and the options set.
+ * Engines that crash are restarted according to the restart policy, and the
+ * interrupted search is repeated. A worker whose engine was given up stops,
+ * and its positions are taken over by the other workers.
+ */
+class BatchAnalysis {
+public:
+    using ResultCallback = std::function<void(const BatchResult &)>;
+    using ProcessCreator = std::function<std::unique_ptr<EngineProcess>()>;
+
+    explicit BatchAnalysis(BatchSettings settings);
+    ~BatchAnalysis();
+
+    BatchAnalysis(const BatchAnalysis &) = delete;
+    auto operator=(const BatchAnalysis &) -> BatchAnalysis & = delete;
+
+    /**
+     * \brief Set the function that creates the engine processes.
+     *
+     * By default, local processes are created.
+     * \param creator Creates one engine process per call.
+     */
+    auto set_process_creator(ProcessCreator creator) -> void { m_process_creator = std::move(creator); }
+
+    /**
+     * \brief Analyse all positions of an EPD or FEN file.
+     *
+     * Blocks until all positions were analysed or the analysis was cancelled.
+     * \param path Path of the file, one position per line.
+     * \param on_result Receives the results in input order.
+     * \return If the file could be read and at least one engine started.
+     */
+    auto run_file(const std::filesystem::path &path, const ResultCallback &on_result) -> bool;
+
+    /**
+     * \brief Analyse all positions of a string.
+     *
+     * \param input The positions, one per line. Must stay valid during the run.
+     * \param on_result Receives the results in input order.
+     * \return If at least one engine started.
+     */
+    auto run(std::string_view input, const ResultCallback &on_result) -> bool;
+
+    /**
+     * \brief Stop a running analysis after the current searches.
+     */
+    auto cancel() -> void { m_cancelled = true; }
+
+    auto statistics() const -> BatchStatistics;
+    auto last_error() const -> const std::string & { return m_last_error; }
+
+    /**
+     * \brief Parse a line of an EPD or FEN file.
+     *
+     * EPD lines contain the first four FEN fields followed by operations.
+     * The halfmove clock and fullmove number are taken from the "hmvc" and
+     * "fmvn" operations, if present.
+     * \param line The line.
+     * \param index Index of the position.
+     * \return The position, if the line is not empty or a comment.
+     */
+    static auto parse_epd_line(std::string_view line, std::size_t index) -> std::optional<BatchPosition>;
+
+    /**
+     * \brief Format a result as EPD line.
+     *
+     * The analysis is added using the operations acd (depth), acn (nodes),
+     * acs (seconds), ce (centipawns), dm (mate), bm (best move) and pv.
+     * Moves are given in UCI notation.
+     * \param result The result.
+     * \return The EPD line.
+     */
+    static auto format_epd_result(const BatchResult &result) -> std::string;
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<BatchPosition> queue;
+    };
+
+    BatchSettings m_settings;
+    ProcessCreator m_process_creator;
+    std::atomic<bool> m_cancelled{false};
+    std::string m_last_error;
+
+    // input, cut into chunks on demand
+    std::mutex m_input_mutex;
+    std::string_view m_input;
+    std::size_t m_input_offset{0};
+    std::size_t m_next_index{0};
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+
+    // results are reordered to input order
+    std::mutex m_results_mutex;
+    std::map<std::size_t, BatchResult> m_pending_results;
+    std::size_t m_next_result{0};
+    const ResultCallback *m_on_result{nullptr};
+
+    std::atomic<std::uint64_t> m_positions{0};
+    std::atomic<std::uint64_t> m_errors{0};
+    std::atomic<std::uint64_t> m_stolen{0};
+    std::atomic<std::uint64_t> m_cache_hits{0};
+    std::atomic<std::uint64_t> m_restarts{0};
+    std::chrono::nanoseconds m_elapsed{0};
+
+    auto run_worker(std::size_t worker_index, std::atomic<std::size_t> &started_engines) -> void;
+    auto next_position(std::size_t worker_index) -> std::optional<BatchPosition>;
+    auto fill_queue(Worker &worker) -> bool;
+    auto steal(std::size_t worker_index) -> std::optional<BatchPosition>;
+    auto publish(BatchResult result) -> void;
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,182 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_COMPACT_INFO_H
+#define CHESSUCI_COMPACT_INFO_H
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+#include "chessuci/move.h"
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+/**
+ * \brief An UCIMove packed into 16 bits.
+ *
+ * Bits 0 to 5 hold the starting square and bits 6 to 11 the target square,
+ * counted from a1 = 0 to h8 = 63. Bits 12 to 14 hold the promotion piece:
+ * zero for none, then knight, bishop, rook and queen.
+ */
+using PackedMove = std::uint16_t;
+
+/**
+ * \brief Pack an UCIMove.
+ */
+auto pack_move(const UCIMove &move) -> PackedMove;
+
+/**
+ * \brief Unpack a move that was packed with pack_move().
+ */
+auto unpack_move(PackedMove move) -> UCIMove;
+
+/**
+ * \brief Parse a move in long algebraic notation directly into a PackedMove.
+ *
+ * Accepts the same moves as parse_uci_move(), without creating an UCIMove.
+ * \param uci_str The move, e.g. "e2e4" or "a7a8q".
+ * \return The packed move, if the string is a valid move.
+ */
+auto parse_packed_move(std::string_view uci_str) -> std::optional<PackedMove>;
+
+/**
+ * \brief The fields of a CompactSearchInfo, as bit positions of its presence mask.
+ */
+enum class InfoField : std::uint8_t {
+    Depth,
+    Seldepth,
+    Time,
+    Nodes,
+    Multipv,
+    Score,
+    ScoreCp,
+    ScoreMate,
+    Lowerbound,
+    Upperbound,
+    Currmove,
+    Currmovenumber,
+    Hashfull,
+    Nps,
+    Tbhits,
+    Sbhits,
+    Cpuload,
+    Currline,
+    Cpunr,
+    Truncated, ///< Moves were dropped, because the move buffer was full.
+};
+
+/**
+ * \brief A search_info without heap storage, for keeping large numbers of infos.
+ *
+ * search_info spends an optional with its own padding on every field and
+ * allocates for the move lists, although most infos carry only a few fields.
+ * CompactSearchInfo marks the present fields in a bitmask and keeps the moves
+ * of the principal variation, the refutation and the current line packed
+ * into one inline buffer of max_moves moves. The object is trivially
+ * copyable and fits into two cache lines.
+ *
+ * Moves that do not fit into the buffer are dropped from the end of their
+ * list and InfoField::Truncated is set; the first moves of a principal
+ * variation are the ones that matter. Infos with a string cannot be
+ * represented, from_search_info() and parse() report them.
+ */
+class CompactSearchInfo {
+public:
+    static constexpr std::size_t max_moves{25}; ///< Capacity of the move buffer, shared by pv, refutation and currline.
+
+    /**
+     * \brief Pack a search_info.
+     *
+     * \return The compact info, or nothing if the info has a string.
+     */
+    static auto from_search_info(const search_info &info) -> std::optional<CompactSearchInfo>;
+
+    /**
+     * \brief Parse an info line without tokenizing it first.
+     *
+     * Follows UCIGuiHandler::try_parse_info_command() and reports the same
+     * errors. The first token, usually "info", is skipped. An info string is
+     * reported as ParseErrorType::UnexpectedToken.
+     * \param line The info line.
+     * \return The parsed info or the parse error.
+     */
+    static auto parse(std::string_view line) -> ParseResult<CompactSearchInfo>;
+
+    /**
+     * \brief Unpack into a search_info.
+     */
+    auto to_search_info() const -> search_info;
+
+    auto has(InfoField field) const -> bool { return (m_fields & bit(field)) != 0; }
+    auto empty() const -> bool { return m_fields == 0 && move_count() == 0; }
+
+    auto depth() const -> std::optional<int> { return get(InfoField::Depth, m_depth); }
+    auto seldepth() const -> std::optional<int> { return get(InfoField::Seldepth, m_seldepth); }
+    auto time() const -> std::optional<std::int64_t> { return get(InfoField::Time, m_time); }
+    auto nodes() const -> std::optional<std::int64_t> { return get(InfoField::Nodes, m_nodes); }
+    auto multipv() const -> std::optional<int> { return get(InfoField::Multipv, m_multipv); }
+    auto score() const -> std::optional<score_info>;
+    auto currmove() const -> std::optional<UCIMove>;
+    auto currmovenumber() const -> std::optional<int> { return get(InfoField::Currmovenumber, m_currmovenumber); }
+    auto hashfull() const -> std::optional<int> { return get(InfoField::Hashfull, m_hashfull); }
+    auto nps() const -> std::optional<std::int64_t> { return get(InfoField::Nps, m_nps); }
+    auto tbhits() const -> std::optional<int> { return get(InfoField::Tbhits, m_tbhits); }
+    auto sbhits() const -> std::optional<int> { return get(InfoField::Sbhits, m_sbhits); }
+    auto cpuload() const -> std::optional<int> { return get(InfoField::Cpuload, m_cpuload); }
+    auto cpunr() const -> std::optional<int> { return get(InfoField::Cpunr, m_cpunr); }
+
+    auto pv() const -> std::span<const PackedMove> { return {m_moves.data(), m_pv_length}; }
+    auto refutation() const -> std::span<const PackedMove> { return {m_moves.data() + m_pv_length, m_refutation_length}; }
+    auto currline() const -> std::span<const PackedMove> { return {m_moves.data() + m_pv_length + m_refutation_length, m_currline_length}; }
+
+    auto operator==(const CompactSearchInfo &rhs) const -> bool = default;
+private:
+    enum class MoveList { Pv, Refutation, Currline };
+
+    static constexpr auto bit(InfoField field) -> std::uint32_t { return std::uint32_t{1} << static_cast<unsigned>(field); }
+
+    template<typename T>
+    auto get(InfoField field, T value) const -> std::optional<T> {
+        return has(field) ? std::optional<T>{value} : std::nullopt;
+    }
+
+    template<typename T>
+    auto set(InfoField field, T &target, T value) -> void {
+        target = value;
+        m_fields |= bit(field);
+    }
+
+    auto move_count() const -> std::size_t { return std::size_t{m_pv_length} + m_refutation_length + m_currline_length; }
+    auto add_move(MoveList list, PackedMove move) -> void;
+
+    std::int64_t m_time{0};
+    std::int64_t m_nodes{0};
+    std::int64_t m_nps{0};
+    std::int32_t m_depth{0};
+    std::int32_t m_seldepth{0};
+    std::int32_t m_multipv{0};
+    std::int32_t m_score_cp{0};
+    std::int32_t m_score_mate{0};
+    std::int32_t m_currmovenumber{0};
+    std::int32_t m_hashfull{0};
+    std::int32_t m_tbhits{0};
+    std::int32_t m_sbhits{0};
+    std::int32_t m_cpuload{0};
+    std::int32_t m_cpunr{0};
+    std::uint32_t m_fields{0}; ///< Presence mask, one bit per InfoField.
+    PackedMove m_currmove{0};
+    std::uint8_t m_pv_length{0};
+    std::uint8_t m_refutation_length{0};
+    std::uint8_t m_currline_length{0};
+    std::array<PackedMove, max_moves> m_moves{}; ///< The pv, followed by the refutation and the currline.
+};
+
+} // namespace chessuci
+
+#endif
@@ -1,90 +1,183 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#ifndef CHESSUCI_ENGINE_HANDLER_H
-#define CHESSUCI_ENGINE_HANDLER_H
-
-#include <atomic>
-#include <functional>
-#include <iostream>
-#include <mutex>
-#include <thread>
-#include <unordered_map>
-
-#include "chessuci/protocol.h"
-#include "chessuci/uci_handler.h"
-
-namespace chessuci {
-
-class UCIEngineHandler : public UCIHandler {
-public:
-    using UciCallback = std::function<void()>;
-    using DebugCallback = std::function<void(bool)>;
-    using IsReadyCallback = std::function<void()>;
-    using SetOptionCallback = std::function<void(const setoption_command &)>;
-    using UCINewGameCallback = std::function<void()>;
-    using PositionCallback = std::function<void(const position_command &)>;
-    using GoCallback = std::function<void(const go_command &)>;
-    using StopCallback = std::function<void()>;
-    using PonderHitCallback = std::function<void()>;
-    using QuitCallback = std::function<void()>;
-
-    explicit UCIEngineHandler(std::istream &input = std::cin, std::ostream &output = std::cout);
-    ~UCIEngineHandler();
-
-    UCIEngineHandler(const UCIEngineHandler &) = delete;
-    auto operator=(const UCIEngineHandler &) -> UCIEngineHandler & = delete;
-
-    auto on_uci(UciCallback callback) -> void { m_uci_callback = std::move(callback); }
-    auto on_debug(DebugCallback callback) -> void { m_debug_callback = std::move(callback); }
-    auto on_isready(IsReadyCallback callback) -> void { m_is_ready_callback = std::move(callback); }
-    auto on_setoption(SetOptionCallback callback) -> void { m_set_option_callback = std::move(callback); }
-    auto on_ucinewgame(UCINewGameCallback callback) -> void { m_uci_new_game_callback = std::move(callback); }
-    auto on_position(PositionCallback callback) -> void { m_position_callback = std::move(callback); }
-    auto on_go(GoCallback callback) -> void { m_go_callback = std::move(callback); }
-    auto on_stop(StopCallback callback) -> void { m_stop_callback = std::move(callback); }
-    auto on_ponderhit(PonderHitCallback callback) -> void { m_ponder_hit_callback = std::move(callback); }
-    auto on_quit(QuitCallback callback) -> void { m_quit_callback = std::move(callback); }
-
-    auto start() -> void;
-    auto stop() -> void;
-
-    auto send_id(const id_info &info) -> void;
-    auto send_option(const Option &option) -> void;
-    auto send_uciok() -> void;
-    auto send_readyok() -> void;
-    auto send_bestmove(const bestmove_info &info) -> void;
-    auto send_bestmove(const UCIMove &move, const std::optional<UCIMove> &ponder = std::nullopt) -> void;
-    auto send_info(const search_info &info) -> void;
-    auto send_info_string(const std::string &message) -> void;
-    auto send_raw(const std::string &message) -> void;
-
-    static auto parse_debug_command(const TokenList &tokens) -> bool;
-    static auto parse_set_option_command(const TokenList &tokens) -> setoption_command;
-    static auto parse_position_command(const TokenList &tokens) -> position_command;
-    static auto parse_go_command(const TokenList &tokens) -> go_command;
-private:
-    std::istream &m_input;
-    std::ostream &m_output;
-
-    auto setup_uci_commands() -> void;
-
-    UciCallback m_uci_callback;
-    DebugCallback m_debug_callback;
-    IsReadyCallback m_is_ready_callback;
-    SetOptionCallback m_set_option_callback;
-    UCINewGameCallback m_uci_new_game_callback;
-    PositionCallback m_position_callback;
-    GoCallback m_go_callback;
-    StopCallback m_stop_callback;
-    PonderHitCallback m_ponder_hit_callback;
-    QuitCallback m_quit_callback;
-
-    auto read_loop() -> void;
-};
-
-} // namespace chessuci
-
-#endif
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_ENGINE_HANDLER_H
+#define CHESSUCI_ENGINE_HANDLER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+#include "chessuci/object_pool.h"
+#include "chessuci/option_registry.h"
+#include "chessuci/protocol.h"
+#include "chessuci/uci_handler.h"
+
+namespace chessuci {
+
+class UCIEngineHandler : public UCIHandler {
+public:
+    using UciCallback = std::function<void()>;
+    using DebugCallback = std::function<void(bool)>;
+    using IsReadyCallback = std::function<void()>;
+    using SetOptionCallback = std::function<void(const setoption_command &)>;
+    using UCINewGameCallback = std::function<void()>;
+    using PositionCallback = std::function<void(const position_command &)>;
+    using PooledPosition = ObjectPool<position_command>::Pointer;
+    using PooledPositionCallback = std::function<void(PooledPosition)>;
+    using GoCallback = std::function<void(const go_command &)>;
+    using StopCallback = std::function<void()>;
+    using PonderHitCallback = std::function<void()>;
+    using QuitCallback = std::function<void()>;
+
+    explicit UCIEngineHandler(std::istream &input = std::cin, std::ostream &output = std::cout);
+    ~UCIEngineHandler();
+
+    UCIEngineHandler(const UCIEngineHandler &) = delete;
+    auto operator=(const UCIEngineHandler &) -> UCIEngineHandler & = delete;
+
+    auto on_uci(UciCallback callback) -> void { m_uci_callback = std::move(callback); }
+    auto on_debug(DebugCallback callback) -> void { m_debug_callback = std::move(callback); }
+    auto on_isready(IsReadyCallback callback) -> void { m_is_ready_callback = std::move(callback); }
+    auto on_setoption(SetOptionCallback callback) -> void { m_set_option_callback = std::move(callback); }
+    auto on_ucinewgame(UCINewGameCallback callback) -> void { m_uci_new_game_callback = std::move(callback); }
+    auto on_position(PositionCallback callback) -> void { m_position_callback = std::move(callback); }
+    auto on_go(GoCallback callback) -> void { m_go_callback = std::move(callback); }
+    auto on_stop(StopCallback callback) -> void { m_stop_callback = std::move(callback); }
+    auto on_ponderhit(PonderHitCallback callback) -> void { m_ponder_hit_callback = std::move(callback); }
+    auto on_quit(QuitCallback callback) -> void { m_quit_callback = std::move(callback); }
+
+    /**
+     * \brief Receive every position command in a pooled object that the callback owns.
+     *
+     * Position commands are usually parsed into one object of the handler
+     * that is only valid during the position callback. With this callback,
+     * every command is parsed into an object of a pool instead and handed
+     * over after the position callback, so a search thread can keep it
+     * without a copy. Destroying the pointer returns the object to the
+     * pool. Must not be called while the handler is running.
+     * \param callback The callback, an empty callback disables pooling.
+     */
+    auto on_pooled_position(PooledPositionCallback callback) -> void { m_pooled_position_callback = std::move(callback); }
+
+    auto start() -> void;
+    auto stop() -> void;
+
+    /**
+     * \brief The typed options of the engine.
+     *
+     * The registered options are sent by send_uciok(), and setoption
+     * commands for them are applied to the registry instead of being passed
+     * to the setoption callback. Invalid values are reported as parse
+     * errors. Options must be added before start().
+     * \return The registry.
+     */
+    auto options() -> OptionRegistry & { return m_options; }
+
+    auto send_id(const id_info &info) -> void;
+    auto send_option(const Option &option) -> void;
+
+    /**
+     * \brief Send the registered options and "uciok".
+     */
+    auto send_uciok() -> void;
+    auto send_readyok() -> void;
+    auto send_bestmove(const bestmove_info &info) -> void;
+    auto send_bestmove(const UCIMove &move, const std::optional<UCIMove> &ponder = std::nullopt) -> void;
+    auto send_info(const search_info &info) -> void;
+
+    /**
+     * \brief Throttle the infos sent with send_info().
+     *
+     * Infos with a principal variation, a score or an info string are always
+     * sent. Other infos (e.g., currmove or nodes updates) are merged and sent
+     * at most once per interval. A principal variation or score supersedes
+     * the pending update, an info string is sent after it. Pending updates
+     * are sent right before the next bestmove.
+     * \param interval Minimum time between two progress updates. Zero
+     *   disables throttling.
+     */
+    auto set_info_throttling(std::chrono::milliseconds interval) -> void;
+
+    /**
+     * \brief Number of infos that were not sent on their own due to throttling.
+     *
+     * \return The number of suppressed infos.
+     */
+    auto suppressed_info_count() const -> std::uint64_t { return m_suppressed_info_count; }
+    auto send_info_string(const std::string &message) -> void;
+    auto send_raw(const std::string &message) -> void;
+
+    static auto parse_debug_command(const TokenList &tokens) -> bool;
+    static auto parse_set_option_command(const TokenList &tokens) -> setoption_command;
+    static auto parse_position_command(const TokenList &tokens) -> position_command;
+    static auto parse_go_command(const TokenList &tokens) -> go_command;
+
+    static auto try_parse_debug_command(const TokenList &tokens) -> ParseResult<bool>;
+    static auto try_parse_set_option_command(const TokenList &tokens) -> ParseResult<setoption_command>;
+    static auto try_parse_position_command(const TokenList &tokens) -> ParseResult<position_command>;
+
+    /**
+     * \brief Parse a position command into an existing command.
+     *
+     * The command is overwritten completely. Its fen and moves keep their
+     * capacity, so reusing one command for every line avoids allocations.
+     * \param tokens The tokens of the position command.
+     * \param command The parsed command, unspecified if parsing fails.
+     * \return Nothing, or the parse error.
+     */
+    static auto try_parse_position_command(const TokenList &tokens, position_command &command) -> ParseResult<void>;
+    static auto try_parse_go_command(const TokenList &tokens) -> ParseResult<go_command>;
+
+    /**
+     * \brief Format an info command as it is sent to the GUI.
+     *
+     * \param info The info.
+     * \return The complete info command.
+     */
+    static auto format_info(const search_info &info) -> std::string;
+private:
+    std::istream &m_input;
+    std::ostream &m_output;
+
+    auto setup_uci_commands() -> void;
+
+    UciCallback m_uci_callback;
+    DebugCallback m_debug_callback;
+    IsReadyCallback m_is_ready_callback;
+    SetOptionCallback m_set_option_callback;
+    UCINewGameCallback m_uci_new_game_callback;
+    PositionCallback m_position_callback;
+    PooledPositionCallback m_pooled_position_callback;
+    GoCallback m_go_callback;
+    StopCallback m_stop_callback;
+    PonderHitCallback m_ponder_hit_callback;
+    QuitCallback m_quit_callback;
+
+    OptionRegistry m_options;
+
+    position_command m_position; // reused for every position command, only accessed by the reader thread
+    ObjectPool<position_command> m_position_pool;
+
+    std::mutex m_info_mutex;
+    std::chrono::milliseconds m_info_interval{0};
+    std::chrono::steady_clock::time_point m_last_info{};
+    std::optional<search_info> m_pending_info;
+    std::atomic<std::uint64_t> m_suppressed_info_count{0};
+
+    auto read_loop() -> void;
+    auto flush_pending_info() -> void;
+    auto handle_setoption(const TokenList &tokens) -> void;
+    auto handle_position(const TokenList &tokens) -> void;
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,127 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_ENGINE_HOST_H
+#define CHESSUCI_ENGINE_HOST_H
+
+#include "chessuci/engine_process_unix.h"
+#include "chessuci/remote_protocol.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+
+namespace chessuci {
+
+/**
+ * \brief Host for remote engine processes.
+ *
+ * The engine host accepts connections from EngineProcessSocket clients, starts
+ * the requested engines locally and relays their input and output. All
+ * connections and engines are served from a single thread. Output of all
+ * engines of a connection, that is available at the same time, is sent with a
+ * single write. Neither a slow client nor a slow engine blocks the thread, the
+ * data buffered for them is limited and the other side is throttled.
+ */
+class EngineHost {
+public:
+    explicit EngineHost(RemoteEndpoint endpoint);
+    ~EngineHost();
+
+    EngineHost(const EngineHost &) = delete;
+    auto operator=(const EngineHost &) -> EngineHost & = delete;
+
+    /**
+     * \brief Allow clients to start an executable.
+     *
+     * Clients can only start allowed executables, at least one must be
+     * allowed before listen().
+     * \param executable Path of an executable that clients may start.
+     */
+    auto allow_executable(const std::filesystem::path &executable) -> void;
+
+    /**
+     * \brief Start listening for connections.
+     *
+     * \return If the endpoint could be bound, false if no executable is allowed.
+     */
+    auto listen() -> bool;
+
+    /**
+     * \brief Serve clients until stop() is called.
+     *
+     * listen() must have been called before.
+     */
+    auto run() -> void;
+
+    /**
+     * \brief Stop serving clients.
+     *
+     * Can be called from any thread and from signal handlers.
+     */
+    auto stop() -> void;
+
+    /**
+     * \brief The address the host is listening on.
+     *
+     * If the host was configured with TCP port 0, the actual port is reported
+     * here after listen().
+     * \return The bound address.
+     */
+    auto bound_endpoint() const -> const RemoteEndpoint & { return m_bound_endpoint; }
+
+    auto session_count() const -> std::size_t { return m_session_count; }
+    auto last_error() const -> const std::string & { return m_last_error; }
+private:
+    struct Engine {
+        std::unique_ptr<EngineProcessUnix> process;
+        std::string input;  ///< Input for the engine that was not written yet.
+        std::string output; ///< Output of the engine that does not form a complete line yet.
+    };
+
+    struct Client {
+        int fd{-1};
+        std::string input;
+        std::string output;
+        std::unordered_map<std::uint32_t, Engine> engines;
+    };
+
+    // an engine whose output was closed or that was killed, reaped without blocking
+    struct ExitingEngine {
+        Client *client; ///< The client to notify, null if the client is gone.
+        std::uint32_t session;
+        std::unique_ptr<EngineProcessUnix> process;
+        std::chrono::steady_clock::time_point kill_time; ///< Time to kill the engine if it is still running.
+    };
+
+    RemoteEndpoint m_endpoint;
+    RemoteEndpoint m_bound_endpoint;
+    std::set<std::filesystem::path> m_allowed_executables;
+    int m_listen_socket{-1};
+    int m_wake_pipe[2]{-1, -1};
+    std::atomic<bool> m_stop_requested{false};
+    std::atomic<std::size_t> m_session_count{0};
+    std::string m_last_error;
+    std::vector<std::unique_ptr<Client>> m_clients;
+    std::vector<ExitingEngine> m_exiting_engines;
+
+    auto accept_client() -> void;
+    auto read_client(Client &client) -> bool;
+    auto handle_frame(Client &client, const RemoteFrame &frame) -> void;
+    auto open_engine(Client &client, std::uint32_t session, const std::string &payload) -> void;
+    auto read_engine(Client &client, std::uint32_t session, Engine &engine) -> bool;
+    auto finish_engine(Client &client, std::uint32_t session, bool kill) -> void;
+    auto reap_engines() -> void;
+    auto close_client(Client &client) -> void;
+    auto is_allowed(const std::filesystem::path &executable) const -> bool;
+    auto set_error(const std::string &message) -> void { m_last_error = message; }
+};
+
+} // namespace chessuci
+
+#endif
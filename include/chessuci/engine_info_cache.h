@@ -0,0 +1,108 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_ENGINE_INFO_CACHE_H
+#define CHESSUCI_ENGINE_INFO_CACHE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+/**
+ * \brief Identifies a specific build of an engine executable.
+ */
+struct ExecutableFingerprint {
+    std::filesystem::path executable; ///< Absolute path of the executable.
+    std::uintmax_t size{0};           ///< File size in bytes.
+    std::int64_t mtime{0};            ///< Last write time in ticks of the file clock.
+    std::uint64_t content_hash{0};    ///< Hash of the file contents.
+
+    auto operator==(const ExecutableFingerprint &rhs) const -> bool = default;
+};
+
+/**
+ * \brief On-disk cache of the id and options engines report in the handshake.
+ *
+ * Every executable is stored in its own file in the cache directory. An entry
+ * is only returned, if path, size, modification time and content hash of the
+ * executable still match, so replacing an engine invalidates its entry.
+ * Different instances may use the same directory; files are replaced
+ * atomically.
+ */
+class EngineInfoCache {
+public:
+    /**
+     * \brief Create a cache.
+     *
+     * \param directory The cache directory. It is created when the first
+     *   entry is stored.
+     */
+    explicit EngineInfoCache(std::filesystem::path directory);
+
+    /**
+     * \brief Look up the handshake of an executable.
+     *
+     * \param executable Path of the engine executable.
+     * \return The cached handshake, if there is a valid entry.
+     */
+    auto lookup(const std::filesystem::path &executable) const -> std::optional<handshake_info>;
+
+    /**
+     * \brief Look up the handshake of an executable by a computed fingerprint.
+     *
+     * \param fingerprint The current fingerprint of the executable.
+     * \return The cached handshake, if there is an entry for this fingerprint.
+     */
+    auto lookup(const ExecutableFingerprint &fingerprint) const -> std::optional<handshake_info>;
+
+    /**
+     * \brief Store the handshake of an executable.
+     *
+     * \param executable Path of the engine executable.
+     * \param info The handshake reported by the engine.
+     * \return If the entry could be written.
+     */
+    auto store(const std::filesystem::path &executable, const handshake_info &info) const -> bool;
+
+    /**
+     * \brief Store the handshake of an executable without hashing it again.
+     *
+     * \param fingerprint The fingerprint of the executable that reported the
+     *   handshake.
+     * \param info The handshake reported by the engine.
+     * \return If the entry could be written.
+     */
+    auto store(const ExecutableFingerprint &fingerprint, const handshake_info &info) const -> bool;
+
+    /**
+     * \brief Remove the entry of an executable.
+     *
+     * \param executable Path of the engine executable.
+     */
+    auto remove(const std::filesystem::path &executable) const -> void;
+
+    auto directory() const -> const std::filesystem::path & { return m_directory; }
+
+    /**
+     * \brief Compute the fingerprint of an executable.
+     *
+     * \param executable Path of the engine executable.
+     * \return The fingerprint, if the file could be read.
+     */
+    static auto fingerprint(const std::filesystem::path &executable) -> std::optional<ExecutableFingerprint>;
+private:
+    std::filesystem::path m_directory;
+
+    auto entry_path(const std::filesystem::path &executable) const -> std::filesystem::path;
+    auto read_entry(const std::filesystem::path &executable, ExecutableFingerprint &cached) const -> std::optional<handshake_info>;
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,181 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_ENGINE_PROCESS_SOCKET_H
+#define CHESSUCI_ENGINE_PROCESS_SOCKET_H
+
+#include "chessuci/engine_process.h"
+#include "chessuci/remote_protocol.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace chessuci {
+
+/**
+ * \brief A connection to a remote engine host.
+ *
+ * Any number of engine sessions can be multiplexed over one connection. The
+ * connection runs a reader thread, that distributes the incoming lines to the
+ * sessions.
+ */
+class RemoteConnection : public std::enable_shared_from_this<RemoteConnection> {
+public:
+    explicit RemoteConnection(RemoteEndpoint endpoint);
+    ~RemoteConnection();
+
+    RemoteConnection(const RemoteConnection &) = delete;
+    auto operator=(const RemoteConnection &) -> RemoteConnection & = delete;
+
+    /**
+     * \brief Connect to the engine host.
+     *
+     * Does nothing if the connection is established, a lost connection is
+     * replaced. Can be called from several threads.
+     * \return If the connection could be established.
+     */
+    auto connect() -> bool;
+
+    /**
+     * \brief Close the connection.
+     *
+     * All engines of this connection are killed by the engine host.
+     */
+    auto disconnect() -> void;
+
+    auto is_connected() const -> bool { return m_connected; }
+    auto endpoint() const -> const RemoteEndpoint & { return m_endpoint; }
+    auto last_error() const -> std::string {
+        std::lock_guard<std::mutex> lock{m_error_mutex};
+        return m_last_error;
+    }
+
+    /**
+     * \brief Create a new engine process that uses this connection.
+     *
+     * The connection must be owned by a std::shared_ptr.
+     * \return The engine process. It is started with EngineProcess::start().
+     */
+    auto create_process() -> std::unique_ptr<EngineProcess>;
+private:
+    friend class EngineProcessSocket;
+
+    struct Session {
+        enum class State { Idle, Opening, Running, Exited, Failed };
+
+        std::uint32_t id{0};
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::string> lines;
+        State state{State::Idle};
+        EngineProcess::proc_id_t pid{-1};
+        std::optional<int> exit_code;
+        std::string error;
+    };
+
+    RemoteEndpoint m_endpoint;
+    std::mutex m_connection_mutex; // serializes connect() and disconnect()
+    int m_socket{-1};              // replaced and closed under m_write_mutex
+    std::atomic<bool> m_connected{false};
+    mutable std::mutex m_error_mutex;
+    std::string m_last_error; // set by the sessions' threads and the reader thread
+    std::thread m_thread;
+
+    std::mutex m_write_mutex;
+    std::mutex m_sessions_mutex;
+    std::unordered_map<std::uint32_t, std::shared_ptr<Session>> m_sessions;
+    std::atomic<std::uint32_t> m_next_session{1};
+
+    auto open_session() -> std::shared_ptr<Session>;
+    auto close_session(std::uint32_t id) -> void;
+    auto send_frame(const RemoteFrame &frame) -> bool;
+    auto close_socket() -> void;
+    auto dispatch_frame(RemoteFrame &frame) -> void;
+    auto read_loop() -> void;
+    auto set_error(const std::string &message) -> void {
+        std::lock_guard<std::mutex> lock{m_error_mutex};
+        m_last_error = message;
+    }
+};
+
+/**
+ * \brief An engine process running on a remote engine host.
+ *
+ * The engine is started by an EngineHost and all communication is relayed
+ * over a socket.
+ */
+class EngineProcessSocket : public EngineProcess {
+public:
+    /**
+     * \brief Create an engine process with its own connection.
+     *
+     * The connection to the engine host is established in start().
+     * \param endpoint Address of the engine host.
+     */
+    explicit EngineProcessSocket(RemoteEndpoint endpoint);
+
+    /**
+     * \brief Create an engine process on a shared connection.
+     *
+     * \param connection The connection to the engine host.
+     */
+    explicit EngineProcessSocket(std::shared_ptr<RemoteConnection> connection);
+    ~EngineProcessSocket() override;
+
+    /** \copydoc EngineProcess::start */
+    auto start(const ProcessParams &params) -> bool override;
+
+    /** \copydoc EngineProcess::is_running */
+    auto is_running() const -> bool override;
+
+    /**
+     * \brief Get the process id.
+     *
+     * Returns the id of the engine process on the remote host.
+     * \return Process id of the engine.
+     */
+    auto pid() const -> proc_id_t override;
+
+    /** \copydoc EngineProcess::terminate */
+    auto terminate(int timeout_ms = 3000) -> bool override;
+
+    /** \copydoc EngineProcess::kill */
+    auto kill() -> void override;
+
+    /** \copydoc EngineProcess::wait_for_exit */
+    auto wait_for_exit(int timeout_ms = 0) -> std::optional<int> override;
+
+    /** \copydoc EngineProcess::write_line */
+    auto write_line(const std::string &line) -> bool override;
+
+    /** \copydoc EngineProcess::read_line */
+    auto read_line(std::string &line) -> bool override;
+
+    /** \copydoc EngineProcess::can_read */
+    auto can_read() const -> bool override;
+
+    /** \copydoc EngineProcess::last_error */
+    auto last_error() const -> const std::string & override;
+private:
+    static constexpr int open_timeout_ms{5000};
+    static constexpr int kill_timeout_ms{1000};
+
+    std::shared_ptr<RemoteConnection> m_connection;
+    std::shared_ptr<RemoteConnection::Session> m_session;
+    mutable std::string m_last_error;
+
+    auto wait_for_state(int timeout_ms) -> bool;
+    auto release_session() -> void;
+    auto set_error(const std::string &message) const -> void { m_last_error = message; }
+};
+
+} // namespace chessuci
+
+#endif
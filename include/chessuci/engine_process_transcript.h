@@ -0,0 +1,132 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_ENGINE_PROCESS_TRANSCRIPT_H
+#define CHESSUCI_ENGINE_PROCESS_TRANSCRIPT_H
+
+#include "chessuci/engine_process.h"
+#include "chessuci/transcript.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+
+namespace chessuci {
+
+/**
+ * \brief An engine process that records all communication.
+ *
+ * Decorates another engine process and writes every line that is sent to or
+ * read from the engine into a binary transcript.
+ */
+class RecordingEngineProcess : public EngineProcess {
+public:
+    /**
+     * \brief Record the communication with an engine process.
+     *
+     * \param process The engine process to decorate.
+     * \param transcript Path of the transcript file. An existing file is
+     *   overwritten.
+     */
+    RecordingEngineProcess(std::unique_ptr<EngineProcess> process, const std::filesystem::path &transcript);
+    ~RecordingEngineProcess() override;
+
+    auto start(const ProcessParams &params) -> bool override { return m_process->start(params); }
+    auto is_running() const -> bool override { return m_process->is_running(); }
+    auto pid() const -> proc_id_t override { return m_process->pid(); }
+    auto terminate(int timeout_ms = 3000) -> bool override;
+    auto kill() -> void override;
+    auto wait_for_exit(int timeout_ms = 0) -> std::optional<int> override { return m_process->wait_for_exit(timeout_ms); }
+    auto write_line(const std::string &line) -> bool override;
+    auto read_line(std::string &line) -> bool override;
+    auto can_read() const -> bool override { return m_process->can_read(); }
+    auto last_error() const -> const std::string & override { return m_process->last_error(); }
+    auto exit_descriptor() const -> int override { return m_process->exit_descriptor(); }
+    auto set_wait_settings(const WaitSettings &settings) -> void override { m_process->set_wait_settings(settings); }
+
+    auto transcript() -> TranscriptWriter & { return m_transcript; }
+private:
+    std::unique_ptr<EngineProcess> m_process;
+    TranscriptWriter m_transcript;
+};
+
+/**
+ * \brief An engine process that replays the engine side of a transcript.
+ *
+ * No process is started. Instead, the lines the engine sent in the recorded
+ * session are returned by read_line(). The engine's lines following a line
+ * sent to the engine are released when the corresponding line is written, so
+ * the replay stays in step with the GUI. Lines that differ from the recorded
+ * input are counted as mismatches.
+ * Lines are either released with their original delays or as fast as
+ * possible, which makes a replay usable as a load generator.
+ */
+class ReplayEngineProcess : public EngineProcess {
+public:
+    enum class Timing {
+        Original,         ///< Keep the recorded delay between input and output.
+        AsFastAsPossible, ///< Release output immediately.
+    };
+
+    explicit ReplayEngineProcess(std::vector<TranscriptEntry> transcript, Timing timing = Timing::AsFastAsPossible);
+
+    auto start(const ProcessParams &params) -> bool override;
+    auto is_running() const -> bool override { return m_running; }
+    auto pid() const -> proc_id_t override { return 0; }
+    auto terminate(int timeout_ms = 3000) -> bool override;
+    auto kill() -> void override;
+    auto wait_for_exit(int timeout_ms = 0) -> std::optional<int> override;
+    auto write_line(const std::string &line) -> bool override;
+    auto read_line(std::string &line) -> bool override;
+    auto can_read() const -> bool override;
+
+    /**
+     * \brief Get the last error message.
+     *
+     * The error is set by the writing and the reading thread, always under
+     * the replay's mutex. Read it after the call that failed.
+     * \return The last error message.
+     */
+    auto last_error() const -> const std::string & override;
+
+    /**
+     * \brief Number of written lines that did not match the transcript.
+     *
+     * \return The number of mismatches.
+     */
+    auto mismatches() const -> std::size_t { return m_mismatches; }
+
+    /**
+     * \brief Check, if the complete transcript has been replayed.
+     *
+     * \return If all entries have been consumed.
+     */
+    auto finished() const -> bool;
+private:
+    using clock = std::chrono::steady_clock;
+
+    struct PendingLine {
+        clock::time_point ready_at;
+        std::string line;
+    };
+
+    std::vector<TranscriptEntry> m_transcript;
+    Timing m_timing;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::size_t m_position{0};
+    std::deque<PendingLine> m_pending;
+    std::atomic<bool> m_running{false};
+    std::atomic<std::size_t> m_mismatches{0};
+    std::string m_last_error; // set under m_mutex
+
+    auto release_output(clock::time_point now, std::chrono::nanoseconds trigger) -> void;
+    auto stop_replay() -> void;
+};
+
+} // namespace chessuci
+
+#endif
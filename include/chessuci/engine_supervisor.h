@@ -0,0 +1,141 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_ENGINE_SUPERVISOR_H
+#define CHESSUCI_ENGINE_SUPERVISOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "chessuci/engine_process.h"
+#include "chessuci/gui_handler.h"
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+/**
+ * \brief When and how often a crashed engine is restarted.
+ */
+struct RestartPolicy {
+    std::chrono::milliseconds initial_backoff{100}; ///< Delay before the first restart after a crash.
+    std::chrono::milliseconds max_backoff{10000};   ///< Upper limit of the delay, which doubles with every consecutive crash.
+    int max_crashes{5};                             ///< The engine is given up after more crashes within the crash window.
+    std::chrono::milliseconds crash_window{60000};  ///< Time span the crashes are counted in.
+    int max_replays{2};                             ///< How often an interrupted search is replayed before it fails.
+};
+
+/**
+ * \brief Keeps an engine running across crashes.
+ *
+ * The supervisor owns an UCIGuiHandler and starts the engine with the same
+ * process parameters and options after it exited. A crash is detected, when
+ * the reader fails the pending search or the engine process is no longer
+ * running. The position and go command of an interrupted search are sent to
+ * the restarted engine again. Consecutive crashes delay the restart with an
+ * exponential backoff; an engine that crashes too often within the crash
+ * window is given up, and all further searches fail.
+ * A supervisor is meant to be used from a single thread. Callbacks are set
+ * before starting the engine and are kept across restarts.
+ */
+class EngineSupervisor {
+public:
+    using InfoCallback = UCIGuiHandler::InfoCallback;
+    using RestartCallback = std::function<void(std::uint64_t restarts)>;
+    using ProcessCreator = std::function<std::unique_ptr<EngineProcess>()>;
+
+    EngineSupervisor(ProcessParams params, std::vector<setoption_command> options, RestartPolicy policy = {});
+    ~EngineSupervisor();
+
+    EngineSupervisor(const EngineSupervisor &) = delete;
+    auto operator=(const EngineSupervisor &) -> EngineSupervisor & = delete;
+
+    /**
+     * \brief Set the function that creates the engine processes.
+     *
+     * By default, local processes are created.
+     * \param creator Creates one engine process per call.
+     */
+    auto set_process_creator(ProcessCreator creator) -> void { m_process_creator = std::move(creator); }
+
+    /**
+     * \brief Set the callback for infos of all engine instances.
+     */
+    auto on_info(InfoCallback callback) -> void { m_info_callback = std::move(callback); }
+
+    /**
+     * \brief Set the callback called after the engine was restarted.
+     *
+     * Infos of an interrupted search may already have been passed to the info
+     * callback, before the search is replayed.
+     */
+    auto on_restart(RestartCallback callback) -> void { m_restart_callback = std::move(callback); }
+
+    /**
+     * \brief Start and initialize the engine.
+     *
+     * The first start is not retried.
+     * \return If the engine was initialized.
+     */
+    auto start() -> bool;
+
+    /**
+     * \brief Search a position.
+     *
+     * Blocks until the engine sent the bestmove. If the engine crashes, it is
+     * restarted and the search is replayed.
+     * \param position The position command.
+     * \param go The go command.
+     * \return The bestmove of the search.
+     * \throws UCIError If the search failed after all replays or the engine
+     *   was given up.
+     */
+    auto search(const position_command &position, const go_command &go) -> bestmove_info;
+
+    auto stop() -> void;
+
+    /**
+     * \brief The handler of the current engine instance.
+     *
+     * Commands sent directly through the handler are not replayed.
+     * \return The handler.
+     */
+    auto handler() -> UCIGuiHandler & { return *m_handler; }
+    auto handshake() const -> const handshake_info & { return m_handshake; }
+    auto restarts() const -> std::uint64_t { return m_restarts; }
+    auto replays() const -> std::uint64_t { return m_replays; }
+    auto given_up() const -> bool { return m_given_up; }
+    auto last_error() const -> const std::string & { return m_last_error; }
+private:
+    using clock = std::chrono::steady_clock;
+
+    ProcessParams m_params;
+    std::vector<setoption_command> m_options;
+    RestartPolicy m_policy;
+    ProcessCreator m_process_creator;
+    InfoCallback m_info_callback;
+    RestartCallback m_restart_callback;
+
+    std::unique_ptr<UCIGuiHandler> m_handler;
+    handshake_info m_handshake;
+    std::deque<clock::time_point> m_crashes;
+    int m_consecutive_crashes{0};
+    std::uint64_t m_restarts{0};
+    std::uint64_t m_replays{0};
+    bool m_given_up{false};
+    std::string m_last_error;
+
+    auto launch() -> bool;
+    auto restart() -> void;
+    auto crashed() const -> bool;
+};
+
+} // namespace chessuci
+
+#endif
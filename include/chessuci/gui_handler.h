@@ -1,86 +1,369 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#ifndef CHESSUCI_GUI_HANDLER_H
-#define CHESSUCI_GUI_HANDLER_H
-
-#include <memory>
-#include <thread>
-
-#include "chessuci/engine_process.h"
-#include "chessuci/process_factory.h"
-#include "chessuci/protocol.h"
-#include "chessuci/uci_handler.h"
-
-namespace chessuci {
-
-class UCIGuiHandler : public UCIHandler {
-public:
-    using IdNameCallback = std::function<void(const std::string &)>;
-    using IdAuthorCallback = std::function<void(const std::string &)>;
-    using UCIOkCallback = std::function<void()>;
-    using ReadyokCallback = std::function<void()>;
-    using BestmoveCallback = std::function<void(const bestmove_info &)>;
-    using InfoCallback = std::function<void(const search_info &)>;
-    using OptionCallback = std::function<void(const Option &)>;
-
-    explicit UCIGuiHandler();
-    explicit UCIGuiHandler(std::unique_ptr<EngineProcess> process);
-    ~UCIGuiHandler();
-
-    auto on_id_name(IdNameCallback callback) -> void { m_id_name_callback = std::move(callback); }
-    auto on_id_author(IdAuthorCallback callback) -> void { m_id_author_callback = std::move(callback); }
-    auto on_uciok(UCIOkCallback callback) -> void { m_uciok_callback = std::move(callback); }
-    auto on_readyok(ReadyokCallback callback) -> void { m_readyok_callback = std::move(callback); }
-    auto on_bestmove(BestmoveCallback callback) -> void { m_bestmove_callback = std::move(callback); }
-    auto on_info(InfoCallback callback) -> void { m_info_callback = std::move(callback); }
-    auto on_option(OptionCallback callback) -> void { m_option_callback = std::move(callback); }
-
-    auto send_uci() -> bool;
-    auto send_debug(bool on) -> bool;
-    auto send_setoption(const setoption_command &command) -> bool;
-    auto send_isready() -> bool;
-    auto send_ucinewgame() -> bool;
-    auto send_position(const position_command &command) -> bool;
-    auto send_go(const go_command &command) -> bool;
-    auto send_stop() -> bool;
-    auto send_ponderhist() -> bool;
-    auto send_quit() -> bool;
-    auto send_raw(const std::string &message) -> bool;
-
-    auto start(const ProcessParams &params) -> bool;
-    auto stop() -> void;
-    auto process() const -> const EngineProcess & { return *m_process; }
-
-    static auto parse_bestmove_command(const TokenList &tokens) -> bestmove_info;
-    static auto parse_info_command(const TokenList &tokens) -> search_info;
-    static auto parse_option_command(const TokenList &tokens) -> Option;
-    static auto parse_score(const TokenList &tokens, size_t index) -> score_info;
-
-    template<typename T>
-    static auto parse_int_param(const TokenList &tokens, size_t index, std::optional<T> &target) -> void;
-    static auto collect_string(const TokenList &tokens, size_t index) -> std::string;
-private:
-    static constexpr int engine_terminate_timeout{3000};
-
-    std::unique_ptr<EngineProcess> m_process;
-
-    // dispatches different "id" messages to corresponding callbacks
-    auto handle_id_message(const TokenList &tokens) const -> void;
-    IdNameCallback m_id_name_callback;
-    IdAuthorCallback m_id_author_callback;
-    UCIOkCallback m_uciok_callback;
-    ReadyokCallback m_readyok_callback;
-    BestmoveCallback m_bestmove_callback;
-    InfoCallback m_info_callback;
-    OptionCallback m_option_callback;
-
-    auto setup_uci_commands() -> void;
-    auto read_loop() -> void;
-};
-
-} // namespace chessuci
-
-#endif
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_GUI_HANDLER_H
+#define CHESSUCI_GUI_HANDLER_H
+
+#include <deque>
+#include <future>
+#include <memory>
+#include <thread>
+
+#include "chessuci/engine_info_cache.h"
+#include "chessuci/engine_process.h"
+#include "chessuci/info_coalescer.h"
+#include "chessuci/latency_histogram.h"
+#include "chessuci/live_analysis.h"
+#include "chessuci/object_pool.h"
+#include "chessuci/process_factory.h"
+#include "chessuci/protocol.h"
+#include "chessuci/response.h"
+#include "chessuci/uci_handler.h"
+#include "chessuci/watchdog.h"
+
+namespace chessuci {
+
+/**
+ * \brief Result of initializing an engine.
+ */
+struct initialize_info {
+    handshake_info handshake;                        ///< Id and options reported by the engine.
+    std::vector<setoption_command> rejected_options; ///< Requested options the engine does not support.
+    bool cache_outdated{false};                      ///< The options were checked against a cached handshake the engine no longer reports.
+};
+
+class UCIGuiHandler : public UCIHandler {
+public:
+    using IdNameCallback = std::function<void(const std::string &)>;
+    using IdAuthorCallback = std::function<void(const std::string &)>;
+    using UCIOkCallback = std::function<void()>;
+    using ReadyokCallback = std::function<void()>;
+    using BestmoveCallback = std::function<void(const bestmove_info &)>;
+    using InfoCallback = std::function<void(const search_info &)>;
+    using PooledInfo = ObjectPool<search_info>::Pointer;
+    using PooledInfoCallback = std::function<void(PooledInfo)>;
+    using OptionCallback = std::function<void(const Option &)>;
+
+    explicit UCIGuiHandler();
+    explicit UCIGuiHandler(std::unique_ptr<EngineProcess> process);
+    ~UCIGuiHandler();
+
+    auto on_id_name(IdNameCallback callback) -> void { m_id_name_callback = std::move(callback); }
+    auto on_id_author(IdAuthorCallback callback) -> void { m_id_author_callback = std::move(callback); }
+    auto on_uciok(UCIOkCallback callback) -> void { m_uciok_callback = std::move(callback); }
+    auto on_readyok(ReadyokCallback callback) -> void { m_readyok_callback = std::move(callback); }
+    auto on_bestmove(BestmoveCallback callback) -> void { m_bestmove_callback = std::move(callback); }
+    auto on_info(InfoCallback callback) -> void { m_info_callback = std::move(callback); }
+    auto on_option(OptionCallback callback) -> void { m_option_callback = std::move(callback); }
+
+    /**
+     * \brief Receive every info in a pooled object that the callback owns.
+     *
+     * Infos are usually parsed into one object of the handler that is only
+     * valid during the info callback. With this callback, every info is
+     * parsed into an object of a pool instead and handed over after the
+     * regular info handling, so it can be kept, e.g. queued for another
+     * thread, without a copy. Destroying the pointer returns the object to
+     * the pool, its move lists keep their capacity for the next info. Must
+     * not be called while the handler is running.
+     * \param callback The callback, an empty callback disables pooling.
+     */
+    auto on_pooled_info(PooledInfoCallback callback) -> void { m_pooled_info_callback = std::move(callback); }
+
+    /**
+     * \brief The pool of the pooled info callback.
+     */
+    auto info_pool() const -> const ObjectPool<search_info> & { return m_info_pool; }
+
+    /**
+     * \brief Coalesce info messages before passing them to the info callback.
+     *
+     * Only the latest info per multipv line is delivered, at most once per
+     * interval. Pending infos are always delivered before the bestmove
+     * callback is called. Pending infos are only delivered when the next info
+     * or the bestmove arrives, so a quiet engine delays its last infos.
+     * Must not be called while the handler is running.
+     * \param interval Minimum time between two deliveries. Zero disables
+     *   coalescing.
+     */
+    auto set_info_coalescing(std::chrono::milliseconds interval) -> void;
+
+    /**
+     * \brief Statistics of the info coalescing.
+     *
+     * \return The statistics, all zero if coalescing is disabled.
+     */
+    auto info_coalescing_statistics() const -> InfoCoalescer::Statistics;
+
+    /**
+     * \brief Choose how the reader thread waits for the engine's output.
+     *
+     * Spinning or busy-polling lowers the latency of every response, e.g.
+     * for bullet games, at the cost of CPU time. Must be called before the
+     * engine is started.
+     * \param settings The wait settings.
+     */
+    auto set_wait_settings(const WaitSettings &settings) -> void { m_process->set_wait_settings(settings); }
+
+    /**
+     * \brief Latencies of the engine's responses.
+     *
+     * Every "isready", "go" and "stop" is timestamped when it is sent, and
+     * the time until the matching response arrives on the reader thread is
+     * recorded. The latencies include the time the engine needs to process
+     * the command.
+     * \return The histograms of this engine.
+     */
+    auto latencies() const -> const ProtocolLatencies & { return m_latencies; }
+
+    /**
+     * \brief Enforce the deadlines of searches with a watchdog.
+     *
+     * Every search started with send_go(), async_go() or co_go() is watched
+     * until its bestmove arrives. The watchdog stops a search that overruns
+     * its expected end and terminates or kills an engine that does not
+     * answer. A pipelined search is watched once the search before it sent
+     * its bestmove. Must not be called while a search is running. The
+     * watchdog must outlive the handler.
+     * \param watchdog The watchdog, usually shared by many handlers.
+     * \param name Name the overrun statistics are collected under.
+     */
+    auto set_watchdog(Watchdog &watchdog, std::string name) -> void;
+
+    /**
+     * \brief Keep the engine's current lines in a live analysis table.
+     *
+     * Every info is written to the table on the reader thread before it is
+     * coalesced or passed to the info callback. The lines are cleared when
+     * the first info of a new search arrives. Must not be called while the
+     * handler is running. The table must outlive the handler.
+     * \param analysis The table.
+     */
+    auto set_live_analysis(LiveAnalysis &analysis) -> void { m_live_analysis = &analysis; }
+
+    auto send_uci() -> bool;
+    auto send_debug(bool on) -> bool;
+    auto send_setoption(const setoption_command &command) -> bool;
+    auto send_isready() -> bool;
+    auto send_ucinewgame() -> bool;
+    auto send_position(const position_command &command) -> bool;
+    auto send_go(const go_command &command) -> bool;
+    auto send_stop() -> bool;
+    auto send_ponderhist() -> bool;
+    auto send_quit() -> bool;
+    auto send_raw(const std::string &message) -> bool;
+
+    /**
+     * \brief Send "isready" and receive "readyok" asynchronously.
+     *
+     * Requests of the same kind are matched to responses in the order they
+     * were sent, so any number of requests can be in flight. Do not mix
+     * send_isready() with pending asynchronous isready requests. If the engine
+     * terminates, all pending requests fail with a UCIError.
+     * \return A future that is ready when "readyok" was received.
+     */
+    auto async_isready() -> std::future<void>;
+
+    /**
+     * \brief Start a search and receive its best move asynchronously.
+     *
+     * \param command The go command.
+     * \return A future that receives the bestmove of the search.
+     */
+    auto async_go(const go_command &command) -> std::future<bestmove_info>;
+
+    /**
+     * \brief Send "uci" and receive the engine's id and options asynchronously.
+     *
+     * \return A future that receives everything the engine sent until "uciok".
+     */
+    auto async_handshake() -> std::future<handshake_info>;
+
+    /**
+     * \brief Coroutine variant of async_isready().
+     *
+     * \return An awaitable that completes when "readyok" was received.
+     */
+    auto co_isready() -> ResponseAwaitable<void>;
+
+    /**
+     * \brief Coroutine variant of async_go().
+     *
+     * \param command The go command.
+     * \return An awaitable that completes with the bestmove of the search.
+     */
+    auto co_go(const go_command &command) -> ResponseAwaitable<bestmove_info>;
+
+    /**
+     * \brief Coroutine variant of async_handshake().
+     *
+     * \return An awaitable that completes with the engine's id and options.
+     */
+    auto co_handshake() -> ResponseAwaitable<handshake_info>;
+
+    /**
+     * \brief Start and initialize an engine with a single call.
+     *
+     * Starts the engine, if it is not running, and sends "uci". As soon as
+     * "uciok" is received, the requested options are checked against the
+     * options the engine advertised, the valid ones are sent together with
+     * "isready", without a round trip through the caller. Options with an
+     * unknown name or an invalid value are not sent.
+     * \param params Parameters to start the engine process.
+     * \param options Options to set.
+     * \return A future that is ready when "readyok" was received.
+     */
+    auto initialize(const ProcessParams &params, const std::vector<setoption_command> &options = {}) -> std::future<initialize_info>;
+
+    /**
+     * \brief Start and initialize an engine using cached engine infos.
+     *
+     * Like initialize(), but if the cache has an entry for the executable, the
+     * options are checked against the cached option list and sent together
+     * with "uci" and "isready" without waiting for "uciok". This is safe,
+     * because the engine reads its input in order and answers "uci" before
+     * it reads the options. The cache is updated, if the engine reports a
+     * different handshake; the result then reports the cache as outdated and
+     * rejects all options that either handshake does not accept. The cache
+     * must outlive the returned future.
+     * \param params Parameters to start the engine process.
+     * \param options Options to set.
+     * \param cache Cache of engine infos.
+     * \return A future that is ready when "readyok" was received.
+     */
+    auto initialize(const ProcessParams &params, const std::vector<setoption_command> &options, EngineInfoCache &cache) -> std::future<initialize_info>;
+
+    auto start(const ProcessParams &params) -> bool;
+    auto stop() -> void;
+
+    /**
+     * \brief Stop several handlers at once.
+     *
+     * All engines are asked to quit together and the engines that did not
+     * exit are killed after one shared timeout, see
+     * EngineProcess::terminate_all().
+     * \param handlers The handlers to stop.
+     */
+    static auto stop_all(std::span<UCIGuiHandler *const> handlers) -> void;
+    auto process() const -> const EngineProcess & { return *m_process; }
+
+    static auto parse_bestmove_command(const TokenList &tokens) -> bestmove_info;
+    static auto parse_info_command(const TokenList &tokens) -> search_info;
+    static auto parse_option_command(const TokenList &tokens) -> Option;
+    static auto parse_score(const TokenList &tokens, size_t index) -> score_info;
+
+    static auto try_parse_bestmove_command(const TokenList &tokens) -> ParseResult<bestmove_info>;
+    static auto try_parse_info_command(const TokenList &tokens) -> ParseResult<search_info>;
+
+    /**
+     * \brief Parse an info command into an existing info.
+     *
+     * The info is overwritten completely. Its move lists and string keep
+     * their capacity, so reusing one info for every line avoids allocations.
+     * \param tokens The tokens of the info command.
+     * \param info The parsed info, unspecified if parsing fails.
+     * \return Nothing, or the parse error.
+     */
+    static auto try_parse_info_command(const TokenList &tokens, search_info &info) -> ParseResult<void>;
+
+    /**
+     * \brief Parse an info command into an existing info, reusing current lines.
+     *
+     * Like the overload above. Current lines come and go between infos, so
+     * the buffer of a current line that the info drops is moved to
+     * spare_currline, and a new current line takes its buffer from there.
+     * \param tokens The tokens of the info command.
+     * \param info The parsed info, unspecified if parsing fails.
+     * \param spare_currline Buffer for current lines, kept between calls.
+     * \return Nothing, or the parse error.
+     */
+    static auto try_parse_info_command(const TokenList &tokens, search_info &info, std::vector<UCIMove> &spare_currline) -> ParseResult<void>;
+    static auto try_parse_option_command(const TokenList &tokens) -> ParseResult<Option>;
+    static auto try_parse_score(const TokenList &tokens, size_t index) -> ParseResult<score_info>;
+
+    template<typename T>
+    static auto parse_int_param(const TokenList &tokens, size_t index, std::optional<T> &target) -> void;
+    template<typename T>
+    static auto try_parse_int_param(const TokenList &tokens, size_t index) -> ParseResult<T>;
+    static auto collect_string(const TokenList &tokens, size_t index) -> std::string;
+private:
+    static constexpr int engine_terminate_timeout{3000};
+
+    std::unique_ptr<EngineProcess> m_process;
+
+    // dispatches different "id" messages to corresponding callbacks
+    auto handle_id_message(const TokenList &tokens) -> void;
+    IdNameCallback m_id_name_callback;
+    IdAuthorCallback m_id_author_callback;
+    UCIOkCallback m_uciok_callback;
+    ReadyokCallback m_readyok_callback;
+    BestmoveCallback m_bestmove_callback;
+    InfoCallback m_info_callback;
+    OptionCallback m_option_callback;
+    PooledInfoCallback m_pooled_info_callback;
+
+    search_info m_info;                    // reused for every info, only accessed by the reader thread
+    std::vector<UCIMove> m_spare_currline; // buffer of dropped current lines, likewise
+    ObjectPool<search_info> m_info_pool;
+
+    std::unique_ptr<InfoCoalescer> m_info_coalescer;
+
+    // send times of the commands whose responses are measured
+    using clock = std::chrono::steady_clock;
+    ProtocolLatencies m_latencies;
+    std::mutex m_latency_mutex;
+    struct SentSearch {
+        clock::time_point go;
+        std::optional<clock::time_point> stop;
+        bool info_received{false};
+    };
+    std::deque<clock::time_point> m_isready_sent;
+    std::deque<SentSearch> m_searches_sent; // pipelined searches in the order they were sent
+    std::atomic<bool> m_awaiting_info{false};
+    auto record_sent(const std::string &message, clock::time_point now) -> void;
+    auto record_readyok(clock::time_point now) -> void;
+    auto record_bestmove(clock::time_point now) -> void;
+
+    // searches in the order their bestmoves are expected, only the running front one is watched
+    struct WatchedSearch {
+        std::optional<std::chrono::milliseconds> duration;
+        std::optional<Watchdog::Id> id;
+    };
+    Watchdog *m_watchdog{nullptr};
+    LiveAnalysis *m_live_analysis{nullptr};
+    std::string m_watchdog_name;
+    std::mutex m_watches_mutex;
+    std::deque<WatchedSearch> m_watches;
+    auto watch_search(const go_command &command) -> void;
+    auto start_watch(WatchedSearch &search) -> void; // requires m_watches_mutex
+    auto finish_search(bool completed) -> void;
+    auto cancel_searches() -> void;
+    auto handle_info(const search_info &info) -> void;
+    auto handle_bestmove(const bestmove_info &info) -> void;
+
+    // pending asynchronous requests, completed in FIFO order
+    std::mutex m_requests_mutex;
+    std::deque<ResponseHandler<void>> m_readyok_requests;
+    std::deque<ResponseHandler<bestmove_info>> m_bestmove_requests;
+    std::deque<ResponseHandler<handshake_info>> m_handshake_requests;
+    handshake_info m_handshake; // only accessed by the reader thread
+
+    template<typename T>
+    auto submit_request(std::deque<ResponseHandler<T>> &queue, const std::string &message, ResponseHandler<T> handler) -> bool;
+    template<typename T>
+    auto complete_request(std::deque<ResponseHandler<T>> &queue, ResponseResult<T> result) -> void;
+    auto fail_requests() -> void;
+    auto write_raw(const std::string &message) -> bool; // requires m_output_mutex
+    auto try_send_raw(const std::string &message) -> bool;
+    auto initialize_engine(const ProcessParams &params, const std::vector<setoption_command> &options, std::optional<handshake_info> cached,
+                           std::function<void(const handshake_info &)> on_handshake) -> std::future<initialize_info>;
+
+    auto setup_uci_commands() -> void;
+    auto read_loop() -> void;
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,91 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_INFO_COALESCER_H
+#define CHESSUCI_INFO_COALESCER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+/**
+ * \brief Coalesces info messages of an engine per multipv line.
+ *
+ * Only the latest state of every multipv line is kept. Infos that do not
+ * contain a principal variation (e.g., currmove or nps updates) are merged
+ * into the pending info of their line, infos with a new principal variation
+ * replace it. Pending infos are delivered in multipv order at most once per
+ * interval. Infos with an info string or a multipv above max_lines are never
+ * coalesced.
+ * The coalescer has no timer of its own: pending infos are only delivered by
+ * the next call to add() or flush(). If the engine stops sending infos, the
+ * last ones stay pending until they are flushed, e.g. at the bestmove.
+ * The coalescer is not thread safe, except for reading the statistics.
+ */
+class InfoCoalescer {
+public:
+    using clock = std::chrono::steady_clock;
+    using DeliverCallback = std::function<void(const search_info &)>;
+
+    /// Highest multipv line that is coalesced, higher lines are passed through.
+    static constexpr int max_lines{256};
+
+    struct Statistics {
+        std::uint64_t received{0};  ///< Number of infos passed to add().
+        std::uint64_t delivered{0}; ///< Number of infos delivered.
+        std::uint64_t merged{0};    ///< Number of infos merged into a pending info.
+        std::uint64_t dropped{0};   ///< Number of pending infos replaced before delivery.
+    };
+
+    /**
+     * \brief Create a coalescer.
+     *
+     * \param interval Minimum time between two deliveries.
+     */
+    explicit InfoCoalescer(std::chrono::milliseconds interval);
+
+    /**
+     * \brief Add an info.
+     *
+     * Delivers all pending infos, if the interval since the last delivery has
+     * elapsed.
+     * \param info The info.
+     * \param now The current time.
+     * \param deliver Receives the infos that are delivered.
+     */
+    auto add(const search_info &info, clock::time_point now, const DeliverCallback &deliver) -> void;
+
+    /**
+     * \brief Deliver all pending infos immediately.
+     *
+     * \param deliver Receives the pending infos.
+     */
+    auto flush(const DeliverCallback &deliver) -> void;
+
+    auto has_pending() const -> bool { return m_pending_count > 0; }
+    auto interval() const -> std::chrono::milliseconds { return m_interval; }
+    auto statistics() const -> Statistics;
+private:
+    std::chrono::milliseconds m_interval;
+    clock::time_point m_last_delivery{};
+    std::vector<std::optional<search_info>> m_pending; // indexed by multipv - 1
+    std::size_t m_pending_count{0};
+
+    std::atomic<std::uint64_t> m_received{0};
+    std::atomic<std::uint64_t> m_delivered{0};
+    std::atomic<std::uint64_t> m_merged{0};
+    std::atomic<std::uint64_t> m_dropped{0};
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,86 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_LATENCY_HISTOGRAM_H
+#define CHESSUCI_LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace chessuci {
+
+/**
+ * \brief Lock-free histogram of latencies.
+ *
+ * Latencies are counted in microseconds in log-linear buckets like an HDR
+ * histogram: values below 64 us are exact, larger values are kept with a
+ * relative error of at most 1/32. Values above about 19 hours are counted in
+ * the last bucket.
+ * Recording only increments atomic counters and can be done from any thread.
+ * The statistics read while values are recorded may be slightly out of date.
+ */
+class LatencyHistogram {
+public:
+    using duration = std::chrono::microseconds;
+
+    static constexpr unsigned sub_bucket_bits{6};
+    static constexpr std::size_t sub_bucket_count{std::size_t{1} << sub_bucket_bits};
+    static constexpr unsigned max_magnitude{30};
+    static constexpr std::size_t bucket_count{sub_bucket_count + max_magnitude * sub_bucket_count / 2};
+
+    /**
+     * \brief Count a latency.
+     *
+     * \param latency The latency, negative values are counted as zero.
+     */
+    auto record(duration latency) -> void;
+
+    /**
+     * \brief Add the counts of another histogram, e.g. to aggregate engines.
+     */
+    auto add(const LatencyHistogram &other) -> void;
+
+    auto reset() -> void;
+
+    auto count() const -> std::uint64_t { return m_count.load(std::memory_order_relaxed); }
+    auto min() const -> duration;
+    auto max() const -> duration { return duration{m_max.load(std::memory_order_relaxed)}; }
+    auto mean() const -> duration;
+
+    /**
+     * \brief Latency below which the given percentage of values lie.
+     *
+     * \param percent Percentage between 0 and 100.
+     * \return The highest value of the bucket the percentile falls into,
+     *   zero if no value was recorded.
+     */
+    auto percentile(double percent) const -> duration;
+
+    static auto bucket_index(std::uint64_t value) -> std::size_t;
+    static auto bucket_upper_bound(std::size_t index) -> std::uint64_t;
+private:
+    std::array<std::atomic<std::uint64_t>, bucket_count> m_buckets{};
+    std::atomic<std::uint64_t> m_count{0};
+    std::atomic<std::uint64_t> m_sum{0};
+    std::atomic<std::uint64_t> m_min{std::numeric_limits<std::uint64_t>::max()};
+    std::atomic<std::uint64_t> m_max{0};
+};
+
+/**
+ * \brief Latencies of the responses of an engine to the GUI's commands.
+ */
+struct ProtocolLatencies {
+    LatencyHistogram isready;    ///< From "isready" to "readyok".
+    LatencyHistogram first_info; ///< From "go" to the first "info" of the search.
+    LatencyHistogram bestmove;   ///< From "go" to "bestmove".
+    LatencyHistogram stop;       ///< From "stop" to "bestmove".
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,106 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_LIVE_ANALYSIS_H
+#define CHESSUCI_LIVE_ANALYSIS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "chessuci/protocol.h"
+#include "chessuci/seqlock.h"
+
+namespace chessuci {
+
+/**
+ * \brief The latest state of one multipv line of a search.
+ */
+struct LiveLine {
+    static constexpr std::size_t max_pv_length{32};
+
+    int multipv{0}; ///< Index of the line, starting at 1, zero for a line that was not reported yet.
+    int depth{0};
+    int seldepth{0};
+    score_info score{};
+    std::int64_t nodes{0};
+    std::int64_t time{0};
+    std::uint64_t version{0}; ///< Version of the analysis when the line was changed last.
+    std::size_t pv_length{0};
+    std::array<UCIMove, max_pv_length> pv{}; ///< The principal variation, truncated to max_pv_length moves.
+
+    auto principal_variation() const -> std::span<const UCIMove> { return {pv.data(), pv_length}; }
+};
+
+/**
+ * \brief Lock-free table of the current multipv lines of an engine.
+ *
+ * Fed with the engine's infos by a single writer, usually the reader thread
+ * of UCIGuiHandler, and read by any number of threads, e.g. of a UI. Every
+ * line is kept in fixed storage behind a seqlock: the writer never waits
+ * and readers get consistent copies of single lines without locking. Infos
+ * with a score or principal variation update their line, other infos are
+ * ignored. Lines above max_lines are dropped.
+ */
+class LiveAnalysis {
+public:
+    static constexpr std::size_t max_lines{32};
+
+    /**
+     * \brief Called by the writer after a change.
+     *
+     * Receives the changed line, or zero when the lines were cleared.
+     */
+    using ChangeCallback = std::function<void(int multipv)>;
+
+    /**
+     * \brief Set the change notification, must be set before the first update.
+     */
+    auto on_change(ChangeCallback callback) -> void { m_change_callback = std::move(callback); }
+
+    /**
+     * \brief Update a line with an info, writer only.
+     */
+    auto update(const search_info &info) -> void;
+
+    /**
+     * \brief Remove all lines, e.g. when a new search starts, writer only.
+     */
+    auto clear() -> void;
+
+    /**
+     * \brief A copy of a line.
+     *
+     * \param multipv Index of the line, starting at 1.
+     * \return The line, if it was reported since the last clear().
+     */
+    auto line(int multipv) const -> std::optional<LiveLine>;
+
+    /**
+     * \brief Copies of all reported lines, ordered by multipv.
+     *
+     * Each line is consistent on its own, lines may be from different infos.
+     */
+    auto lines() const -> std::vector<LiveLine>;
+
+    /**
+     * \brief Number of changes, to detect updates by polling.
+     */
+    auto version() const -> std::uint64_t { return m_version.load(std::memory_order_acquire); }
+private:
+    std::array<SeqLock<LiveLine>, max_lines> m_lines;
+    std::array<LiveLine, max_lines> m_written{}; ///< The writer's copies, to merge partial infos.
+    std::atomic<std::size_t> m_line_count{0};
+    std::atomic<std::uint64_t> m_version{0};
+    ChangeCallback m_change_callback;
+};
+
+} // namespace chessuci
+
+#endif
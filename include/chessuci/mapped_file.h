@@ -0,0 +1,53 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_MAPPED_FILE_H
+#define CHESSUCI_MAPPED_FILE_H
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace chessuci {
+
+/**
+ * \brief A file that is mapped read-only into memory.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+    /**
+     * \brief Map a file.
+     *
+     * A previously mapped file is unmapped.
+     * \param path Path of the file.
+     * \return If the file could be mapped.
+     */
+    auto open(const std::filesystem::path &path) -> bool;
+    auto close() -> void;
+
+    auto is_open() const -> bool { return m_open; }
+    auto contents() const -> std::string_view { return {m_data, m_size}; }
+    auto last_error() const -> const std::string & { return m_last_error; }
+private:
+    const char *m_data{nullptr};
+    std::size_t m_size{0};
+    bool m_open{false};
+    std::string m_last_error;
+#if defined(_WIN32)
+    void *m_file{nullptr};
+    void *m_mapping{nullptr};
+#endif
+};
+
+} // namespace chessuci
+
+#endif
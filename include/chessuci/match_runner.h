@@ -0,0 +1,259 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_MATCH_RUNNER_H
+#define CHESSUCI_MATCH_RUNNER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <chesscore/position.h>
+
+#include "chessuci/engine_process.h"
+#include "chessuci/protocol.h"
+#include "chessuci/sprt.h"
+
+namespace chessuci {
+
+class UCIGuiHandler;
+
+/**
+ * \brief Result of a game.
+ */
+enum class GameResult {
+    WhiteWins,
+    BlackWins,
+    Draw,
+    Unfinished,
+};
+
+/**
+ * \brief The PGN representation of a game result.
+ *
+ * \param result The result.
+ * \return "1-0", "0-1", "1/2-1/2" or "*".
+ */
+auto to_string(GameResult result) -> std::string;
+
+/**
+ * \brief Time control of a match, applied to both sides.
+ */
+struct TimeControl {
+    std::chrono::milliseconds base{60000};  ///< Initial time of each side.
+    std::chrono::milliseconds increment{0}; ///< Time added after each move.
+    std::chrono::milliseconds margin{50};   ///< Overrun tolerated before a game is lost on time.
+};
+
+/**
+ * \brief Rules for ending games early based on the engines' scores.
+ *
+ * Scores are taken from the last info with a score the engine sent before its
+ * bestmove. Mate scores count as won or lost positions, bound scores and moves
+ * without score interrupt the counting.
+ */
+struct AdjudicationSettings {
+    std::optional<int> resign_score{};  ///< A game is resigned, if both engines agree that one side is behind by at least this many centipawns.
+    int resign_move_count{3};           ///< Number of consecutive moves of each engine the resign score must be reached.
+    std::optional<int> draw_score{};    ///< A game is drawn, if both engines report an absolute score of at most this many centipawns.
+    int draw_move_count{8};             ///< Number of consecutive moves of each engine the draw score must be kept.
+    int draw_move_number{40};           ///< First move number at which games are adjudicated as draw.
+    int max_moves{0};                   ///< Games are drawn after this many moves. 0 disables the limit.
+};
+
+/**
+ * \brief Adjudicates games based on the scores the engines report.
+ */
+class Adjudicator {
+public:
+    explicit Adjudicator(AdjudicationSettings settings) : m_settings{std::move(settings)} {}
+
+    /**
+     * \brief Forget all scores of the previous game.
+     */
+    auto reset() -> void;
+
+    /**
+     * \brief Add the score an engine reported for its move.
+     *
+     * \param side The side that made the move.
+     * \param score The score from the point of view of the engine, if any.
+     * \param move_number Number of the move in the game.
+     * \return The result, if the game can be adjudicated.
+     */
+    auto add_score(chesscore::Color side, const std::optional<score_info> &score, int move_number) -> std::optional<GameResult>;
+private:
+    AdjudicationSettings m_settings;
+    std::array<int, 2> m_losing_moves{};
+    std::array<int, 2> m_winning_moves{};
+    int m_drawn_plies{0};
+};
+
+/**
+ * \brief An engine taking part in a match.
+ */
+struct MatchEngine {
+    std::string name;                       ///< Name in the PGN. The engine's id name is used, if empty.
+    ProcessParams process;                  ///< The engine to start.
+    std::vector<setoption_command> options; ///< Options to set after starting the engine.
+};
+
+/**
+ * \brief Settings of a match between two engines.
+ */
+struct MatchSettings {
+    std::array<MatchEngine, 2> engines;
+    TimeControl time_control{};
+    AdjudicationSettings adjudication{};
+    std::vector<std::string> openings{}; ///< Start positions as FEN. Each opening is played twice with swapped colors. The initial position is used, if empty.
+    std::size_t games{2};                ///< Number of games to play.
+    std::size_t concurrency{1};          ///< Number of games played at the same time.
+    std::string event{"Engine match"};   ///< Event name in the PGN.
+    std::optional<SprtSettings> sprt{};  ///< Stop the match as soon as a sequential probability ratio test decides.
+};
+
+/**
+ * \brief A finished game.
+ */
+struct GameRecord {
+    std::size_t round{1};               ///< Number of the game in the match, starting at 1.
+    std::size_t white_engine{0};        ///< Index of the engine that played white.
+    std::string white{};                ///< Name of the white engine.
+    std::string black{};                ///< Name of the black engine.
+    std::string opening{};              ///< FEN of the start position or "startpos".
+    int first_move_number{1};           ///< Move number of the first move.
+    bool black_starts{false};           ///< If black made the first move.
+    std::vector<std::string> moves{};   ///< The moves in SAN.
+    GameResult result{GameResult::Unfinished};
+    std::string termination{"normal"};  ///< Value of the PGN Termination tag.
+    std::string reason{};               ///< Why the game ended, in words.
+};
+
+/**
+ * \brief Statistics of a match, counted from the first engine's point of view.
+ */
+struct MatchStatistics {
+    std::uint64_t games{0};
+    std::uint64_t wins{0};
+    std::uint64_t losses{0};
+    std::uint64_t draws{0};
+    std::uint64_t adjudicated{0}; ///< Games ended by the adjudication rules.
+    std::uint64_t forfeits{0};    ///< Games lost on time, by an illegal move or a failing engine.
+    std::chrono::nanoseconds elapsed{0};
+};
+
+/**
+ * \brief Plays a match between two engines.
+ *
+ * Every slot runs one game at a time with its own pair of engine processes.
+ * The processes are kept between games, so a slot takes the next game as soon
+ * as its previous game has ended. Slots whose engine failed restart it.
+ * Clocks are measured from sending the go command until the bestmove arrives
+ * on the reader thread, so the time a slot needs to pick up the move is not
+ * charged to the engine. Every bestmove is validated against the legal moves
+ * of the position; illegal moves, time losses and failing engines lose the
+ * game.
+ * Games are written to the PGN stream in the order they end.
+ * With an SPRT configured, each finished game pair (games 2k+1 and 2k+2, played
+ * from the same opening) is added to the test, and the match is stopped as
+ * soon as one of the hypotheses is accepted.
+ */
+class MatchRunner {
+public:
+    using GameCallback = std::function<void(const GameRecord &)>;
+    using ProcessCreator = std::function<std::unique_ptr<EngineProcess>()>;
+
+    explicit MatchRunner(MatchSettings settings);
+    ~MatchRunner();
+
+    MatchRunner(const MatchRunner &) = delete;
+    auto operator=(const MatchRunner &) -> MatchRunner & = delete;
+
+    /**
+     * \brief Set the function that creates the engine processes.
+     *
+     * By default, local processes are created.
+     * \param creator Creates one engine process per call.
+     */
+    auto set_process_creator(ProcessCreator creator) -> void { m_process_creator = std::move(creator); }
+
+    /**
+     * \brief Play the match.
+     *
+     * Blocks until all games were played or the match was cancelled. A
+     * runner can run several matches, a cancellation only ends the current one.
+     * \param pgn Receives the games in PGN.
+     * \param on_game Called for every finished game.
+     * \return If all games could be played, false without playing if an
+     *   opening is not a valid FEN.
+     */
+    auto run(std::ostream &pgn, const GameCallback &on_game = {}) -> bool;
+
+    /**
+     * \brief Stop a running match after the current games.
+     */
+    auto cancel() -> void { m_cancelled = true; }
+
+    /**
+     * \brief Statistics of the current or last match.
+     *
+     * Can be called while the match is running.
+     * \return The statistics.
+     */
+    auto statistics() const -> MatchStatistics;
+
+    /**
+     * \brief The sequential probability ratio test of the match.
+     *
+     * \return The test, if the settings contain one.
+     */
+    auto sprt() const -> const std::optional<Sprt> & { return m_sprt; }
+    auto last_error() const -> const std::string & { return m_last_error; }
+
+    /**
+     * \brief Format a game as PGN.
+     *
+     * \param game The game.
+     * \param event Value of the Event tag.
+     * \return The game including the tag section and a trailing empty line.
+     */
+    static auto format_pgn(const GameRecord &game, const std::string &event) -> std::string;
+private:
+    struct Player;
+
+    MatchSettings m_settings;
+    ProcessCreator m_process_creator;
+    std::atomic<bool> m_cancelled{false};
+    std::atomic<std::size_t> m_next_game{0};
+    std::string m_last_error;
+
+    mutable std::mutex m_output_mutex;
+    std::ostream *m_pgn{nullptr};
+    const GameCallback *m_on_game{nullptr};
+    MatchStatistics m_statistics;
+    std::optional<Sprt> m_sprt;
+    std::map<std::size_t, double> m_pair_scores; // score of the first finished game of a pair
+
+    auto run_slot(std::atomic<std::size_t> &started_slots) -> void;
+    auto start_player(Player &player, std::size_t engine_index) -> bool;
+    auto play_game(std::size_t game_index, std::array<std::unique_ptr<Player>, 2> &players) -> GameRecord;
+    auto search(Player &player, const position_command &position, const go_command &go, std::chrono::milliseconds time_left)
+        -> std::optional<std::pair<bestmove_info, std::chrono::milliseconds>>;
+    auto publish(const GameRecord &game) -> void;
+    auto update_sprt(const GameRecord &game) -> void;
+};
+
+} // namespace chessuci
+
+#endif
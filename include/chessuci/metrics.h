@@ -0,0 +1,108 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_METRICS_H
+#define CHESSUCI_METRICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+
+namespace chessuci {
+
+/**
+ * \brief Counters of the protocol layer.
+ */
+enum class Metric {
+    LinesRead,          ///< Lines read from an engine or GUI.
+    LinesWritten,       ///< Lines written to an engine or GUI.
+    BytesRead,          ///< Bytes read, including line breaks.
+    BytesWritten,       ///< Bytes written, including line breaks.
+    ParseErrors,        ///< Commands that could not be parsed.
+    UnknownCommands,    ///< Commands passed to the unknown command callback.
+    CallbackNanoseconds ///< Time spent handling received commands, including the callbacks.
+};
+
+/**
+ * \brief Values of all counters at one point in time.
+ */
+struct MetricsSnapshot {
+    std::uint64_t lines_read{0};
+    std::uint64_t lines_written{0};
+    std::uint64_t bytes_read{0};
+    std::uint64_t bytes_written{0};
+    std::uint64_t parse_errors{0};
+    std::uint64_t unknown_commands{0};
+    std::chrono::nanoseconds callback_time{0};
+    std::map<std::string, std::uint64_t> commands_received; ///< Received commands by name, unknown names are counted as "other".
+    std::map<std::string, std::uint64_t> commands_sent;     ///< Sent commands by name, unknown names are counted as "other".
+};
+
+enum class MetricsFormat { Prometheus, Json };
+
+/**
+ * \brief Process-wide registry of the protocol counters.
+ *
+ * Every thread counts into its own block of counters, so recording is a
+ * relaxed load and store without contention. The blocks are summed up when
+ * a snapshot is taken; the counts of finished threads are kept.
+ */
+class Metrics {
+public:
+    /**
+     * \brief Add to a counter of the calling thread.
+     */
+    static auto add(Metric metric, std::uint64_t value = 1) -> void;
+
+    /**
+     * \brief Count a received command.
+     *
+     * \param command The first token of the line.
+     */
+    static auto count_received(std::string_view command) -> void;
+
+    /**
+     * \brief Count a sent command.
+     *
+     * \param line The line that is sent.
+     */
+    static auto count_sent(std::string_view line) -> void;
+
+    static auto snapshot() -> MetricsSnapshot;
+
+    static auto to_prometheus(const MetricsSnapshot &snapshot) -> std::string;
+    static auto to_json(const MetricsSnapshot &snapshot) -> std::string;
+    static auto format(const MetricsSnapshot &snapshot, MetricsFormat format) -> std::string;
+
+    /**
+     * \brief Write a snapshot to a file.
+     *
+     * The file is replaced atomically, so a collector never reads a partial
+     * snapshot.
+     * \param path Path of the file.
+     * \param format Format of the snapshot.
+     * \return If the file was written.
+     */
+    static auto write_file(const std::filesystem::path &path, MetricsFormat format) -> bool;
+
+    /**
+     * \brief Send a snapshot to a Unix-domain socket.
+     *
+     * Connects to the socket, writes the snapshot and closes the connection.
+     * Only supported on Unix platforms.
+     * \param path Path of the socket file.
+     * \param format Format of the snapshot.
+     * \param error Receives the error message, if the snapshot was not sent.
+     * \return If the snapshot was sent.
+     */
+    static auto write_socket(const std::filesystem::path &path, MetricsFormat format, std::string &error) -> bool;
+};
+
+} // namespace chessuci
+
+#endif
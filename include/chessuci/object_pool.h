@@ -0,0 +1,116 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_OBJECT_POOL_H
+#define CHESSUCI_OBJECT_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace chessuci {
+
+/**
+ * \brief A pool of reusable objects.
+ *
+ * Acquired objects are owned by a unique pointer that returns the object to
+ * the pool when it is destroyed, from any thread. Returned objects are not
+ * reset, so their vectors and strings keep their capacity for the next
+ * user. Once the pool holds as many objects as are used at the same time,
+ * acquiring and returning objects does not allocate. Idle objects are
+ * deleted with the pool. Objects may outlive the pool, they are deleted when
+ * they are returned after the pool is gone.
+ */
+template<typename T>
+class ObjectPool {
+    struct Storage {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<T>> idle;
+        std::size_t created{0};
+        bool destroyed{false}; // set by the pool's destructor, returned objects are deleted then
+    };
+public:
+    ObjectPool() = default;
+
+    ~ObjectPool() {
+        std::vector<std::unique_ptr<T>> idle;
+        {
+            std::lock_guard<std::mutex> lock{m_storage->mutex};
+            m_storage->destroyed = true;
+            idle.swap(m_storage->idle);
+        }
+    }
+
+    ObjectPool(const ObjectPool &) = delete;
+    auto operator=(const ObjectPool &) -> ObjectPool & = delete;
+
+    /**
+     * \brief Deleter that returns the object to its pool.
+     */
+    class Recycler {
+    public:
+        Recycler() = default;
+        explicit Recycler(std::shared_ptr<Storage> storage) : m_storage{std::move(storage)} {}
+
+        auto operator()(T *object) const -> void {
+            std::unique_ptr<T> owned{object};
+            if (m_storage) {
+                std::lock_guard<std::mutex> lock{m_storage->mutex};
+                if (!m_storage->destroyed) {
+                    m_storage->idle.push_back(std::move(owned));
+                }
+            }
+        }
+    private:
+        std::shared_ptr<Storage> m_storage;
+    };
+
+    using Pointer = std::unique_ptr<T, Recycler>;
+
+    /**
+     * \brief Take an object from the pool, or create one if the pool is empty.
+     *
+     * \return The object, in the state its previous user left it.
+     */
+    auto acquire() -> Pointer {
+        std::unique_ptr<T> object;
+        {
+            std::lock_guard<std::mutex> lock{m_storage->mutex};
+            if (!m_storage->idle.empty()) {
+                object = std::move(m_storage->idle.back());
+                m_storage->idle.pop_back();
+            } else {
+                ++m_storage->created;
+            }
+        }
+        if (!object) {
+            object = std::make_unique<T>();
+        }
+        return Pointer{object.release(), Recycler{m_storage}};
+    }
+
+    /**
+     * \brief Number of objects waiting in the pool.
+     */
+    auto idle_count() const -> std::size_t {
+        std::lock_guard<std::mutex> lock{m_storage->mutex};
+        return m_storage->idle.size();
+    }
+
+    /**
+     * \brief Number of objects the pool has created.
+     */
+    auto created_count() const -> std::size_t {
+        std::lock_guard<std::mutex> lock{m_storage->mutex};
+        return m_storage->created;
+    }
+private:
+    std::shared_ptr<Storage> m_storage{std::make_shared<Storage>()};
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,152 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_OPTION_REGISTRY_H
+#define CHESSUCI_OPTION_REGISTRY_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+/**
+ * \brief Outcome of setting an option of the registry.
+ */
+enum class OptionResult {
+    Applied,       ///< The value was converted and passed to the option's setter.
+    UnknownOption, ///< No option with this name is registered.
+    InvalidValue   ///< The value does not fit the type, range or choices of the option.
+};
+
+/**
+ * \brief Typed options of an engine.
+ *
+ * Every option is declared once with its type, default value and a setter,
+ * which is either a callback or an atomic variable that search threads can
+ * read without locking. The declarations produce the option lines sent
+ * during the handshake, and setoption commands are dispatched to the
+ * setters: names are looked up case-insensitively through a precomputed
+ * hash, and values are validated and converted without allocations (only
+ * values of string and combo options that contain spaces are joined, into a
+ * reused buffer).
+ * Options must be added before the handler is started. The registry is not
+ * thread safe, setters are called on the thread that applies the command.
+ */
+class OptionRegistry {
+public:
+    using CheckSetter = std::function<void(bool)>;
+    using SpinSetter = std::function<void(int)>;
+    using ComboSetter = std::function<void(std::size_t, std::string_view)>; ///< Receives the index and the text of the choice.
+    using StringSetter = std::function<void(std::string_view)>;
+    using ButtonCallback = std::function<void()>;
+
+    /**
+     * \brief Add a check option.
+     *
+     * The setter is called with the default value right away. Throws an
+     * UCIError if an option with the same name exists.
+     */
+    auto add_check(std::string name, bool default_value, CheckSetter setter) -> void;
+    auto add_check(std::string name, bool default_value, std::atomic<bool> &target) -> void;
+
+    /**
+     * \brief Add a spin option.
+     *
+     * The setter is called with the default value right away. Throws an
+     * UCIError if an option with the same name exists or the default value
+     * is out of range.
+     */
+    auto add_spin(std::string name, int default_value, int min, int max, SpinSetter setter) -> void;
+    auto add_spin(std::string name, int default_value, int min, int max, std::atomic<int> &target) -> void;
+
+    /**
+     * \brief Add a combo option.
+     *
+     * The setter is called with the default value right away. Throws an
+     * UCIError if an option with the same name exists or the default value
+     * is not one of the choices.
+     * \param target Receives the index of the choice.
+     */
+    auto add_combo(std::string name, std::string default_value, std::vector<std::string> choices, ComboSetter setter) -> void;
+    auto add_combo(std::string name, std::string default_value, std::vector<std::string> choices, std::atomic<std::size_t> &target) -> void;
+
+    /**
+     * \brief Add a string option.
+     *
+     * The setter is called with the default value right away. The value
+     * "<empty>" is passed as an empty string. Throws an UCIError if an
+     * option with the same name exists.
+     */
+    auto add_string(std::string name, std::string default_value, StringSetter setter) -> void;
+
+    /**
+     * \brief Add a button option.
+     *
+     * Throws an UCIError if an option with the same name exists.
+     */
+    auto add_button(std::string name, ButtonCallback callback) -> void;
+
+    /**
+     * \brief The declared options, in the order they were added.
+     */
+    auto options() const -> const std::vector<Option> & { return m_options; }
+    auto empty() const -> bool { return m_options.empty(); }
+
+    /**
+     * \brief Find an option by name, ignoring case.
+     *
+     * \return The option, or a null pointer if it is not registered.
+     */
+    auto find(std::string_view name) const -> const Option *;
+
+    /**
+     * \brief Set an option.
+     *
+     * \param name Name of the option, case is ignored.
+     * \param value The value, none for buttons.
+     */
+    auto set(std::string_view name, std::optional<std::string_view> value) -> OptionResult;
+
+    /**
+     * \brief Apply a setoption command.
+     *
+     * \param tokens The tokenized setoption command.
+     */
+    auto apply(const TokenList &tokens) -> OptionResult;
+
+    /**
+     * \brief Case-insensitive hash of an option name.
+     */
+    static auto hash_name(std::string_view name) -> std::uint64_t;
+private:
+    struct Setter {
+        CheckSetter check;
+        SpinSetter spin;
+        ComboSetter combo;
+        StringSetter string;
+        ButtonCallback button;
+    };
+
+    std::vector<Option> m_options;
+    std::vector<Setter> m_setters;
+    std::vector<std::pair<std::uint64_t, std::size_t>> m_index; ///< Hashes of the names and indices of the options, sorted by hash.
+    std::string m_value_buffer;
+
+    auto add(Option option, Setter setter) -> void;
+    auto lookup(std::uint64_t hash, const auto &matches) const -> std::optional<std::size_t>;
+    auto set_value(std::size_t index, std::optional<std::string_view> value) -> OptionResult;
+};
+
+} // namespace chessuci
+
+#endif
@@ -1,22 +1,36 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#ifndef CHESSUCI_PROCESS_FACTORY_H
-#define CHESSUCI_PROCESS_FACTORY_H
-
-#include "chessuci/engine_process.h"
-
-#include <memory>
-
-namespace chessuci {
-
-class ProcessFactory {
-public:
-    static auto create_local() -> std::unique_ptr<EngineProcess>;
-};
-
-} // namespace chessuci
-
-#endif
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_PROCESS_FACTORY_H
+#define CHESSUCI_PROCESS_FACTORY_H
+
+#include "chessuci/engine_process.h"
+#include "chessuci/remote_protocol.h"
+
+#include <memory>
+
+namespace chessuci {
+
+class ProcessFactory {
+public:
+    static auto create_local() -> std::unique_ptr<EngineProcess>;
+
+    /**
+     * \brief Create an engine process on a remote engine host.
+     *
+     * The engine is started by the EngineHost listening on the endpoint. Each
+     * process created this way uses its own connection. Use a RemoteConnection
+     * to multiplex several engines over one connection.
+     * Remote engines are only supported on Unix platforms. On other platforms,
+     * `nullptr` is returned.
+     * \param endpoint Address of the engine host.
+     * \return The engine process.
+     */
+    static auto create_remote(const RemoteEndpoint &endpoint) -> std::unique_ptr<EngineProcess>;
+};
+
+} // namespace chessuci
+
+#endif
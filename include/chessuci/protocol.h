@@ -1,125 +1,194 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#ifndef CHESSUCI_PROTOCOL_H
-#define CHESSUCI_PROTOCOL_H
-
-#include <optional>
-#include <stdexcept>
-#include <vector>
-
-#include "chessuci/move.h"
-
-namespace chessuci {
-
-class UCIError : public std::runtime_error {
-    using std::runtime_error::runtime_error;
-};
-
-struct debug_command {
-    bool enable_debugging;
-};
-
-struct setoption_command {
-    std::string name;
-    std::optional<std::string> value; // not set is not the same as empty string
-};
-
-struct position_command {
-    std::string fen; // Could also be 'startpos'
-    std::vector<UCIMove> moves;
-
-    static const std::string startpos;
-};
-
-auto to_string(const position_command &command) -> std::string;
-
-struct go_command {
-    std::vector<UCIMove> searchmoves;
-    bool ponder = false;
-    std::optional<std::int64_t> wtime;
-    std::optional<std::int64_t> btime;
-    std::optional<int> winc;
-    std::optional<int> binc;
-    std::optional<int> movestogo;
-    std::optional<std::int64_t> depth;
-    std::optional<std::int64_t> nodes;
-    std::optional<int> mate;
-    std::optional<std::int64_t> movetime;
-    bool infinite = false;
-
-    auto has_timing_control() const -> bool;
-};
-
-auto to_string(const go_command &command) -> std::string;
-
-struct id_info {
-    std::string name;
-    std::string author;
-};
-
-struct bestmove_info {
-    UCIMove bestmove;
-    std::optional<UCIMove> pondermove;
-};
-
-struct score_info {
-    std::optional<int> cp;
-    std::optional<int> mate;
-    bool lowerbound{false};
-    bool upperbound{false};
-};
-
-auto to_string(const score_info &info) -> std::string;
-
-struct line_info {
-    std::optional<int> cpunr;
-    std::vector<UCIMove> line;
-};
-
-auto to_string(const line_info &info) -> std::string;
-
-struct search_info {
-    std::optional<int> depth;
-    std::optional<int> seldepth;
-    std::optional<std::int64_t> time;
-    std::optional<std::int64_t> nodes;
-    std::vector<UCIMove> pv;
-    std::optional<int> multipv;
-    std::optional<score_info> score;
-    std::optional<UCIMove> currmove;
-    std::optional<int> currmovenumber;
-    std::optional<int> hashfull;
-    std::optional<std::int64_t> nps;
-    std::optional<int> tbhits;
-    std::optional<int> sbhits;
-    std::optional<int> cpuload;
-    std::string string{};
-    std::vector<UCIMove> refutation;
-    std::optional<line_info> currline;
-};
-
-auto to_string(const search_info &info) -> std::string;
-
-struct Option {
-    enum class Type { Check, Spin, Combo, Button, String };
-
-    std::string name;
-    Type type;
-    std::optional<std::string> default_value;
-    std::optional<int> min;
-    std::optional<int> max;
-    std::vector<std::string> combo_values;
-
-    auto to_uci_string() const -> std::string;
-    auto type_to_string() const -> std::string;
-    static auto type_from_string(const std::string &str) -> Type;
-};
-
-using TokenList = std::vector<std::string>;
-
-} // namespace chessuci
-
-#endif
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_PROTOCOL_H
+#define CHESSUCI_PROTOCOL_H
+
+#include <expected>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "chessuci/move.h"
+
+namespace chessuci {
+
+class UCIError : public std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * \brief Error conditions while parsing UCI commands.
+ */
+enum class ParseErrorType {
+    MissingValue,       ///< A parameter is missing its value.
+    InvalidInteger,     ///< A value is not a valid integer.
+    InvalidMove,        ///< A value is not a valid move.
+    UnexpectedToken,    ///< A token is not allowed at this position.
+    UnknownOptionType,  ///< The type of an option is unknown.
+    InvalidOptionValue, ///< A value does not fit the type, range or choices of the option.
+};
+
+/**
+ * \brief An error from parsing an UCI command.
+ */
+struct ParseError {
+    ParseErrorType type; ///< Type of the error.
+    std::string token;   ///< The offending token, or the parameter that is missing its value.
+
+    auto operator==(const ParseError &rhs) const -> bool = default;
+};
+
+/**
+ * \brief Result of parsing an UCI command without exceptions.
+ */
+template<typename T>
+using ParseResult = std::expected<T, ParseError>;
+
+/**
+ * \brief Describe a parse error.
+ *
+ * \param error The error.
+ * \return Human readable description of the error.
+ */
+auto to_string(const ParseError &error) -> std::string;
+
+struct debug_command {
+    bool enable_debugging;
+};
+
+struct setoption_command {
+    std::string name;
+    std::optional<std::string> value; // not set is not the same as empty string
+};
+
+struct position_command {
+    std::string fen; // Could also be 'startpos'
+    std::vector<UCIMove> moves;
+
+    static const std::string startpos;
+};
+
+auto to_string(const position_command &command) -> std::string;
+
+struct go_command {
+    std::vector<UCIMove> searchmoves;
+    bool ponder = false;
+    std::optional<std::int64_t> wtime;
+    std::optional<std::int64_t> btime;
+    std::optional<int> winc;
+    std::optional<int> binc;
+    std::optional<int> movestogo;
+    std::optional<std::int64_t> depth;
+    std::optional<std::int64_t> nodes;
+    std::optional<int> mate;
+    std::optional<std::int64_t> movetime;
+    bool infinite = false;
+
+    auto has_timing_control() const -> bool;
+};
+
+auto to_string(const go_command &command) -> std::string;
+
+struct id_info {
+    std::string name;
+    std::string author;
+
+    auto operator==(const id_info &rhs) const -> bool = default;
+};
+
+struct bestmove_info {
+    UCIMove bestmove;
+    std::optional<UCIMove> pondermove;
+};
+
+struct score_info {
+    std::optional<int> cp;
+    std::optional<int> mate;
+    bool lowerbound{false};
+    bool upperbound{false};
+};
+
+auto to_string(const score_info &info) -> std::string;
+
+struct line_info {
+    std::optional<int> cpunr;
+    std::vector<UCIMove> line;
+};
+
+auto to_string(const line_info &info) -> std::string;
+
+struct search_info {
+    std::optional<int> depth;
+    std::optional<int> seldepth;
+    std::optional<std::int64_t> time;
+    std::optional<std::int64_t> nodes;
+    std::vector<UCIMove> pv;
+    std::optional<int> multipv;
+    std::optional<score_info> score;
+    std::optional<UCIMove> currmove;
+    std::optional<int> currmovenumber;
+    std::optional<int> hashfull;
+    std::optional<std::int64_t> nps;
+    std::optional<int> tbhits;
+    std::optional<int> sbhits;
+    std::optional<int> cpuload;
+    std::string string{};
+    std::vector<UCIMove> refutation;
+    std::optional<line_info> currline;
+};
+
+auto to_string(const search_info &info) -> std::string;
+
+/**
+ * \brief Merge the fields of an info into another.
+ *
+ * All fields that are set in update overwrite the fields of target.
+ * \param target The info to update.
+ * \param update The new values.
+ */
+auto merge_info(search_info &target, const search_info &update) -> void;
+
+struct Option {
+    enum class Type { Check, Spin, Combo, Button, String };
+
+    std::string name;
+    Type type;
+    std::optional<std::string> default_value;
+    std::optional<int> min;
+    std::optional<int> max;
+    std::vector<std::string> combo_values;
+
+    auto to_uci_string() const -> std::string;
+    auto type_to_string() const -> std::string;
+    static auto type_from_string(const std::string &str) -> Type;
+    static auto try_type_from_string(const std::string &str) -> ParseResult<Type>;
+
+    /**
+     * \brief Check, if a value is valid for this option.
+     *
+     * \param value The value of a setoption command.
+     * \return If the value matches the type, range or choices of the option.
+     */
+    auto accepts(const std::optional<std::string> &value) const -> bool;
+
+    auto operator==(const Option &rhs) const -> bool = default;
+};
+
+/**
+ * \brief Everything an engine reports between "uci" and "uciok".
+ */
+struct handshake_info {
+    id_info id;
+    std::vector<Option> options;
+
+    auto operator==(const handshake_info &rhs) const -> bool = default;
+};
+
+using TokenList = std::vector<std::string>;
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,112 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_REMOTE_PROTOCOL_H
+#define CHESSUCI_REMOTE_PROTOCOL_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "chessuci/engine_process.h"
+
+namespace chessuci {
+
+/**
+ * \brief Address of a remote engine host.
+ *
+ * An engine host can either listen on a TCP port or on a Unix-domain socket.
+ */
+struct RemoteEndpoint {
+    enum class Kind { Tcp, Local };
+
+    Kind kind{Kind::Tcp};         ///< Type of the socket.
+    std::string host{};           ///< Host name or address (TCP only).
+    std::uint16_t port{0};        ///< Port number (TCP only).
+    std::filesystem::path path{}; ///< Path of the socket file (Unix-domain sockets only).
+
+    static auto tcp(std::string host, std::uint16_t port) -> RemoteEndpoint;
+    static auto local(std::filesystem::path path) -> RemoteEndpoint;
+};
+
+/**
+ * \brief Parse an endpoint description.
+ *
+ * Accepted formats are `tcp://<host>:<port>` and `unix:<path>`.
+ * \param str The endpoint description.
+ * \return The endpoint, if the description is valid.
+ */
+auto parse_remote_endpoint(std::string_view str) -> std::optional<RemoteEndpoint>;
+
+/**
+ * \brief Convert an endpoint to its textual description.
+ *
+ * The result can be parsed by parse_remote_endpoint().
+ * \param endpoint The endpoint.
+ * \return Description of the endpoint.
+ */
+auto to_string(const RemoteEndpoint &endpoint) -> std::string;
+
+/**
+ * \brief A message exchanged between a remote engine client and an engine host.
+ *
+ * All engine sessions of one connection are multiplexed over the same socket.
+ * Each frame is a single text line `<session> <verb>[ <payload>]`.
+ */
+struct RemoteFrame {
+    enum class Verb {
+        Open,   ///< client -> host: start an engine, payload are the process parameters
+        Opened, ///< host -> client: engine started, payload is the process id
+        Line,   ///< both directions: a line of engine input or output
+        Kill,   ///< client -> host: kill the engine immediately
+        Exited, ///< host -> client: engine exited, payload is the exit code (may be empty)
+        Error,  ///< host -> client: request failed, payload is the error message
+    };
+
+    std::uint32_t session{0};
+    Verb verb{Verb::Line};
+    std::string payload{};
+};
+
+/**
+ * \brief Append the encoded frame to a buffer.
+ *
+ * Frames are appended, so that several frames can be collected and sent with
+ * a single write.
+ * \param frame The frame to encode.
+ * \param buffer The buffer, the frame (including the newline) is appended to.
+ */
+auto encode_frame(const RemoteFrame &frame, std::string &buffer) -> void;
+
+/**
+ * \brief Decode a frame from a line.
+ *
+ * \param line The line without the trailing newline.
+ * \return The frame, if the line is a valid frame.
+ */
+auto decode_frame(std::string_view line) -> std::optional<RemoteFrame>;
+
+/**
+ * \brief Encode process parameters as payload of an `Open` frame.
+ *
+ * The fields are separated by tabs, so arguments must not contain tabs.
+ * \param params The process parameters.
+ * \return The encoded parameters.
+ */
+auto encode_process_params(const ProcessParams &params) -> std::string;
+
+/**
+ * \brief Decode process parameters from the payload of an `Open` frame.
+ *
+ * \param payload The payload.
+ * \return The process parameters, if the payload is valid.
+ */
+auto decode_process_params(std::string_view payload) -> std::optional<ProcessParams>;
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,124 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_RESPONSE_H
+#define CHESSUCI_RESPONSE_H
+
+#include <coroutine>
+#include <exception>
+#include <expected>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace chessuci {
+
+/**
+ * \brief Result of a request to an engine.
+ *
+ * Holds either the response or the exception that describes why the request
+ * failed (e.g., because the engine terminated).
+ */
+template<typename T>
+using ResponseResult = std::expected<T, std::exception_ptr>;
+
+/**
+ * \brief Receives the result of a request.
+ */
+template<typename T>
+using ResponseHandler = std::function<void(ResponseResult<T>)>;
+
+/**
+ * \brief Create a response handler that fulfills a future.
+ *
+ * \param future Receives the future.
+ * \return The handler.
+ */
+template<typename T>
+auto make_future_handler(std::future<T> &future) -> ResponseHandler<T> {
+    auto promise = std::make_shared<std::promise<T>>();
+    future = promise->get_future();
+    return [promise](ResponseResult<T> result) -> void {
+        if (!result.has_value()) {
+            promise->set_exception(result.error());
+        } else if constexpr (std::is_void_v<T>) {
+            promise->set_value();
+        } else {
+            promise->set_value(std::move(result.value()));
+        }
+    };
+}
+
+/**
+ * \brief Awaitable response of an engine request.
+ *
+ * A coroutine awaiting the response is suspended without blocking a thread and
+ * resumed on the thread that completes the request, which is the reader thread
+ * of the handler. If the request failed, awaiting it rethrows the exception.
+ */
+template<typename T>
+class ResponseAwaitable {
+public:
+    ResponseAwaitable() : m_state{std::make_shared<State>()} {}
+
+    /**
+     * \brief Create the handler that completes this awaitable.
+     *
+     * \return The handler.
+     */
+    auto handler() const -> ResponseHandler<T> {
+        return [state = m_state](ResponseResult<T> result) -> void {
+            std::coroutine_handle<> continuation;
+            {
+                std::lock_guard<std::mutex> lock{state->mutex};
+                state->result = std::move(result);
+                continuation = std::exchange(state->continuation, nullptr);
+            }
+            if (continuation) {
+                continuation.resume();
+            }
+        };
+    }
+
+    auto await_ready() const -> bool {
+        std::lock_guard<std::mutex> lock{m_state->mutex};
+        return m_state->result.has_value();
+    }
+
+    auto await_suspend(std::coroutine_handle<> continuation) -> bool {
+        std::lock_guard<std::mutex> lock{m_state->mutex};
+        if (m_state->result.has_value()) {
+            return false;
+        }
+        m_state->continuation = continuation;
+        return true;
+    }
+
+    auto await_resume() -> T {
+        std::lock_guard<std::mutex> lock{m_state->mutex};
+        auto &result = m_state->result.value();
+        if (!result.has_value()) {
+            std::rethrow_exception(result.error());
+        }
+        if constexpr (!std::is_void_v<T>) {
+            return std::move(result.value());
+        }
+    }
+private:
+    struct State {
+        std::mutex mutex;
+        std::optional<ResponseResult<T>> result;
+        std::coroutine_handle<> continuation;
+    };
+    std::shared_ptr<State> m_state;
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,84 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_SEQLOCK_H
+#define CHESSUCI_SEQLOCK_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+namespace chessuci {
+
+/**
+ * \brief A value with one writer and any number of lock-free readers.
+ *
+ * The writer never waits. Readers copy the value and retry when it was
+ * changed while they copied it, so they always get a consistent value. The
+ * value is stored in atomic words, which keeps the concurrent copies free
+ * of data races.
+ */
+template<typename T>
+requires std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>
+class SeqLock {
+public:
+    SeqLock() { store(T{}); }
+
+    /**
+     * \brief Replace the value, must only be called by the writer.
+     */
+    auto store(const T &value) -> void {
+        std::array<std::uint64_t, word_count> words{};
+        std::memcpy(words.data(), &value, sizeof(T));
+        const auto sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t index = 0; index < word_count; ++index) {
+            m_words[index].store(words[index], std::memory_order_relaxed);
+        }
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /**
+     * \brief A consistent copy of the value.
+     */
+    auto load() const -> T {
+        std::array<std::uint64_t, word_count> words{};
+        while (true) {
+            const auto sequence = m_sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) != 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            for (std::size_t index = 0; index < word_count; ++index) {
+                words[index] = m_words[index].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+                break;
+            }
+        }
+        T value;
+        std::memcpy(static_cast<void *>(&value), words.data(), sizeof(T));
+        return value;
+    }
+
+    /**
+     * \brief Number of completed stores.
+     */
+    auto version() const -> std::uint64_t { return m_sequence.load(std::memory_order_acquire) / 2; }
+private:
+    static constexpr std::size_t word_count{(sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t)};
+
+    std::atomic<std::uint64_t> m_sequence{0};
+    std::array<std::atomic<std::uint64_t>, word_count> m_words{};
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,68 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_SOCKET_UNIX_H
+#define CHESSUCI_SOCKET_UNIX_H
+
+#include "chessuci/remote_protocol.h"
+
+#include <string>
+#include <string_view>
+
+namespace chessuci {
+
+/**
+ * \brief Connect a stream socket to an endpoint.
+ *
+ * TCP sockets are configured with `TCP_NODELAY`, so that single UCI lines are
+ * not delayed by Nagle's algorithm.
+ * \param endpoint The endpoint to connect to.
+ * \param error Receives the error message, if the connection fails.
+ * \return The socket, or -1 on failure.
+ */
+auto socket_connect(const RemoteEndpoint &endpoint, std::string &error) -> int;
+
+/**
+ * \brief Create a listening socket for an endpoint.
+ *
+ * For TCP endpoints, port 0 selects a free port. The actual address is
+ * returned in \p bound.
+ * \param endpoint The endpoint to listen on.
+ * \param bound Receives the address the socket is bound to.
+ * \param error Receives the error message, if the socket cannot be created.
+ * \return The socket, or -1 on failure.
+ */
+auto socket_listen(const RemoteEndpoint &endpoint, RemoteEndpoint &bound, std::string &error) -> int;
+
+/**
+ * \brief Prepare an accepted or connected stream socket.
+ *
+ * Disables Nagle's algorithm (for TCP sockets) and `SIGPIPE` on write (where
+ * supported by a socket option).
+ * \param fd The socket.
+ */
+auto socket_configure(int fd) -> void;
+
+/**
+ * \brief Write all data to a blocking socket.
+ *
+ * \param fd The socket.
+ * \param data The data to write.
+ * \return If all data was written.
+ */
+auto socket_send_all(int fd, std::string_view data) -> bool;
+
+/**
+ * \brief Write as much data as possible to a non-blocking socket.
+ *
+ * \param fd The socket.
+ * \param data The data to write.
+ * \return Number of bytes written, or -1 on error.
+ */
+auto socket_send_some(int fd, std::string_view data) -> long;
+
+} // namespace chessuci
+
+#endif
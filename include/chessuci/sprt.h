@@ -0,0 +1,113 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_SPRT_H
+#define CHESSUCI_SPRT_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace chessuci {
+
+/**
+ * \brief Hypotheses and error rates of a sequential probability ratio test.
+ *
+ * Elo differences are logistic Elo of the first engine against the second.
+ */
+struct SprtSettings {
+    double elo0{0.0};   ///< Elo difference of the null hypothesis H0.
+    double elo1{5.0};   ///< Elo difference of the alternative hypothesis H1.
+    double alpha{0.05}; ///< Probability of accepting H1, although H0 is true.
+    double beta{0.05};  ///< Probability of accepting H0, although H1 is true.
+};
+
+/**
+ * \brief State of a sequential probability ratio test.
+ */
+enum class SprtDecision {
+    Continue, ///< More games are needed.
+    AcceptH0, ///< The first engine is not stronger by elo1.
+    AcceptH1, ///< The first engine is stronger by more than elo0.
+};
+
+auto to_string(SprtDecision decision) -> std::string;
+
+/**
+ * \brief Estimated Elo difference with a 95% confidence interval.
+ */
+struct EloEstimate {
+    double elo{0.0};
+    double lower{0.0};
+    double upper{0.0};
+};
+
+/**
+ * \brief Sequential probability ratio test over game pairs.
+ *
+ * The two games of a pair are played from the same opening with swapped
+ * colors. A pair scores 0, 0.5, 1, 1.5 or 2 points for the first engine, and
+ * the test counts how often each score occurs (the pentanomial model). This
+ * removes most of the variance the openings add and ends tests earlier than
+ * counting single games.
+ * The log-likelihood ratio uses the normal approximation of the generalized
+ * SPRT: LLR = N (s1 - s0) (2 m - s0 - s1) / (2 v), with the expected scores
+ * s0 and s1 of the hypotheses, and the mean m and variance v of the pair
+ * scores.
+ */
+class Sprt {
+public:
+    explicit Sprt(SprtSettings settings = {});
+
+    /**
+     * \brief Add the result of a game pair.
+     *
+     * \param half_points Points of the first engine in both games, counted in
+     *   half points (0 to 4).
+     * \return The decision after adding the pair.
+     */
+    auto add_pair(int half_points) -> SprtDecision;
+
+    /**
+     * \brief Add the result of a game pair.
+     *
+     * \param first_score Points of the first engine in the first game (0, 0.5 or 1).
+     * \param second_score Points of the first engine in the second game.
+     * \return The decision after adding the pair.
+     */
+    auto add_pair(double first_score, double second_score) -> SprtDecision;
+
+    auto decision() const -> SprtDecision;
+    auto llr() const -> double;
+    auto lower_bound() const -> double;
+    auto upper_bound() const -> double;
+    auto elo() const -> EloEstimate;
+
+    /**
+     * \brief Number of pairs per pair score.
+     *
+     * \return Counts for 0, 0.5, 1, 1.5 and 2 points of the first engine.
+     */
+    auto pentanomial() const -> const std::array<std::uint64_t, 5> & { return m_pentanomial; }
+    auto pairs() const -> std::uint64_t;
+    auto settings() const -> const SprtSettings & { return m_settings; }
+
+    /**
+     * \brief Format the state of the test in one line.
+     *
+     * \return LLR with its bounds, Elo estimate and pentanomial counts.
+     */
+    auto summary() const -> std::string;
+private:
+    SprtSettings m_settings;
+    std::array<std::uint64_t, 5> m_pentanomial{};
+
+    auto mean_and_variance() const -> std::pair<double, double>;
+};
+
+} // namespace chessuci
+
+#endif
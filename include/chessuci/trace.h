@@ -0,0 +1,93 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_TRACE_H
+#define CHESSUCI_TRACE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chessuci {
+
+enum class TracePhase : char {
+    Begin = 'B',  ///< Start of a duration on the track.
+    End = 'E',    ///< End of the innermost duration on the track.
+    Instant = 'i' ///< A single point in time.
+};
+
+/**
+ * \brief An event on the timeline of a track.
+ */
+struct TraceEvent {
+    std::int64_t timestamp{0};     ///< Nanoseconds since tracing was started.
+    std::uint64_t track{0};        ///< Track of the event, the engine's process id on the GUI side.
+    const char *name{nullptr};     ///< Name of the event, a string literal.
+    TracePhase phase{TracePhase::Instant};
+    std::array<char, 64> detail{}; ///< The command or line, truncated and null-terminated.
+};
+
+/**
+ * \brief Optional process-wide tracing of the protocol activity.
+ *
+ * Events are written to lock-free ring buffers, one per thread, that keep
+ * the latest events. When tracing is off, recording costs a single relaxed
+ * atomic load. The trace is exported in the Chrome trace-event format, which
+ * can be opened in Perfetto or chrome://tracing; every track becomes a
+ * thread of its own.
+ * The buffers should only be read after stop(), when the traced handlers
+ * are idle.
+ */
+class Trace {
+public:
+    /**
+     * \brief Start tracing and drop all recorded events.
+     *
+     * \param capacity Number of events kept per thread.
+     */
+    static auto start(std::size_t capacity = 65536) -> void;
+
+    static auto stop() -> void;
+    static auto enabled() -> bool { return m_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * \brief Record an event on the calling thread, if tracing is on.
+     *
+     * \param track Track of the event.
+     * \param name Name of the event, must be a string literal.
+     * \param phase Phase of the event.
+     * \param detail Command or line belonging to the event.
+     */
+    static auto record(std::uint64_t track, const char *name, TracePhase phase, std::string_view detail = {}) -> void {
+        if (enabled()) {
+            write(track, name, phase, detail);
+        }
+    }
+
+    /**
+     * \brief Set the name shown for a track.
+     */
+    static auto name_track(std::uint64_t track, std::string name) -> void;
+
+    /**
+     * \brief All recorded events ordered by time.
+     */
+    static auto events() -> std::vector<TraceEvent>;
+
+    static auto to_json() -> std::string;
+    static auto write_file(const std::filesystem::path &path) -> bool;
+private:
+    static inline std::atomic<bool> m_enabled{false};
+
+    static auto write(std::uint64_t track, const char *name, TracePhase phase, std::string_view detail) -> void;
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,131 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_TRANSCRIPT_H
+#define CHESSUCI_TRANSCRIPT_H
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace chessuci {
+
+/**
+ * \brief Direction of a line in a transcript.
+ */
+enum class TranscriptDirection : std::uint8_t {
+    ToEngine = 0,   ///< The line was sent to the engine.
+    FromEngine = 1, ///< The line was received from the engine.
+};
+
+/**
+ * \brief A single line of communication with an engine.
+ */
+struct TranscriptEntry {
+    TranscriptDirection direction{TranscriptDirection::ToEngine}; ///< Direction of the line.
+    std::chrono::nanoseconds timestamp{0};                        ///< Monotonic time since the start of the recording.
+    std::string line{};                                           ///< The line without newline.
+
+    auto operator==(const TranscriptEntry &rhs) const -> bool = default;
+};
+
+/**
+ * \brief Writes a binary transcript of the communication with an engine.
+ *
+ * A transcript starts with an 8 byte header, followed by one record per line.
+ * Each record consists of the direction (1 byte), the time since the previous
+ * record in nanoseconds and the length of the line (both as LEB128 varints),
+ * followed by the bytes of the line.
+ * Records are only ever appended, so a transcript that is cut off (e.g., by a
+ * crash) can still be read up to the last complete record.
+ * All functions are thread safe.
+ */
+class TranscriptWriter {
+public:
+    explicit TranscriptWriter(const std::filesystem::path &path);
+
+    auto is_open() const -> bool { return m_stream.is_open() && m_stream.good(); }
+
+    /**
+     * \brief Append a line with the current time.
+     *
+     * \param direction Direction of the line.
+     * \param line The line.
+     */
+    auto append(TranscriptDirection direction, std::string_view line) -> void;
+
+    /**
+     * \brief Append an entry with a given timestamp.
+     *
+     * Timestamps must not decrease. Earlier timestamps are stored as the
+     * timestamp of the previous entry.
+     * \param entry The entry to append.
+     */
+    auto append(const TranscriptEntry &entry) -> void;
+
+    auto flush() -> void;
+private:
+    std::mutex m_mutex;
+    std::ofstream m_stream;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::nanoseconds m_last_timestamp{0};
+    std::string m_record;
+
+    auto write_record(TranscriptDirection direction, std::chrono::nanoseconds timestamp, std::string_view line) -> void;
+};
+
+/**
+ * \brief Reads a binary transcript written by TranscriptWriter.
+ */
+class TranscriptReader {
+public:
+    explicit TranscriptReader(const std::filesystem::path &path);
+
+    /**
+     * \brief Check, if the transcript could be opened.
+     *
+     * \return If the file exists and starts with a valid header.
+     */
+    auto is_open() const -> bool { return m_valid; }
+
+    /**
+     * \brief Read the next entry.
+     *
+     * Records with a line longer than the rest of the file, or longer than
+     * any plausible UCI line, are rejected without reading them.
+     * \param entry Receives the entry.
+     * \return If a complete entry could be read, false at the end or at a corrupt record.
+     */
+    auto next(TranscriptEntry &entry) -> bool;
+
+    /**
+     * \brief Check, if reading stopped at a corrupt or truncated record.
+     */
+    auto is_corrupt() const -> bool { return m_corrupt; }
+
+    /**
+     * \brief Read a complete transcript.
+     *
+     * \param path Path of the transcript.
+     * \return All entries of the transcript, if it could be opened.
+     */
+    static auto read_all(const std::filesystem::path &path) -> std::optional<std::vector<TranscriptEntry>>;
+private:
+    std::ifstream m_stream;
+    bool m_valid{false};
+    bool m_corrupt{false};
+    std::uint64_t m_file_size{0};
+    std::chrono::nanoseconds m_last_timestamp{0};
+};
+
+} // namespace chessuci
+
+#endif
@@ -1,57 +1,129 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#ifndef CHESSUCI_UCI_HANDLER_H
-#define CHESSUCI_UCI_HANDLER_H
-
-#include <atomic>
-#include <functional>
-#include <mutex>
-#include <string>
-#include <thread>
-#include <unordered_map>
-#include <vector>
-
-#include "chessuci/protocol.h"
-
-namespace chessuci {
-
-class UCIHandler {
-public:
-    using CustomCommandCallback = std::function<void(const TokenList &)>;
-    using UnknownCommandCallback = std::function<void(const TokenList &)>;
-
-    auto is_running() const -> bool { return m_running; }
-
-    auto register_command(const std::string &command, CustomCommandCallback callback) -> void;
-    auto unregister_command(const std::string &command) -> void;
-    auto on_unknown_command(UnknownCommandCallback callback) -> void { m_unknown_command_callback = std::move(callback); }
-
-    static auto strip_trailing_whitespace(std::string &line) -> void;
-    static auto tokenize(const std::string &line) -> TokenList;
-
-    auto process_line(const std::string &line) -> void;
-protected:
-    std::atomic<bool> m_running{false};
-    std::mutex m_custom_commands_mutex;
-    std::unordered_map<std::string, CustomCommandCallback> m_custom_commands;
-    std::mutex m_output_mutex;
-    std::thread m_thread;
-
-    UnknownCommandCallback m_unknown_command_callback;
-    using CommandHandler = std::function<void(const TokenList &)>;
-    std::unordered_map<std::string, CommandHandler> m_uci_commands;
-
-    template<typename C, typename... Args>
-    auto call(const C &callback, Args &&...args) const -> void {
-        if (callback) {
-            callback(std::forward<Args>(args)...);
-        }
-    }
-};
-
-} // namespace chessuci
-
-#endif
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_UCI_HANDLER_H
+#define CHESSUCI_UCI_HANDLER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "chessuci/metrics.h"
+#include "chessuci/protocol.h"
+#include "chessuci/trace.h"
+
+namespace chessuci {
+
+class UCIHandler {
+public:
+    /**
+     * \brief The tokens of a line, with the strings of earlier lines kept for reuse.
+     */
+    struct TokenBuffer {
+        TokenList tokens;               ///< The tokens of the current line.
+        std::vector<std::string> spare; ///< Strings of earlier, longer lines, kept for their capacity.
+    };
+
+    using CustomCommandCallback = std::function<void(const TokenList &)>;
+    using UnknownCommandCallback = std::function<void(const TokenList &)>;
+    using ParseErrorCallback = std::function<void(const ParseError &, const TokenList &)>;
+
+    auto is_running() const -> bool { return m_running; }
+
+    auto register_command(const std::string &command, CustomCommandCallback callback) -> void;
+    auto unregister_command(const std::string &command) -> void;
+    auto on_unknown_command(UnknownCommandCallback callback) -> void { m_unknown_command_callback = std::move(callback); }
+    auto on_parse_error(ParseErrorCallback callback) -> void { m_parse_error_callback = std::move(callback); }
+
+    /**
+     * \brief Number of malformed commands received.
+     *
+     * Malformed commands are dropped and reported to the parse error callback.
+     * \return The number of commands that could not be parsed.
+     */
+    auto parse_error_count() const -> std::uint64_t { return m_parse_error_count; }
+
+    static auto strip_trailing_whitespace(std::string &line) -> void;
+    static auto tokenize(const std::string &line) -> TokenList;
+
+    /**
+     * \brief Split a line into tokens, reusing the strings of a token buffer.
+     *
+     * Tokens that fit the existing strings do not allocate. Strings that a
+     * shorter line does not need are moved to the spare strings instead of
+     * being destroyed, so a buffer that is reused for every line stops
+     * allocating after a few lines.
+     * \param line The line to split at whitespace.
+     * \param buffer The tokens of the line, previous tokens are replaced.
+     */
+    static auto tokenize(std::string_view line, TokenBuffer &buffer) -> void;
+
+    /**
+     * \brief Parse a line and pass it to its command handler.
+     *
+     * The tokens are kept in a buffer of the handler. A call from a callback,
+     * i.e., while a line is processed, uses a buffer of its own. Must not be
+     * called concurrently.
+     */
+    auto process_line(const std::string &line) -> void;
+protected:
+    std::atomic<bool> m_running{false};
+    std::mutex m_custom_commands_mutex;
+    std::unordered_map<std::string, CustomCommandCallback> m_custom_commands;
+    std::mutex m_output_mutex;
+    std::thread m_thread;
+
+    UnknownCommandCallback m_unknown_command_callback;
+    ParseErrorCallback m_parse_error_callback;
+    std::atomic<std::uint64_t> m_parse_error_count{0};
+    std::uint64_t m_trace_track{0}; // set before the reader thread starts
+    using CommandHandler = std::function<void(const TokenList &)>;
+    std::unordered_map<std::string, CommandHandler> m_uci_commands;
+    TokenBuffer m_tokens;     // reused by process_line()
+    bool m_processing{false}; // set while process_line() uses m_tokens
+
+    template<typename C, typename... Args>
+    auto call(const C &callback, Args &&...args) const -> void {
+        if (callback) {
+            callback(std::forward<Args>(args)...);
+        }
+    }
+
+    template<typename C, typename T>
+    auto call_parsed(const C &callback, const ParseResult<T> &result, const TokenList &tokens) -> void {
+        if (result.has_value()) {
+            call(callback, result.value());
+        } else {
+            report_parse_error(result.error(), tokens);
+        }
+    }
+
+    template<typename T>
+    static auto value_or_throw(ParseResult<T> &&result, const std::string &context) -> T {
+        if (!result.has_value()) {
+            throw UCIError{context + to_string(result.error())};
+        }
+        return std::move(result.value());
+    }
+
+    auto report_parse_error(const ParseError &error, const TokenList &tokens) -> void {
+        ++m_parse_error_count;
+        Metrics::add(Metric::ParseErrors);
+        call(m_parse_error_callback, error, tokens);
+    }
+private:
+    auto process_tokens(const std::string &line, const TokenList &tokens) -> void;
+    auto dispatch(const TokenList &tokens) -> void;
+};
+
+} // namespace chessuci
+
+#endif
@@ -0,0 +1,176 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#ifndef CHESSUCI_WATCHDOG_H
+#define CHESSUCI_WATCHDOG_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "chessuci/protocol.h"
+
+namespace chessuci {
+
+/**
+ * \brief Deadlines the watchdog enforces.
+ */
+struct WatchdogSettings {
+    std::chrono::milliseconds resolution{10};         ///< Tick of the timer wheel.
+    std::chrono::milliseconds grace{1000};            ///< Time after the expected end of a search until "stop" is sent.
+    std::chrono::milliseconds terminate_after{2000};  ///< Time after "stop" until the engine is terminated.
+    std::chrono::milliseconds kill_after{2000};       ///< Time after terminating until the engine is killed.
+    std::chrono::milliseconds default_budget{0};      ///< Expected duration of searches without time limit, 0 to not watch them.
+};
+
+/**
+ * \brief Overrun statistics of one engine.
+ */
+struct WatchdogStatistics {
+    std::uint64_t searches{0};                  ///< Number of searches watched.
+    std::uint64_t overruns{0};                  ///< Number of searches that ended after their expected end.
+    std::uint64_t stops{0};                     ///< Number of "stop" commands sent by the watchdog.
+    std::uint64_t terminations{0};              ///< Number of engines terminated by the watchdog.
+    std::uint64_t kills{0};                     ///< Number of engines killed by the watchdog.
+    std::chrono::milliseconds total_overrun{0}; ///< Sum of the time the searches ran past their expected end.
+    std::chrono::milliseconds max_overrun{0};   ///< Longest time a search ran past its expected end.
+};
+
+/**
+ * \brief Enforces the deadlines of searches of many engines.
+ *
+ * The watchdog keeps the outstanding searches in a timer wheel that a single
+ * thread advances once per resolution tick, so adding and completing a
+ * search takes constant time independent of the number of engines. A search
+ * that runs longer than its expected end plus the grace period is stopped.
+ * If the engine does not answer, it is terminated and finally killed.
+ * The actions are called on the watchdog thread. After cancel() returned,
+ * no action of the search is running or called anymore.
+ * All functions are thread safe.
+ */
+class Watchdog {
+public:
+    using clock = std::chrono::steady_clock;
+    using Id = std::uint64_t;
+
+    /**
+     * \brief What the watchdog does to a stuck engine.
+     */
+    struct Actions {
+        std::function<void()> stop;      ///< Sends "stop".
+        std::function<void()> terminate; ///< Asks the engine to quit without waiting.
+        std::function<void()> kill;      ///< Kills the engine process.
+    };
+
+    explicit Watchdog(WatchdogSettings settings = {});
+    ~Watchdog();
+
+    Watchdog(const Watchdog &) = delete;
+    auto operator=(const Watchdog &) -> Watchdog & = delete;
+
+    /**
+     * \brief Start watching a search.
+     *
+     * The expected duration counts from the call, so a pipelined search is
+     * watched once the engine starts it.
+     * \param engine Name the statistics are collected under.
+     * \param duration Expected duration of the search, no deadline if empty.
+     * \param actions Actions for the escalation.
+     * \return Id of the search.
+     */
+    auto watch(const std::string &engine, std::optional<std::chrono::milliseconds> duration, Actions actions) -> Id;
+
+    /**
+     * \brief Note that the search was stopped by the caller.
+     *
+     * The engine is terminated, if it does not send the bestmove within the
+     * terminate period.
+     * \param id Id of the search.
+     */
+    auto stopped(Id id) -> void;
+
+    /**
+     * \brief The search sent its bestmove.
+     *
+     * \param id Id of the search.
+     */
+    auto complete(Id id) -> void;
+
+    /**
+     * \brief Stop watching a search without counting it.
+     *
+     * Waits for a running action of the search.
+     * \param id Id of the search.
+     */
+    auto cancel(Id id) -> void;
+
+    /**
+     * \brief Expected duration of a search.
+     *
+     * For searches with a clock, the longer clock including its increment
+     * is used, because the side to move is not known from the go command.
+     * Pondering and infinite searches have no expected end.
+     * \param command The go command.
+     * \return The duration, or the default budget for searches without time
+     *   limit, if it is set.
+     */
+    auto expected_duration(const go_command &command) const -> std::optional<std::chrono::milliseconds>;
+
+    auto statistics(const std::string &engine) const -> WatchdogStatistics;
+    auto statistics() const -> std::map<std::string, WatchdogStatistics>;
+    auto pending() const -> std::size_t;
+    auto settings() const -> const WatchdogSettings & { return m_settings; }
+private:
+    static constexpr std::size_t wheel_size{256};
+
+    enum class Stage { Running, Stopped, Terminated };
+
+    struct Search {
+        std::string engine;
+        Actions actions;
+        std::optional<clock::time_point> expected_end;
+        Stage stage{Stage::Running};
+        std::uint64_t deadline{0}; // tick of the next escalation
+        std::uint64_t generation{0};
+    };
+
+    struct Slot {
+        Id id;
+        std::uint64_t generation;
+    };
+
+    WatchdogSettings m_settings;
+    clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::unordered_map<Id, Search> m_searches;
+    std::vector<std::vector<Slot>> m_wheel;
+    std::map<std::string, WatchdogStatistics> m_statistics;
+    std::uint64_t m_tick{0};
+    Id m_next_id{1};
+    bool m_running{true};
+
+    // held while actions run, taken before m_mutex
+    std::mutex m_action_mutex;
+    std::thread m_thread;
+
+    auto tick_of(clock::time_point time) const -> std::uint64_t;
+    auto schedule(Id id, Search &search, clock::time_point deadline) -> void;
+    auto advance(std::uint64_t tick, std::vector<std::function<void()>> &actions) -> void;
+    auto run() -> void;
+};
+
+} // namespace chessuci
+
+#endif
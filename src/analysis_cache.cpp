@@ -0,0 +1,384 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/analysis_cache.h"
+#include "chessuci/engine_handler.h"
+#include "chessuci/gui_handler.h"
+#include "chessuci/mapped_file.h"
+#include "chessuci/move.h"
+
+#include <array>
+#include <sstream>
+
+#include <chesscore/fen.h>
+#include <chesscore/position.h>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::array<char, 8> cache_magic{'C', 'U', 'C', 'I', 'A', 'N', 'L', '\x01'};
+constexpr unsigned bits_per_byte{8};
+constexpr std::uint64_t byte_mask{0xff};
+
+constexpr int square_count{64};
+constexpr int files_per_rank{8};
+constexpr char first_file{'a'};
+constexpr std::size_t piece_type_count{6};
+constexpr std::size_t castling_combinations{16};
+
+constexpr std::size_t side_key{2 * piece_type_count * square_count};
+constexpr std::size_t castling_keys{side_key + 1};
+constexpr std::size_t en_passant_keys{castling_keys + castling_combinations};
+constexpr std::size_t zobrist_size{en_passant_keys + files_per_rank};
+
+constexpr unsigned white_kingside{1};
+constexpr unsigned white_queenside{2};
+constexpr unsigned black_kingside{4};
+constexpr unsigned black_queenside{8};
+
+constexpr std::uint64_t fnv_offset_basis{0xcbf29ce484222325ULL};
+constexpr std::uint64_t fnv_prime{0x100000001b3ULL};
+
+constexpr auto splitmix64(std::uint64_t &state) -> std::uint64_t {
+    state += 0x9e3779b97f4a7c15ULL;
+    auto value = state;
+    value = (value ^ (value >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27U)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31U);
+}
+
+constexpr auto make_zobrist_table() -> std::array<std::uint64_t, zobrist_size> {
+    std::array<std::uint64_t, zobrist_size> table{};
+    std::uint64_t state{0};
+    for (auto &key : table) {
+        key = splitmix64(state);
+    }
+    // no castling rights must not change the hash
+    table[castling_keys] = 0;
+    return table;
+}
+
+// fixed seed, so hashes stay valid across runs
+constexpr auto zobrist_table = make_zobrist_table();
+
+auto piece_index(const chesscore::Piece &piece) -> std::size_t {
+    std::size_t index{0};
+    switch (piece.type) {
+    case chesscore::PieceType::Pawn:
+        index = 0;
+        break;
+    case chesscore::PieceType::Knight:
+        index = 1;
+        break;
+    case chesscore::PieceType::Bishop:
+        index = 2;
+        break;
+    case chesscore::PieceType::Rook:
+        index = 3;
+        break;
+    case chesscore::PieceType::Queen:
+        index = 4;
+        break;
+    case chesscore::PieceType::King:
+        index = 5;
+        break;
+    }
+    return piece.color == chesscore::Color::White ? index : index + piece_type_count;
+}
+
+auto parse_castling_rights(std::string_view field) -> unsigned {
+    unsigned rights{0};
+    for (const auto chr : field) {
+        if (chr == 'K') {
+            rights |= white_kingside;
+        } else if (chr == 'Q') {
+            rights |= white_queenside;
+        } else if (chr == 'k') {
+            rights |= black_kingside;
+        } else if (chr == 'q') {
+            rights |= black_queenside;
+        }
+    }
+    return rights;
+}
+
+// castling rights lost by moving from or to a square
+auto castling_mask(const chesscore::Square &square) -> unsigned {
+    if (square == chesscore::Square::E1) {
+        return white_kingside | white_queenside;
+    }
+    if (square == chesscore::Square::H1) {
+        return white_kingside;
+    }
+    if (square == chesscore::Square::A1) {
+        return white_queenside;
+    }
+    if (square == chesscore::Square::E8) {
+        return black_kingside | black_queenside;
+    }
+    if (square == chesscore::Square::H8) {
+        return black_kingside;
+    }
+    if (square == chesscore::Square::A8) {
+        return black_queenside;
+    }
+    return 0;
+}
+
+auto append_integer(std::string &buffer, std::uint64_t value, std::size_t bytes) -> void {
+    for (std::size_t index = 0; index < bytes; ++index) {
+        buffer += static_cast<char>(value & byte_mask);
+        value >>= bits_per_byte;
+    }
+}
+
+auto read_integer(std::string_view &data, std::size_t bytes, std::uint64_t &value) -> bool {
+    if (data.size() < bytes) {
+        return false;
+    }
+    value = 0;
+    for (std::size_t index = 0; index < bytes; ++index) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(data[index])) << (bits_per_byte * index);
+    }
+    data.remove_prefix(bytes);
+    return true;
+}
+
+auto read_string(std::string_view &data, std::string &value) -> bool {
+    std::uint64_t length{0};
+    if (!read_integer(data, sizeof(std::uint32_t), length) || data.size() < length) {
+        return false;
+    }
+    value.assign(data.substr(0, length));
+    data.remove_prefix(length);
+    return true;
+}
+
+auto format_bestmove(const bestmove_info &bestmove) -> std::string {
+    std::string line{"bestmove " + to_string(bestmove.bestmove)};
+    if (bestmove.pondermove.has_value()) {
+        line += " ponder " + to_string(bestmove.pondermove.value());
+    }
+    return line;
+}
+
+} // namespace
+
+AnalysisCache::AnalysisCache(const std::filesystem::path &path) {
+    std::error_code error;
+    const auto file_size = std::filesystem::exists(path, error) ? std::filesystem::file_size(path, error) : 0;
+    if (error) {
+        m_last_error = "Failed to open analysis cache " + path.string();
+        return;
+    }
+    if (file_size == 0) {
+        m_stream.open(path, std::ios::binary | std::ios::trunc);
+        m_stream.write(cache_magic.data(), cache_magic.size());
+    } else {
+        const auto valid_size = load(path);
+        if (valid_size == 0) {
+            // never overwrite a file that might belong to someone else
+            m_last_error = "Not an analysis cache " + path.string();
+            return;
+        }
+        // drop a record that was cut off, so new records can be appended
+        if (file_size > valid_size) {
+            std::filesystem::resize_file(path, valid_size, error);
+        }
+        m_stream.open(path, std::ios::binary | std::ios::app);
+    }
+    if (!m_stream.is_open() || error) {
+        m_last_error = "Failed to open analysis cache " + path.string();
+        m_stream.close();
+    }
+}
+
+auto AnalysisCache::is_open() const -> bool {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_stream.is_open();
+}
+
+auto AnalysisCache::last_error() const -> std::string {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_last_error;
+}
+
+auto AnalysisCache::lookup(const AnalysisKey &key) const -> std::optional<AnalysisResult> {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto entry = m_entries.find(IndexKey{.position = key.position, .engine = key.engine, .kind = key.limit.kind});
+    if (entry == m_entries.end() || entry->second.limit < key.limit.value) {
+        return std::nullopt;
+    }
+    return entry->second.result;
+}
+
+auto AnalysisCache::store(const AnalysisKey &key, const AnalysisResult &result) -> bool {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (!insert(key, result) || !m_stream.is_open()) {
+        return false;
+    }
+
+    const auto info = UCIEngineHandler::format_info(result.info);
+    const auto bestmove = format_bestmove(result.bestmove);
+    m_record.clear();
+    append_integer(m_record, key.position, sizeof(std::uint64_t));
+    append_integer(m_record, key.engine, sizeof(std::uint64_t));
+    append_integer(m_record, static_cast<std::uint64_t>(key.limit.kind), sizeof(std::uint8_t));
+    append_integer(m_record, key.limit.value, sizeof(std::uint64_t));
+    append_integer(m_record, info.size(), sizeof(std::uint32_t));
+    m_record += info;
+    append_integer(m_record, bestmove.size(), sizeof(std::uint32_t));
+    m_record += bestmove;
+    m_stream.write(m_record.data(), static_cast<std::streamsize>(m_record.size()));
+    if (!m_stream.flush()) {
+        // the result stays in memory, but later results are not written either
+        m_last_error = "Failed to write analysis cache";
+        m_stream.close();
+        return false;
+    }
+    return true;
+}
+
+auto AnalysisCache::size() const -> std::size_t {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_entries.size();
+}
+
+auto AnalysisCache::load(const std::filesystem::path &path) -> std::size_t {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return 0;
+    }
+    MappedFile file{path};
+    const auto contents = file.contents();
+    if (!file.is_open() || !contents.starts_with(std::string_view{cache_magic.data(), cache_magic.size()})) {
+        return 0;
+    }
+
+    auto data = contents.substr(cache_magic.size());
+    while (!data.empty()) {
+        auto record = data;
+        AnalysisKey key{};
+        std::uint64_t kind{0};
+        std::string info_line;
+        std::string bestmove_line;
+        if (!read_integer(record, sizeof(std::uint64_t), key.position) || !read_integer(record, sizeof(std::uint64_t), key.engine) ||
+            !read_integer(record, sizeof(std::uint8_t), kind) || !read_integer(record, sizeof(std::uint64_t), key.limit.value) ||
+            !read_string(record, info_line) || !read_string(record, bestmove_line)) {
+            break;
+        }
+        data = record;
+
+        const auto info = UCIGuiHandler::try_parse_info_command(UCIHandler::tokenize(info_line));
+        const auto bestmove = UCIGuiHandler::try_parse_bestmove_command(UCIHandler::tokenize(bestmove_line));
+        if (kind <= static_cast<std::uint64_t>(SearchLimit::Kind::Movetime) && info.has_value() && bestmove.has_value()) {
+            key.limit.kind = static_cast<SearchLimit::Kind>(kind);
+            insert(key, AnalysisResult{.info = info.value(), .bestmove = bestmove.value()});
+        }
+    }
+    return contents.size() - data.size();
+}
+
+auto AnalysisCache::insert(const AnalysisKey &key, AnalysisResult result) -> bool {
+    const auto index_key = IndexKey{.position = key.position, .engine = key.engine, .kind = key.limit.kind};
+    const auto entry = m_entries.find(index_key);
+    if (entry != m_entries.end() && entry->second.limit > key.limit.value) {
+        return false;
+    }
+    m_entries.insert_or_assign(index_key, Entry{.limit = key.limit.value, .result = std::move(result)});
+    return true;
+}
+
+auto AnalysisCache::IndexKeyHash::operator()(const IndexKey &key) const -> std::size_t {
+    return static_cast<std::size_t>(key.position ^ (key.engine * fnv_prime) ^ static_cast<std::uint64_t>(key.kind));
+}
+
+auto AnalysisCache::make_key(std::string_view engine, const position_command &position, const go_command &go) -> std::optional<AnalysisKey> {
+    const auto limit = normalize(go);
+    if (!limit.has_value()) {
+        return std::nullopt;
+    }
+    const auto hash = position_hash(position);
+    if (!hash.has_value()) {
+        return std::nullopt;
+    }
+    return AnalysisKey{.position = hash.value(), .engine = engine_hash(engine), .limit = limit.value()};
+}
+
+auto AnalysisCache::normalize(const go_command &go) -> std::optional<SearchLimit> {
+    if (!go.searchmoves.empty() || go.ponder || go.infinite || go.wtime.has_value() || go.btime.has_value() || go.winc.has_value() ||
+        go.binc.has_value() || go.movestogo.has_value() || go.mate.has_value()) {
+        return std::nullopt;
+    }
+    const auto limits = static_cast<int>(go.depth.has_value()) + static_cast<int>(go.nodes.has_value()) + static_cast<int>(go.movetime.has_value());
+    if (limits != 1) {
+        return std::nullopt;
+    }
+    const auto [kind, value] = go.depth.has_value()   ? std::pair{SearchLimit::Kind::Depth, go.depth.value()}
+                               : go.nodes.has_value() ? std::pair{SearchLimit::Kind::Nodes, go.nodes.value()}
+                                                      : std::pair{SearchLimit::Kind::Movetime, go.movetime.value()};
+    if (value <= 0) {
+        return std::nullopt;
+    }
+    return SearchLimit{.kind = kind, .value = static_cast<std::uint64_t>(value)};
+}
+
+auto AnalysisCache::position_hash(const position_command &position) -> std::optional<std::uint64_t> {
+    const auto fen = position.fen == position_command::startpos ? chesscore::starting_position_fen : position.fen;
+    std::istringstream fields{fen};
+    std::string placement;
+    std::string side;
+    std::string castling;
+    if (!(fields >> placement >> side >> castling)) {
+        return std::nullopt;
+    }
+
+    try {
+        chesscore::Position board{chesscore::FenString{fen}};
+        auto castling_rights = parse_castling_rights(castling);
+        for (const auto &move : position.moves) {
+            const auto converted = convert_move(move, board);
+            if (!converted.has_value()) {
+                return std::nullopt;
+            }
+            castling_rights &= ~(castling_mask(converted->from) | castling_mask(converted->to));
+            board.make_move(converted.value());
+        }
+
+        std::uint64_t hash{0};
+        for (int index = 0; index < square_count; ++index) {
+            const auto square = chesscore::Square{
+                chesscore::File{static_cast<char>(first_file + index % files_per_rank)}, chesscore::Rank{index / files_per_rank + 1}
+            };
+            const auto piece = board.board().get_piece(square);
+            if (piece.has_value()) {
+                hash ^= zobrist_table[piece_index(piece.value()) * square_count + static_cast<std::size_t>(index)];
+            }
+        }
+        if (board.side_to_move() == chesscore::Color::Black) {
+            hash ^= zobrist_table[side_key];
+        }
+        hash ^= zobrist_table[castling_keys + castling_rights];
+        const auto en_passant = board.en_passant_target();
+        if (en_passant.has_value()) {
+            hash ^= zobrist_table[en_passant_keys + static_cast<std::size_t>(to_string(en_passant.value())[0] - first_file)];
+        }
+        return hash;
+    } catch (const std::exception &) {
+        return std::nullopt;
+    }
+}
+
+auto AnalysisCache::engine_hash(std::string_view identity) -> std::uint64_t {
+    auto hash = fnv_offset_basis;
+    for (const auto chr : identity) {
+        hash ^= static_cast<unsigned char>(chr);
+        hash *= fnv_prime;
+    }
+    return hash;
+}
+
+} // namespace chessuci
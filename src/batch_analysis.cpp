@@ -0,0 +1,392 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/batch_analysis.h"
+#include "chessuci/analysis_cache.h"
+#include "chessuci/gui_handler.h"
+#include "chessuci/mapped_file.h"
+#include "chessuci/process_factory.h"
+#include "chessuci/string_conversion.h"
+
+#include <thread>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::size_t fen_board_fields{4};
+constexpr int milliseconds_per_second{1000};
+
+auto is_space(char chr) -> bool {
+    return chr == ' ' || chr == '\t' || chr == '\r' || chr == '\n';
+}
+
+auto trim(std::string_view text) -> std::string_view {
+    while (!text.empty() && is_space(text.front())) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && is_space(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// removes the next whitespace separated field from text
+auto next_field(std::string_view &text) -> std::string_view {
+    text = trim(text);
+    std::size_t end = 0;
+    while (end < text.size() && !is_space(text[end])) {
+        ++end;
+    }
+    const auto field = text.substr(0, end);
+    text.remove_prefix(end);
+    return field;
+}
+
+auto unquote(std::string_view text) -> std::string_view {
+    text = trim(text);
+    if (text.size() >= 2 && text.front() == '"' && text.back() == '"') {
+        text = text.substr(1, text.size() - 2);
+    }
+    return text;
+}
+
+// splits EPD operations at semicolons outside of quoted strings
+auto for_each_operation(std::string_view operations, const std::function<void(std::string_view, std::string_view)> &callback) -> void {
+    bool quoted = false;
+    std::size_t start = 0;
+    for (std::size_t index = 0; index <= operations.size(); ++index) {
+        if (index < operations.size() && operations[index] == '"') {
+            quoted = !quoted;
+        }
+        if (index == operations.size() || (operations[index] == ';' && !quoted)) {
+            auto operation = operations.substr(start, index - start);
+            const auto opcode = next_field(operation);
+            if (!opcode.empty()) {
+                callback(opcode, trim(operation));
+            }
+            start = index + 1;
+        }
+    }
+}
+
+auto fen_board(const std::string &fen) -> std::string {
+    std::string_view rest{fen};
+    std::string board;
+    for (std::size_t field = 0; field < fen_board_fields; ++field) {
+        if (field > 0) {
+            board += ' ';
+        }
+        board += next_field(rest);
+    }
+    return board;
+}
+
+} // namespace
+
+auto BatchStatistics::positions_per_second() const -> double {
+    const auto seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0.0 ? static_cast<double>(positions) / seconds : 0.0;
+}
+
+BatchAnalysis::BatchAnalysis(BatchSettings settings) : m_settings{std::move(settings)}, m_process_creator{&ProcessFactory::create_local} {
+    m_settings.engine_count = std::max<std::size_t>(m_settings.engine_count, 1);
+    m_settings.chunk_size = std::max<std::size_t>(m_settings.chunk_size, 1);
+}
+
+BatchAnalysis::~BatchAnalysis() = default;
+
+auto BatchAnalysis::run_file(const std::filesystem::path &path, const ResultCallback &on_result) -> bool {
+    MappedFile file{path};
+    if (!file.is_open()) {
+        m_last_error = file.last_error();
+        return false;
+    }
+    return run(file.contents(), on_result);
+}
+
+auto BatchAnalysis::run(std::string_view input, const ResultCallback &on_result) -> bool {
+    m_input = input;
+    m_input_offset = 0;
+    m_next_index = 0;
+    m_pending_results.clear();
+    m_next_result = 0;
+    m_on_result = &on_result;
+    m_positions = 0;
+    m_errors = 0;
+    m_stolen = 0;
+    m_cache_hits = 0;
+    m_restarts = 0;
+    m_last_error.clear();
+    m_workers.clear();
+    for (std::size_t index = 0; index < m_settings.engine_count; ++index) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> started_engines{0};
+    std::vector<std::thread> threads;
+    for (std::size_t index = 0; index < m_workers.size(); ++index) {
+        threads.emplace_back([this, index, &started_engines] -> void { run_worker(index, started_engines); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // positions left over, because engines failed
+    while (auto position = next_position(0)) {
+        publish(BatchResult{.position = std::move(position.value()), .info = {}, .bestmove = {}, .error = "No engine available"});
+    }
+    m_elapsed = std::chrono::steady_clock::now() - start;
+    m_on_result = nullptr;
+
+    if (started_engines == 0) {
+        m_last_error = "No engine could be started";
+        return false;
+    }
+    return true;
+}
+
+auto BatchAnalysis::statistics() const -> BatchStatistics {
+    return BatchStatistics{.positions = m_positions, .errors = m_errors, .stolen = m_stolen, .cache_hits = m_cache_hits, .restarts = m_restarts, .elapsed = m_elapsed};
+}
+
+auto BatchAnalysis::run_worker(std::size_t worker_index, std::atomic<std::size_t> &started_engines) -> void {
+    EngineSupervisor engine{m_settings.engine, m_settings.options, m_settings.restart};
+    engine.set_process_creator(m_process_creator);
+    std::mutex info_mutex;
+    search_info current_info{};
+    engine.on_info([&info_mutex, &current_info](const search_info &info) -> void {
+        if (info.multipv.value_or(1) != 1 || !info.string.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock{info_mutex};
+        merge_info(current_info, info);
+    });
+    engine.on_restart([this, &info_mutex, &current_info](std::uint64_t) -> void {
+        // the infos of the interrupted search are not part of the result
+        ++m_restarts;
+        std::lock_guard<std::mutex> lock{info_mutex};
+        current_info = search_info{};
+    });
+
+    if (!engine.start()) {
+        return;
+    }
+    std::string identity{engine.handshake().id.name + '\n' + engine.handshake().id.author};
+    for (const auto &option : m_settings.options) {
+        identity += '\n' + option.name + '=' + option.value.value_or("");
+    }
+    ++started_engines;
+    engine.handler().send_ucinewgame();
+
+    while (auto position = next_position(worker_index)) {
+        {
+            std::lock_guard<std::mutex> lock{info_mutex};
+            current_info = search_info{};
+        }
+        BatchResult result{.position = std::move(position.value()), .info = {}, .bestmove = {}, .error = {}};
+        const position_command command{.fen = result.position.fen, .moves = {}};
+        const auto cache_key = m_settings.cache != nullptr ? AnalysisCache::make_key(identity, command, m_settings.go) : std::nullopt;
+        if (cache_key.has_value()) {
+            if (auto cached = m_settings.cache->lookup(cache_key.value())) {
+                result.info = std::move(cached->info);
+                result.bestmove = std::move(cached->bestmove);
+                ++m_cache_hits;
+                publish(std::move(result));
+                continue;
+            }
+        }
+
+        try {
+            result.bestmove = engine.search(command, m_settings.go);
+            std::lock_guard<std::mutex> lock{info_mutex};
+            result.info = current_info;
+        } catch (const std::exception &error) {
+            result.error = error.what();
+        }
+        if (cache_key.has_value() && result.ok()) {
+            m_settings.cache->store(cache_key.value(), AnalysisResult{.info = result.info, .bestmove = result.bestmove});
+        }
+        const auto engine_failed = !result.ok();
+        publish(std::move(result));
+        if (engine_failed) {
+            // the remaining positions of this worker are stolen by the others
+            break;
+        }
+    }
+}
+
+auto BatchAnalysis::next_position(std::size_t worker_index) -> std::optional<BatchPosition> {
+    auto &worker = *m_workers[worker_index];
+    while (!m_cancelled) {
+        {
+            std::lock_guard<std::mutex> lock{worker.mutex};
+            if (!worker.queue.empty()) {
+                auto position = std::move(worker.queue.front());
+                worker.queue.pop_front();
+                return position;
+            }
+        }
+        if (!fill_queue(worker)) {
+            return steal(worker_index);
+        }
+    }
+    return std::nullopt;
+}
+
+auto BatchAnalysis::fill_queue(Worker &worker) -> bool {
+    std::vector<BatchPosition> chunk;
+    {
+        std::lock_guard<std::mutex> lock{m_input_mutex};
+        while (chunk.size() < m_settings.chunk_size && m_input_offset < m_input.size()) {
+            auto line_end = m_input.find('\n', m_input_offset);
+            if (line_end == std::string_view::npos) {
+                line_end = m_input.size();
+            }
+            auto position = parse_epd_line(m_input.substr(m_input_offset, line_end - m_input_offset), m_next_index);
+            m_input_offset = line_end + 1;
+            if (position.has_value()) {
+                ++m_next_index;
+                chunk.push_back(std::move(position.value()));
+            }
+        }
+    }
+    if (chunk.empty()) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock{worker.mutex};
+    worker.queue.insert(worker.queue.end(), std::make_move_iterator(chunk.begin()), std::make_move_iterator(chunk.end()));
+    return true;
+}
+
+auto BatchAnalysis::steal(std::size_t worker_index) -> std::optional<BatchPosition> {
+    while (!m_cancelled) {
+        // the oldest position blocks the output the longest
+        Worker *victim{nullptr};
+        std::size_t oldest_index{0};
+        for (std::size_t index = 0; index < m_workers.size(); ++index) {
+            if (index == worker_index) {
+                continue;
+            }
+            auto &worker = *m_workers[index];
+            std::lock_guard<std::mutex> lock{worker.mutex};
+            if (!worker.queue.empty() && (victim == nullptr || worker.queue.front().index < oldest_index)) {
+                victim = &worker;
+                oldest_index = worker.queue.front().index;
+            }
+        }
+        if (victim == nullptr) {
+            return std::nullopt;
+        }
+        std::lock_guard<std::mutex> lock{victim->mutex};
+        if (!victim->queue.empty()) {
+            auto position = std::move(victim->queue.front());
+            victim->queue.pop_front();
+            ++m_stolen;
+            return position;
+        }
+    }
+    return std::nullopt;
+}
+
+auto BatchAnalysis::publish(BatchResult result) -> void {
+    std::lock_guard<std::mutex> lock{m_results_mutex};
+    if (result.ok()) {
+        ++m_positions;
+    } else {
+        ++m_errors;
+    }
+    const auto index = result.position.index;
+    m_pending_results.emplace(index, std::move(result));
+    while (!m_pending_results.empty() && m_pending_results.begin()->first == m_next_result) {
+        if (m_on_result != nullptr && *m_on_result) {
+            (*m_on_result)(m_pending_results.begin()->second);
+        }
+        m_pending_results.erase(m_pending_results.begin());
+        ++m_next_result;
+    }
+}
+
+auto BatchAnalysis::parse_epd_line(std::string_view line, std::size_t index) -> std::optional<BatchPosition> {
+    line = trim(line);
+    if (line.empty() || line.front() == '#') {
+        return std::nullopt;
+    }
+
+    BatchPosition position{.index = index, .fen = {}, .id = {}};
+    for (std::size_t field = 0; field < fen_board_fields; ++field) {
+        const auto value = next_field(line);
+        if (value.empty()) {
+            return std::nullopt;
+        }
+        if (field > 0) {
+            position.fen += ' ';
+        }
+        position.fen += value;
+    }
+
+    // a FEN line continues with the halfmove clock and fullmove number
+    auto rest = line;
+    const auto halfmove = next_field(rest);
+    const auto fullmove = next_field(rest);
+    if (str_to_inttype<int>(halfmove).has_value() && str_to_inttype<int>(fullmove).has_value()) {
+        position.fen += " " + std::string{halfmove} + " " + std::string{fullmove};
+        return position;
+    }
+
+    std::string halfmove_clock{"0"};
+    std::string fullmove_number{"1"};
+    for_each_operation(line, [&](std::string_view opcode, std::string_view operand) -> void {
+        if (opcode == "id") {
+            position.id = unquote(operand);
+        } else if (opcode == "hmvc" && str_to_inttype<int>(operand).has_value()) {
+            halfmove_clock = operand;
+        } else if (opcode == "fmvn" && str_to_inttype<int>(operand).has_value()) {
+            fullmove_number = operand;
+        }
+    });
+    position.fen += " " + halfmove_clock + " " + fullmove_number;
+    return position;
+}
+
+auto BatchAnalysis::format_epd_result(const BatchResult &result) -> std::string {
+    std::string line = fen_board(result.position.fen);
+    const auto &info = result.info;
+    if (info.depth.has_value()) {
+        line += " acd " + std::to_string(info.depth.value()) + ";";
+    }
+    if (info.nodes.has_value()) {
+        line += " acn " + std::to_string(info.nodes.value()) + ";";
+    }
+    if (info.time.has_value()) {
+        line += " acs " + std::to_string(info.time.value() / milliseconds_per_second) + ";";
+    }
+    if (info.score.has_value() && info.score->cp.has_value()) {
+        line += " ce " + std::to_string(info.score->cp.value()) + ";";
+    }
+    if (info.score.has_value() && info.score->mate.has_value()) {
+        line += " dm " + std::to_string(info.score->mate.value()) + ";";
+    }
+    if (result.ok()) {
+        line += " bm " + to_string(result.bestmove.bestmove) + ";";
+    }
+    if (!info.pv.empty()) {
+        line += " pv";
+        for (const auto &move : info.pv) {
+            line += " " + to_string(move);
+        }
+        line += ";";
+    }
+    if (!result.position.id.empty()) {
+        line += " id \"" + result.position.id + "\";";
+    }
+    if (!result.ok()) {
+        line += " c9 \"" + result.error + "\";";
+    }
+    return line;
+}
+
+} // namespace chessuci
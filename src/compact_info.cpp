@@ -0,0 +1,371 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/compact_info.h"
+#include "chessuci/string_conversion.h"
+
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::string_view promotion_chars{" nbrq"};
+constexpr unsigned square_bits{6};
+constexpr unsigned square_mask{(1U << square_bits) - 1};
+constexpr unsigned board_size{8};
+
+auto square_index(char file, char rank) -> std::optional<unsigned> {
+    if (file < 'a' || file > 'h' || rank < '1' || rank > '8') {
+        return std::nullopt;
+    }
+    return static_cast<unsigned>(file - 'a') + 8U * static_cast<unsigned>(rank - '1');
+}
+
+// compares the coordinates instead of formatting the square
+auto square_index(const chesscore::Square &square) -> unsigned {
+    unsigned file{0};
+    while (file < board_size && square.file() != chesscore::File{static_cast<char>('a' + file)}) {
+        ++file;
+    }
+    unsigned rank{0};
+    while (rank < board_size && square.rank() != chesscore::Rank{static_cast<int>(rank) + 1}) {
+        ++rank;
+    }
+    return (file + board_size * rank) & square_mask;
+}
+
+auto promotion_index(const std::optional<chesscore::PieceType> &piece) -> unsigned {
+    if (!piece.has_value()) {
+        return 0;
+    }
+    // the order of promotion_chars
+    switch (piece.value()) {
+    case chesscore::PieceType::Knight:
+        return 1;
+    case chesscore::PieceType::Bishop:
+        return 2;
+    case chesscore::PieceType::Rook:
+        return 3;
+    case chesscore::PieceType::Queen:
+        return 4;
+    case chesscore::PieceType::Pawn:
+    case chesscore::PieceType::King:
+        break;
+    }
+    return 0;
+}
+
+auto square_from_index(unsigned index) -> chesscore::Square {
+    return chesscore::Square{chesscore::File{static_cast<char>('a' + index % 8)}, chesscore::Rank{static_cast<int>(index / 8) + 1}};
+}
+
+// splits a line at whitespace without copying, like UCIHandler::tokenize()
+class TokenReader {
+public:
+    explicit TokenReader(std::string_view line) : m_line{line} {}
+
+    auto next() -> std::optional<std::string_view> {
+        const auto token = peek();
+        if (token.has_value()) {
+            m_position = static_cast<std::size_t>(token->data() - m_line.data()) + token->size();
+        }
+        return token;
+    }
+
+    auto peek() const -> std::optional<std::string_view> {
+        const auto first = m_line.find_first_not_of(whitespace, m_position);
+        if (first == std::string_view::npos) {
+            return std::nullopt;
+        }
+        const auto last = std::min(m_line.find_first_of(whitespace, first), m_line.size());
+        return m_line.substr(first, last - first);
+    }
+private:
+    static constexpr std::string_view whitespace{" \t\n\r\v\f"};
+
+    std::string_view m_line;
+    std::size_t m_position{0};
+};
+
+auto error(ParseErrorType type, std::string_view token) -> ParseResult<void> {
+    return std::unexpected{ParseError{.type = type, .token = std::string{token}}};
+}
+
+template<typename T>
+auto parse_int(TokenReader &reader, std::string_view keyword) -> ParseResult<T> {
+    const auto token = reader.next();
+    if (!token.has_value()) {
+        return std::unexpected{ParseError{.type = ParseErrorType::MissingValue, .token = std::string{keyword}}};
+    }
+    const auto value = str_to_inttype<T>(token.value());
+    if (!value.has_value()) {
+        return std::unexpected{ParseError{.type = ParseErrorType::InvalidInteger, .token = std::string{token.value()}}};
+    }
+    return value.value();
+}
+
+} // namespace
+
+auto pack_move(const UCIMove &move) -> PackedMove {
+    return static_cast<PackedMove>(square_index(move.from) | square_index(move.to) << square_bits | promotion_index(move.promotion_piece) << (2 * square_bits));
+}
+
+auto unpack_move(PackedMove move) -> UCIMove {
+    const auto promotion = static_cast<std::size_t>(move >> (2 * square_bits));
+    std::optional<chesscore::PieceType> promotion_piece{std::nullopt};
+    if (promotion > 0 && promotion < promotion_chars.size()) {
+        promotion_piece = chesscore::piece_type_from_char(promotion_chars[promotion]);
+    }
+    return UCIMove{square_from_index(move & square_mask), square_from_index((move >> square_bits) & square_mask), promotion_piece};
+}
+
+auto parse_packed_move(std::string_view uci_str) -> std::optional<PackedMove> {
+    if (uci_str.size() != 4 && uci_str.size() != 5) {
+        return std::nullopt;
+    }
+    const auto from = square_index(uci_str[0], uci_str[1]);
+    const auto to = square_index(uci_str[2], uci_str[3]);
+    if (!from.has_value() || !to.has_value()) {
+        return std::nullopt;
+    }
+    std::size_t promotion{0};
+    if (uci_str.size() == 5) {
+        promotion = promotion_chars.find(uci_str[4]);
+        if (promotion == 0 || promotion == std::string_view::npos) {
+            return std::nullopt;
+        }
+    }
+    return static_cast<PackedMove>(from.value() | to.value() << square_bits | promotion << (2 * square_bits));
+}
+
+auto CompactSearchInfo::from_search_info(const search_info &info) -> std::optional<CompactSearchInfo> {
+    if (!info.string.empty()) {
+        return std::nullopt;
+    }
+
+    CompactSearchInfo compact{};
+    auto copy = [&compact](InfoField field, auto &target, const auto &value) -> void {
+        if (value.has_value()) {
+            compact.set(field, target, value.value());
+        }
+    };
+    copy(InfoField::Depth, compact.m_depth, info.depth);
+    copy(InfoField::Seldepth, compact.m_seldepth, info.seldepth);
+    copy(InfoField::Time, compact.m_time, info.time);
+    copy(InfoField::Nodes, compact.m_nodes, info.nodes);
+    copy(InfoField::Multipv, compact.m_multipv, info.multipv);
+    copy(InfoField::Currmovenumber, compact.m_currmovenumber, info.currmovenumber);
+    copy(InfoField::Hashfull, compact.m_hashfull, info.hashfull);
+    copy(InfoField::Nps, compact.m_nps, info.nps);
+    copy(InfoField::Tbhits, compact.m_tbhits, info.tbhits);
+    copy(InfoField::Sbhits, compact.m_sbhits, info.sbhits);
+    copy(InfoField::Cpuload, compact.m_cpuload, info.cpuload);
+    if (info.score.has_value()) {
+        compact.m_fields |= bit(InfoField::Score);
+        copy(InfoField::ScoreCp, compact.m_score_cp, info.score->cp);
+        copy(InfoField::ScoreMate, compact.m_score_mate, info.score->mate);
+        compact.m_fields |= (info.score->lowerbound ? bit(InfoField::Lowerbound) : 0) | (info.score->upperbound ? bit(InfoField::Upperbound) : 0);
+    }
+    if (info.currmove.has_value()) {
+        compact.set(InfoField::Currmove, compact.m_currmove, pack_move(info.currmove.value()));
+    }
+    for (const auto &move : info.pv) {
+        compact.add_move(MoveList::Pv, pack_move(move));
+    }
+    for (const auto &move : info.refutation) {
+        compact.add_move(MoveList::Refutation, pack_move(move));
+    }
+    if (info.currline.has_value()) {
+        compact.m_fields |= bit(InfoField::Currline);
+        copy(InfoField::Cpunr, compact.m_cpunr, info.currline->cpunr);
+        for (const auto &move : info.currline->line) {
+            compact.add_move(MoveList::Currline, pack_move(move));
+        }
+    }
+    return compact;
+}
+
+auto CompactSearchInfo::parse(std::string_view line) -> ParseResult<CompactSearchInfo> {
+    CompactSearchInfo compact{};
+    TokenReader reader{line};
+    reader.next();
+    std::optional<MoveList> target_list{std::nullopt};
+    while (const auto token = reader.next()) {
+        // parses the integer following the current token
+        auto parse_field = [&](InfoField field, auto &target) -> ParseResult<void> {
+            const auto value = parse_int<std::remove_reference_t<decltype(target)>>(reader, token.value());
+            if (!value.has_value()) {
+                return std::unexpected{value.error()};
+            }
+            compact.set(field, target, value.value());
+            target_list = std::nullopt;
+            return {};
+        };
+
+        ParseResult<void> result{};
+        if (token == "depth") {
+            result = parse_field(InfoField::Depth, compact.m_depth);
+        } else if (token == "seldepth") {
+            result = parse_field(InfoField::Seldepth, compact.m_seldepth);
+        } else if (token == "time") {
+            result = parse_field(InfoField::Time, compact.m_time);
+        } else if (token == "nodes") {
+            result = parse_field(InfoField::Nodes, compact.m_nodes);
+        } else if (token == "multipv") {
+            result = parse_field(InfoField::Multipv, compact.m_multipv);
+        } else if (token == "score") {
+            target_list = std::nullopt;
+            bool found = false;
+            compact.m_fields &= ~(bit(InfoField::ScoreCp) | bit(InfoField::ScoreMate) | bit(InfoField::Lowerbound) | bit(InfoField::Upperbound));
+            while (const auto score_token = reader.peek()) {
+                if (score_token == "cp" || score_token == "mate") {
+                    reader.next();
+                    const auto value = parse_int<int>(reader, score_token.value());
+                    if (!value.has_value()) {
+                        result = std::unexpected{value.error()};
+                        break;
+                    }
+                    const auto is_cp = score_token == "cp";
+                    compact.set(is_cp ? InfoField::ScoreCp : InfoField::ScoreMate, is_cp ? compact.m_score_cp : compact.m_score_mate, value.value());
+                } else if (score_token == "lowerbound" || score_token == "upperbound") {
+                    reader.next();
+                    compact.m_fields |= bit(score_token == "lowerbound" ? InfoField::Lowerbound : InfoField::Upperbound);
+                } else {
+                    break;
+                }
+                found = true;
+            }
+            if (result.has_value() && !found) {
+                result = error(ParseErrorType::MissingValue, "score");
+            }
+            compact.m_fields |= bit(InfoField::Score);
+        } else if (token == "currmove") {
+            target_list = std::nullopt;
+            const auto move_token = reader.next();
+            if (!move_token.has_value()) {
+                result = error(ParseErrorType::MissingValue, token.value());
+            } else if (const auto move = parse_packed_move(move_token.value())) {
+                compact.set(InfoField::Currmove, compact.m_currmove, move.value());
+            } else {
+                result = error(ParseErrorType::InvalidMove, move_token.value());
+            }
+        } else if (token == "currmovenumber") {
+            result = parse_field(InfoField::Currmovenumber, compact.m_currmovenumber);
+        } else if (token == "hashfull") {
+            result = parse_field(InfoField::Hashfull, compact.m_hashfull);
+        } else if (token == "nps") {
+            result = parse_field(InfoField::Nps, compact.m_nps);
+        } else if (token == "tbhits") {
+            result = parse_field(InfoField::Tbhits, compact.m_tbhits);
+        } else if (token == "sbhits") {
+            result = parse_field(InfoField::Sbhits, compact.m_sbhits);
+        } else if (token == "cpuload") {
+            result = parse_field(InfoField::Cpuload, compact.m_cpuload);
+        } else if (token == "currline") {
+            // a new current line replaces the previous one
+            std::fill_n(compact.m_moves.begin() + compact.m_pv_length + compact.m_refutation_length, compact.m_currline_length, PackedMove{0});
+            compact.m_currline_length = 0;
+            compact.m_fields &= ~bit(InfoField::Cpunr);
+            compact.m_fields |= bit(InfoField::Currline);
+            // the cpu number is optional
+            if (const auto cpunr = str_to_inttype<int>(reader.peek().value_or(""))) {
+                reader.next();
+                compact.set(InfoField::Cpunr, compact.m_cpunr, cpunr.value());
+            }
+            target_list = MoveList::Currline;
+        } else if (token == "pv") {
+            target_list = MoveList::Pv;
+        } else if (token == "refutation") {
+            target_list = MoveList::Refutation;
+        } else if (token == "string") {
+            result = error(ParseErrorType::UnexpectedToken, token.value());
+        } else if (target_list.has_value()) {
+            const auto move = parse_packed_move(token.value());
+            if (move.has_value()) {
+                compact.add_move(target_list.value(), move.value());
+            } else {
+                result = error(ParseErrorType::InvalidMove, token.value());
+            }
+        }
+        if (!result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+    }
+    return compact;
+}
+
+auto CompactSearchInfo::to_search_info() const -> search_info {
+    search_info info{};
+    info.depth = depth();
+    info.seldepth = seldepth();
+    info.time = time();
+    info.nodes = nodes();
+    info.multipv = multipv();
+    info.score = score();
+    info.currmove = currmove();
+    info.currmovenumber = currmovenumber();
+    info.hashfull = hashfull();
+    info.nps = nps();
+    info.tbhits = tbhits();
+    info.sbhits = sbhits();
+    info.cpuload = cpuload();
+    auto unpack_list = [](std::span<const PackedMove> moves) -> std::vector<UCIMove> {
+        std::vector<UCIMove> result;
+        result.reserve(moves.size());
+        std::ranges::transform(moves, std::back_inserter(result), unpack_move);
+        return result;
+    };
+    info.pv = unpack_list(pv());
+    info.refutation = unpack_list(refutation());
+    if (has(InfoField::Currline)) {
+        info.currline = line_info{.cpunr = cpunr(), .line = unpack_list(currline())};
+    }
+    return info;
+}
+
+auto CompactSearchInfo::score() const -> std::optional<score_info> {
+    if (!has(InfoField::Score)) {
+        return std::nullopt;
+    }
+    return score_info{
+        .cp = get(InfoField::ScoreCp, m_score_cp),
+        .mate = get(InfoField::ScoreMate, m_score_mate),
+        .lowerbound = has(InfoField::Lowerbound),
+        .upperbound = has(InfoField::Upperbound),
+    };
+}
+
+auto CompactSearchInfo::currmove() const -> std::optional<UCIMove> {
+    if (!has(InfoField::Currmove)) {
+        return std::nullopt;
+    }
+    return unpack_move(m_currmove);
+}
+
+auto CompactSearchInfo::add_move(MoveList list, PackedMove move) -> void {
+    if (move_count() >= max_moves) {
+        m_fields |= bit(InfoField::Truncated);
+        return;
+    }
+    // the lists are stored one after another, later lists move up by one
+    std::size_t position{m_pv_length};
+    std::uint8_t *length{&m_pv_length};
+    if (list == MoveList::Refutation) {
+        position += m_refutation_length;
+        length = &m_refutation_length;
+    } else if (list == MoveList::Currline) {
+        position += std::size_t{m_refutation_length} + m_currline_length;
+        length = &m_currline_length;
+    }
+    const auto insert_it = m_moves.begin() + static_cast<std::ptrdiff_t>(position);
+    std::copy_backward(insert_it, m_moves.begin() + static_cast<std::ptrdiff_t>(move_count()), m_moves.begin() + static_cast<std::ptrdiff_t>(move_count() + 1));
+    *insert_it = move;
+    ++*length;
+}
+
+} // namespace chessuci
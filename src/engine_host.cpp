@@ -0,0 +1,402 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_host.h"
+#include "chessuci/socket_unix.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::chrono::milliseconds engine_exit_timeout{100};
+constexpr int reap_interval_ms{10};
+// limits of the buffered data per client and engine, a peer that does not keep up is throttled
+constexpr std::size_t max_buffered_bytes{std::size_t{1} << 20};
+// limit of a line that is not complete yet, a longer line drops its client or engine
+constexpr std::size_t max_line_length{std::size_t{1} << 20};
+
+auto set_non_blocking(int fd) -> bool {
+    const int flags = fcntl(fd, F_GETFL, 0);
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+auto write_some(int fd, std::string_view data) -> long {
+    std::size_t total{0};
+    while (total < data.size()) {
+        const auto written = write(fd, data.data() + total, data.size() - total);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+        total += static_cast<std::size_t>(written);
+    }
+    return static_cast<long>(total);
+}
+
+auto exit_code_payload(const std::optional<int> &exit_code) -> std::string {
+    return exit_code.has_value() ? std::to_string(exit_code.value()) : std::string{};
+}
+
+} // namespace
+
+EngineHost::EngineHost(RemoteEndpoint endpoint) : m_endpoint{std::move(endpoint)} {}
+
+EngineHost::~EngineHost() {
+    for (auto &client : m_clients) {
+        close_client(*client);
+    }
+    for (auto &engine : m_exiting_engines) {
+        engine.process->kill();
+    }
+    if (m_listen_socket != -1) {
+        close(m_listen_socket);
+        if (m_bound_endpoint.kind == RemoteEndpoint::Kind::Local) {
+            unlink(m_bound_endpoint.path.c_str());
+        }
+    }
+    for (auto &fd : m_wake_pipe) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+}
+
+auto EngineHost::allow_executable(const std::filesystem::path &executable) -> void {
+    m_allowed_executables.insert(executable.lexically_normal());
+}
+
+auto EngineHost::listen() -> bool {
+    if (m_allowed_executables.empty()) {
+        set_error("No executable allowed");
+        return false;
+    }
+    if (pipe(m_wake_pipe) == -1) {
+        set_error(std::string{"Failed to create pipe: "} + strerror(errno));
+        return false;
+    }
+    set_non_blocking(m_wake_pipe[0]);
+    set_non_blocking(m_wake_pipe[1]);
+
+    std::string error;
+    m_listen_socket = socket_listen(m_endpoint, m_bound_endpoint, error);
+    if (m_listen_socket == -1) {
+        set_error(error);
+        return false;
+    }
+    set_non_blocking(m_listen_socket);
+    return true;
+}
+
+auto EngineHost::run() -> void {
+    // session 0 is never used by clients and marks the client socket itself
+    struct Watch {
+        Client *client;
+        std::uint32_t session;
+        bool input; ///< The engine's input, only watched to wake up when it can be written.
+    };
+    std::vector<pollfd> fds;
+    std::vector<Watch> watches;
+
+    while (!m_stop_requested) {
+        fds.clear();
+        watches.clear();
+        fds.push_back(pollfd{.fd = m_wake_pipe[0], .events = POLLIN, .revents = 0});
+        fds.push_back(pollfd{.fd = m_listen_socket, .events = POLLIN, .revents = 0});
+        for (auto &client : m_clients) {
+            // engine output is not read while the client is behind, client input not while an engine is
+            const bool client_full = client->output.size() >= max_buffered_bytes;
+            bool engine_full{false};
+            for (const auto &[session, engine] : client->engines) {
+                if (!client_full) {
+                    fds.push_back(pollfd{.fd = engine.process->output_fd(), .events = POLLIN, .revents = 0});
+                    watches.push_back(Watch{.client = client.get(), .session = session, .input = false});
+                }
+                if (!engine.input.empty()) {
+                    fds.push_back(pollfd{.fd = engine.process->input_fd(), .events = POLLOUT, .revents = 0});
+                    watches.push_back(Watch{.client = client.get(), .session = session, .input = true});
+                    engine_full = engine_full || engine.input.size() >= max_buffered_bytes;
+                }
+            }
+            auto events = static_cast<short>(engine_full ? 0 : POLLIN);
+            if (!client->output.empty()) {
+                events = static_cast<short>(events | POLLOUT);
+            }
+            fds.push_back(pollfd{.fd = client->fd, .events = events, .revents = 0});
+            watches.push_back(Watch{.client = client.get(), .session = 0, .input = false});
+        }
+
+        // exited engines are reaped by polling, the loop never waits for a process
+        const int timeout = m_exiting_engines.empty() ? -1 : reap_interval_ms;
+        if (poll(fds.data(), fds.size(), timeout) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            set_error(std::string{"Poll failed: "} + strerror(errno));
+            break;
+        }
+
+        if (fds[0].revents != 0) {
+            char buffer[64];
+            while (read(m_wake_pipe[0], buffer, sizeof(buffer)) > 0) {
+            }
+        }
+        if ((fds[1].revents & POLLIN) != 0) {
+            accept_client();
+        }
+
+        for (std::size_t index = 2; index < fds.size(); ++index) {
+            const auto &watch = watches[index - 2];
+            if (fds[index].revents == 0 || watch.client->fd == -1 || watch.input) {
+                continue;
+            }
+            if (watch.session == 0) {
+                if ((fds[index].revents & (POLLIN | POLLHUP | POLLERR)) != 0 && !read_client(*watch.client)) {
+                    close_client(*watch.client);
+                }
+                continue;
+            }
+            const auto engine_it = watch.client->engines.find(watch.session);
+            if (engine_it != watch.client->engines.end() && !read_engine(*watch.client, watch.session, engine_it->second)) {
+                finish_engine(*watch.client, watch.session, false);
+            }
+        }
+        reap_engines();
+
+        for (auto &client : m_clients) {
+            for (auto &[session, engine] : client->engines) {
+                if (engine.input.empty()) {
+                    continue;
+                }
+                // an engine that closed its input is finished when its output closes
+                const auto written = write_some(engine.process->input_fd(), engine.input);
+                if (written < 0) {
+                    engine.input.clear();
+                } else {
+                    engine.input.erase(0, static_cast<std::size_t>(written));
+                }
+            }
+            if (client->fd == -1 || client->output.empty()) {
+                continue;
+            }
+            const auto written = socket_send_some(client->fd, client->output);
+            if (written < 0) {
+                close_client(*client);
+            } else {
+                client->output.erase(0, static_cast<std::size_t>(written));
+            }
+        }
+        std::erase_if(m_clients, [](const auto &client) -> bool { return client->fd == -1; });
+    }
+}
+
+auto EngineHost::stop() -> void {
+    m_stop_requested = true;
+    if (m_wake_pipe[1] != -1) {
+        [[maybe_unused]] const auto result = write(m_wake_pipe[1], "x", 1);
+    }
+}
+
+auto EngineHost::accept_client() -> void {
+    while (true) {
+        const int fd = accept(m_listen_socket, nullptr, nullptr);
+        if (fd == -1) {
+            return;
+        }
+        socket_configure(fd);
+        set_non_blocking(fd);
+        auto client = std::make_unique<Client>();
+        client->fd = fd;
+        m_clients.push_back(std::move(client));
+    }
+}
+
+auto EngineHost::read_client(Client &client) -> bool {
+    char buffer[4096];
+    while (true) {
+        const auto bytes_read = recv(client.fd, buffer, sizeof(buffer), 0);
+        if (bytes_read > 0) {
+            client.input.append(buffer, static_cast<std::size_t>(bytes_read));
+            continue;
+        }
+        if (bytes_read == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+
+    std::size_t line_start{0};
+    std::size_t newline_pos{0};
+    while ((newline_pos = client.input.find('\n', line_start)) != std::string::npos) {
+        const auto frame = decode_frame(std::string_view{client.input}.substr(line_start, newline_pos - line_start));
+        if (frame.has_value()) {
+            handle_frame(client, frame.value());
+        }
+        line_start = newline_pos + 1;
+    }
+    client.input.erase(0, line_start);
+    return client.input.size() <= max_line_length;
+}
+
+auto EngineHost::handle_frame(Client &client, const RemoteFrame &frame) -> void {
+    if (frame.verb == RemoteFrame::Verb::Open) {
+        open_engine(client, frame.session, frame.payload);
+        return;
+    }
+
+    const auto engine_it = client.engines.find(frame.session);
+    if (engine_it == client.engines.end()) {
+        return;
+    }
+    if (frame.verb == RemoteFrame::Verb::Line) {
+        // written by run() when the engine can take it, the loop never blocks on an engine
+        auto &input = engine_it->second.input;
+        input.append(frame.payload);
+        input.push_back('\n');
+    } else if (frame.verb == RemoteFrame::Verb::Kill) {
+        finish_engine(client, frame.session, true);
+    }
+}
+
+auto EngineHost::open_engine(Client &client, std::uint32_t session, const std::string &payload) -> void {
+    auto fail = [&](const std::string &message, const std::optional<int> &exit_code) -> void {
+        encode_frame(RemoteFrame{.session = session, .verb = RemoteFrame::Verb::Error, .payload = message}, client.output);
+        encode_frame(RemoteFrame{.session = session, .verb = RemoteFrame::Verb::Exited, .payload = exit_code_payload(exit_code)}, client.output);
+    };
+
+    if (session == 0 || client.engines.contains(session)) {
+        fail("Invalid session " + std::to_string(session), std::nullopt);
+        return;
+    }
+    const auto params = decode_process_params(payload);
+    if (!params.has_value()) {
+        fail("Invalid process parameters", std::nullopt);
+        return;
+    }
+    if (!is_allowed(params->executable)) {
+        fail("Executable not allowed: " + params->executable.string(), std::nullopt);
+        return;
+    }
+
+    // an engine that exits right away is reported when its output closes
+    auto engine = std::make_unique<EngineProcessUnix>();
+    engine->set_startup_check(false);
+    if (!engine->start(params.value())) {
+        fail(engine->last_error(), engine->wait_for_exit(0));
+        return;
+    }
+    if (!set_non_blocking(engine->input_fd())) {
+        engine->kill();
+        fail(std::string{"Failed to set stdin pipe non-blocking: "} + strerror(errno), std::nullopt);
+        return;
+    }
+    encode_frame(RemoteFrame{.session = session, .verb = RemoteFrame::Verb::Opened, .payload = std::to_string(engine->pid())}, client.output);
+    client.engines[session] = Engine{.process = std::move(engine), .input = {}, .output = {}};
+    ++m_session_count;
+}
+
+auto EngineHost::read_engine(Client &client, std::uint32_t session, Engine &engine) -> bool {
+    // reads only what is available, a partial line must not stall the other sessions
+    char buffer[4096];
+    bool open{true};
+    while (true) {
+        const auto bytes_read = read(engine.process->output_fd(), buffer, sizeof(buffer));
+        if (bytes_read > 0) {
+            engine.output.append(buffer, static_cast<std::size_t>(bytes_read));
+            continue;
+        }
+        if (bytes_read == -1 && errno == EINTR) {
+            continue;
+        }
+        open = bytes_read == -1 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        break;
+    }
+
+    std::size_t line_start{0};
+    std::size_t newline_pos{0};
+    while ((newline_pos = engine.output.find('\n', line_start)) != std::string::npos) {
+        auto line = std::string_view{engine.output}.substr(line_start, newline_pos - line_start);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        encode_frame(RemoteFrame{.session = session, .verb = RemoteFrame::Verb::Line, .payload = std::string{line}}, client.output);
+        line_start = newline_pos + 1;
+    }
+    engine.output.erase(0, line_start);
+    return open && engine.output.size() <= max_line_length;
+}
+
+auto EngineHost::finish_engine(Client &client, std::uint32_t session, bool kill) -> void {
+    const auto engine_it = client.engines.find(session);
+    if (engine_it == client.engines.end()) {
+        return;
+    }
+    auto process = std::move(engine_it->second.process);
+    client.engines.erase(engine_it);
+    const auto now = std::chrono::steady_clock::now();
+    if (kill) {
+        ::kill(process->pid(), SIGKILL);
+    }
+    m_exiting_engines.push_back(ExitingEngine{.client = &client, .session = session, .process = std::move(process), .kill_time = kill ? now : now + engine_exit_timeout});
+}
+
+auto EngineHost::reap_engines() -> void {
+    const auto now = std::chrono::steady_clock::now();
+    std::erase_if(m_exiting_engines, [this, now](ExitingEngine &engine) -> bool {
+        if (engine.process->is_running()) {
+            // an engine that closed its output but does not exit is killed, and reaped on a later pass
+            if (now >= engine.kill_time) {
+                ::kill(engine.process->pid(), SIGKILL);
+                engine.kill_time = std::chrono::steady_clock::time_point::max();
+            }
+            return false;
+        }
+        if (engine.client != nullptr) {
+            encode_frame(RemoteFrame{.session = engine.session, .verb = RemoteFrame::Verb::Exited, .payload = exit_code_payload(engine.process->wait_for_exit(0))},
+                         engine.client->output);
+        }
+        --m_session_count;
+        return true;
+    });
+}
+
+auto EngineHost::close_client(Client &client) -> void {
+    std::vector<std::uint32_t> sessions;
+    for (const auto &[session, engine] : client.engines) {
+        sessions.push_back(session);
+    }
+    for (const auto session : sessions) {
+        finish_engine(client, session, true);
+    }
+    for (auto &engine : m_exiting_engines) {
+        if (engine.client == &client) {
+            engine.client = nullptr;
+        }
+    }
+    if (client.fd != -1) {
+        close(client.fd);
+        client.fd = -1;
+    }
+}
+
+auto EngineHost::is_allowed(const std::filesystem::path &executable) const -> bool {
+    return m_allowed_executables.contains(executable.lexically_normal());
+}
+
+} // namespace chessuci
@@ -0,0 +1,274 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_info_cache.h"
+#include "chessuci/string_conversion.h"
+
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::string_view cache_header{"CUCIENG 1"};
+constexpr std::size_t hash_buffer_size{64 * 1024};
+constexpr std::uint64_t hash_multiplier{0x9e3779b97f4a7c15ULL};
+constexpr unsigned hash_shift{32};
+constexpr int hex_base{16};
+
+auto mix(std::uint64_t hash, std::uint64_t word) -> std::uint64_t {
+    hash = (hash ^ word) * hash_multiplier;
+    return hash ^ (hash >> hash_shift);
+}
+
+// hashes 8 bytes at a time, the executables can be tens of megabytes
+auto hash_bytes(std::uint64_t hash, const char *data, std::size_t size) -> std::uint64_t {
+    std::size_t index = 0;
+    for (; index + sizeof(std::uint64_t) <= size; index += sizeof(std::uint64_t)) {
+        std::uint64_t word{0};
+        std::memcpy(&word, data + index, sizeof(word));
+        hash = mix(hash, word);
+    }
+    if (index < size) {
+        std::uint64_t word{0};
+        std::memcpy(&word, data + index, size - index);
+        hash = mix(hash, word);
+    }
+    return hash;
+}
+
+auto to_hex(std::uint64_t value) -> std::string {
+    std::array<char, 2 * sizeof(value)> buffer{};
+    const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, hex_base);
+    return std::string(buffer.data(), result.ptr);
+}
+
+auto from_hex(const std::string &text) -> std::optional<std::uint64_t> {
+    std::uint64_t value{0};
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), value, hex_base);
+    if (result.ec != std::errc{} || result.ptr != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return value;
+}
+
+auto split_fields(const std::string &line) -> std::vector<std::string> {
+    std::vector<std::string> fields;
+    std::size_t start = 0;
+    std::size_t tab = 0;
+    while ((tab = line.find('\t', start)) != std::string::npos) {
+        fields.push_back(line.substr(start, tab - start));
+        start = tab + 1;
+    }
+    fields.push_back(line.substr(start));
+    return fields;
+}
+
+auto optional_int_field(const std::optional<int> &value) -> std::string {
+    return value.has_value() ? std::to_string(value.value()) : std::string{};
+}
+
+auto write_option(std::ostream &stream, const Option &option) -> void {
+    stream << "option\t" << option.name << '\t' << option.type_to_string() << '\t';
+    // an empty default value is different from no default value
+    if (option.default_value.has_value()) {
+        stream << '=' << option.default_value.value();
+    }
+    stream << '\t' << optional_int_field(option.min) << '\t' << optional_int_field(option.max);
+    for (const auto &value : option.combo_values) {
+        stream << '\t' << value;
+    }
+    stream << '\n';
+}
+
+auto read_option(const std::vector<std::string> &fields) -> std::optional<Option> {
+    constexpr std::size_t min_fields{6};
+    if (fields.size() < min_fields) {
+        return std::nullopt;
+    }
+    const auto type = Option::try_type_from_string(fields[2]);
+    if (!type.has_value()) {
+        return std::nullopt;
+    }
+    Option option{.name = fields[1], .type = type.value(), .default_value = std::nullopt, .min = std::nullopt, .max = std::nullopt, .combo_values = {}};
+    if (!fields[3].empty()) {
+        option.default_value = fields[3].substr(1);
+    }
+    if (!fields[4].empty()) {
+        option.min = str_to_inttype<int>(fields[4]);
+    }
+    if (!fields[5].empty()) {
+        option.max = str_to_inttype<int>(fields[5]);
+    }
+    option.combo_values.assign(fields.begin() + min_fields, fields.end());
+    return option;
+}
+
+// the fingerprint without the content hash, which is expensive to compute
+auto file_fingerprint(const std::filesystem::path &executable) -> std::optional<ExecutableFingerprint> {
+    std::error_code error;
+    ExecutableFingerprint result{};
+    result.executable = std::filesystem::absolute(executable, error).lexically_normal();
+    result.size = std::filesystem::file_size(executable, error);
+    if (error) {
+        return std::nullopt;
+    }
+    result.mtime = static_cast<std::int64_t>(std::filesystem::last_write_time(executable, error).time_since_epoch().count());
+    if (error) {
+        return std::nullopt;
+    }
+    return result;
+}
+
+auto content_hash(const std::filesystem::path &executable, std::uintmax_t size) -> std::optional<std::uint64_t> {
+    std::ifstream stream{executable, std::ios::binary};
+    if (!stream) {
+        return std::nullopt;
+    }
+    std::vector<char> buffer(hash_buffer_size);
+    std::uint64_t hash{mix(0, size)};
+    while (stream) {
+        stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        hash = hash_bytes(hash, buffer.data(), static_cast<std::size_t>(stream.gcount()));
+    }
+    return hash;
+}
+
+} // namespace
+
+EngineInfoCache::EngineInfoCache(std::filesystem::path directory) : m_directory{std::move(directory)} {}
+
+auto EngineInfoCache::fingerprint(const std::filesystem::path &executable) -> std::optional<ExecutableFingerprint> {
+    auto result = file_fingerprint(executable);
+    if (!result.has_value()) {
+        return std::nullopt;
+    }
+    const auto hash = content_hash(executable, result->size);
+    if (!hash.has_value()) {
+        return std::nullopt;
+    }
+    result->content_hash = hash.value();
+    return result;
+}
+
+auto EngineInfoCache::lookup(const std::filesystem::path &executable) const -> std::optional<handshake_info> {
+    ExecutableFingerprint cached{};
+    auto info = read_entry(executable, cached);
+    if (!info.has_value()) {
+        return std::nullopt;
+    }
+    // size and modification time are checked first, the file is only hashed if they match
+    const auto current = file_fingerprint(executable);
+    if (!current.has_value() || current->executable != cached.executable || current->size != cached.size || current->mtime != cached.mtime) {
+        return std::nullopt;
+    }
+    if (content_hash(executable, current->size) != cached.content_hash) {
+        return std::nullopt;
+    }
+    return info;
+}
+
+auto EngineInfoCache::lookup(const ExecutableFingerprint &fingerprint) const -> std::optional<handshake_info> {
+    ExecutableFingerprint cached{};
+    auto info = read_entry(fingerprint.executable, cached);
+    if (!info.has_value() || cached != fingerprint) {
+        return std::nullopt;
+    }
+    return info;
+}
+
+auto EngineInfoCache::store(const std::filesystem::path &executable, const handshake_info &info) const -> bool {
+    const auto current = fingerprint(executable);
+    return current.has_value() && store(current.value(), info);
+}
+
+auto EngineInfoCache::store(const ExecutableFingerprint &fingerprint, const handshake_info &info) const -> bool {
+    std::error_code error;
+    std::filesystem::create_directories(m_directory, error);
+    if (error) {
+        return false;
+    }
+
+    const auto path = entry_path(fingerprint.executable);
+    auto temporary = path;
+    temporary += "." + to_hex(std::random_device{}()) + ".tmp";
+    {
+        std::ofstream stream{temporary, std::ios::trunc};
+        stream << cache_header << '\n';
+        stream << "path\t" << fingerprint.executable.string() << '\n';
+        stream << "size\t" << fingerprint.size << '\n';
+        stream << "mtime\t" << fingerprint.mtime << '\n';
+        stream << "hash\t" << to_hex(fingerprint.content_hash) << '\n';
+        stream << "name\t" << info.id.name << '\n';
+        stream << "author\t" << info.id.author << '\n';
+        for (const auto &option : info.options) {
+            write_option(stream, option);
+        }
+        if (!stream.flush()) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+auto EngineInfoCache::remove(const std::filesystem::path &executable) const -> void {
+    std::error_code error;
+    std::filesystem::remove(entry_path(executable), error);
+}
+
+auto EngineInfoCache::read_entry(const std::filesystem::path &executable, ExecutableFingerprint &cached) const -> std::optional<handshake_info> {
+    std::ifstream stream{entry_path(executable)};
+    std::string line;
+    if (!std::getline(stream, line) || line != cache_header) {
+        return std::nullopt;
+    }
+
+    handshake_info info{};
+    while (std::getline(stream, line)) {
+        const auto fields = split_fields(line);
+        if (fields.size() < 2) {
+            return std::nullopt;
+        }
+        const auto &key = fields[0];
+        if (key == "path") {
+            cached.executable = line.substr(key.size() + 1);
+        } else if (key == "size") {
+            cached.size = str_to_inttype<std::uintmax_t>(fields[1]).value_or(0);
+        } else if (key == "mtime") {
+            cached.mtime = str_to_inttype<std::int64_t>(fields[1]).value_or(0);
+        } else if (key == "hash") {
+            cached.content_hash = from_hex(fields[1]).value_or(0);
+        } else if (key == "name") {
+            info.id.name = fields[1];
+        } else if (key == "author") {
+            info.id.author = fields[1];
+        } else if (key == "option") {
+            auto option = read_option(fields);
+            if (!option.has_value()) {
+                return std::nullopt;
+            }
+            info.options.push_back(std::move(option.value()));
+        }
+    }
+    return info;
+}
+
+auto EngineInfoCache::entry_path(const std::filesystem::path &executable) const -> std::filesystem::path {
+    std::error_code error;
+    const auto name = std::filesystem::absolute(executable, error).lexically_normal().string();
+    return m_directory / (to_hex(hash_bytes(0, name.data(), name.size())) + ".engine");
+}
+
+} // namespace chessuci
@@ -1,6 +1,70 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#include "chessuci/engine_process.h"
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_process.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#ifndef CHESSUCI_WINDOWS
+#include <poll.h>
+#endif
+
+namespace chessuci {
+
+namespace {
+
+// polling interval for processes without exit descriptor
+constexpr std::chrono::milliseconds poll_interval{10};
+
+auto wait_for_any_exit(const std::vector<EngineProcess *> &processes, std::chrono::milliseconds timeout) -> void {
+#ifndef CHESSUCI_WINDOWS
+    std::vector<pollfd> descriptors;
+    descriptors.reserve(processes.size());
+    for (const auto *process : processes) {
+        const auto descriptor = process->exit_descriptor();
+        if (descriptor >= 0) {
+            descriptors.push_back(pollfd{.fd = descriptor, .events = POLLIN, .revents = 0});
+        }
+    }
+    if (descriptors.size() < processes.size()) {
+        timeout = std::min(timeout, poll_interval);
+    }
+    poll(descriptors.data(), descriptors.size(), static_cast<int>(timeout.count()));
+#else
+    std::this_thread::sleep_for(std::min(timeout, poll_interval));
+    static_cast<void>(processes);
+#endif
+}
+
+} // namespace
+
+auto EngineProcess::terminate_all(std::span<EngineProcess *const> processes, int timeout_ms) -> std::size_t {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{timeout_ms};
+    std::vector<EngineProcess *> running;
+    for (auto *process : processes) {
+        if (process && process->is_running()) {
+            process->write_line("quit");
+            running.push_back(process);
+        }
+    }
+
+    while (true) {
+        std::erase_if(running, [](const EngineProcess *process) -> bool { return !process->is_running(); });
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (running.empty() || remaining.count() <= 0) {
+            break;
+        }
+        wait_for_any_exit(running, remaining);
+    }
+
+    for (auto *process : running) {
+        process->kill();
+    }
+    return running.size();
+}
+
+} // namespace chessuci
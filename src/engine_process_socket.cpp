@@ -0,0 +1,328 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_process_socket.h"
+#include "chessuci/socket_unix.h"
+#include "chessuci/string_conversion.h"
+
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace chessuci {
+
+RemoteConnection::RemoteConnection(RemoteEndpoint endpoint) : m_endpoint{std::move(endpoint)} {}
+
+RemoteConnection::~RemoteConnection() {
+    disconnect();
+}
+
+auto RemoteConnection::connect() -> bool {
+    std::lock_guard<std::mutex> lock{m_connection_mutex};
+    if (m_connected) {
+        return true;
+    }
+    // the reader thread of a lost connection has exited or is about to, its socket is still open
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    close_socket();
+    std::string error;
+    const int fd = socket_connect(m_endpoint, error);
+    if (fd == -1) {
+        set_error(error);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> write_lock{m_write_mutex};
+        m_socket = fd;
+    }
+    m_connected = true;
+    m_thread = std::thread([this] -> void { read_loop(); });
+    return true;
+}
+
+auto RemoteConnection::disconnect() -> void {
+    std::lock_guard<std::mutex> lock{m_connection_mutex};
+    if (m_socket != -1) {
+        shutdown(m_socket, SHUT_RDWR);
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    close_socket();
+}
+
+auto RemoteConnection::close_socket() -> void {
+    std::lock_guard<std::mutex> lock{m_write_mutex};
+    if (m_socket != -1) {
+        close(m_socket);
+        m_socket = -1;
+    }
+}
+
+auto RemoteConnection::create_process() -> std::unique_ptr<EngineProcess> {
+    return std::make_unique<EngineProcessSocket>(shared_from_this());
+}
+
+auto RemoteConnection::open_session() -> std::shared_ptr<Session> {
+    auto session = std::make_shared<Session>();
+    session->id = m_next_session++;
+    std::lock_guard<std::mutex> lock{m_sessions_mutex};
+    m_sessions[session->id] = session;
+    return session;
+}
+
+auto RemoteConnection::close_session(std::uint32_t id) -> void {
+    std::lock_guard<std::mutex> lock{m_sessions_mutex};
+    m_sessions.erase(id);
+}
+
+auto RemoteConnection::send_frame(const RemoteFrame &frame) -> bool {
+    std::string buffer;
+    encode_frame(frame, buffer);
+    std::lock_guard<std::mutex> lock{m_write_mutex};
+    if (!m_connected || m_socket == -1 || !socket_send_all(m_socket, buffer)) {
+        set_error("Connection to engine host lost");
+        return false;
+    }
+    return true;
+}
+
+auto RemoteConnection::dispatch_frame(RemoteFrame &frame) -> void {
+    std::shared_ptr<Session> session;
+    {
+        std::lock_guard<std::mutex> lock{m_sessions_mutex};
+        const auto it = m_sessions.find(frame.session);
+        if (it == m_sessions.end()) {
+            return;
+        }
+        session = it->second;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{session->mutex};
+        switch (frame.verb) {
+        case RemoteFrame::Verb::Opened:
+            session->pid = str_to_inttype<EngineProcess::proc_id_t>(frame.payload).value_or(-1);
+            session->state = Session::State::Running;
+            break;
+        case RemoteFrame::Verb::Line:
+            session->lines.push_back(std::move(frame.payload));
+            break;
+        case RemoteFrame::Verb::Exited:
+            session->exit_code = str_to_inttype<int>(frame.payload);
+            session->state = Session::State::Exited;
+            break;
+        case RemoteFrame::Verb::Error:
+            session->error = std::move(frame.payload);
+            if (session->state == Session::State::Opening) {
+                session->state = Session::State::Failed;
+            }
+            break;
+        default:
+            return;
+        }
+    }
+    session->changed.notify_all();
+}
+
+auto RemoteConnection::read_loop() -> void {
+    std::string buffer;
+    char chunk[4096];
+    while (true) {
+        const auto bytes_read = recv(m_socket, chunk, sizeof(chunk), 0);
+        if (bytes_read > 0) {
+            buffer.append(chunk, static_cast<std::size_t>(bytes_read));
+            std::size_t line_start{0};
+            std::size_t newline_pos{0};
+            while ((newline_pos = buffer.find('\n', line_start)) != std::string::npos) {
+                auto frame = decode_frame(std::string_view{buffer}.substr(line_start, newline_pos - line_start));
+                if (frame.has_value()) {
+                    dispatch_frame(frame.value());
+                }
+                line_start = newline_pos + 1;
+            }
+            buffer.erase(0, line_start);
+        } else if (bytes_read == -1 && errno == EINTR) {
+            continue;
+        } else {
+            break;
+        }
+    }
+
+    m_connected = false;
+    std::lock_guard<std::mutex> lock{m_sessions_mutex};
+    for (auto &[id, session] : m_sessions) {
+        {
+            std::lock_guard<std::mutex> session_lock{session->mutex};
+            if (session->state == Session::State::Opening) {
+                session->state = Session::State::Failed;
+            } else if (session->state == Session::State::Running) {
+                session->state = Session::State::Exited;
+            }
+            session->error = "Connection to engine host lost";
+        }
+        session->changed.notify_all();
+    }
+}
+
+EngineProcessSocket::EngineProcessSocket(RemoteEndpoint endpoint) : m_connection{std::make_shared<RemoteConnection>(std::move(endpoint))} {}
+
+EngineProcessSocket::EngineProcessSocket(std::shared_ptr<RemoteConnection> connection) : m_connection{std::move(connection)} {}
+
+EngineProcessSocket::~EngineProcessSocket() {
+    if (is_running()) {
+        terminate(1000);
+        if (is_running()) {
+            kill();
+        }
+    }
+    release_session();
+}
+
+auto EngineProcessSocket::start(const ProcessParams &params) -> bool {
+    if (is_running()) {
+        set_error("Process already running");
+        return false;
+    }
+    if (!m_connection->connect()) {
+        set_error(m_connection->last_error());
+        return false;
+    }
+
+    release_session();
+    m_session = m_connection->open_session();
+    m_session->state = RemoteConnection::Session::State::Opening;
+    if (!m_connection->send_frame(RemoteFrame{.session = m_session->id, .verb = RemoteFrame::Verb::Open, .payload = encode_process_params(params)})) {
+        set_error(m_connection->last_error());
+        return false;
+    }
+
+    std::unique_lock<std::mutex> lock{m_session->mutex};
+    const auto opened = m_session->changed.wait_for(lock, std::chrono::milliseconds{open_timeout_ms}, [this] -> bool {
+        return m_session->state != RemoteConnection::Session::State::Opening;
+    });
+    if (!opened) {
+        set_error("Engine host did not respond");
+        return false;
+    }
+    if (m_session->pid == -1) {
+        set_error(m_session->error);
+        return false;
+    }
+    return true;
+}
+
+auto EngineProcessSocket::is_running() const -> bool {
+    if (!m_session) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock{m_session->mutex};
+    return m_session->state == RemoteConnection::Session::State::Running;
+}
+
+auto EngineProcessSocket::pid() const -> proc_id_t {
+    if (!m_session) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock{m_session->mutex};
+    return m_session->pid;
+}
+
+auto EngineProcessSocket::terminate(int timeout_ms) -> bool {
+    if (!is_running()) {
+        return true;
+    }
+
+    write_line("quit");
+    return wait_for_state(timeout_ms);
+}
+
+auto EngineProcessSocket::kill() -> void {
+    if (!is_running()) {
+        return;
+    }
+
+    if (m_connection->send_frame(RemoteFrame{.session = m_session->id, .verb = RemoteFrame::Verb::Kill, .payload = {}})) {
+        wait_for_state(kill_timeout_ms);
+    }
+}
+
+auto EngineProcessSocket::wait_for_exit(int timeout_ms) -> std::optional<int> {
+    if (!m_session) {
+        return std::nullopt;
+    }
+    if (!wait_for_state(timeout_ms)) {
+        return std::nullopt;
+    }
+    std::lock_guard<std::mutex> lock{m_session->mutex};
+    return m_session->exit_code;
+}
+
+auto EngineProcessSocket::write_line(const std::string &line) -> bool {
+    if (!is_running()) {
+        set_error("Process not running");
+        return false;
+    }
+    if (!m_connection->send_frame(RemoteFrame{.session = m_session->id, .verb = RemoteFrame::Verb::Line, .payload = line})) {
+        set_error(m_connection->last_error());
+        return false;
+    }
+    return true;
+}
+
+auto EngineProcessSocket::read_line(std::string &line) -> bool {
+    if (!m_session) {
+        set_error("Process not running");
+        return false;
+    }
+    std::unique_lock<std::mutex> lock{m_session->mutex};
+    m_session->changed.wait(lock, [this] -> bool {
+        return !m_session->lines.empty() ||
+               (m_session->state != RemoteConnection::Session::State::Running && m_session->state != RemoteConnection::Session::State::Opening);
+    });
+    if (m_session->lines.empty()) {
+        set_error("Process closed stdout");
+        return false;
+    }
+    line = std::move(m_session->lines.front());
+    m_session->lines.pop_front();
+    return true;
+}
+
+auto EngineProcessSocket::can_read() const -> bool {
+    if (!m_session) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock{m_session->mutex};
+    return !m_session->lines.empty();
+}
+
+auto EngineProcessSocket::last_error() const -> const std::string & {
+    return m_last_error;
+}
+
+auto EngineProcessSocket::wait_for_state(int timeout_ms) -> bool {
+    auto has_exited = [this] -> bool {
+        return m_session->state == RemoteConnection::Session::State::Exited || m_session->state == RemoteConnection::Session::State::Failed;
+    };
+
+    std::unique_lock<std::mutex> lock{m_session->mutex};
+    if (timeout_ms < 0) {
+        m_session->changed.wait(lock, has_exited);
+        return true;
+    }
+    return m_session->changed.wait_for(lock, std::chrono::milliseconds{timeout_ms}, has_exited);
+}
+
+auto EngineProcessSocket::release_session() -> void {
+    if (m_session) {
+        m_connection->close_session(m_session->id);
+        m_session.reset();
+    }
+}
+
+} // namespace chessuci
@@ -0,0 +1,149 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_process_transcript.h"
+
+namespace chessuci {
+
+RecordingEngineProcess::RecordingEngineProcess(std::unique_ptr<EngineProcess> process, const std::filesystem::path &transcript)
+    : m_process{std::move(process)}, m_transcript{transcript} {}
+
+RecordingEngineProcess::~RecordingEngineProcess() {
+    m_transcript.flush();
+}
+
+auto RecordingEngineProcess::terminate(int timeout_ms) -> bool {
+    // the decorated process sends the quit command itself
+    if (m_process->is_running()) {
+        m_transcript.append(TranscriptDirection::ToEngine, "quit");
+    }
+    const auto result = m_process->terminate(timeout_ms);
+    m_transcript.flush();
+    return result;
+}
+
+auto RecordingEngineProcess::kill() -> void {
+    m_process->kill();
+    m_transcript.flush();
+}
+
+auto RecordingEngineProcess::write_line(const std::string &line) -> bool {
+    m_transcript.append(TranscriptDirection::ToEngine, line);
+    return m_process->write_line(line);
+}
+
+auto RecordingEngineProcess::read_line(std::string &line) -> bool {
+    if (!m_process->read_line(line)) {
+        return false;
+    }
+    m_transcript.append(TranscriptDirection::FromEngine, line);
+    return true;
+}
+
+ReplayEngineProcess::ReplayEngineProcess(std::vector<TranscriptEntry> transcript, Timing timing) : m_transcript{std::move(transcript)}, m_timing{timing} {}
+
+auto ReplayEngineProcess::start(const ProcessParams &) -> bool {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (m_running) {
+        m_last_error = "Process already running";
+        return false;
+    }
+    m_position = 0;
+    m_pending.clear();
+    m_mismatches = 0;
+    m_running = true;
+    release_output(clock::now(), std::chrono::nanoseconds{0});
+    return true;
+}
+
+auto ReplayEngineProcess::terminate(int) -> bool {
+    stop_replay();
+    return true;
+}
+
+auto ReplayEngineProcess::kill() -> void {
+    stop_replay();
+}
+
+auto ReplayEngineProcess::wait_for_exit(int) -> std::optional<int> {
+    if (m_running) {
+        return std::nullopt;
+    }
+    return 0;
+}
+
+auto ReplayEngineProcess::write_line(const std::string &line) -> bool {
+    const auto now = clock::now();
+    std::lock_guard<std::mutex> lock{m_mutex};
+    if (!m_running) {
+        m_last_error = "Process not running";
+        return false;
+    }
+    if (m_position >= m_transcript.size() || m_transcript[m_position].direction != TranscriptDirection::ToEngine) {
+        ++m_mismatches;
+        return true;
+    }
+    const auto &expected = m_transcript[m_position++];
+    if (expected.line != line) {
+        ++m_mismatches;
+    }
+    release_output(now, expected.timestamp);
+    return true;
+}
+
+auto ReplayEngineProcess::read_line(std::string &line) -> bool {
+    std::unique_lock<std::mutex> lock{m_mutex};
+    while (true) {
+        m_changed.wait(lock, [this] -> bool { return !m_pending.empty() || !m_running || m_position >= m_transcript.size(); });
+        if (m_pending.empty()) {
+            m_last_error = "Transcript finished";
+            return false;
+        }
+        const auto ready_at = m_pending.front().ready_at;
+        if (m_changed.wait_until(lock, ready_at, [this] -> bool { return !m_running; })) {
+            m_last_error = "Process not running";
+            return false;
+        }
+        if (!m_pending.empty() && m_pending.front().ready_at <= clock::now()) {
+            line = std::move(m_pending.front().line);
+            m_pending.pop_front();
+            return true;
+        }
+    }
+}
+
+auto ReplayEngineProcess::last_error() const -> const std::string & {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_last_error;
+}
+
+auto ReplayEngineProcess::can_read() const -> bool {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return !m_pending.empty() && m_pending.front().ready_at <= clock::now();
+}
+
+auto ReplayEngineProcess::finished() const -> bool {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_position >= m_transcript.size() && m_pending.empty();
+}
+
+auto ReplayEngineProcess::release_output(clock::time_point now, std::chrono::nanoseconds trigger) -> void {
+    while (m_position < m_transcript.size() && m_transcript[m_position].direction == TranscriptDirection::FromEngine) {
+        auto &entry = m_transcript[m_position++];
+        const auto ready_at = m_timing == Timing::Original ? now + std::chrono::duration_cast<clock::duration>(entry.timestamp - trigger) : now;
+        m_pending.push_back(PendingLine{.ready_at = ready_at, .line = entry.line});
+    }
+    m_changed.notify_all();
+}
+
+auto ReplayEngineProcess::stop_replay() -> void {
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_running = false;
+    }
+    m_changed.notify_all();
+}
+
+} // namespace chessuci
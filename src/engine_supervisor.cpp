@@ -0,0 +1,109 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_supervisor.h"
+#include "chessuci/process_factory.h"
+
+#include <thread>
+
+namespace chessuci {
+
+EngineSupervisor::EngineSupervisor(ProcessParams params, std::vector<setoption_command> options, RestartPolicy policy)
+    : m_params{std::move(params)}, m_options{std::move(options)}, m_policy{policy}, m_process_creator{&ProcessFactory::create_local} {}
+
+EngineSupervisor::~EngineSupervisor() {
+    stop();
+}
+
+auto EngineSupervisor::start() -> bool {
+    return launch();
+}
+
+auto EngineSupervisor::search(const position_command &position, const go_command &go) -> bestmove_info {
+    for (int replay = 0;; ++replay) {
+        if (crashed()) {
+            restart();
+        }
+        try {
+            if (!m_handler->send_position(position)) {
+                throw UCIError{"Failed to send position"};
+            }
+            auto bestmove = m_handler->async_go(go).get();
+            m_consecutive_crashes = 0;
+            return bestmove;
+        } catch (const UCIError &error) {
+            if (!crashed()) {
+                throw;
+            }
+            m_last_error = error.what();
+            if (replay >= m_policy.max_replays) {
+                throw UCIError{"Search failed after " + std::to_string(replay) + " replays: " + m_last_error};
+            }
+            ++m_replays;
+        }
+    }
+}
+
+auto EngineSupervisor::stop() -> void {
+    m_handler.reset();
+}
+
+auto EngineSupervisor::launch() -> bool {
+    m_handler.reset();
+    m_handler = std::make_unique<UCIGuiHandler>(m_process_creator());
+    m_handler->on_info([this](const search_info &info) -> void {
+        if (m_info_callback) {
+            m_info_callback(info);
+        }
+    });
+    try {
+        m_handshake = m_handler->initialize(m_params, m_options).get().handshake;
+    } catch (const std::exception &error) {
+        m_last_error = error.what();
+        return false;
+    }
+    return true;
+}
+
+auto EngineSupervisor::restart() -> void {
+    while (true) {
+        if (m_given_up) {
+            throw UCIError{"Engine was given up: " + m_last_error};
+        }
+        const auto now = clock::now();
+        m_crashes.push_back(now);
+        while (now - m_crashes.front() > m_policy.crash_window) {
+            m_crashes.pop_front();
+        }
+        if (m_crashes.size() > static_cast<std::size_t>(m_policy.max_crashes)) {
+            m_given_up = true;
+            m_handler.reset();
+            m_last_error = "Engine crashed " + std::to_string(m_crashes.size()) + " times within " + std::to_string(m_policy.crash_window.count()) + " ms";
+            throw UCIError{m_last_error};
+        }
+
+        auto backoff = m_policy.initial_backoff;
+        for (int crash = 0; crash < m_consecutive_crashes && backoff < m_policy.max_backoff; ++crash) {
+            backoff *= 2;
+        }
+        backoff = std::min(backoff, m_policy.max_backoff);
+        ++m_consecutive_crashes;
+        std::this_thread::sleep_for(backoff);
+
+        if (launch()) {
+            ++m_restarts;
+            if (m_restart_callback) {
+                m_restart_callback(m_restarts);
+            }
+            return;
+        }
+    }
+}
+
+auto EngineSupervisor::crashed() const -> bool {
+    return !m_handler || !m_handler->is_running() || !m_handler->process().is_running();
+}
+
+} // namespace chessuci
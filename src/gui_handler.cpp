@@ -1,353 +1,921 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#include "chessuci/gui_handler.h"
-#include "chessuci/string_conversion.h"
-
-namespace chessuci {
-
-UCIGuiHandler::UCIGuiHandler() : m_process{ProcessFactory::create_local()} {
-    setup_uci_commands();
-}
-
-UCIGuiHandler::UCIGuiHandler(std::unique_ptr<EngineProcess> process) : m_process{std::move(process)} {
-    setup_uci_commands();
-}
-
-UCIGuiHandler::~UCIGuiHandler() {
-    stop();
-}
-
-auto UCIGuiHandler::start(const ProcessParams &params) -> bool {
-    if (m_running.exchange(true)) {
-        return false;
-    }
-    auto result = m_process->start(params);
-    if (result) {
-        m_thread = std::thread([this] { read_loop(); });
-    } else {
-        m_running = false;
-    }
-    return result;
-}
-
-auto UCIGuiHandler::stop() -> void {
-    m_running = false;
-    m_process->terminate(engine_terminate_timeout);
-    if (m_process->is_running()) {
-        m_process->kill();
-    }
-    if (m_thread.joinable()) {
-        m_thread.join();
-    }
-}
-
-auto UCIGuiHandler::send_uci() -> bool {
-    return send_raw("uci");
-}
-
-auto UCIGuiHandler::send_debug(bool on) -> bool {
-    return send_raw(on ? "debug on" : "debug off");
-}
-
-auto UCIGuiHandler::send_setoption(const setoption_command &command) -> bool {
-    if (command.value.has_value()) {
-        return send_raw(std::string{"setoption name "} + command.name + std::string{" value "} + command.value.value());
-    } else {
-        return send_raw(std::string{"setoption name "} + command.name);
-    }
-}
-
-auto UCIGuiHandler::send_isready() -> bool {
-    return send_raw("isready");
-}
-
-auto UCIGuiHandler::send_ucinewgame() -> bool {
-    return send_raw("ucinewgame");
-}
-
-auto UCIGuiHandler::send_position(const position_command &command) -> bool {
-    return send_raw(to_string(command));
-}
-
-auto UCIGuiHandler::send_go(const go_command &command) -> bool {
-    return send_raw(to_string(command));
-}
-
-auto UCIGuiHandler::send_stop() -> bool {
-    return send_raw("stop");
-}
-
-auto UCIGuiHandler::send_ponderhist() -> bool {
-    return send_raw("ponderhist");
-}
-
-auto UCIGuiHandler::send_quit() -> bool {
-    return send_raw("quit");
-}
-
-auto UCIGuiHandler::send_raw(const std::string &message) -> bool {
-    std::lock_guard<std::mutex> lock{m_output_mutex};
-    return m_process->write_line(message);
-}
-
-auto UCIGuiHandler::read_loop() -> void {
-    std::string line;
-    while (m_running && m_process->read_line(line)) {
-        strip_trailing_whitespace(line);
-        if (line.empty()) {
-            continue;
-        }
-        process_line(line);
-    }
-    m_running = false;
-}
-
-auto UCIGuiHandler::setup_uci_commands() -> void {
-    m_uci_commands["id"] = [this](const auto &args) -> void { handle_id_message(args); };
-    m_uci_commands["uciok"] = [this](const auto &) -> void { call(m_uciok_callback); };
-    m_uci_commands["readyok"] = [this](const auto &) -> void { call(m_readyok_callback); };
-    m_uci_commands["bestmove"] = [this](const auto &args) -> void { call(m_bestmove_callback, parse_bestmove_command(args)); };
-    m_uci_commands["info"] = [this](const auto &args) -> void { call(m_info_callback, parse_info_command(args)); };
-    m_uci_commands["option"] = [this](const auto &args) -> void { call(m_option_callback, parse_option_command(args)); };
-}
-
-auto UCIGuiHandler::handle_id_message(const TokenList &tokens) const -> void {
-    if (tokens.size() > 2) {
-        if (tokens[1] == "name") {
-            call(m_id_name_callback, tokens[2]);
-            return;
-        } else if (tokens[1] == "author") {
-            call(m_id_author_callback, tokens[2]);
-            return;
-        }
-    }
-    throw UCIError("Invalid id command: expected name or author");
-}
-
-auto UCIGuiHandler::parse_bestmove_command(const TokenList &tokens) -> bestmove_info {
-    bestmove_info info{};
-    if (tokens.size() > 1) {
-        const auto move = parse_uci_move(tokens[1]);
-        if (move.has_value()) {
-            info.bestmove = move.value();
-        } else {
-            throw UCIError("Invalid bestmove command: invalid best move " + tokens[1]);
-        }
-    }
-    if (tokens.size() > 3) {
-        if (tokens[2] != "ponder") {
-            throw UCIError("Invalid bestmove command: expected ponder");
-        }
-        const auto move = parse_uci_move(tokens[3]);
-        if (move.has_value()) {
-            info.pondermove = move.value();
-        } else {
-            throw UCIError("Invalid bestmove command: invalid ponder move " + tokens[3]);
-        }
-    }
-    return info;
-}
-
-auto UCIGuiHandler::parse_info_command(const TokenList &tokens) -> search_info {
-    search_info info{};
-    std::vector<UCIMove> *target_vector{nullptr};
-    for (size_t index = 1; index < tokens.size(); ++index) {
-        auto parse_move_param = [&](std::optional<UCIMove> &target) -> void {
-            if (index + 1 < tokens.size()) {
-                const auto move = parse_uci_move(tokens[++index]);
-                if (move.has_value()) {
-                    target = move.value();
-                }
-                throw UCIError{"Invalid move parameter"};
-            }
-            throw UCIError{"Missing move parameter"};
-        };
-
-        const auto &token = tokens[index];
-        if (token == "depth") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.depth);
-        } else if (token == "seldepth") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.seldepth);
-        } else if (token == "time") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.time);
-        } else if (token == "nodes") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.nodes);
-        } else if (token == "multipv") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.multipv);
-        } else if (token == "score") {
-            target_vector = nullptr;
-            info.score = parse_score(tokens, index);
-        } else if (token == "currmove") {
-            target_vector = nullptr;
-            parse_move_param(info.currmove);
-        } else if (token == "currmovenumber") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.currmovenumber);
-        } else if (token == "hashfull") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.hashfull);
-        } else if (token == "nps") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.nps);
-        } else if (token == "tbhits") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.tbhits);
-        } else if (token == "sbhits") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.sbhits);
-        } else if (token == "cpuload") {
-            target_vector = nullptr;
-            parse_int_param(tokens, index, info.cpuload);
-        } else if (token == "currline") {
-            info.currline = line_info{};
-            parse_int_param(tokens, index, info.currline->cpunr);
-            ++index;
-            target_vector = &info.currline->line;
-        } else if (token == "pv") {
-            target_vector = &info.pv;
-        } else if (token == "refutation") {
-            target_vector = &info.refutation;
-        } else if (token == "string") {
-            target_vector = nullptr;
-            info.string = collect_string(tokens, index + 1);
-        } else {
-            if (target_vector == nullptr) {
-                continue;
-            }
-            const auto move = parse_uci_move(token);
-            if (move.has_value()) {
-                target_vector->push_back(move.value());
-            } else {
-                throw UCIError{"Invalid info command: move expected, but found " + token};
-            }
-        }
-    }
-    return info;
-}
-
-auto UCIGuiHandler::parse_score(const TokenList &tokens, size_t index) -> score_info {
-    score_info info{};
-    if (index + 1 < tokens.size()) {
-        if (tokens[index + 1] == "cp") {
-            parse_int_param(tokens, index + 1, info.cp);
-        } else if (tokens[index + 1] == "mate") {
-            parse_int_param(tokens, index + 1, info.mate);
-        }
-
-        if (index + 3 < tokens.size()) {
-            if (tokens[index + 3] == "lowerbound") {
-                info.lowerbound = true;
-            } else if (tokens[index + 3] == "upperbound") {
-                info.upperbound = true;
-            }
-        }
-    }
-    return info;
-}
-
-namespace {
-
-enum class OptionItem { name, type, default_value, min_value, max_value, var_value, unknown };
-
-auto process_option_item(OptionItem &item_type, std::string &value, Option &option) -> void {
-    if (value.empty() || item_type == OptionItem::unknown) {
-        return;
-    }
-
-    switch (item_type) {
-    case OptionItem::name:
-        option.name = value;
-        break;
-    case OptionItem::type:
-        option.type = Option::type_from_string(value);
-        break;
-    case OptionItem::default_value:
-        option.default_value = value;
-        break;
-    case OptionItem::min_value:
-        option.min = std::stoi(value);
-        break;
-    case OptionItem::max_value:
-        option.max = std::stoi(value);
-        break;
-    case OptionItem::var_value:
-        option.combo_values.push_back(value);
-        break;
-    default:
-        break;
-    }
-
-    item_type = OptionItem::unknown;
-    value.clear();
-}
-
-} // namespace
-
-auto UCIGuiHandler::parse_option_command(const TokenList &tokens) -> Option {
-    Option option{};
-    OptionItem current_item{OptionItem::unknown};
-    std::string collected_tokens{};
-    for (size_t index = 1; index < tokens.size(); ++index) {
-        const auto &token = tokens[index];
-        if (token == "name") {
-            process_option_item(current_item, collected_tokens, option);
-            current_item = OptionItem::name;
-        } else if (token == "type") {
-            process_option_item(current_item, collected_tokens, option);
-            current_item = OptionItem::type;
-        } else if (token == "default") {
-            process_option_item(current_item, collected_tokens, option);
-            current_item = OptionItem::default_value;
-        } else if (token == "min") {
-            process_option_item(current_item, collected_tokens, option);
-            current_item = OptionItem::min_value;
-        } else if (token == "max") {
-            process_option_item(current_item, collected_tokens, option);
-            current_item = OptionItem::max_value;
-        } else if (token == "var") {
-            process_option_item(current_item, collected_tokens, option);
-            current_item = OptionItem::var_value;
-        } else {
-            if (collected_tokens.empty()) {
-                collected_tokens = token;
-            } else {
-                collected_tokens += " " + token;
-            }
-        }
-    }
-    process_option_item(current_item, collected_tokens, option);
-    return option;
-}
-
-template<typename T>
-auto UCIGuiHandler::parse_int_param(const TokenList &tokens, size_t index, std::optional<T> &target) -> void {
-    if (index + 1 < tokens.size()) {
-        target = str_to_inttype<T>(tokens[++index]);
-        if (!target.has_value()) {
-            throw UCIError{"Invalid integer parameter"};
-        }
-    } else {
-        throw UCIError{"Missing integer parameter"};
-    }
-}
-
-auto UCIGuiHandler::collect_string(const TokenList &tokens, size_t index) -> std::string {
-    std::ostringstream oss{};
-    if (index < tokens.size()) {
-        oss << tokens[index];
-    }
-    for (size_t i = index + 1; i < tokens.size(); ++i) {
-        oss << " " << tokens[i];
-    }
-    return oss.str();
-}
-
-} // namespace chessuci
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include "chessuci/string_conversion.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace chessuci {
+
+namespace {
+
+// option names are not case sensitive
+auto find_option(const std::vector<Option> &options, const std::string &name) -> const Option * {
+    const auto option_it = std::ranges::find_if(options, [&name](const Option &option) -> bool {
+        return std::ranges::equal(option.name, name, [](unsigned char lhs, unsigned char rhs) -> bool { return std::tolower(lhs) == std::tolower(rhs); });
+    });
+    return option_it != options.end() ? &*option_it : nullptr;
+}
+
+} // namespace
+
+UCIGuiHandler::UCIGuiHandler() : m_process{ProcessFactory::create_local()} {
+    setup_uci_commands();
+}
+
+UCIGuiHandler::UCIGuiHandler(std::unique_ptr<EngineProcess> process) : m_process{std::move(process)} {
+    setup_uci_commands();
+}
+
+UCIGuiHandler::~UCIGuiHandler() {
+    stop();
+}
+
+auto UCIGuiHandler::start(const ProcessParams &params) -> bool {
+    if (m_running.exchange(true)) {
+        return false;
+    }
+    auto result = m_process->start(params);
+    if (result) {
+        // the engine's timeline in a trace
+        m_trace_track = static_cast<std::uint64_t>(m_process->pid());
+        m_thread = std::thread([this] { read_loop(); });
+    } else {
+        m_running = false;
+    }
+    return result;
+}
+
+auto UCIGuiHandler::initialize(const ProcessParams &params, const std::vector<setoption_command> &options) -> std::future<initialize_info> {
+    return initialize_engine(params, options, std::nullopt, nullptr);
+}
+
+auto UCIGuiHandler::initialize(const ProcessParams &params, const std::vector<setoption_command> &options, EngineInfoCache &cache) -> std::future<initialize_info> {
+    // hashed once here, so the reader thread only writes the entry
+    auto fingerprint = EngineInfoCache::fingerprint(params.executable);
+    auto cached = fingerprint.has_value() ? cache.lookup(fingerprint.value()) : std::nullopt;
+    auto update_cache = [&cache, fingerprint, cached](const handshake_info &handshake) -> void {
+        if (fingerprint.has_value() && (!cached.has_value() || cached.value() != handshake)) {
+            cache.store(fingerprint.value(), handshake);
+        }
+    };
+    return initialize_engine(params, options, std::move(cached), std::move(update_cache));
+}
+
+auto UCIGuiHandler::initialize_engine(const ProcessParams &params, const std::vector<setoption_command> &options, std::optional<handshake_info> cached,
+                                      std::function<void(const handshake_info &)> on_handshake) -> std::future<initialize_info> {
+    auto promise = std::make_shared<std::promise<initialize_info>>();
+    auto future = promise->get_future();
+    if (!is_running() && !start(params)) {
+        promise->set_exception(std::make_exception_ptr(UCIError{"Failed to start engine: " + m_process->last_error()}));
+        return future;
+    }
+
+    auto result = std::make_shared<initialize_info>();
+    auto accepts = [](const handshake_info &advertised, const setoption_command &option) -> bool {
+        const auto *known = find_option(advertised.options, option.name);
+        return known != nullptr && known->accepts(option.value);
+    };
+    auto select_options = [result, options, accepts](const handshake_info &advertised) -> std::vector<setoption_command> {
+        std::vector<setoption_command> accepted;
+        for (const auto &option : options) {
+            if (accepts(advertised, option)) {
+                accepted.push_back(option);
+            } else {
+                result->rejected_options.push_back(option);
+            }
+        }
+        return accepted;
+    };
+    auto send_options = [this, promise, result](const std::vector<setoption_command> &accepted) -> void {
+        for (const auto &option : accepted) {
+            send_setoption(option);
+        }
+        submit_request<void>(m_readyok_requests, "isready", [promise, result](ResponseResult<void> ready) -> void {
+            if (ready.has_value()) {
+                promise->set_value(std::move(*result));
+            } else {
+                promise->set_exception(ready.error());
+            }
+        });
+    };
+
+    if (cached.has_value()) {
+        // setoption must not be sent before the engine's options are known; the cache knows them, and an
+        // engine reads its input in order, so it answers "uci" completely before it reads the first setoption
+        const auto accepted = select_options(cached.value());
+        auto check_handshake = [result, options, accepts, advertised = cached.value(), on_handshake](ResponseResult<handshake_info> handshake) -> void {
+            if (!handshake.has_value()) {
+                return;
+            }
+            if (on_handshake) {
+                on_handshake(handshake.value());
+            }
+            if (handshake.value() != advertised) {
+                // the options were checked against a stale list, only the ones both lists accept are in effect
+                result->cache_outdated = true;
+                result->rejected_options.clear();
+                for (const auto &option : options) {
+                    if (!accepts(advertised, option) || !accepts(handshake.value(), option)) {
+                        result->rejected_options.push_back(option);
+                    }
+                }
+            }
+            result->handshake = std::move(handshake.value());
+        };
+        submit_request<handshake_info>(m_handshake_requests, "uci", std::move(check_handshake));
+        send_options(accepted);
+        return future;
+    }
+
+    // runs on the reader thread when "uciok" is received
+    submit_request<handshake_info>(m_handshake_requests, "uci", [promise, result, on_handshake, select_options, send_options](ResponseResult<handshake_info> handshake) -> void {
+        if (!handshake.has_value()) {
+            promise->set_exception(handshake.error());
+            return;
+        }
+        if (on_handshake) {
+            on_handshake(handshake.value());
+        }
+        result->handshake = std::move(handshake.value());
+        send_options(select_options(result->handshake));
+    });
+    return future;
+}
+
+auto UCIGuiHandler::stop() -> void {
+    cancel_searches();
+    m_running = false;
+    m_process->terminate(engine_terminate_timeout);
+    if (m_process->is_running()) {
+        m_process->kill();
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+auto UCIGuiHandler::set_info_coalescing(std::chrono::milliseconds interval) -> void {
+    if (interval.count() > 0) {
+        m_info_coalescer = std::make_unique<InfoCoalescer>(interval);
+    } else {
+        m_info_coalescer.reset();
+    }
+}
+
+auto UCIGuiHandler::stop_all(std::span<UCIGuiHandler *const> handlers) -> void {
+    std::vector<EngineProcess *> processes;
+    processes.reserve(handlers.size());
+    for (auto *handler : handlers) {
+        handler->cancel_searches();
+        handler->m_running = false;
+        processes.push_back(handler->m_process.get());
+    }
+    EngineProcess::terminate_all(processes, engine_terminate_timeout);
+    for (auto *handler : handlers) {
+        if (handler->m_thread.joinable()) {
+            handler->m_thread.join();
+        }
+    }
+}
+
+auto UCIGuiHandler::set_watchdog(Watchdog &watchdog, std::string name) -> void {
+    m_watchdog = &watchdog;
+    m_watchdog_name = std::move(name);
+}
+
+auto UCIGuiHandler::info_coalescing_statistics() const -> InfoCoalescer::Statistics {
+    return m_info_coalescer ? m_info_coalescer->statistics() : InfoCoalescer::Statistics{};
+}
+
+auto UCIGuiHandler::send_uci() -> bool {
+    return send_raw("uci");
+}
+
+auto UCIGuiHandler::send_debug(bool on) -> bool {
+    return send_raw(on ? "debug on" : "debug off");
+}
+
+auto UCIGuiHandler::send_setoption(const setoption_command &command) -> bool {
+    if (command.value.has_value()) {
+        return send_raw(std::string{"setoption name "} + command.name + std::string{" value "} + command.value.value());
+    } else {
+        return send_raw(std::string{"setoption name "} + command.name);
+    }
+}
+
+auto UCIGuiHandler::send_isready() -> bool {
+    return send_raw("isready");
+}
+
+auto UCIGuiHandler::send_ucinewgame() -> bool {
+    return send_raw("ucinewgame");
+}
+
+auto UCIGuiHandler::send_position(const position_command &command) -> bool {
+    return send_raw(to_string(command));
+}
+
+auto UCIGuiHandler::send_go(const go_command &command) -> bool {
+    watch_search(command);
+    const auto sent = send_raw(to_string(command));
+    if (!sent) {
+        finish_search(false);
+    }
+    return sent;
+}
+
+auto UCIGuiHandler::send_stop() -> bool {
+    if (m_watchdog) {
+        // stop ends the running search, queued searches start afterwards
+        std::lock_guard<std::mutex> lock{m_watches_mutex};
+        if (!m_watches.empty() && m_watches.front().id.has_value()) {
+            m_watchdog->stopped(m_watches.front().id.value());
+        }
+    }
+    return send_raw("stop");
+}
+
+auto UCIGuiHandler::send_ponderhist() -> bool {
+    return send_raw("ponderhist");
+}
+
+auto UCIGuiHandler::send_quit() -> bool {
+    return send_raw("quit");
+}
+
+auto UCIGuiHandler::send_raw(const std::string &message) -> bool {
+    std::lock_guard<std::mutex> lock{m_output_mutex};
+    return write_raw(message);
+}
+
+auto UCIGuiHandler::try_send_raw(const std::string &message) -> bool {
+    std::unique_lock<std::mutex> lock{m_output_mutex, std::try_to_lock};
+    return lock.owns_lock() && write_raw(message);
+}
+
+auto UCIGuiHandler::write_raw(const std::string &message) -> bool {
+    // stamped before writing, so the response cannot arrive first
+    record_sent(message, clock::now());
+    Metrics::count_sent(message);
+    Trace::record(m_trace_track, "sent", TracePhase::Instant, message);
+    return m_process->write_line(message);
+}
+
+auto UCIGuiHandler::read_loop() -> void {
+    std::string line;
+    while (m_running && m_process->read_line(line)) {
+        strip_trailing_whitespace(line);
+        if (line.empty()) {
+            continue;
+        }
+        process_line(line);
+    }
+    m_running = false;
+    fail_requests();
+}
+
+auto UCIGuiHandler::async_isready() -> std::future<void> {
+    std::future<void> future;
+    submit_request(m_readyok_requests, "isready", make_future_handler(future));
+    return future;
+}
+
+auto UCIGuiHandler::async_go(const go_command &command) -> std::future<bestmove_info> {
+    std::future<bestmove_info> future;
+    watch_search(command);
+    if (!submit_request(m_bestmove_requests, to_string(command), make_future_handler(future))) {
+        finish_search(false);
+    }
+    return future;
+}
+
+auto UCIGuiHandler::async_handshake() -> std::future<handshake_info> {
+    std::future<handshake_info> future;
+    submit_request(m_handshake_requests, "uci", make_future_handler(future));
+    return future;
+}
+
+auto UCIGuiHandler::co_isready() -> ResponseAwaitable<void> {
+    ResponseAwaitable<void> awaitable;
+    submit_request(m_readyok_requests, "isready", awaitable.handler());
+    return awaitable;
+}
+
+auto UCIGuiHandler::co_go(const go_command &command) -> ResponseAwaitable<bestmove_info> {
+    ResponseAwaitable<bestmove_info> awaitable;
+    watch_search(command);
+    if (!submit_request(m_bestmove_requests, to_string(command), awaitable.handler())) {
+        finish_search(false);
+    }
+    return awaitable;
+}
+
+auto UCIGuiHandler::co_handshake() -> ResponseAwaitable<handshake_info> {
+    ResponseAwaitable<handshake_info> awaitable;
+    submit_request(m_handshake_requests, "uci", awaitable.handler());
+    return awaitable;
+}
+
+template<typename T>
+auto UCIGuiHandler::submit_request(std::deque<ResponseHandler<T>> &queue, const std::string &message, ResponseHandler<T> handler) -> bool {
+    // the output lock keeps the queue in the order of the sent commands; the
+    // request is queued before it is sent, so the response cannot overtake it
+    std::unique_lock<std::mutex> output_lock{m_output_mutex};
+    {
+        std::lock_guard<std::mutex> lock{m_requests_mutex};
+        queue.push_back(std::move(handler));
+    }
+    if (write_raw(message)) {
+        return true;
+    }
+    {
+        // no request can be queued meanwhile, so the request is the last one,
+        // unless the queue was already completed or failed up to it
+        std::lock_guard<std::mutex> lock{m_requests_mutex};
+        if (queue.empty()) {
+            return false;
+        }
+        handler = std::move(queue.back());
+        queue.pop_back();
+    }
+    output_lock.unlock();
+    handler(std::unexpected{std::make_exception_ptr(UCIError{"Failed to send command: " + message})});
+    return false;
+}
+
+template<typename T>
+auto UCIGuiHandler::complete_request(std::deque<ResponseHandler<T>> &queue, ResponseResult<T> result) -> void {
+    ResponseHandler<T> handler;
+    {
+        std::lock_guard<std::mutex> lock{m_requests_mutex};
+        if (queue.empty()) {
+            return;
+        }
+        handler = std::move(queue.front());
+        queue.pop_front();
+    }
+    handler(std::move(result));
+}
+
+auto UCIGuiHandler::fail_requests() -> void {
+    std::deque<ResponseHandler<void>> readyok_requests;
+    std::deque<ResponseHandler<bestmove_info>> bestmove_requests;
+    std::deque<ResponseHandler<handshake_info>> handshake_requests;
+    {
+        std::lock_guard<std::mutex> lock{m_requests_mutex};
+        readyok_requests.swap(m_readyok_requests);
+        bestmove_requests.swap(m_bestmove_requests);
+        handshake_requests.swap(m_handshake_requests);
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_latency_mutex};
+        m_isready_sent.clear();
+        m_searches_sent.clear();
+        m_awaiting_info = false;
+    }
+    // the searches ended, but no bestmove will arrive
+    {
+        std::lock_guard<std::mutex> lock{m_watches_mutex};
+        if (!m_watches.empty() && m_watches.front().id.has_value()) {
+            m_watchdog->complete(m_watches.front().id.value());
+        }
+        m_watches.clear();
+    }
+    const auto error = std::make_exception_ptr(UCIError{"Engine terminated"});
+    for (auto &handler : readyok_requests) {
+        handler(std::unexpected{error});
+    }
+    for (auto &handler : bestmove_requests) {
+        handler(std::unexpected{error});
+    }
+    for (auto &handler : handshake_requests) {
+        handler(std::unexpected{error});
+    }
+}
+
+auto UCIGuiHandler::setup_uci_commands() -> void {
+    m_uci_commands["id"] = [this](const auto &args) -> void { handle_id_message(args); };
+    m_uci_commands["uciok"] = [this](const auto &) -> void {
+        call(m_uciok_callback);
+        complete_request(m_handshake_requests, ResponseResult<handshake_info>{std::exchange(m_handshake, {})});
+    };
+    m_uci_commands["readyok"] = [this](const auto &) -> void {
+        record_readyok(clock::now());
+        call(m_readyok_callback);
+        complete_request(m_readyok_requests, ResponseResult<void>{});
+    };
+    m_uci_commands["bestmove"] = [this](const auto &args) -> void {
+        const auto info = try_parse_bestmove_command(args);
+        if (info.has_value()) {
+            handle_bestmove(info.value());
+        } else {
+            report_parse_error(info.error(), args);
+        }
+    };
+    m_uci_commands["info"] = [this](const auto &args) -> void {
+        auto pooled_info = m_pooled_info_callback ? m_info_pool.acquire() : PooledInfo{};
+        auto &info = pooled_info ? *pooled_info : m_info;
+        const auto result = try_parse_info_command(args, info, m_spare_currline);
+        if (!result.has_value()) {
+            report_parse_error(result.error(), args);
+            return;
+        }
+        handle_info(info);
+        if (pooled_info) {
+            m_pooled_info_callback(std::move(pooled_info));
+        }
+    };
+    m_uci_commands["option"] = [this](const auto &args) -> void {
+        const auto option = try_parse_option_command(args);
+        if (option.has_value()) {
+            m_handshake.options.push_back(option.value());
+            call(m_option_callback, option.value());
+        } else {
+            report_parse_error(option.error(), args);
+        }
+    };
+}
+
+auto UCIGuiHandler::handle_info(const search_info &info) -> void {
+    const auto first_info = m_awaiting_info.exchange(false);
+    if (first_info) {
+        const auto now = clock::now();
+        std::lock_guard<std::mutex> lock{m_latency_mutex};
+        if (!m_searches_sent.empty() && !m_searches_sent.front().info_received) {
+            m_searches_sent.front().info_received = true;
+            m_latencies.first_info.record(std::chrono::duration_cast<LatencyHistogram::duration>(now - m_searches_sent.front().go));
+        }
+    }
+    if (m_live_analysis != nullptr) {
+        if (first_info) {
+            m_live_analysis->clear();
+        }
+        m_live_analysis->update(info);
+    }
+    if (m_info_coalescer) {
+        m_info_coalescer->add(info, InfoCoalescer::clock::now(), m_info_callback);
+    } else {
+        call(m_info_callback, info);
+    }
+}
+
+auto UCIGuiHandler::handle_bestmove(const bestmove_info &info) -> void {
+    record_bestmove(clock::now());
+    // the final infos of a search always precede its bestmove
+    if (m_info_coalescer) {
+        m_info_coalescer->flush(m_info_callback);
+    }
+    finish_search(true);
+    call(m_bestmove_callback, info);
+    complete_request(m_bestmove_requests, ResponseResult<bestmove_info>{info});
+}
+
+auto UCIGuiHandler::record_sent(const std::string &message, clock::time_point now) -> void {
+    if (message == "isready") {
+        std::lock_guard<std::mutex> lock{m_latency_mutex};
+        m_isready_sent.push_back(now);
+    } else if (message == "stop") {
+        // stops the search that is running, which is the oldest one
+        std::lock_guard<std::mutex> lock{m_latency_mutex};
+        if (!m_searches_sent.empty() && !m_searches_sent.front().stop.has_value()) {
+            m_searches_sent.front().stop = now;
+        }
+    } else if (message == "go" || message.starts_with("go ")) {
+        std::lock_guard<std::mutex> lock{m_latency_mutex};
+        m_searches_sent.push_back(SentSearch{.go = now, .stop = std::nullopt, .info_received = false});
+        if (m_searches_sent.size() == 1) {
+            m_awaiting_info = true;
+        }
+    }
+}
+
+auto UCIGuiHandler::record_readyok(clock::time_point now) -> void {
+    std::lock_guard<std::mutex> lock{m_latency_mutex};
+    if (!m_isready_sent.empty()) {
+        m_latencies.isready.record(std::chrono::duration_cast<LatencyHistogram::duration>(now - m_isready_sent.front()));
+        m_isready_sent.pop_front();
+    }
+}
+
+auto UCIGuiHandler::record_bestmove(clock::time_point now) -> void {
+    std::lock_guard<std::mutex> lock{m_latency_mutex};
+    if (!m_searches_sent.empty()) {
+        const auto search = m_searches_sent.front();
+        m_searches_sent.pop_front();
+        m_latencies.bestmove.record(std::chrono::duration_cast<LatencyHistogram::duration>(now - search.go));
+        if (search.stop.has_value()) {
+            m_latencies.stop.record(std::chrono::duration_cast<LatencyHistogram::duration>(now - search.stop.value()));
+        }
+    }
+    // the next infos belong to the next pipelined search, if there is one
+    m_awaiting_info = !m_searches_sent.empty();
+}
+
+auto UCIGuiHandler::watch_search(const go_command &command) -> void {
+    if (!m_watchdog) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{m_watches_mutex};
+    m_watches.push_back(WatchedSearch{.duration = m_watchdog->expected_duration(command), .id = std::nullopt});
+    if (m_watches.size() == 1) {
+        start_watch(m_watches.front());
+    }
+}
+
+auto UCIGuiHandler::start_watch(WatchedSearch &search) -> void {
+    // the watchdog thread must not wait for the engine, nor for a writer that waits for it
+    Watchdog::Actions actions{
+        .stop = [this] -> void { try_send_raw("stop"); },
+        .terminate = [this] -> void { m_process->terminate(0); },
+        .kill = [this] -> void { m_process->kill(); },
+    };
+    search.id = m_watchdog->watch(m_watchdog_name, search.duration, std::move(actions));
+}
+
+auto UCIGuiHandler::finish_search(bool completed) -> void {
+    std::lock_guard<std::mutex> lock{m_watches_mutex};
+    if (m_watches.empty()) {
+        return;
+    }
+    if (completed) {
+        // the engine starts the next pipelined search now
+        m_watchdog->complete(m_watches.front().id.value());
+        m_watches.pop_front();
+        if (!m_watches.empty()) {
+            start_watch(m_watches.front());
+        }
+    } else {
+        if (m_watches.back().id.has_value()) {
+            m_watchdog->cancel(m_watches.back().id.value());
+        }
+        m_watches.pop_back();
+    }
+}
+
+auto UCIGuiHandler::cancel_searches() -> void {
+    std::deque<WatchedSearch> watches;
+    {
+        std::lock_guard<std::mutex> lock{m_watches_mutex};
+        watches.swap(m_watches);
+    }
+    for (const auto &search : watches) {
+        if (search.id.has_value()) {
+            m_watchdog->cancel(search.id.value());
+        }
+    }
+}
+
+auto UCIGuiHandler::handle_id_message(const TokenList &tokens) -> void {
+    if (tokens.size() > 2) {
+        if (tokens[1] == "name") {
+            m_handshake.id.name = collect_string(tokens, 2);
+            if (Trace::enabled()) {
+                Trace::name_track(m_trace_track, m_handshake.id.name);
+            }
+            call(m_id_name_callback, m_handshake.id.name);
+            return;
+        } else if (tokens[1] == "author") {
+            m_handshake.id.author = collect_string(tokens, 2);
+            call(m_id_author_callback, m_handshake.id.author);
+            return;
+        }
+    }
+    if (tokens.size() == 2 && (tokens[1] == "name" || tokens[1] == "author")) {
+        report_parse_error(ParseError{.type = ParseErrorType::MissingValue, .token = tokens[1]}, tokens);
+    } else {
+        report_parse_error(ParseError{.type = ParseErrorType::UnexpectedToken, .token = tokens.size() > 1 ? tokens[1] : tokens[0]}, tokens);
+    }
+}
+
+auto UCIGuiHandler::parse_bestmove_command(const TokenList &tokens) -> bestmove_info {
+    return value_or_throw(try_parse_bestmove_command(tokens), "Invalid bestmove command: ");
+}
+
+auto UCIGuiHandler::try_parse_bestmove_command(const TokenList &tokens) -> ParseResult<bestmove_info> {
+    bestmove_info info{};
+    if (tokens.size() > 1) {
+        const auto move = parse_uci_move(tokens[1]);
+        if (!move.has_value()) {
+            return std::unexpected{ParseError{.type = ParseErrorType::InvalidMove, .token = tokens[1]}};
+        }
+        info.bestmove = move.value();
+    }
+    if (tokens.size() > 3) {
+        if (tokens[2] != "ponder") {
+            return std::unexpected{ParseError{.type = ParseErrorType::UnexpectedToken, .token = tokens[2]}};
+        }
+        const auto move = parse_uci_move(tokens[3]);
+        if (!move.has_value()) {
+            return std::unexpected{ParseError{.type = ParseErrorType::InvalidMove, .token = tokens[3]}};
+        }
+        info.pondermove = move.value();
+    }
+    return info;
+}
+
+namespace {
+
+// Appends the tokens from index on, separated by single spaces.
+auto append_string(const TokenList &tokens, size_t index, std::string &target) -> void {
+    for (size_t i = index; i < tokens.size(); ++i) {
+        if (i > index) {
+            target += ' ';
+        }
+        target += tokens[i];
+    }
+}
+
+// Parses a score starting at index, which points to the "score" token. On
+// return, index points to the last token that belongs to the score.
+auto parse_score_at(const TokenList &tokens, size_t &index) -> ParseResult<score_info> {
+    score_info info{};
+    const auto score_index = index;
+    while (index + 1 < tokens.size()) {
+        const auto &token = tokens[index + 1];
+        if (token == "cp" || token == "mate") {
+            auto value = UCIGuiHandler::try_parse_int_param<int>(tokens, index + 1);
+            if (!value.has_value()) {
+                return std::unexpected{value.error()};
+            }
+            (token == "cp" ? info.cp : info.mate) = value.value();
+            index += 2;
+        } else if (token == "lowerbound") {
+            info.lowerbound = true;
+            ++index;
+        } else if (token == "upperbound") {
+            info.upperbound = true;
+            ++index;
+        } else {
+            break;
+        }
+    }
+    if (index == score_index) {
+        return std::unexpected{ParseError{.type = ParseErrorType::MissingValue, .token = "score"}};
+    }
+    return info;
+}
+
+} // namespace
+
+auto UCIGuiHandler::parse_info_command(const TokenList &tokens) -> search_info {
+    return value_or_throw(try_parse_info_command(tokens), "Invalid info command: ");
+}
+
+auto UCIGuiHandler::try_parse_info_command(const TokenList &tokens) -> ParseResult<search_info> {
+    search_info info{};
+    const auto result = try_parse_info_command(tokens, info);
+    if (!result.has_value()) {
+        return std::unexpected{result.error()};
+    }
+    return info;
+}
+
+auto UCIGuiHandler::try_parse_info_command(const TokenList &tokens, search_info &info) -> ParseResult<void> {
+    std::vector<UCIMove> spare_currline;
+    return try_parse_info_command(tokens, info, spare_currline);
+}
+
+auto UCIGuiHandler::try_parse_info_command(const TokenList &tokens, search_info &info, std::vector<UCIMove> &spare_currline) -> ParseResult<void> {
+    // reset the info, but keep the buffers of the move lists and the string
+    auto pv = std::move(info.pv);
+    auto refutation = std::move(info.refutation);
+    auto string = std::move(info.string);
+    if (info.currline.has_value() && info.currline->line.capacity() > spare_currline.capacity()) {
+        spare_currline = std::move(info.currline->line);
+    }
+    info = search_info{};
+    pv.clear();
+    refutation.clear();
+    string.clear();
+    info.pv = std::move(pv);
+    info.refutation = std::move(refutation);
+    info.string = std::move(string);
+
+    std::vector<UCIMove> *target_vector{nullptr};
+    for (size_t index = 1; index < tokens.size(); ++index) {
+        // parses the integer following the current token and skips it
+        auto parse_int = [&](auto &target) -> ParseResult<void> {
+            using TargetValueType = typename std::remove_reference_t<decltype(target)>::value_type;
+            const auto value = try_parse_int_param<TargetValueType>(tokens, index);
+            if (!value.has_value()) {
+                return std::unexpected{value.error()};
+            }
+            target = value.value();
+            target_vector = nullptr;
+            ++index;
+            return {};
+        };
+
+        const auto &token = tokens[index];
+        ParseResult<void> result{};
+        if (token == "depth") {
+            result = parse_int(info.depth);
+        } else if (token == "seldepth") {
+            result = parse_int(info.seldepth);
+        } else if (token == "time") {
+            result = parse_int(info.time);
+        } else if (token == "nodes") {
+            result = parse_int(info.nodes);
+        } else if (token == "multipv") {
+            result = parse_int(info.multipv);
+        } else if (token == "score") {
+            target_vector = nullptr;
+            auto score = parse_score_at(tokens, index);
+            if (!score.has_value()) {
+                return std::unexpected{score.error()};
+            }
+            info.score = score.value();
+        } else if (token == "currmove") {
+            target_vector = nullptr;
+            if (index + 1 >= tokens.size()) {
+                return std::unexpected{ParseError{.type = ParseErrorType::MissingValue, .token = token}};
+            }
+            const auto move = parse_uci_move(tokens[++index]);
+            if (!move.has_value()) {
+                return std::unexpected{ParseError{.type = ParseErrorType::InvalidMove, .token = tokens[index]}};
+            }
+            info.currmove = move.value();
+        } else if (token == "currmovenumber") {
+            result = parse_int(info.currmovenumber);
+        } else if (token == "hashfull") {
+            result = parse_int(info.hashfull);
+        } else if (token == "nps") {
+            result = parse_int(info.nps);
+        } else if (token == "tbhits") {
+            result = parse_int(info.tbhits);
+        } else if (token == "sbhits") {
+            result = parse_int(info.sbhits);
+        } else if (token == "cpuload") {
+            result = parse_int(info.cpuload);
+        } else if (token == "currline") {
+            if (info.currline.has_value()) {
+                info.currline->line.clear();
+                info.currline->cpunr = std::nullopt;
+            } else {
+                info.currline = line_info{.cpunr = std::nullopt, .line = std::move(spare_currline)};
+                info.currline->line.clear();
+            }
+            if (index + 1 < tokens.size()) {
+                // the cpu number is optional
+                info.currline->cpunr = str_to_inttype<int>(tokens[index + 1]);
+                if (info.currline->cpunr.has_value()) {
+                    ++index;
+                }
+            }
+            target_vector = &info.currline->line;
+        } else if (token == "pv") {
+            target_vector = &info.pv;
+        } else if (token == "refutation") {
+            target_vector = &info.refutation;
+        } else if (token == "string") {
+            // the string extends to the end of the line
+            append_string(tokens, index + 1, info.string);
+            break;
+        } else {
+            if (target_vector == nullptr) {
+                continue;
+            }
+            const auto move = parse_uci_move(token);
+            if (!move.has_value()) {
+                return std::unexpected{ParseError{.type = ParseErrorType::InvalidMove, .token = token}};
+            }
+            target_vector->push_back(move.value());
+        }
+        if (!result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+    }
+    return {};
+}
+
+auto UCIGuiHandler::parse_score(const TokenList &tokens, size_t index) -> score_info {
+    return value_or_throw(try_parse_score(tokens, index), "Invalid score: ");
+}
+
+auto UCIGuiHandler::try_parse_score(const TokenList &tokens, size_t index) -> ParseResult<score_info> {
+    return parse_score_at(tokens, index);
+}
+
+namespace {
+
+enum class OptionItem { name, type, default_value, min_value, max_value, var_value, unknown };
+
+auto process_option_item(OptionItem &item_type, std::string &value, Option &option) -> ParseResult<void> {
+    if (value.empty() || item_type == OptionItem::unknown) {
+        return {};
+    }
+
+    switch (item_type) {
+    case OptionItem::name:
+        option.name = value;
+        break;
+    case OptionItem::type: {
+        const auto type = Option::try_type_from_string(value);
+        if (!type.has_value()) {
+            return std::unexpected{type.error()};
+        }
+        option.type = type.value();
+        break;
+    }
+    case OptionItem::default_value:
+        option.default_value = value;
+        break;
+    case OptionItem::min_value:
+        option.min = str_to_inttype<int>(value);
+        if (!option.min.has_value()) {
+            return std::unexpected{ParseError{.type = ParseErrorType::InvalidInteger, .token = value}};
+        }
+        break;
+    case OptionItem::max_value:
+        option.max = str_to_inttype<int>(value);
+        if (!option.max.has_value()) {
+            return std::unexpected{ParseError{.type = ParseErrorType::InvalidInteger, .token = value}};
+        }
+        break;
+    case OptionItem::var_value:
+        option.combo_values.push_back(value);
+        break;
+    default:
+        break;
+    }
+
+    item_type = OptionItem::unknown;
+    value.clear();
+    return {};
+}
+
+} // namespace
+
+auto UCIGuiHandler::parse_option_command(const TokenList &tokens) -> Option {
+    return value_or_throw(try_parse_option_command(tokens), "Invalid option command: ");
+}
+
+auto UCIGuiHandler::try_parse_option_command(const TokenList &tokens) -> ParseResult<Option> {
+    Option option{};
+    OptionItem current_item{OptionItem::unknown};
+    std::string collected_tokens{};
+    for (size_t index = 1; index < tokens.size(); ++index) {
+        const auto &token = tokens[index];
+        OptionItem next_item{OptionItem::unknown};
+        if (token == "name") {
+            next_item = OptionItem::name;
+        } else if (token == "type") {
+            next_item = OptionItem::type;
+        } else if (token == "default") {
+            next_item = OptionItem::default_value;
+        } else if (token == "min") {
+            next_item = OptionItem::min_value;
+        } else if (token == "max") {
+            next_item = OptionItem::max_value;
+        } else if (token == "var") {
+            next_item = OptionItem::var_value;
+        } else {
+            if (collected_tokens.empty()) {
+                collected_tokens = token;
+            } else {
+                collected_tokens += " " + token;
+            }
+            continue;
+        }
+        const auto result = process_option_item(current_item, collected_tokens, option);
+        if (!result.has_value()) {
+            return std::unexpected{result.error()};
+        }
+        current_item = next_item;
+    }
+    const auto result = process_option_item(current_item, collected_tokens, option);
+    if (!result.has_value()) {
+        return std::unexpected{result.error()};
+    }
+    return option;
+}
+
+template<typename T>
+auto UCIGuiHandler::parse_int_param(const TokenList &tokens, size_t index, std::optional<T> &target) -> void {
+    target = value_or_throw(try_parse_int_param<T>(tokens, index), "Invalid integer parameter: ");
+}
+
+template<typename T>
+auto UCIGuiHandler::try_parse_int_param(const TokenList &tokens, size_t index) -> ParseResult<T> {
+    if (index + 1 >= tokens.size()) {
+        return std::unexpected{ParseError{.type = ParseErrorType::MissingValue, .token = tokens[index]}};
+    }
+    const auto value = str_to_inttype<T>(tokens[index + 1]);
+    if (!value.has_value()) {
+        return std::unexpected{ParseError{.type = ParseErrorType::InvalidInteger, .token = tokens[index + 1]}};
+    }
+    return value.value();
+}
+
+auto UCIGuiHandler::collect_string(const TokenList &tokens, size_t index) -> std::string {
+    std::string result;
+    append_string(tokens, index, result);
+    return result;
+}
+
+} // namespace chessuci
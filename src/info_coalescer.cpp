@@ -0,0 +1,69 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/info_coalescer.h"
+
+#include <algorithm>
+
+namespace chessuci {
+
+InfoCoalescer::InfoCoalescer(std::chrono::milliseconds interval) : m_interval{interval} {}
+
+auto InfoCoalescer::add(const search_info &info, clock::time_point now, const DeliverCallback &deliver) -> void {
+    ++m_received;
+    // the multipv index is sent by the engine and must not size the pending lines
+    if (!info.string.empty() || info.multipv.value_or(1) > max_lines) {
+        ++m_delivered;
+        if (deliver) {
+            deliver(info);
+        }
+        return;
+    }
+
+    const auto line = static_cast<std::size_t>(std::max(info.multipv.value_or(1), 1) - 1);
+    if (line >= m_pending.size()) {
+        m_pending.resize(line + 1);
+    }
+    auto &pending = m_pending[line];
+    if (!pending.has_value()) {
+        pending = info;
+        ++m_pending_count;
+    } else if (info.pv.empty()) {
+        ++m_merged;
+        merge_info(pending.value(), info);
+    } else {
+        // a new principal variation supersedes everything reported for the old one
+        ++m_dropped;
+        pending = info;
+    }
+
+    if (now - m_last_delivery >= m_interval) {
+        flush(deliver);
+        m_last_delivery = now;
+    }
+}
+
+auto InfoCoalescer::flush(const DeliverCallback &deliver) -> void {
+    if (m_pending_count == 0) {
+        return;
+    }
+    for (auto &pending : m_pending) {
+        if (!pending.has_value()) {
+            continue;
+        }
+        ++m_delivered;
+        if (deliver) {
+            deliver(pending.value());
+        }
+        pending.reset();
+    }
+    m_pending_count = 0;
+}
+
+auto InfoCoalescer::statistics() const -> Statistics {
+    return Statistics{.received = m_received, .delivered = m_delivered, .merged = m_merged, .dropped = m_dropped};
+}
+
+} // namespace chessuci
@@ -0,0 +1,108 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/latency_histogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace chessuci {
+
+namespace {
+
+auto update_min(std::atomic<std::uint64_t> &target, std::uint64_t value) -> void {
+    auto current = target.load(std::memory_order_relaxed);
+    while (value < current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+auto update_max(std::atomic<std::uint64_t> &target, std::uint64_t value) -> void {
+    auto current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+auto LatencyHistogram::record(duration latency) -> void {
+    const auto value = static_cast<std::uint64_t>(std::max(latency.count(), duration::rep{0}));
+    m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    update_min(m_min, value);
+    update_max(m_max, value);
+}
+
+auto LatencyHistogram::add(const LatencyHistogram &other) -> void {
+    for (std::size_t index = 0; index < bucket_count; ++index) {
+        const auto count = other.m_buckets[index].load(std::memory_order_relaxed);
+        if (count > 0) {
+            m_buckets[index].fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+    if (other.count() > 0) {
+        m_count.fetch_add(other.count(), std::memory_order_relaxed);
+        m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        update_min(m_min, other.m_min.load(std::memory_order_relaxed));
+        update_max(m_max, other.m_max.load(std::memory_order_relaxed));
+    }
+}
+
+auto LatencyHistogram::reset() -> void {
+    for (auto &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(std::numeric_limits<std::uint64_t>::max(), std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::min() const -> duration {
+    return count() > 0 ? duration{m_min.load(std::memory_order_relaxed)} : duration{0};
+}
+
+auto LatencyHistogram::mean() const -> duration {
+    const auto values = count();
+    return values > 0 ? duration{m_sum.load(std::memory_order_relaxed) / values} : duration{0};
+}
+
+auto LatencyHistogram::percentile(double percent) const -> duration {
+    const auto values = count();
+    if (values == 0) {
+        return duration{0};
+    }
+    const auto rank = std::max(static_cast<std::uint64_t>(std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 * static_cast<double>(values))), std::uint64_t{1});
+    std::uint64_t seen{0};
+    for (std::size_t index = 0; index < bucket_count; ++index) {
+        seen += m_buckets[index].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return duration{std::min(bucket_upper_bound(index), m_max.load(std::memory_order_relaxed))};
+        }
+    }
+    return max();
+}
+
+auto LatencyHistogram::bucket_index(std::uint64_t value) -> std::size_t {
+    if (value < sub_bucket_count) {
+        return static_cast<std::size_t>(value);
+    }
+    // the top sub_bucket_bits bits select the sub-bucket within the magnitude
+    const auto magnitude = std::min(static_cast<unsigned>(std::bit_width(value)) - sub_bucket_bits, max_magnitude);
+    const auto top = std::min(value >> magnitude, std::uint64_t{sub_bucket_count - 1});
+    return sub_bucket_count + (magnitude - 1) * sub_bucket_count / 2 + static_cast<std::size_t>(top - sub_bucket_count / 2);
+}
+
+auto LatencyHistogram::bucket_upper_bound(std::size_t index) -> std::uint64_t {
+    if (index < sub_bucket_count) {
+        return index;
+    }
+    const auto magnitude = static_cast<unsigned>((index - sub_bucket_count) / (sub_bucket_count / 2)) + 1;
+    const auto top = (index - sub_bucket_count) % (sub_bucket_count / 2) + sub_bucket_count / 2;
+    return ((static_cast<std::uint64_t>(top) + 1) << magnitude) - 1;
+}
+
+} // namespace chessuci
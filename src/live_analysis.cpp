@@ -0,0 +1,82 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/live_analysis.h"
+
+#include <algorithm>
+
+namespace chessuci {
+
+auto LiveAnalysis::update(const search_info &info) -> void {
+    if (!info.score.has_value() && info.pv.empty()) {
+        return;
+    }
+    const auto multipv = info.multipv.value_or(1);
+    if (multipv < 1 || static_cast<std::size_t>(multipv) > max_lines) {
+        return;
+    }
+
+    const auto index = static_cast<std::size_t>(multipv - 1);
+    auto &line = m_written[index];
+    line.multipv = multipv;
+    line.depth = info.depth.value_or(line.depth);
+    line.seldepth = info.seldepth.value_or(line.seldepth);
+    line.score = info.score.value_or(line.score);
+    line.nodes = info.nodes.value_or(line.nodes);
+    line.time = info.time.value_or(line.time);
+    if (!info.pv.empty()) {
+        line.pv_length = std::min(info.pv.size(), LiveLine::max_pv_length);
+        std::copy_n(info.pv.begin(), line.pv_length, line.pv.begin());
+    }
+    line.version = m_version.load(std::memory_order_relaxed) + 1;
+    m_lines[index].store(line);
+
+    if (static_cast<std::size_t>(multipv) > m_line_count.load(std::memory_order_relaxed)) {
+        m_line_count.store(static_cast<std::size_t>(multipv), std::memory_order_release);
+    }
+    m_version.store(line.version, std::memory_order_release);
+    if (m_change_callback) {
+        m_change_callback(multipv);
+    }
+}
+
+auto LiveAnalysis::clear() -> void {
+    const auto count = m_line_count.load(std::memory_order_relaxed);
+    m_line_count.store(0, std::memory_order_release);
+    for (std::size_t index = 0; index < count; ++index) {
+        m_written[index] = LiveLine{};
+        m_lines[index].store(m_written[index]);
+    }
+    m_version.fetch_add(1, std::memory_order_release);
+    if (m_change_callback) {
+        m_change_callback(0);
+    }
+}
+
+auto LiveAnalysis::line(int multipv) const -> std::optional<LiveLine> {
+    if (multipv < 1 || static_cast<std::size_t>(multipv) > max_lines) {
+        return std::nullopt;
+    }
+    auto line = m_lines[static_cast<std::size_t>(multipv - 1)].load();
+    if (line.multipv == 0) {
+        return std::nullopt;
+    }
+    return line;
+}
+
+auto LiveAnalysis::lines() const -> std::vector<LiveLine> {
+    const auto count = m_line_count.load(std::memory_order_acquire);
+    std::vector<LiveLine> lines;
+    lines.reserve(count);
+    for (std::size_t index = 0; index < count; ++index) {
+        auto line = m_lines[index].load();
+        if (line.multipv != 0) {
+            lines.push_back(line);
+        }
+    }
+    return lines;
+}
+
+} // namespace chessuci
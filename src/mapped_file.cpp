@@ -0,0 +1,129 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/mapped_file.h"
+
+#if defined(CHESSUCI_WINDOWS)
+#include <windows.h>
+#elif defined(CHESSUCI_UNIX)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#error "Platform not configured in CMake"
+#endif
+
+namespace chessuci {
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    open(path);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#if defined(CHESSUCI_WINDOWS)
+
+auto MappedFile::open(const std::filesystem::path &path) -> bool {
+    close();
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        m_last_error = "Failed to open file: error " + std::to_string(GetLastError());
+        return false;
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(m_file, &size)) {
+        m_last_error = "Failed to get file size: error " + std::to_string(GetLastError());
+        close();
+        return false;
+    }
+    m_size = static_cast<std::size_t>(size.QuadPart);
+    m_open = true;
+    if (m_size == 0) {
+        // empty files cannot be mapped
+        return true;
+    }
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        m_last_error = "Failed to map file: error " + std::to_string(GetLastError());
+        close();
+        return false;
+    }
+    m_data = static_cast<const char *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (m_data == nullptr) {
+        m_last_error = "Failed to map file: error " + std::to_string(GetLastError());
+        close();
+        return false;
+    }
+    return true;
+}
+
+auto MappedFile::close() -> void {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != nullptr) {
+        CloseHandle(m_file);
+    }
+    m_data = nullptr;
+    m_mapping = nullptr;
+    m_file = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#else
+
+auto MappedFile::open(const std::filesystem::path &path) -> bool {
+    close();
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        m_last_error = std::string{"Failed to open file: "} + strerror(errno);
+        return false;
+    }
+    struct stat status{};
+    if (fstat(fd, &status) == -1) {
+        m_last_error = std::string{"Failed to get file size: "} + strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    m_open = true;
+    if (m_size > 0) {
+        void *data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            m_last_error = std::string{"Failed to map file: "} + strerror(errno);
+            m_size = 0;
+            m_open = false;
+        } else {
+            m_data = static_cast<const char *>(data);
+            madvise(data, m_size, MADV_SEQUENTIAL);
+        }
+    }
+    // the mapping stays valid after the descriptor is closed
+    ::close(fd);
+    return m_open;
+}
+
+auto MappedFile::close() -> void {
+    if (m_data != nullptr) {
+        munmap(const_cast<char *>(m_data), m_size);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_open = false;
+}
+
+#endif
+
+} // namespace chessuci
@@ -0,0 +1,533 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/match_runner.h"
+#include "chessuci/gui_handler.h"
+#include "chessuci/move.h"
+#include "chessuci/process_factory.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+#include <chesscore/fen.h>
+
+namespace chessuci {
+
+namespace {
+
+constexpr int mate_score{100000};
+constexpr int fifty_move_plies{100};
+constexpr std::size_t pgn_line_length{80};
+constexpr int square_count{64};
+constexpr char first_file{'a'};
+constexpr int files_per_rank{8};
+
+// time an engine gets on top of its clock, before it is considered stalled
+constexpr std::chrono::milliseconds stall_timeout{5000};
+
+auto color_index(chesscore::Color color) -> std::size_t {
+    return color == chesscore::Color::White ? 0 : 1;
+}
+
+auto win_for(chesscore::Color color) -> GameResult {
+    return color == chesscore::Color::White ? GameResult::WhiteWins : GameResult::BlackWins;
+}
+
+auto color_name(chesscore::Color color) -> std::string {
+    return color == chesscore::Color::White ? "White" : "Black";
+}
+
+auto opponent(chesscore::Color color) -> chesscore::Color {
+    return color == chesscore::Color::White ? chesscore::Color::Black : chesscore::Color::White;
+}
+
+auto is_valid_opening(const std::string &opening) -> bool {
+    if (opening == position_command::startpos) {
+        return true;
+    }
+    try {
+        const chesscore::Position position{chesscore::FenString{opening}};
+    } catch (const std::exception &) {
+        return false;
+    }
+    return true;
+}
+
+// everything that decides, whether two positions are repetitions
+struct PositionKey {
+    std::array<std::optional<chesscore::Piece>, square_count> board{};
+    chesscore::Color side_to_move{chesscore::Color::White};
+    chesscore::CastlingRights castling_rights{};
+    std::optional<chesscore::Square> en_passant_target{};
+
+    auto operator==(const PositionKey &rhs) const -> bool = default;
+};
+
+auto position_key(const chesscore::Position &position) -> PositionKey {
+    PositionKey key{};
+    for (int index = 0; index < square_count; ++index) {
+        const auto square = chesscore::Square{
+            chesscore::File{static_cast<char>(first_file + index % files_per_rank)}, chesscore::Rank{index / files_per_rank + 1}
+        };
+        key.board[static_cast<std::size_t>(index)] = position.board().get_piece(square);
+    }
+    key.side_to_move = position.side_to_move();
+    key.castling_rights = position.castling_rights();
+    key.en_passant_target = position.en_passant_target();
+    return key;
+}
+
+auto format_san(const chesscore::Move &move, const chesscore::MoveList &legal_moves) -> std::string {
+    const auto from = to_string(move.from);
+    const auto to = to_string(move.to);
+    if (move.piece.type == chesscore::PieceType::King && std::abs(from[0] - to[0]) == 2) {
+        return to[0] > from[0] ? "O-O" : "O-O-O";
+    }
+
+    std::string san;
+    if (move.piece.type == chesscore::PieceType::Pawn) {
+        if (move.captured.has_value()) {
+            san += from[0];
+        }
+    } else {
+        san += chesscore::Piece{.type = move.piece.type, .color = chesscore::Color::White}.piece_char();
+        bool ambiguous{false};
+        bool same_file{false};
+        bool same_rank{false};
+        for (const auto &other : legal_moves) {
+            if (other.piece == move.piece && other.to == move.to && other.from != move.from) {
+                const auto other_from = to_string(other.from);
+                ambiguous = true;
+                same_file = same_file || other_from[0] == from[0];
+                same_rank = same_rank || other_from[1] == from[1];
+            }
+        }
+        if (ambiguous) {
+            if (!same_file) {
+                san += from[0];
+            } else if (!same_rank) {
+                san += from[1];
+            } else {
+                san += from;
+            }
+        }
+    }
+    if (move.captured.has_value()) {
+        san += 'x';
+    }
+    san += to;
+    if (move.promoted.has_value()) {
+        san += '=';
+        san += chesscore::Piece{.type = move.promoted->type, .color = chesscore::Color::White}.piece_char();
+    }
+    return san;
+}
+
+} // namespace
+
+auto to_string(GameResult result) -> std::string {
+    switch (result) {
+    case GameResult::WhiteWins:
+        return "1-0";
+    case GameResult::BlackWins:
+        return "0-1";
+    case GameResult::Draw:
+        return "1/2-1/2";
+    case GameResult::Unfinished:
+        break;
+    }
+    return "*";
+}
+
+auto Adjudicator::reset() -> void {
+    m_losing_moves = {};
+    m_winning_moves = {};
+    m_drawn_plies = 0;
+}
+
+auto Adjudicator::add_score(chesscore::Color side, const std::optional<score_info> &score, int move_number) -> std::optional<GameResult> {
+    const auto index = color_index(side);
+    const auto other = 1 - index;
+    if (!score.has_value() || score->lowerbound || score->upperbound || (!score->cp.has_value() && !score->mate.has_value())) {
+        m_losing_moves[index] = 0;
+        m_winning_moves[index] = 0;
+        m_drawn_plies = 0;
+        return std::nullopt;
+    }
+
+    const auto value = score->mate.has_value() ? (score->mate.value() > 0 ? mate_score : -mate_score) : score->cp.value();
+    if (m_settings.resign_score.has_value()) {
+        const auto threshold = m_settings.resign_score.value();
+        m_losing_moves[index] = value <= -threshold ? m_losing_moves[index] + 1 : 0;
+        m_winning_moves[index] = value >= threshold ? m_winning_moves[index] + 1 : 0;
+        if (m_losing_moves[index] >= m_settings.resign_move_count && m_winning_moves[other] >= m_settings.resign_move_count) {
+            return win_for(opponent(side));
+        }
+        if (m_winning_moves[index] >= m_settings.resign_move_count && m_losing_moves[other] >= m_settings.resign_move_count) {
+            return win_for(side);
+        }
+    }
+    if (m_settings.draw_score.has_value()) {
+        const auto drawn = move_number >= m_settings.draw_move_number && std::abs(value) <= m_settings.draw_score.value();
+        m_drawn_plies = drawn ? m_drawn_plies + 1 : 0;
+        if (m_drawn_plies >= 2 * m_settings.draw_move_count) {
+            return GameResult::Draw;
+        }
+    }
+    return std::nullopt;
+}
+
+struct MatchRunner::Player {
+    std::unique_ptr<UCIGuiHandler> handler;
+    std::string name;
+    bool failed{false};
+
+    // written by the reader thread of the engine
+    std::mutex mutex;
+    std::optional<score_info> score;
+    std::chrono::steady_clock::time_point bestmove_time;
+};
+
+MatchRunner::MatchRunner(MatchSettings settings) : m_settings{std::move(settings)}, m_process_creator{&ProcessFactory::create_local} {
+    m_settings.concurrency = std::max<std::size_t>(m_settings.concurrency, 1);
+}
+
+MatchRunner::~MatchRunner() = default;
+
+auto MatchRunner::run(std::ostream &pgn, const GameCallback &on_game) -> bool {
+    m_cancelled = false;
+    m_next_game = 0;
+    {
+        std::lock_guard<std::mutex> lock{m_output_mutex};
+        m_statistics = MatchStatistics{};
+    }
+    m_sprt.reset();
+    if (m_settings.sprt.has_value()) {
+        m_sprt.emplace(m_settings.sprt.value());
+    }
+    m_pair_scores.clear();
+    m_last_error.clear();
+    // the games are played on the slot threads, which must not see an invalid opening
+    for (const auto &opening : m_settings.openings) {
+        if (!is_valid_opening(opening)) {
+            m_last_error = "Invalid opening " + opening;
+            return false;
+        }
+    }
+    m_pgn = &pgn;
+    m_on_game = &on_game;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::atomic<std::size_t> started_slots{0};
+    std::vector<std::thread> threads;
+    for (std::size_t index = 0; index < std::min(m_settings.concurrency, m_settings.games); ++index) {
+        threads.emplace_back([this, &started_slots] -> void { run_slot(started_slots); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock{m_output_mutex};
+        m_statistics.elapsed = std::chrono::steady_clock::now() - start;
+    }
+    m_pgn = nullptr;
+    m_on_game = nullptr;
+
+    if (started_slots == 0 && m_settings.games > 0) {
+        m_last_error = "No engines could be started";
+        return false;
+    }
+    if (m_statistics.games < m_settings.games && !m_cancelled) {
+        m_last_error = "Engines failed, only " + std::to_string(m_statistics.games) + " games were played";
+        return false;
+    }
+    return true;
+}
+
+auto MatchRunner::statistics() const -> MatchStatistics {
+    std::lock_guard<std::mutex> lock{m_output_mutex};
+    return m_statistics;
+}
+
+auto MatchRunner::run_slot(std::atomic<std::size_t> &started_slots) -> void {
+    std::array<std::unique_ptr<Player>, 2> players{std::make_unique<Player>(), std::make_unique<Player>()};
+    for (std::size_t index = 0; index < players.size(); ++index) {
+        if (!start_player(*players[index], index)) {
+            return;
+        }
+    }
+    ++started_slots;
+
+    while (!m_cancelled) {
+        const auto game_index = m_next_game++;
+        if (game_index >= m_settings.games) {
+            break;
+        }
+        publish(play_game(game_index, players));
+        for (std::size_t index = 0; index < players.size(); ++index) {
+            if (players[index]->failed && !start_player(*players[index], index)) {
+                return;
+            }
+        }
+    }
+}
+
+auto MatchRunner::start_player(Player &player, std::size_t engine_index) -> bool {
+    const auto &engine = m_settings.engines[engine_index];
+    player.handler.reset();
+    player.failed = false;
+    player.handler = std::make_unique<UCIGuiHandler>(m_process_creator());
+    player.handler->on_info([&player](const search_info &info) -> void {
+        if (info.score.has_value() && info.multipv.value_or(1) == 1) {
+            std::lock_guard<std::mutex> lock{player.mutex};
+            player.score = info.score;
+        }
+    });
+    player.handler->on_bestmove([&player](const bestmove_info &) -> void {
+        std::lock_guard<std::mutex> lock{player.mutex};
+        player.bestmove_time = std::chrono::steady_clock::now();
+    });
+
+    try {
+        const auto info = player.handler->initialize(engine.process, engine.options).get();
+        player.name = engine.name.empty() ? info.handshake.id.name : engine.name;
+    } catch (const std::exception &) {
+        player.handler.reset();
+        return false;
+    }
+    return true;
+}
+
+auto MatchRunner::play_game(std::size_t game_index, std::array<std::unique_ptr<Player>, 2> &players) -> GameRecord {
+    const auto white_engine = game_index % 2;
+    std::array<Player *, 2> sides{players[white_engine].get(), players[1 - white_engine].get()};
+    GameRecord game{};
+    game.round = game_index + 1;
+    game.white_engine = white_engine;
+    game.white = sides[0]->name;
+    game.black = sides[1]->name;
+    game.opening = m_settings.openings.empty() ? position_command::startpos : m_settings.openings[(game_index / 2) % m_settings.openings.size()];
+
+    chesscore::Position position{chesscore::FenString{game.opening == position_command::startpos ? chesscore::starting_position_fen : game.opening}};
+    game.first_move_number = position.fullmove_number();
+    game.black_starts = position.side_to_move() == chesscore::Color::Black;
+
+    position_command command{.fen = game.opening, .moves = {}};
+    std::vector<PositionKey> history{position_key(position)};
+    std::array<std::chrono::milliseconds, 2> time_left{m_settings.time_control.base, m_settings.time_control.base};
+    Adjudicator adjudicator{m_settings.adjudication};
+    std::optional<GameResult> adjudicated;
+    for (auto *player : sides) {
+        player->handler->send_ucinewgame();
+    }
+
+    auto finish = [&game](GameResult result, std::string termination, std::string reason) -> GameRecord & {
+        game.result = result;
+        game.termination = std::move(termination);
+        game.reason = std::move(reason);
+        return game;
+    };
+
+    while (true) {
+        const auto legal_moves = position.all_legal_moves();
+        const auto side = position.side_to_move();
+        if (position.is_check() && !game.moves.empty()) {
+            game.moves.back() += legal_moves.empty() ? "#" : "+";
+        }
+        if (legal_moves.empty()) {
+            if (position.is_check()) {
+                return finish(win_for(opponent(side)), "normal", color_name(opponent(side)) + " mates");
+            }
+            return finish(GameResult::Draw, "normal", "Draw by stalemate");
+        }
+        if (position.halfmove_clock() >= fifty_move_plies) {
+            return finish(GameResult::Draw, "normal", "Draw by fifty move rule");
+        }
+        // only positions since the last capture or pawn move can repeat
+        const auto reversible = std::min(history.size() - 1, static_cast<std::size_t>(position.halfmove_clock()));
+        if (std::count(history.end() - static_cast<std::ptrdiff_t>(reversible) - 1, history.end(), history.back()) >= 3) {
+            return finish(GameResult::Draw, "normal", "Draw by threefold repetition");
+        }
+        if (adjudicated == GameResult::Draw) {
+            return finish(GameResult::Draw, "adjudication", "Draw by adjudication");
+        }
+        if (adjudicated.has_value()) {
+            const auto loser = adjudicated.value() == GameResult::WhiteWins ? chesscore::Color::Black : chesscore::Color::White;
+            return finish(adjudicated.value(), "adjudication", color_name(loser) + " resigns");
+        }
+        if (m_settings.adjudication.max_moves > 0 && position.fullmove_number() - game.first_move_number >= m_settings.adjudication.max_moves) {
+            return finish(GameResult::Draw, "adjudication", "Draw by move limit");
+        }
+        if (m_cancelled) {
+            return finish(GameResult::Unfinished, "unterminated", "Match cancelled");
+        }
+
+        const auto index = color_index(side);
+        auto &player = *sides[index];
+        go_command go{};
+        go.wtime = time_left[0].count();
+        go.btime = time_left[1].count();
+        go.winc = static_cast<int>(m_settings.time_control.increment.count());
+        go.binc = static_cast<int>(m_settings.time_control.increment.count());
+        const auto response = search(player, command, go, time_left[index]);
+        if (!response.has_value()) {
+            player.failed = true;
+            return finish(win_for(opponent(side)), "abandoned", color_name(side) + " engine failed");
+        }
+
+        const auto &[bestmove, elapsed] = response.value();
+        time_left[index] -= elapsed;
+        if (time_left[index] < -m_settings.time_control.margin) {
+            return finish(win_for(opponent(side)), "time forfeit", color_name(side) + " loses on time");
+        }
+        time_left[index] = std::max(time_left[index], std::chrono::milliseconds{0}) + m_settings.time_control.increment;
+
+        const auto move = convert_move(bestmove.bestmove, position);
+        if (!move.has_value()) {
+            return finish(win_for(opponent(side)), "rules infraction", color_name(side) + " makes an illegal move: " + to_string(bestmove.bestmove));
+        }
+        const auto move_number = position.fullmove_number();
+        game.moves.push_back(format_san(move.value(), legal_moves));
+        position.make_move(move.value());
+        command.moves.push_back(bestmove.bestmove);
+        history.push_back(position_key(position));
+
+        std::lock_guard<std::mutex> lock{player.mutex};
+        adjudicated = adjudicator.add_score(side, player.score, move_number);
+    }
+}
+
+auto MatchRunner::search(Player &player, const position_command &position, const go_command &go, std::chrono::milliseconds time_left)
+    -> std::optional<std::pair<bestmove_info, std::chrono::milliseconds>> {
+    {
+        std::lock_guard<std::mutex> lock{player.mutex};
+        player.score.reset();
+    }
+    if (!player.handler->send_position(position)) {
+        return std::nullopt;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    auto bestmove = player.handler->async_go(go);
+    if (bestmove.wait_for(std::max(time_left, std::chrono::milliseconds{0}) + m_settings.time_control.margin + stall_timeout) != std::future_status::ready) {
+        // a stalled engine is not trusted for further games
+        return std::nullopt;
+    }
+    try {
+        auto info = bestmove.get();
+        std::lock_guard<std::mutex> lock{player.mutex};
+        return std::pair{std::move(info), std::chrono::duration_cast<std::chrono::milliseconds>(player.bestmove_time - start)};
+    } catch (const std::exception &) {
+        return std::nullopt;
+    }
+}
+
+auto MatchRunner::publish(const GameRecord &game) -> void {
+    std::lock_guard<std::mutex> lock{m_output_mutex};
+    ++m_statistics.games;
+    if (game.result == GameResult::Draw) {
+        ++m_statistics.draws;
+    } else if (game.result != GameResult::Unfinished) {
+        const auto white_won = game.result == GameResult::WhiteWins;
+        if (white_won == (game.white_engine == 0)) {
+            ++m_statistics.wins;
+        } else {
+            ++m_statistics.losses;
+        }
+    }
+    if (game.termination == "adjudication") {
+        ++m_statistics.adjudicated;
+    } else if (game.termination != "normal" && game.termination != "unterminated") {
+        ++m_statistics.forfeits;
+    }
+    update_sprt(game);
+    if (m_pgn != nullptr) {
+        *m_pgn << format_pgn(game, m_settings.event) << std::flush;
+    }
+    if (m_on_game != nullptr && *m_on_game) {
+        (*m_on_game)(game);
+    }
+}
+
+auto MatchRunner::update_sprt(const GameRecord &game) -> void {
+    if (!m_sprt.has_value() || game.result == GameResult::Unfinished) {
+        return;
+    }
+    double score{0.5};
+    if (game.result != GameResult::Draw) {
+        const auto first_engine_won = (game.result == GameResult::WhiteWins) == (game.white_engine == 0);
+        score = first_engine_won ? 1.0 : 0.0;
+    }
+    const auto pair = (game.round - 1) / 2;
+    const auto first_game = m_pair_scores.find(pair);
+    if (first_game == m_pair_scores.end()) {
+        m_pair_scores.emplace(pair, score);
+        return;
+    }
+    const auto decision = m_sprt->add_pair(first_game->second, score);
+    m_pair_scores.erase(first_game);
+    if (decision != SprtDecision::Continue) {
+        // the games still running are not needed any more
+        m_cancelled = true;
+    }
+}
+
+auto MatchRunner::format_pgn(const GameRecord &game, const std::string &event) -> std::string {
+    auto tag = [](const std::string &name, const std::string &value) -> std::string { return "[" + name + " \"" + value + "\"]\n"; };
+    const auto result = to_string(game.result);
+
+    std::string pgn;
+    pgn += tag("Event", event);
+    pgn += tag("Site", "?");
+    pgn += tag("Date", "????.??.??");
+    pgn += tag("Round", std::to_string(game.round));
+    pgn += tag("White", game.white);
+    pgn += tag("Black", game.black);
+    pgn += tag("Result", result);
+    if (game.opening != position_command::startpos) {
+        pgn += tag("SetUp", "1");
+        pgn += tag("FEN", game.opening);
+    }
+    pgn += tag("PlyCount", std::to_string(game.moves.size()));
+    pgn += tag("Termination", game.termination);
+    pgn += "\n";
+
+    std::vector<std::string> tokens;
+    auto move_number = game.first_move_number;
+    auto white_to_move = !game.black_starts;
+    for (std::size_t index = 0; index < game.moves.size(); ++index) {
+        if (white_to_move) {
+            tokens.push_back(std::to_string(move_number) + ".");
+        } else if (index == 0) {
+            tokens.push_back(std::to_string(move_number) + "...");
+        }
+        tokens.push_back(game.moves[index]);
+        if (!white_to_move) {
+            ++move_number;
+        }
+        white_to_move = !white_to_move;
+    }
+    if (!game.reason.empty()) {
+        tokens.push_back("{" + game.reason + "}");
+    }
+    tokens.push_back(result);
+
+    std::size_t line_length{0};
+    for (const auto &token : tokens) {
+        if (line_length > 0 && line_length + 1 + token.size() > pgn_line_length) {
+            pgn += "\n";
+            line_length = 0;
+        } else if (line_length > 0) {
+            pgn += " ";
+            ++line_length;
+        }
+        pgn += token;
+        line_length += token.size();
+    }
+    pgn += "\n\n";
+    return pgn;
+}
+
+} // namespace chessuci
@@ -0,0 +1,248 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#ifndef CHESSUCI_WINDOWS
+#include "chessuci/socket_unix.h"
+
+#include <unistd.h>
+#endif
+
+namespace chessuci {
+
+namespace {
+
+// commands of both directions; everything else is counted as "other"
+constexpr std::array<std::string_view, 19> command_names{
+    "uci",      "debug", "isready", "setoption", "register", "ucinewgame",     "position",     "go",   "stop",   "ponderhit",
+    "quit",     "id",    "uciok",   "readyok",   "bestmove", "copyprotection", "registration", "info", "option",
+};
+constexpr std::size_t command_slots{command_names.size() + 1};
+constexpr std::size_t metric_count{static_cast<std::size_t>(Metric::CallbackNanoseconds) + 1};
+constexpr std::size_t received_offset{metric_count};
+constexpr std::size_t sent_offset{received_offset + command_slots};
+constexpr std::size_t slot_count{sent_offset + command_slots};
+
+using Counters = std::array<std::uint64_t, slot_count>;
+
+struct ThreadCounters {
+    std::array<std::atomic<std::uint64_t>, slot_count> values{};
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<const ThreadCounters *> threads;
+    Counters retired{};
+};
+
+// never destroyed, threads may still count while static objects are destroyed
+auto registry() -> Registry & {
+    static auto *instance = new Registry{};
+    return *instance;
+}
+
+auto add_counters(Counters &total, const ThreadCounters &counters) -> void {
+    for (std::size_t slot = 0; slot < slot_count; ++slot) {
+        total[slot] += counters.values[slot].load(std::memory_order_relaxed);
+    }
+}
+
+// registers the counters of a thread and keeps their values when the thread ends
+class ThreadRegistration {
+public:
+    ThreadRegistration() {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> lock{instance.mutex};
+        instance.threads.push_back(&m_counters);
+    }
+
+    ~ThreadRegistration() {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> lock{instance.mutex};
+        add_counters(instance.retired, m_counters);
+        std::erase(instance.threads, &m_counters);
+    }
+
+    ThreadRegistration(const ThreadRegistration &) = delete;
+    auto operator=(const ThreadRegistration &) -> ThreadRegistration & = delete;
+
+    auto counters() -> ThreadCounters & { return m_counters; }
+private:
+    ThreadCounters m_counters;
+};
+
+auto increment(std::size_t slot, std::uint64_t value) -> void {
+    thread_local ThreadRegistration registration;
+    // only this thread writes its counters, so no read-modify-write is needed
+    auto &counter = registration.counters().values[slot];
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+auto command_slot(std::string_view command) -> std::size_t {
+    const auto name_it = std::ranges::find(command_names, command);
+    return static_cast<std::size_t>(name_it - command_names.begin());
+}
+
+auto command_name(std::size_t slot) -> std::string {
+    return slot < command_names.size() ? std::string{command_names[slot]} : std::string{"other"};
+}
+
+auto write_json_map(std::ostream &stream, const std::map<std::string, std::uint64_t> &values) -> void {
+    stream << '{';
+    bool first{true};
+    for (const auto &[name, value] : values) {
+        stream << (first ? "" : ",") << '"' << name << "\":" << value;
+        first = false;
+    }
+    stream << '}';
+}
+
+} // namespace
+
+auto Metrics::add(Metric metric, std::uint64_t value) -> void {
+    increment(static_cast<std::size_t>(metric), value);
+}
+
+auto Metrics::count_received(std::string_view command) -> void {
+    increment(received_offset + command_slot(command), 1);
+}
+
+auto Metrics::count_sent(std::string_view line) -> void {
+    increment(sent_offset + command_slot(line.substr(0, line.find(' '))), 1);
+}
+
+auto Metrics::snapshot() -> MetricsSnapshot {
+    Counters total{};
+    {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> lock{instance.mutex};
+        total = instance.retired;
+        for (const auto *counters : instance.threads) {
+            add_counters(total, *counters);
+        }
+    }
+
+    auto value = [&total](Metric metric) -> std::uint64_t { return total[static_cast<std::size_t>(metric)]; };
+    MetricsSnapshot snapshot{
+        .lines_read = value(Metric::LinesRead),
+        .lines_written = value(Metric::LinesWritten),
+        .bytes_read = value(Metric::BytesRead),
+        .bytes_written = value(Metric::BytesWritten),
+        .parse_errors = value(Metric::ParseErrors),
+        .unknown_commands = value(Metric::UnknownCommands),
+        .callback_time = std::chrono::nanoseconds{value(Metric::CallbackNanoseconds)},
+        .commands_received = {},
+        .commands_sent = {},
+    };
+    for (std::size_t slot = 0; slot < command_slots; ++slot) {
+        if (total[received_offset + slot] > 0) {
+            snapshot.commands_received[command_name(slot)] = total[received_offset + slot];
+        }
+        if (total[sent_offset + slot] > 0) {
+            snapshot.commands_sent[command_name(slot)] = total[sent_offset + slot];
+        }
+    }
+    return snapshot;
+}
+
+auto Metrics::to_prometheus(const MetricsSnapshot &snapshot) -> std::string {
+    std::ostringstream stream;
+    auto counter = [&stream](std::string_view name, std::string_view help, auto value) -> void {
+        stream << "# HELP chessuci_" << name << ' ' << help << '\n';
+        stream << "# TYPE chessuci_" << name << " counter\n";
+        stream << "chessuci_" << name << ' ' << value << '\n';
+    };
+    counter("lines_read_total", "Lines read from engines or GUIs.", snapshot.lines_read);
+    counter("lines_written_total", "Lines written to engines or GUIs.", snapshot.lines_written);
+    counter("bytes_read_total", "Bytes read from engines or GUIs.", snapshot.bytes_read);
+    counter("bytes_written_total", "Bytes written to engines or GUIs.", snapshot.bytes_written);
+    counter("parse_errors_total", "Commands that could not be parsed.", snapshot.parse_errors);
+    counter("unknown_commands_total", "Commands without handler.", snapshot.unknown_commands);
+    counter("callback_seconds_total", "Time spent handling received commands.", std::chrono::duration<double>(snapshot.callback_time).count());
+
+    stream << "# HELP chessuci_commands_total UCI commands by name.\n";
+    stream << "# TYPE chessuci_commands_total counter\n";
+    for (const auto &[name, value] : snapshot.commands_received) {
+        stream << "chessuci_commands_total{direction=\"received\",command=\"" << name << "\"} " << value << '\n';
+    }
+    for (const auto &[name, value] : snapshot.commands_sent) {
+        stream << "chessuci_commands_total{direction=\"sent\",command=\"" << name << "\"} " << value << '\n';
+    }
+    return stream.str();
+}
+
+auto Metrics::to_json(const MetricsSnapshot &snapshot) -> std::string {
+    std::ostringstream stream;
+    stream << "{\"lines_read\":" << snapshot.lines_read;
+    stream << ",\"lines_written\":" << snapshot.lines_written;
+    stream << ",\"bytes_read\":" << snapshot.bytes_read;
+    stream << ",\"bytes_written\":" << snapshot.bytes_written;
+    stream << ",\"parse_errors\":" << snapshot.parse_errors;
+    stream << ",\"unknown_commands\":" << snapshot.unknown_commands;
+    stream << ",\"callback_nanoseconds\":" << snapshot.callback_time.count();
+    stream << ",\"commands_received\":";
+    write_json_map(stream, snapshot.commands_received);
+    stream << ",\"commands_sent\":";
+    write_json_map(stream, snapshot.commands_sent);
+    stream << "}\n";
+    return stream.str();
+}
+
+auto Metrics::format(const MetricsSnapshot &snapshot, MetricsFormat format) -> std::string {
+    return format == MetricsFormat::Json ? to_json(snapshot) : to_prometheus(snapshot);
+}
+
+auto Metrics::write_file(const std::filesystem::path &path, MetricsFormat format) -> bool {
+    const auto text = Metrics::format(snapshot(), format);
+    auto temporary = path;
+    temporary += ".tmp";
+    std::error_code error;
+    {
+        std::ofstream stream{temporary, std::ios::trunc | std::ios::binary};
+        stream << text;
+        if (!stream.flush()) {
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, path, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+auto Metrics::write_socket(const std::filesystem::path &path, MetricsFormat format, std::string &error) -> bool {
+#ifndef CHESSUCI_WINDOWS
+    const auto socket = socket_connect(RemoteEndpoint::local(path), error);
+    if (socket == -1) {
+        return false;
+    }
+    socket_configure(socket);
+    const auto sent = socket_send_all(socket, Metrics::format(snapshot(), format));
+    close(socket);
+    if (!sent) {
+        error = "Failed to send metrics to " + path.string();
+    }
+    return sent;
+#else
+    static_cast<void>(path);
+    static_cast<void>(format);
+    error = "Unix-domain sockets are not supported on this platform";
+    return false;
+#endif
+}
+
+} // namespace chessuci
@@ -0,0 +1,275 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/option_registry.h"
+#include "chessuci/string_conversion.h"
+
+#include <algorithm>
+#include <cctype>
+#include <span>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::uint64_t fnv_offset{14695981039346656037ULL};
+constexpr std::uint64_t fnv_prime{1099511628211ULL};
+
+auto lower(char chr) -> unsigned char {
+    return static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(chr)));
+}
+
+auto hash_step(std::uint64_t hash, char chr) -> std::uint64_t {
+    return (hash ^ lower(chr)) * fnv_prime;
+}
+
+auto equals_ignore_case(std::string_view lhs, std::string_view rhs) -> bool {
+    return std::ranges::equal(lhs, rhs, [](char left, char right) -> bool { return lower(left) == lower(right); });
+}
+
+// the tokens joined by single spaces, as they are in names and values of setoption commands
+auto joined_hash(std::span<const std::string> tokens) -> std::uint64_t {
+    auto hash = fnv_offset;
+    for (std::size_t index = 0; index < tokens.size(); ++index) {
+        if (index > 0) {
+            hash = hash_step(hash, ' ');
+        }
+        for (const auto chr : tokens[index]) {
+            hash = hash_step(hash, chr);
+        }
+    }
+    return hash;
+}
+
+auto joined_equals_ignore_case(std::span<const std::string> tokens, std::string_view text) -> bool {
+    for (std::size_t index = 0; index < tokens.size(); ++index) {
+        if (index > 0) {
+            if (text.empty() || text.front() != ' ') {
+                return false;
+            }
+            text.remove_prefix(1);
+        }
+        if (text.size() < tokens[index].size() || !equals_ignore_case(tokens[index], text.substr(0, tokens[index].size()))) {
+            return false;
+        }
+        text.remove_prefix(tokens[index].size());
+    }
+    return text.empty();
+}
+
+auto parse_check(std::string_view value) -> std::optional<bool> {
+    if (equals_ignore_case(value, "true")) {
+        return true;
+    }
+    if (equals_ignore_case(value, "false")) {
+        return false;
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+auto OptionRegistry::hash_name(std::string_view name) -> std::uint64_t {
+    auto hash = fnv_offset;
+    for (const auto chr : name) {
+        hash = hash_step(hash, chr);
+    }
+    return hash;
+}
+
+auto OptionRegistry::add_check(std::string name, bool default_value, CheckSetter setter) -> void {
+    setter(default_value);
+    add(Option{
+            .name = std::move(name),
+            .type = Option::Type::Check,
+            .default_value = default_value ? "true" : "false",
+            .min = std::nullopt,
+            .max = std::nullopt,
+            .combo_values = {},
+        },
+        Setter{.check = std::move(setter), .spin = {}, .combo = {}, .string = {}, .button = {}});
+}
+
+auto OptionRegistry::add_check(std::string name, bool default_value, std::atomic<bool> &target) -> void {
+    add_check(std::move(name), default_value, [&target](bool value) -> void { target.store(value, std::memory_order_relaxed); });
+}
+
+auto OptionRegistry::add_spin(std::string name, int default_value, int min, int max, SpinSetter setter) -> void {
+    if (default_value < min || default_value > max) {
+        throw UCIError{"Default value of option " + name + " is out of range"};
+    }
+    setter(default_value);
+    add(Option{
+            .name = std::move(name),
+            .type = Option::Type::Spin,
+            .default_value = std::to_string(default_value),
+            .min = min,
+            .max = max,
+            .combo_values = {},
+        },
+        Setter{.check = {}, .spin = std::move(setter), .combo = {}, .string = {}, .button = {}});
+}
+
+auto OptionRegistry::add_spin(std::string name, int default_value, int min, int max, std::atomic<int> &target) -> void {
+    add_spin(std::move(name), default_value, min, max, [&target](int value) -> void { target.store(value, std::memory_order_relaxed); });
+}
+
+auto OptionRegistry::add_combo(std::string name, std::string default_value, std::vector<std::string> choices, ComboSetter setter) -> void {
+    const auto choice_it = std::ranges::find_if(choices, [&default_value](const std::string &choice) -> bool { return equals_ignore_case(choice, default_value); });
+    if (choice_it == choices.end()) {
+        throw UCIError{"Default value of option " + name + " is not a choice"};
+    }
+    setter(static_cast<std::size_t>(choice_it - choices.begin()), *choice_it);
+    add(Option{
+            .name = std::move(name),
+            .type = Option::Type::Combo,
+            .default_value = std::move(default_value),
+            .min = std::nullopt,
+            .max = std::nullopt,
+            .combo_values = std::move(choices),
+        },
+        Setter{.check = {}, .spin = {}, .combo = std::move(setter), .string = {}, .button = {}});
+}
+
+auto OptionRegistry::add_combo(std::string name, std::string default_value, std::vector<std::string> choices, std::atomic<std::size_t> &target) -> void {
+    add_combo(std::move(name), std::move(default_value), std::move(choices),
+              [&target](std::size_t index, std::string_view) -> void { target.store(index, std::memory_order_relaxed); });
+}
+
+auto OptionRegistry::add_string(std::string name, std::string default_value, StringSetter setter) -> void {
+    setter(default_value == "<empty>" ? std::string_view{} : std::string_view{default_value});
+    add(Option{
+            .name = std::move(name),
+            .type = Option::Type::String,
+            .default_value = default_value.empty() ? std::string{"<empty>"} : std::move(default_value),
+            .min = std::nullopt,
+            .max = std::nullopt,
+            .combo_values = {},
+        },
+        Setter{.check = {}, .spin = {}, .combo = {}, .string = std::move(setter), .button = {}});
+}
+
+auto OptionRegistry::add_button(std::string name, ButtonCallback callback) -> void {
+    add(Option{
+            .name = std::move(name),
+            .type = Option::Type::Button,
+            .default_value = std::nullopt,
+            .min = std::nullopt,
+            .max = std::nullopt,
+            .combo_values = {},
+        },
+        Setter{.check = {}, .spin = {}, .combo = {}, .string = {}, .button = std::move(callback)});
+}
+
+auto OptionRegistry::add(Option option, Setter setter) -> void {
+    if (find(option.name) != nullptr) {
+        throw UCIError{"Option " + option.name + " is already registered"};
+    }
+    const auto hash = hash_name(option.name);
+    const auto position = std::ranges::upper_bound(m_index, hash, {}, &std::pair<std::uint64_t, std::size_t>::first);
+    m_index.insert(position, {hash, m_options.size()});
+    m_options.push_back(std::move(option));
+    m_setters.push_back(std::move(setter));
+}
+
+auto OptionRegistry::lookup(std::uint64_t hash, const auto &matches) const -> std::optional<std::size_t> {
+    auto entry_it = std::ranges::lower_bound(m_index, hash, {}, &std::pair<std::uint64_t, std::size_t>::first);
+    for (; entry_it != m_index.end() && entry_it->first == hash; ++entry_it) {
+        if (matches(m_options[entry_it->second].name)) {
+            return entry_it->second;
+        }
+    }
+    return std::nullopt;
+}
+
+auto OptionRegistry::find(std::string_view name) const -> const Option * {
+    const auto index = lookup(hash_name(name), [name](const std::string &option_name) -> bool { return equals_ignore_case(option_name, name); });
+    return index.has_value() ? &m_options[index.value()] : nullptr;
+}
+
+auto OptionRegistry::set(std::string_view name, std::optional<std::string_view> value) -> OptionResult {
+    const auto index = lookup(hash_name(name), [name](const std::string &option_name) -> bool { return equals_ignore_case(option_name, name); });
+    return index.has_value() ? set_value(index.value(), value) : OptionResult::UnknownOption;
+}
+
+auto OptionRegistry::apply(const TokenList &tokens) -> OptionResult {
+    if (tokens.size() < 3 || tokens[1] != "name") {
+        return OptionResult::UnknownOption;
+    }
+    const std::span<const std::string> arguments{tokens};
+    const auto value_it = std::ranges::find(arguments.subspan(2), std::string_view{"value"});
+    const auto name = std::span<const std::string>{arguments.begin() + 2, value_it};
+    const auto index = lookup(joined_hash(name), [name](const std::string &option_name) -> bool { return joined_equals_ignore_case(name, option_name); });
+    if (!index.has_value()) {
+        return OptionResult::UnknownOption;
+    }
+    if (value_it == arguments.end()) {
+        return set_value(index.value(), std::nullopt);
+    }
+
+    const auto value = std::span<const std::string>{value_it + 1, arguments.end()};
+    if (value.size() == 1) {
+        return set_value(index.value(), value.front());
+    }
+    m_value_buffer.clear();
+    for (const auto &token : value) {
+        if (!m_value_buffer.empty()) {
+            m_value_buffer += ' ';
+        }
+        m_value_buffer += token;
+    }
+    return set_value(index.value(), m_value_buffer);
+}
+
+auto OptionRegistry::set_value(std::size_t index, std::optional<std::string_view> value) -> OptionResult {
+    const auto &option = m_options[index];
+    const auto &setter = m_setters[index];
+    if (option.type == Option::Type::Button) {
+        if (value.has_value()) {
+            return OptionResult::InvalidValue;
+        }
+        setter.button();
+        return OptionResult::Applied;
+    }
+    if (!value.has_value()) {
+        return OptionResult::InvalidValue;
+    }
+
+    switch (option.type) {
+    case Option::Type::Check: {
+        const auto check = parse_check(value.value());
+        if (!check.has_value()) {
+            return OptionResult::InvalidValue;
+        }
+        setter.check(check.value());
+        return OptionResult::Applied;
+    }
+    case Option::Type::Spin: {
+        const auto number = str_to_inttype<int>(value.value());
+        if (!number.has_value() || number.value() < option.min.value_or(number.value()) || number.value() > option.max.value_or(number.value())) {
+            return OptionResult::InvalidValue;
+        }
+        setter.spin(number.value());
+        return OptionResult::Applied;
+    }
+    case Option::Type::Combo: {
+        const auto choice_it =
+            std::ranges::find_if(option.combo_values, [&value](const std::string &choice) -> bool { return equals_ignore_case(choice, value.value()); });
+        if (choice_it == option.combo_values.end()) {
+            return OptionResult::InvalidValue;
+        }
+        setter.combo(static_cast<std::size_t>(choice_it - option.combo_values.begin()), *choice_it);
+        return OptionResult::Applied;
+    }
+    case Option::Type::String:
+        setter.string(value.value() == "<empty>" ? std::string_view{} : value.value());
+        return OptionResult::Applied;
+    case Option::Type::Button:
+        break;
+    }
+    return OptionResult::InvalidValue;
+}
+
+} // namespace chessuci
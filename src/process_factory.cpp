@@ -1,24 +1,33 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#include "chessuci/process_factory.h"
-
-#if defined(CHESSUCI_WINDOWS)
-#include "chessuci/engine_process_win.h"
-using LocalEngineProcess = chessuci::EngineProcessWin;
-#elif defined(CHESSUCI_UNIX)
-#include "chessuci/engine_process_unix.h"
-using LocalEngineProcess = chessuci::EngineProcessUnix;
-#else
-#error "Platform not configured in CMake"
-#endif
-
-namespace chessuci {
-
-auto ProcessFactory::create_local() -> std::unique_ptr<EngineProcess> {
-    return std::make_unique<LocalEngineProcess>();
-}
-
-} // namespace chessuci
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/process_factory.h"
+
+#if defined(CHESSUCI_WINDOWS)
+#include "chessuci/engine_process_win.h"
+using LocalEngineProcess = chessuci::EngineProcessWin;
+#elif defined(CHESSUCI_UNIX)
+#include "chessuci/engine_process_socket.h"
+#include "chessuci/engine_process_unix.h"
+using LocalEngineProcess = chessuci::EngineProcessUnix;
+#else
+#error "Platform not configured in CMake"
+#endif
+
+namespace chessuci {
+
+auto ProcessFactory::create_local() -> std::unique_ptr<EngineProcess> {
+    return std::make_unique<LocalEngineProcess>();
+}
+
+auto ProcessFactory::create_remote([[maybe_unused]] const RemoteEndpoint &endpoint) -> std::unique_ptr<EngineProcess> {
+#if defined(CHESSUCI_UNIX)
+    return std::make_unique<EngineProcessSocket>(endpoint);
+#else
+    return nullptr;
+#endif
+}
+
+} // namespace chessuci
@@ -1,168 +1,247 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#include "chessuci/protocol.h"
-
-#include <sstream>
-
-namespace chessuci {
-
-namespace {
-
-auto add_bool_flag(std::string &line, const std::string &name, bool flag) -> void {
-    if (flag) {
-        line += " " + name;
-    }
-}
-
-template<typename T>
-auto add_optional_value(std::string &line, const std::string &name, const std::optional<T> &value) -> void {
-    if (value.has_value()) {
-        using std::to_string;
-        line += " " + name + " " + to_string(value.value());
-    }
-}
-
-auto add_move_list(std::string &line, const std::vector<UCIMove> &moves, const std::string &name = "") -> void {
-    if (!moves.empty()) {
-        line += " " + name;
-    }
-    for (const auto &move : moves) {
-        line += " " + to_string(move);
-    }
-}
-
-} // namespace
-
-auto to_string(const position_command &command) -> std::string {
-    std::string message{"position "};
-    if (command.fen != position_command::startpos) {
-        message += "fen " + command.fen;
-    }
-    if (!command.moves.empty()) {
-        message += " moves";
-        add_move_list(message, command.moves);
-    }
-    return message;
-}
-
-const std::string position_command::startpos{"startpos"};
-
-auto to_string(const go_command &command) -> std::string {
-    std::string message{"go"};
-    add_move_list(message, command.searchmoves, "searchmoves");
-    add_bool_flag(message, "ponder", command.ponder);
-    add_optional_value(message, "wtime", command.wtime);
-    add_optional_value(message, "btime", command.btime);
-    add_optional_value(message, "winc", command.winc);
-    add_optional_value(message, "binc", command.binc);
-    add_optional_value(message, "movestogo", command.movestogo);
-    add_optional_value(message, "depth", command.depth);
-    add_optional_value(message, "nodes", command.nodes);
-    add_optional_value(message, "mate", command.mate);
-    add_optional_value(message, "movetime", command.movetime);
-    add_bool_flag(message, "infinite", command.infinite);
-
-    return message;
-}
-
-auto go_command::has_timing_control() const -> bool {
-    return wtime.has_value() || btime.has_value() || movetime.has_value() || infinite;
-}
-
-auto to_string(const search_info &info) -> std::string {
-    std::string message{"info"};
-    add_optional_value(message, "depth", info.depth);
-    add_optional_value(message, "seldepth", info.seldepth);
-    add_optional_value(message, "time", info.time);
-    add_optional_value(message, "nodes", info.nodes);
-    add_optional_value(message, "multipv", info.multipv);
-    add_optional_value(message, "score", info.score);
-    add_optional_value(message, "currmove", info.currmove);
-    add_optional_value(message, "currmovenumber", info.currmovenumber);
-    add_optional_value(message, "hashfull", info.hashfull);
-    add_optional_value(message, "nps", info.nps);
-    add_optional_value(message, "tbhits", info.tbhits);
-    add_optional_value(message, "sbhits", info.sbhits);
-    add_optional_value(message, "cpuload", info.cpuload);
-    if (!info.string.empty()) {
-        message += " string " + info.string;
-    }
-    add_move_list(message, info.pv, "pv");
-    add_move_list(message, info.refutation, "refutation");
-    add_optional_value(message, "currline", info.currline);
-    return message;
-}
-
-auto to_string(const score_info &info) -> std::string {
-    std::string message{"score"};
-    add_optional_value(message, "cp", info.cp);
-    add_optional_value(message, "mate", info.mate);
-    add_bool_flag(message, "lowerbound", info.lowerbound);
-    add_bool_flag(message, "upperbound", info.upperbound);
-    return message;
-}
-
-auto to_string(const line_info &info) -> std::string {
-    std::string message{"line"};
-    add_optional_value(message, "cpunr", info.cpunr);
-    add_move_list(message, info.line);
-    return message;
-}
-
-auto Option::to_uci_string() const -> std::string {
-    std::ostringstream oss;
-    oss << "option ";
-    oss << "name " << name;
-    oss << "type " << type_to_string();
-    if (default_value.has_value()) {
-        oss << "default " << *default_value;
-    }
-    if (min.has_value()) {
-        oss << "min " << *min;
-    }
-    if (max.has_value()) {
-        oss << "max " << *max;
-    }
-    for (const auto &value : combo_values) {
-        oss << "var " << value;
-    }
-    return oss.str();
-}
-
-auto Option::type_to_string() const -> std::string {
-    switch (type) {
-    case Type::Button:
-        return "button";
-    case Type::Check:
-        return "check";
-    case Type::Combo:
-        return "combo";
-    case Type::Spin:
-        return "spin";
-    case Type::String:
-        return "string";
-    default:
-        return "<unknown>";
-    }
-}
-
-auto Option::type_from_string(const std::string &str) -> Type {
-    if (str == "button") {
-        return Type::Button;
-    } else if (str == "check") {
-        return Type::Check;
-    } else if (str == "combo") {
-        return Type::Combo;
-    } else if (str == "spin") {
-        return Type::Spin;
-    } else if (str == "string") {
-        return Type::String;
-    } else {
-        throw UCIError("unknown option type: " + str);
-    }
-}
-
-} // namespace chessuci
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/protocol.h"
+#include "chessuci/string_conversion.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace chessuci {
+
+namespace {
+
+auto add_bool_flag(std::string &line, const std::string &name, bool flag) -> void {
+    if (flag) {
+        line += " " + name;
+    }
+}
+
+template<typename T>
+auto add_optional_value(std::string &line, const std::string &name, const std::optional<T> &value) -> void {
+    if (value.has_value()) {
+        using std::to_string;
+        line += " " + name + " " + to_string(value.value());
+    }
+}
+
+template<typename T>
+auto merge_field(std::optional<T> &target, const std::optional<T> &update) -> void {
+    if (update.has_value()) {
+        target = update;
+    }
+}
+
+auto add_move_list(std::string &line, const std::vector<UCIMove> &moves, const std::string &name = "") -> void {
+    if (!moves.empty()) {
+        line += " " + name;
+    }
+    for (const auto &move : moves) {
+        line += " " + to_string(move);
+    }
+}
+
+} // namespace
+
+auto to_string(const position_command &command) -> std::string {
+    std::string message{"position "};
+    if (command.fen == position_command::startpos) {
+        message += position_command::startpos;
+    } else {
+        message += "fen " + command.fen;
+    }
+    add_move_list(message, command.moves, "moves");
+    return message;
+}
+
+const std::string position_command::startpos{"startpos"};
+
+auto to_string(const go_command &command) -> std::string {
+    std::string message{"go"};
+    add_move_list(message, command.searchmoves, "searchmoves");
+    add_bool_flag(message, "ponder", command.ponder);
+    add_optional_value(message, "wtime", command.wtime);
+    add_optional_value(message, "btime", command.btime);
+    add_optional_value(message, "winc", command.winc);
+    add_optional_value(message, "binc", command.binc);
+    add_optional_value(message, "movestogo", command.movestogo);
+    add_optional_value(message, "depth", command.depth);
+    add_optional_value(message, "nodes", command.nodes);
+    add_optional_value(message, "mate", command.mate);
+    add_optional_value(message, "movetime", command.movetime);
+    add_bool_flag(message, "infinite", command.infinite);
+
+    return message;
+}
+
+auto go_command::has_timing_control() const -> bool {
+    return wtime.has_value() || btime.has_value() || movetime.has_value() || infinite;
+}
+
+auto to_string(const search_info &info) -> std::string {
+    std::string message{"info"};
+    add_optional_value(message, "depth", info.depth);
+    add_optional_value(message, "seldepth", info.seldepth);
+    add_optional_value(message, "time", info.time);
+    add_optional_value(message, "nodes", info.nodes);
+    add_optional_value(message, "multipv", info.multipv);
+    add_optional_value(message, "score", info.score);
+    add_optional_value(message, "currmove", info.currmove);
+    add_optional_value(message, "currmovenumber", info.currmovenumber);
+    add_optional_value(message, "hashfull", info.hashfull);
+    add_optional_value(message, "nps", info.nps);
+    add_optional_value(message, "tbhits", info.tbhits);
+    add_optional_value(message, "sbhits", info.sbhits);
+    add_optional_value(message, "cpuload", info.cpuload);
+    if (!info.string.empty()) {
+        message += " string " + info.string;
+    }
+    add_move_list(message, info.pv, "pv");
+    add_move_list(message, info.refutation, "refutation");
+    add_optional_value(message, "currline", info.currline);
+    return message;
+}
+
+auto merge_info(search_info &target, const search_info &update) -> void {
+    merge_field(target.depth, update.depth);
+    merge_field(target.seldepth, update.seldepth);
+    merge_field(target.time, update.time);
+    merge_field(target.nodes, update.nodes);
+    if (!update.pv.empty()) {
+        target.pv = update.pv;
+    }
+    merge_field(target.multipv, update.multipv);
+    merge_field(target.score, update.score);
+    merge_field(target.currmove, update.currmove);
+    merge_field(target.currmovenumber, update.currmovenumber);
+    merge_field(target.hashfull, update.hashfull);
+    merge_field(target.nps, update.nps);
+    merge_field(target.tbhits, update.tbhits);
+    merge_field(target.sbhits, update.sbhits);
+    merge_field(target.cpuload, update.cpuload);
+    if (!update.string.empty()) {
+        target.string = update.string;
+    }
+    if (!update.refutation.empty()) {
+        target.refutation = update.refutation;
+    }
+    merge_field(target.currline, update.currline);
+}
+
+auto to_string(const score_info &info) -> std::string {
+    std::string message{"score"};
+    add_optional_value(message, "cp", info.cp);
+    add_optional_value(message, "mate", info.mate);
+    add_bool_flag(message, "lowerbound", info.lowerbound);
+    add_bool_flag(message, "upperbound", info.upperbound);
+    return message;
+}
+
+auto to_string(const line_info &info) -> std::string {
+    std::string message{"line"};
+    add_optional_value(message, "cpunr", info.cpunr);
+    add_move_list(message, info.line);
+    return message;
+}
+
+auto Option::to_uci_string() const -> std::string {
+    std::ostringstream oss;
+    oss << "option ";
+    oss << "name " << name;
+    oss << " type " << type_to_string();
+    if (default_value.has_value()) {
+        oss << " default " << *default_value;
+    }
+    if (min.has_value()) {
+        oss << " min " << *min;
+    }
+    if (max.has_value()) {
+        oss << " max " << *max;
+    }
+    for (const auto &value : combo_values) {
+        oss << " var " << value;
+    }
+    return oss.str();
+}
+
+auto Option::type_to_string() const -> std::string {
+    switch (type) {
+    case Type::Button:
+        return "button";
+    case Type::Check:
+        return "check";
+    case Type::Combo:
+        return "combo";
+    case Type::Spin:
+        return "spin";
+    case Type::String:
+        return "string";
+    default:
+        return "<unknown>";
+    }
+}
+
+auto Option::type_from_string(const std::string &str) -> Type {
+    const auto type = try_type_from_string(str);
+    if (!type.has_value()) {
+        throw UCIError(to_string(type.error()));
+    }
+    return type.value();
+}
+
+auto Option::accepts(const std::optional<std::string> &value) const -> bool {
+    switch (type) {
+    case Type::Button:
+        return !value.has_value();
+    case Type::Check:
+        return value == "true" || value == "false";
+    case Type::Spin: {
+        const auto number = value.has_value() ? str_to_inttype<int>(value.value()) : std::nullopt;
+        return number.has_value() && (!min.has_value() || number.value() >= min.value()) && (!max.has_value() || number.value() <= max.value());
+    }
+    case Type::Combo:
+        return value.has_value() && std::ranges::find(combo_values, value.value()) != combo_values.end();
+    case Type::String:
+        return value.has_value();
+    }
+    return false;
+}
+
+auto Option::try_type_from_string(const std::string &str) -> ParseResult<Type> {
+    if (str == "button") {
+        return Type::Button;
+    } else if (str == "check") {
+        return Type::Check;
+    } else if (str == "combo") {
+        return Type::Combo;
+    } else if (str == "spin") {
+        return Type::Spin;
+    } else if (str == "string") {
+        return Type::String;
+    } else {
+        return std::unexpected{ParseError{.type = ParseErrorType::UnknownOptionType, .token = str}};
+    }
+}
+
+auto to_string(const ParseError &error) -> std::string {
+    switch (error.type) {
+    case ParseErrorType::MissingValue:
+        return "missing value for " + error.token;
+    case ParseErrorType::InvalidInteger:
+        return "invalid integer: " + error.token;
+    case ParseErrorType::InvalidMove:
+        return "invalid move: " + error.token;
+    case ParseErrorType::UnexpectedToken:
+        return "unexpected token: " + error.token;
+    case ParseErrorType::UnknownOptionType:
+        return "unknown option type: " + error.token;
+    case ParseErrorType::InvalidOptionValue:
+        return "invalid value for option " + error.token;
+    default:
+        return "parse error: " + error.token;
+    }
+}
+
+} // namespace chessuci
@@ -0,0 +1,174 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/remote_protocol.h"
+#include "chessuci/string_conversion.h"
+
+#include <array>
+#include <utility>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::string_view tcp_prefix{"tcp://"};
+constexpr std::string_view local_prefix{"unix:"};
+constexpr char param_separator{'\t'};
+
+struct VerbName {
+    RemoteFrame::Verb verb;
+    std::string_view name;
+};
+
+constexpr std::array<VerbName, 6> verb_names{{
+    {.verb = RemoteFrame::Verb::Open, .name = "open"},
+    {.verb = RemoteFrame::Verb::Opened, .name = "opened"},
+    {.verb = RemoteFrame::Verb::Line, .name = "line"},
+    {.verb = RemoteFrame::Verb::Kill, .name = "kill"},
+    {.verb = RemoteFrame::Verb::Exited, .name = "exited"},
+    {.verb = RemoteFrame::Verb::Error, .name = "error"},
+}};
+
+auto verb_to_string(RemoteFrame::Verb verb) -> std::string_view {
+    for (const auto &entry : verb_names) {
+        if (entry.verb == verb) {
+            return entry.name;
+        }
+    }
+    return "error";
+}
+
+auto verb_from_string(std::string_view name) -> std::optional<RemoteFrame::Verb> {
+    for (const auto &entry : verb_names) {
+        if (entry.name == name) {
+            return entry.verb;
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace
+
+auto RemoteEndpoint::tcp(std::string host, std::uint16_t port) -> RemoteEndpoint {
+    return RemoteEndpoint{.kind = Kind::Tcp, .host = std::move(host), .port = port, .path = {}};
+}
+
+auto RemoteEndpoint::local(std::filesystem::path path) -> RemoteEndpoint {
+    return RemoteEndpoint{.kind = Kind::Local, .host = {}, .port = 0, .path = std::move(path)};
+}
+
+auto parse_remote_endpoint(std::string_view str) -> std::optional<RemoteEndpoint> {
+    if (str.starts_with(tcp_prefix)) {
+        str.remove_prefix(tcp_prefix.size());
+        const auto colon = str.rfind(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            return std::nullopt;
+        }
+        auto host = str.substr(0, colon);
+        if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+        const auto port = str_to_inttype<std::uint16_t>(str.substr(colon + 1));
+        if (!port.has_value()) {
+            return std::nullopt;
+        }
+        return RemoteEndpoint::tcp(std::string{host}, port.value());
+    }
+    if (str.starts_with(local_prefix)) {
+        str.remove_prefix(local_prefix.size());
+        if (str.starts_with("//")) {
+            str.remove_prefix(2);
+        }
+        if (str.empty()) {
+            return std::nullopt;
+        }
+        return RemoteEndpoint::local(std::filesystem::path{str});
+    }
+    return std::nullopt;
+}
+
+auto to_string(const RemoteEndpoint &endpoint) -> std::string {
+    if (endpoint.kind == RemoteEndpoint::Kind::Local) {
+        return std::string{local_prefix} + endpoint.path.string();
+    }
+    if (endpoint.host.find(':') != std::string::npos) {
+        return std::string{tcp_prefix} + "[" + endpoint.host + "]:" + std::to_string(endpoint.port);
+    }
+    return std::string{tcp_prefix} + endpoint.host + ":" + std::to_string(endpoint.port);
+}
+
+auto encode_frame(const RemoteFrame &frame, std::string &buffer) -> void {
+    buffer += std::to_string(frame.session);
+    buffer += ' ';
+    buffer += verb_to_string(frame.verb);
+    if (!frame.payload.empty()) {
+        buffer += ' ';
+        buffer += frame.payload;
+    }
+    buffer += '\n';
+}
+
+auto decode_frame(std::string_view line) -> std::optional<RemoteFrame> {
+    const auto session_end = line.find(' ');
+    if (session_end == std::string_view::npos) {
+        return std::nullopt;
+    }
+    const auto session = str_to_inttype<std::uint32_t>(line.substr(0, session_end));
+    if (!session.has_value()) {
+        return std::nullopt;
+    }
+    line.remove_prefix(session_end + 1);
+
+    const auto verb_end = line.find(' ');
+    const auto verb = verb_from_string(line.substr(0, verb_end));
+    if (!verb.has_value()) {
+        return std::nullopt;
+    }
+
+    RemoteFrame frame{.session = session.value(), .verb = verb.value(), .payload = {}};
+    if (verb_end != std::string_view::npos) {
+        frame.payload = line.substr(verb_end + 1);
+    }
+    return frame;
+}
+
+auto encode_process_params(const ProcessParams &params) -> std::string {
+    std::string payload{params.working_directory.has_value() ? params.working_directory->string() : std::string{}};
+    payload += param_separator;
+    payload += params.executable.string();
+    for (const auto &argument : params.arguments) {
+        payload += param_separator;
+        payload += argument;
+    }
+    return payload;
+}
+
+auto decode_process_params(std::string_view payload) -> std::optional<ProcessParams> {
+    auto next_field = [&payload]() -> std::string {
+        const auto separator = payload.find(param_separator);
+        std::string field{payload.substr(0, separator)};
+        payload = separator == std::string_view::npos ? std::string_view{} : payload.substr(separator + 1);
+        return field;
+    };
+
+    if (payload.find(param_separator) == std::string_view::npos) {
+        return std::nullopt;
+    }
+    ProcessParams params{};
+    const auto working_directory = next_field();
+    if (!working_directory.empty()) {
+        params.working_directory = working_directory;
+    }
+    params.executable = next_field();
+    if (params.executable.empty()) {
+        return std::nullopt;
+    }
+    while (!payload.empty()) {
+        params.arguments.push_back(next_field());
+    }
+    return params;
+}
+
+} // namespace chessuci
@@ -0,0 +1,211 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/socket_unix.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace chessuci {
+
+namespace {
+
+#if defined(MSG_NOSIGNAL)
+constexpr int send_flags{MSG_NOSIGNAL};
+#else
+constexpr int send_flags{0};
+#endif
+
+constexpr int listen_backlog{64};
+
+auto errno_message(const std::string &context) -> std::string {
+    return context + ": " + strerror(errno);
+}
+
+auto make_local_address(const std::filesystem::path &path, sockaddr_un &address, std::string &error) -> bool {
+    const auto &native = path.native();
+    if (native.size() >= sizeof(address.sun_path)) {
+        error = "Socket path too long: " + path.string();
+        return false;
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, native.c_str(), native.size() + 1);
+    return true;
+}
+
+auto resolve(const RemoteEndpoint &endpoint, bool passive, std::string &error) -> addrinfo * {
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    addrinfo *result{nullptr};
+    const auto port = std::to_string(endpoint.port);
+    const auto status = getaddrinfo(endpoint.host.empty() ? nullptr : endpoint.host.c_str(), port.c_str(), &hints, &result);
+    if (status != 0) {
+        error = std::string{"Failed to resolve "} + endpoint.host + ": " + gai_strerror(status);
+        return nullptr;
+    }
+    return result;
+}
+
+} // namespace
+
+auto socket_connect(const RemoteEndpoint &endpoint, std::string &error) -> int {
+    if (endpoint.kind == RemoteEndpoint::Kind::Local) {
+        sockaddr_un address{};
+        if (!make_local_address(endpoint.path, address, error)) {
+            return -1;
+        }
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd == -1) {
+            error = errno_message("Failed to create socket");
+            return -1;
+        }
+        if (connect(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == -1) {
+            error = errno_message("Failed to connect to " + to_string(endpoint));
+            close(fd);
+            return -1;
+        }
+        socket_configure(fd);
+        return fd;
+    }
+
+    auto *addresses = resolve(endpoint, false, error);
+    if (addresses == nullptr) {
+        return -1;
+    }
+    int fd{-1};
+    for (auto *address = addresses; address != nullptr; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd == -1) {
+            continue;
+        }
+        if (connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd == -1) {
+        error = errno_message("Failed to connect to " + to_string(endpoint));
+        return -1;
+    }
+    socket_configure(fd);
+    return fd;
+}
+
+auto socket_listen(const RemoteEndpoint &endpoint, RemoteEndpoint &bound, std::string &error) -> int {
+    if (endpoint.kind == RemoteEndpoint::Kind::Local) {
+        sockaddr_un address{};
+        if (!make_local_address(endpoint.path, address, error)) {
+            return -1;
+        }
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd == -1) {
+            error = errno_message("Failed to create socket");
+            return -1;
+        }
+        unlink(endpoint.path.c_str());
+        if (bind(fd, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) == -1 || listen(fd, listen_backlog) == -1) {
+            error = errno_message("Failed to listen on " + to_string(endpoint));
+            close(fd);
+            return -1;
+        }
+        bound = endpoint;
+        return fd;
+    }
+
+    auto *addresses = resolve(endpoint, true, error);
+    if (addresses == nullptr) {
+        return -1;
+    }
+    int fd{-1};
+    for (auto *address = addresses; address != nullptr; address = address->ai_next) {
+        fd = socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+        if (fd == -1) {
+            continue;
+        }
+        const int reuse{1};
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        if (bind(fd, address->ai_addr, address->ai_addrlen) == 0 && listen(fd, listen_backlog) == 0) {
+            break;
+        }
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(addresses);
+    if (fd == -1) {
+        error = errno_message("Failed to listen on " + to_string(endpoint));
+        return -1;
+    }
+
+    sockaddr_storage address{};
+    socklen_t length{sizeof(address)};
+    bound = endpoint;
+    if (getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) == 0) {
+        if (address.ss_family == AF_INET) {
+            bound.port = ntohs(reinterpret_cast<const sockaddr_in *>(&address)->sin_port);
+        } else if (address.ss_family == AF_INET6) {
+            bound.port = ntohs(reinterpret_cast<const sockaddr_in6 *>(&address)->sin6_port);
+        }
+    }
+    return fd;
+}
+
+auto socket_configure(int fd) -> void {
+    sockaddr_storage address{};
+    socklen_t length{sizeof(address)};
+    if (getsockname(fd, reinterpret_cast<sockaddr *>(&address), &length) == 0 && (address.ss_family == AF_INET || address.ss_family == AF_INET6)) {
+        const int no_delay{1};
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    }
+#if defined(SO_NOSIGPIPE)
+    const int no_sigpipe{1};
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif
+}
+
+auto socket_send_all(int fd, std::string_view data) -> bool {
+    while (!data.empty()) {
+        const auto written = send(fd, data.data(), data.size(), send_flags);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data.remove_prefix(static_cast<std::size_t>(written));
+    }
+    return true;
+}
+
+auto socket_send_some(int fd, std::string_view data) -> long {
+    std::size_t total{0};
+    while (total < data.size()) {
+        const auto written = send(fd, data.data() + total, data.size() - total, send_flags);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            return -1;
+        }
+        total += static_cast<std::size_t>(written);
+    }
+    return static_cast<long>(total);
+}
+
+} // namespace chessuci
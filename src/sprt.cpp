@@ -0,0 +1,139 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/sprt.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace chessuci {
+
+namespace {
+
+constexpr double elo_scale{400.0};
+constexpr double quantile_95{1.959963984540054};
+constexpr int max_half_points{4};
+// lower bound of the pair score variance, so the LLR moves while all pairs
+// scored the same; well below the variance of real matches, but large enough
+// that a few identical pairs do not decide the test
+constexpr double min_variance{1e-2};
+constexpr double score_epsilon{1e-6};
+
+auto expected_score(double elo) -> double {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / elo_scale));
+}
+
+auto score_to_elo(double score) -> double {
+    // a perfect score is infinitely many Elo, report a large finite value instead
+    score = std::clamp(score, score_epsilon, 1.0 - score_epsilon);
+    return -elo_scale * std::log10(1.0 / score - 1.0);
+}
+
+} // namespace
+
+auto to_string(SprtDecision decision) -> std::string {
+    switch (decision) {
+    case SprtDecision::Continue:
+        return "continue";
+    case SprtDecision::AcceptH0:
+        return "H0 accepted";
+    case SprtDecision::AcceptH1:
+        return "H1 accepted";
+    }
+    return {};
+}
+
+Sprt::Sprt(SprtSettings settings) : m_settings{settings} {}
+
+auto Sprt::add_pair(int half_points) -> SprtDecision {
+    if (half_points >= 0 && half_points <= max_half_points) {
+        ++m_pentanomial[static_cast<std::size_t>(half_points)];
+    }
+    return decision();
+}
+
+auto Sprt::add_pair(double first_score, double second_score) -> SprtDecision {
+    return add_pair(static_cast<int>(std::lround(2.0 * (first_score + second_score))));
+}
+
+auto Sprt::decision() const -> SprtDecision {
+    const auto ratio = llr();
+    if (ratio >= upper_bound()) {
+        return SprtDecision::AcceptH1;
+    }
+    if (ratio <= lower_bound()) {
+        return SprtDecision::AcceptH0;
+    }
+    return SprtDecision::Continue;
+}
+
+auto Sprt::llr() const -> double {
+    if (pairs() == 0) {
+        return 0.0;
+    }
+    const auto [mean, sample_variance] = mean_and_variance();
+    const auto variance = std::max(sample_variance, min_variance);
+    const auto score0 = expected_score(m_settings.elo0);
+    const auto score1 = expected_score(m_settings.elo1);
+    return static_cast<double>(pairs()) * (score1 - score0) * (2.0 * mean - score0 - score1) / (2.0 * variance);
+}
+
+auto Sprt::lower_bound() const -> double {
+    return std::log(m_settings.beta / (1.0 - m_settings.alpha));
+}
+
+auto Sprt::upper_bound() const -> double {
+    return std::log((1.0 - m_settings.beta) / m_settings.alpha);
+}
+
+auto Sprt::elo() const -> EloEstimate {
+    const auto count = pairs();
+    if (count == 0) {
+        return EloEstimate{};
+    }
+    const auto [mean, variance] = mean_and_variance();
+    const auto deviation = quantile_95 * std::sqrt(variance / static_cast<double>(count));
+    return EloEstimate{.elo = score_to_elo(mean), .lower = score_to_elo(mean - deviation), .upper = score_to_elo(mean + deviation)};
+}
+
+auto Sprt::pairs() const -> std::uint64_t {
+    std::uint64_t count{0};
+    for (const auto pair_count : m_pentanomial) {
+        count += pair_count;
+    }
+    return count;
+}
+
+auto Sprt::summary() const -> std::string {
+    const auto estimate = elo();
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(2) << "LLR " << llr() << " (" << lower_bound() << ", " << upper_bound() << ") [" << m_settings.elo0 << ", "
+           << m_settings.elo1 << "] Elo " << std::setprecision(1) << estimate.elo << " +/- " << (estimate.upper - estimate.lower) / 2.0 << " pairs " << pairs()
+           << " (" << m_pentanomial[0] << ", " << m_pentanomial[1] << ", " << m_pentanomial[2] << ", " << m_pentanomial[3] << ", " << m_pentanomial[4] << ") "
+           << to_string(decision());
+    return stream.str();
+}
+
+auto Sprt::mean_and_variance() const -> std::pair<double, double> {
+    const auto count = static_cast<double>(pairs());
+    if (count == 0.0) {
+        return {0.0, 0.0};
+    }
+    double mean{0.0};
+    for (std::size_t index = 0; index < m_pentanomial.size(); ++index) {
+        mean += static_cast<double>(m_pentanomial[index]) * static_cast<double>(index) / max_half_points;
+    }
+    mean /= count;
+    double variance{0.0};
+    for (std::size_t index = 0; index < m_pentanomial.size(); ++index) {
+        const auto deviation = static_cast<double>(index) / max_half_points - mean;
+        variance += static_cast<double>(m_pentanomial[index]) * deviation * deviation;
+    }
+    return {mean, variance / count};
+}
+
+} // namespace chessuci
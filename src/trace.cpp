@@ -0,0 +1,188 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+namespace chessuci {
+
+namespace {
+
+// ring buffer with a single producer, the owning thread
+struct ThreadBuffer {
+    ThreadBuffer(std::size_t capacity, std::uint64_t trace_generation) : events(capacity), generation{trace_generation} {}
+
+    std::vector<TraceEvent> events;
+    std::atomic<std::uint64_t> written{0};
+    std::uint64_t generation;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::map<std::uint64_t, std::string> track_names;
+    std::size_t capacity{1};
+    std::atomic<std::uint64_t> generation{0};
+    std::atomic<std::int64_t> epoch{0};
+};
+
+// never destroyed, threads may still record while static objects are destroyed
+auto registry() -> Registry & {
+    static auto *instance = new Registry{};
+    return *instance;
+}
+
+auto now_nanoseconds() -> std::int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// buffers of an earlier trace are replaced on the next event
+auto thread_buffer() -> ThreadBuffer & {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    auto &instance = registry();
+    if (!buffer || buffer->generation != instance.generation.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock{instance.mutex};
+        buffer = std::make_shared<ThreadBuffer>(instance.capacity, instance.generation);
+        instance.buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+auto write_json_string(std::ostream &stream, std::string_view text) -> void {
+    stream << '"';
+    for (const auto chr : text) {
+        switch (chr) {
+        case '"':
+            stream << "\\\"";
+            break;
+        case '\\':
+            stream << "\\\\";
+            break;
+        default:
+            if (static_cast<unsigned char>(chr) < 0x20) {
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(chr) << std::dec;
+            } else {
+                stream << chr;
+            }
+        }
+    }
+    stream << '"';
+}
+
+} // namespace
+
+auto Trace::start(std::size_t capacity) -> void {
+    auto &instance = registry();
+    {
+        std::lock_guard<std::mutex> lock{instance.mutex};
+        instance.buffers.clear();
+        instance.capacity = std::max(capacity, std::size_t{1});
+        instance.epoch = now_nanoseconds();
+        ++instance.generation;
+    }
+    m_enabled = true;
+}
+
+auto Trace::stop() -> void {
+    m_enabled = false;
+}
+
+auto Trace::write(std::uint64_t track, const char *name, TracePhase phase, std::string_view detail) -> void {
+    auto &buffer = thread_buffer();
+    const auto index = buffer.written.load(std::memory_order_relaxed);
+    auto &event = buffer.events[index % buffer.events.size()];
+    event.timestamp = now_nanoseconds() - registry().epoch.load(std::memory_order_relaxed);
+    event.track = track;
+    event.name = name;
+    event.phase = phase;
+    const auto size = std::min(detail.size(), event.detail.size() - 1);
+    std::copy_n(detail.begin(), size, event.detail.begin());
+    event.detail[size] = '\0';
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+auto Trace::name_track(std::uint64_t track, std::string name) -> void {
+    auto &instance = registry();
+    std::lock_guard<std::mutex> lock{instance.mutex};
+    instance.track_names[track] = std::move(name);
+}
+
+auto Trace::events() -> std::vector<TraceEvent> {
+    std::vector<TraceEvent> events;
+    {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> lock{instance.mutex};
+        for (const auto &buffer : instance.buffers) {
+            const auto written = buffer->written.load(std::memory_order_acquire);
+            const auto capacity = buffer->events.size();
+            for (auto index = written > capacity ? written - capacity : 0; index < written; ++index) {
+                events.push_back(buffer->events[index % capacity]);
+            }
+        }
+    }
+    std::ranges::stable_sort(events, {}, &TraceEvent::timestamp);
+    return events;
+}
+
+auto Trace::to_json() -> std::string {
+    const auto trace_events = events();
+    std::map<std::uint64_t, std::string> track_names;
+    {
+        auto &instance = registry();
+        std::lock_guard<std::mutex> lock{instance.mutex};
+        track_names = instance.track_names;
+    }
+
+    std::ostringstream stream;
+    stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first{true};
+    std::set<std::uint64_t> tracks;
+    for (const auto &event : trace_events) {
+        tracks.insert(event.track);
+    }
+    for (const auto track : tracks) {
+        const auto name_it = track_names.find(track);
+        stream << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << track << ",\"args\":{\"name\":";
+        write_json_string(stream, name_it != track_names.end() ? name_it->second : "track " + std::to_string(track));
+        stream << "}}";
+        first = false;
+    }
+    for (const auto &event : trace_events) {
+        stream << (first ? "" : ",") << "\n{\"name\":";
+        write_json_string(stream, event.name != nullptr ? event.name : "");
+        stream << ",\"ph\":\"" << static_cast<char>(event.phase) << '"';
+        if (event.phase == TracePhase::Instant) {
+            stream << ",\"s\":\"t\"";
+        }
+        stream << ",\"ts\":" << event.timestamp / 1000 << '.' << std::setw(3) << std::setfill('0') << event.timestamp % 1000;
+        stream << ",\"pid\":0,\"tid\":" << event.track;
+        if (event.detail[0] != '\0') {
+            stream << ",\"args\":{\"detail\":";
+            write_json_string(stream, event.detail.data());
+            stream << '}';
+        }
+        stream << '}';
+        first = false;
+    }
+    stream << "\n]}\n";
+    return stream.str();
+}
+
+auto Trace::write_file(const std::filesystem::path &path) -> bool {
+    std::ofstream stream{path, std::ios::trunc | std::ios::binary};
+    stream << to_json();
+    return static_cast<bool>(stream.flush());
+}
+
+} // namespace chessuci
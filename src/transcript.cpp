@@ -0,0 +1,140 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/transcript.h"
+
+#include <algorithm>
+#include <array>
+
+namespace chessuci {
+
+namespace {
+
+constexpr std::array<char, 8> transcript_magic{'C', 'U', 'C', 'I', 'T', 'R', 'C', '\x01'};
+constexpr std::uint8_t varint_continuation{0x80};
+constexpr std::uint8_t varint_payload{0x7f};
+constexpr unsigned varint_shift{7};
+constexpr unsigned max_varint_shift{63};
+constexpr std::uint64_t max_line_length{16 * 1024 * 1024}; // far above any UCI line, bounds the allocation of a corrupt record
+
+auto append_varint(std::string &buffer, std::uint64_t value) -> void {
+    while (value >= varint_continuation) {
+        buffer += static_cast<char>((value & varint_payload) | varint_continuation);
+        value >>= varint_shift;
+    }
+    buffer += static_cast<char>(value);
+}
+
+auto read_varint(std::istream &stream, std::uint64_t &value) -> bool {
+    value = 0;
+    for (unsigned shift = 0; shift <= max_varint_shift; shift += varint_shift) {
+        const auto byte = stream.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<std::uint64_t>(byte & varint_payload) << shift;
+        if ((byte & varint_continuation) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TranscriptWriter::TranscriptWriter(const std::filesystem::path &path)
+    : m_stream{path, std::ios::binary | std::ios::trunc}, m_start{std::chrono::steady_clock::now()} {
+    m_stream.write(transcript_magic.data(), transcript_magic.size());
+}
+
+auto TranscriptWriter::append(TranscriptDirection direction, std::string_view line) -> void {
+    const auto timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start);
+    std::lock_guard<std::mutex> lock{m_mutex};
+    write_record(direction, timestamp, line);
+}
+
+auto TranscriptWriter::append(const TranscriptEntry &entry) -> void {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    write_record(entry.direction, entry.timestamp, entry.line);
+}
+
+auto TranscriptWriter::flush() -> void {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    m_stream.flush();
+}
+
+auto TranscriptWriter::write_record(TranscriptDirection direction, std::chrono::nanoseconds timestamp, std::string_view line) -> void {
+    const auto delta = std::max(timestamp - m_last_timestamp, std::chrono::nanoseconds{0});
+    m_last_timestamp += delta;
+
+    m_record.clear();
+    m_record += static_cast<char>(direction);
+    append_varint(m_record, static_cast<std::uint64_t>(delta.count()));
+    append_varint(m_record, line.size());
+    m_record += line;
+    m_stream.write(m_record.data(), static_cast<std::streamsize>(m_record.size()));
+}
+
+TranscriptReader::TranscriptReader(const std::filesystem::path &path) : m_stream{path, std::ios::binary} {
+    std::error_code error;
+    const auto file_size = std::filesystem::file_size(path, error);
+    m_file_size = error ? 0 : file_size;
+    std::array<char, transcript_magic.size()> header{};
+    m_stream.read(header.data(), header.size());
+    m_valid = m_stream.good() && header == transcript_magic;
+}
+
+auto TranscriptReader::next(TranscriptEntry &entry) -> bool {
+    if (!m_valid) {
+        return false;
+    }
+    const auto direction = m_stream.get();
+    if (direction == std::char_traits<char>::eof()) {
+        return false;
+    }
+    if (direction != static_cast<int>(TranscriptDirection::ToEngine) && direction != static_cast<int>(TranscriptDirection::FromEngine)) {
+        m_corrupt = true;
+        return false;
+    }
+    std::uint64_t delta{0};
+    std::uint64_t length{0};
+    if (!read_varint(m_stream, delta) || !read_varint(m_stream, length)) {
+        m_corrupt = true;
+        return false;
+    }
+    // the length is checked before anything is allocated for the line
+    const auto position = static_cast<std::uint64_t>(std::max<std::streamoff>(m_stream.tellg(), 0));
+    const auto remaining = m_file_size > position ? m_file_size - position : 0;
+    if (length > max_line_length || length > remaining) {
+        m_corrupt = true;
+        return false;
+    }
+    std::string line(length, '\0');
+    if (!m_stream.read(line.data(), static_cast<std::streamsize>(length))) {
+        m_corrupt = true;
+        return false;
+    }
+
+    m_last_timestamp += std::chrono::nanoseconds{static_cast<std::chrono::nanoseconds::rep>(delta)};
+    entry.direction = static_cast<TranscriptDirection>(direction);
+    entry.timestamp = m_last_timestamp;
+    entry.line = std::move(line);
+    return true;
+}
+
+auto TranscriptReader::read_all(const std::filesystem::path &path) -> std::optional<std::vector<TranscriptEntry>> {
+    TranscriptReader reader{path};
+    if (!reader.is_open()) {
+        return std::nullopt;
+    }
+    std::vector<TranscriptEntry> entries;
+    TranscriptEntry entry;
+    while (reader.next(entry)) {
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+} // namespace chessuci
@@ -1,63 +1,117 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#include "chessuci/uci_handler.h"
-
-#include <ranges>
-#include <sstream>
-
-namespace chessuci {
-
-auto UCIHandler::register_command(const std::string &command, CustomCommandCallback callback) -> void {
-    std::lock_guard<std::mutex> lock{m_custom_commands_mutex};
-    m_custom_commands[command] = std::move(callback);
-}
-
-auto UCIHandler::unregister_command(const std::string &command) -> void {
-    std::lock_guard<std::mutex> lock{m_custom_commands_mutex};
-    m_custom_commands.erase(command);
-}
-
-auto UCIHandler::process_line(const std::string &line) -> void {
-    const auto tokens = tokenize(line);
-    if (tokens.empty()) {
-        return;
-    }
-    const auto &command = tokens[0];
-    const auto command_it = m_uci_commands.find(command);
-    if (command_it != m_uci_commands.end()) {
-        command_it->second(tokens);
-        return;
-    }
-
-    {
-        std::lock_guard<std::mutex> lock{m_custom_commands_mutex};
-        auto custom_it = m_custom_commands.find(command);
-        if (custom_it != m_custom_commands.end()) {
-            custom_it->second(tokens);
-            return;
-        }
-    }
-
-    call(m_unknown_command_callback, tokens);
-}
-
-auto UCIHandler::strip_trailing_whitespace(std::string &line) -> void {
-    line.erase(std::ranges::find_if(std::ranges::reverse_view(line), [](int chr) { return !std::isspace(chr); }).base(), line.end());
-}
-
-auto UCIHandler::tokenize(const std::string &line) -> std::vector<std::string> {
-    std::vector<std::string> tokens;
-    std::istringstream iss(line);
-    std::string token;
-
-    while (iss >> token) {
-        tokens.push_back(token);
-    }
-
-    return tokens;
-}
-
-} // namespace chessuci
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/uci_handler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <ranges>
+
+namespace chessuci {
+
+auto UCIHandler::register_command(const std::string &command, CustomCommandCallback callback) -> void {
+    std::lock_guard<std::mutex> lock{m_custom_commands_mutex};
+    m_custom_commands[command] = std::move(callback);
+}
+
+auto UCIHandler::unregister_command(const std::string &command) -> void {
+    std::lock_guard<std::mutex> lock{m_custom_commands_mutex};
+    m_custom_commands.erase(command);
+}
+
+auto UCIHandler::process_line(const std::string &line) -> void {
+    // a line processed by a callback must not overwrite the tokens of the outer line
+    if (m_processing) {
+        process_tokens(line, tokenize(line));
+        return;
+    }
+    m_processing = true;
+    try {
+        tokenize(line, m_tokens);
+        process_tokens(line, m_tokens.tokens);
+    } catch (...) {
+        m_processing = false;
+        throw;
+    }
+    m_processing = false;
+}
+
+auto UCIHandler::process_tokens(const std::string &line, const TokenList &tokens) -> void {
+    if (tokens.empty()) {
+        return;
+    }
+    Metrics::count_received(tokens[0]);
+    Trace::record(m_trace_track, "received", TracePhase::Instant, line);
+    Trace::record(m_trace_track, "handle", TracePhase::Begin, tokens[0]);
+    const auto start = std::chrono::steady_clock::now();
+    dispatch(tokens);
+    Trace::record(m_trace_track, "handle", TracePhase::End);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    Metrics::add(Metric::CallbackNanoseconds, static_cast<std::uint64_t>(elapsed.count()));
+}
+
+auto UCIHandler::dispatch(const TokenList &tokens) -> void {
+    const auto &command = tokens[0];
+    const auto command_it = m_uci_commands.find(command);
+    if (command_it != m_uci_commands.end()) {
+        command_it->second(tokens);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock{m_custom_commands_mutex};
+        auto custom_it = m_custom_commands.find(command);
+        if (custom_it != m_custom_commands.end()) {
+            custom_it->second(tokens);
+            return;
+        }
+    }
+
+    Metrics::add(Metric::UnknownCommands);
+    call(m_unknown_command_callback, tokens);
+}
+
+auto UCIHandler::strip_trailing_whitespace(std::string &line) -> void {
+    line.erase(std::ranges::find_if(std::ranges::reverse_view(line), [](int chr) { return !std::isspace(chr); }).base(), line.end());
+}
+
+auto UCIHandler::tokenize(const std::string &line) -> std::vector<std::string> {
+    TokenBuffer buffer;
+    tokenize(line, buffer);
+    return std::move(buffer.tokens);
+}
+
+auto UCIHandler::tokenize(std::string_view line, TokenBuffer &buffer) -> void {
+    // the characters that std::isspace() accepts in the "C" locale
+    constexpr std::string_view whitespace{" \t\n\v\f\r"};
+    auto &tokens = buffer.tokens;
+    std::size_t count{0};
+    std::size_t position{0};
+    while (true) {
+        const auto first = line.find_first_not_of(whitespace, position);
+        if (first == std::string_view::npos) {
+            break;
+        }
+        position = std::min(line.find_first_of(whitespace, first), line.size());
+        const auto token = line.substr(first, position - first);
+        if (count == tokens.size()) {
+            if (buffer.spare.empty()) {
+                tokens.emplace_back();
+            } else {
+                tokens.push_back(std::move(buffer.spare.back()));
+                buffer.spare.pop_back();
+            }
+        }
+        tokens[count].assign(token);
+        ++count;
+    }
+    // unused strings keep their capacity for longer lines
+    while (tokens.size() > count) {
+        buffer.spare.push_back(std::move(tokens.back()));
+        tokens.pop_back();
+    }
+}
+
+} // namespace chessuci
@@ -0,0 +1,207 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/watchdog.h"
+
+#include <algorithm>
+
+namespace chessuci {
+
+namespace {
+
+auto with_valid_resolution(WatchdogSettings settings) -> WatchdogSettings {
+    settings.resolution = std::max(settings.resolution, std::chrono::milliseconds{1});
+    return settings;
+}
+
+auto add_overrun(WatchdogStatistics &statistics, std::chrono::steady_clock::duration overrun) -> void {
+    const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(overrun);
+    ++statistics.overruns;
+    statistics.total_overrun += milliseconds;
+    statistics.max_overrun = std::max(statistics.max_overrun, milliseconds);
+}
+
+} // namespace
+
+Watchdog::Watchdog(WatchdogSettings settings)
+    : m_settings{with_valid_resolution(settings)}, m_start{clock::now()}, m_wheel(wheel_size), m_thread{[this] -> void { run(); }} {}
+
+Watchdog::~Watchdog() {
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_running = false;
+    }
+    m_condition.notify_all();
+    m_thread.join();
+}
+
+auto Watchdog::watch(const std::string &engine, std::optional<std::chrono::milliseconds> duration, Actions actions) -> Id {
+    const auto now = clock::now();
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto id = m_next_id++;
+    ++m_statistics[engine].searches;
+    auto &search = m_searches[id];
+    search.engine = engine;
+    search.actions = std::move(actions);
+    if (duration.has_value()) {
+        search.expected_end = now + duration.value();
+        schedule(id, search, search.expected_end.value() + m_settings.grace);
+    }
+    return id;
+}
+
+auto Watchdog::stopped(Id id) -> void {
+    const auto now = clock::now();
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto search_it = m_searches.find(id);
+    if (search_it != m_searches.end() && search_it->second.stage == Stage::Running) {
+        search_it->second.stage = Stage::Stopped;
+        schedule(id, search_it->second, now + m_settings.terminate_after);
+    }
+}
+
+auto Watchdog::complete(Id id) -> void {
+    const auto now = clock::now();
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto search_it = m_searches.find(id);
+    if (search_it == m_searches.end()) {
+        return;
+    }
+    const auto &search = search_it->second;
+    if (search.expected_end.has_value() && now > search.expected_end.value()) {
+        add_overrun(m_statistics[search.engine], now - search.expected_end.value());
+    }
+    m_searches.erase(search_it);
+}
+
+auto Watchdog::cancel(Id id) -> void {
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_searches.erase(id);
+    }
+    // an action of the search may have been collected before it was erased
+    std::lock_guard<std::mutex> action_lock{m_action_mutex};
+}
+
+auto Watchdog::expected_duration(const go_command &command) const -> std::optional<std::chrono::milliseconds> {
+    if (command.ponder || command.infinite) {
+        return std::nullopt;
+    }
+    if (command.movetime.has_value()) {
+        return std::chrono::milliseconds{command.movetime.value()};
+    }
+    if (command.wtime.has_value() || command.btime.has_value()) {
+        const auto time = std::max(command.wtime.value_or(0), command.btime.value_or(0));
+        const auto increment = std::max(command.winc.value_or(0), command.binc.value_or(0));
+        return std::chrono::milliseconds{time + increment};
+    }
+    if (m_settings.default_budget.count() > 0) {
+        return m_settings.default_budget;
+    }
+    return std::nullopt;
+}
+
+auto Watchdog::statistics(const std::string &engine) const -> WatchdogStatistics {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    const auto statistics_it = m_statistics.find(engine);
+    return statistics_it != m_statistics.end() ? statistics_it->second : WatchdogStatistics{};
+}
+
+auto Watchdog::statistics() const -> std::map<std::string, WatchdogStatistics> {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_statistics;
+}
+
+auto Watchdog::pending() const -> std::size_t {
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_searches.size();
+}
+
+auto Watchdog::tick_of(clock::time_point time) const -> std::uint64_t {
+    const auto elapsed = std::max(time - m_start, clock::duration::zero());
+    const clock::duration resolution{m_settings.resolution};
+    return static_cast<std::uint64_t>((elapsed + resolution - clock::duration{1}) / resolution);
+}
+
+auto Watchdog::schedule(Id id, Search &search, clock::time_point deadline) -> void {
+    // an earlier slot reference of the search is skipped by its generation
+    search.deadline = std::max(tick_of(deadline), m_tick + 1);
+    ++search.generation;
+    m_wheel[search.deadline % wheel_size].push_back(Slot{.id = id, .generation = search.generation});
+}
+
+auto Watchdog::advance(std::uint64_t tick, std::vector<std::function<void()>> &actions) -> void {
+    auto &slot = m_wheel[tick % wheel_size];
+    std::vector<Slot> entries;
+    entries.swap(slot);
+    const auto now = m_start + tick * m_settings.resolution;
+    for (const auto &entry : entries) {
+        const auto search_it = m_searches.find(entry.id);
+        if (search_it == m_searches.end() || search_it->second.generation != entry.generation) {
+            continue;
+        }
+        auto &search = search_it->second;
+        if (search.deadline > tick) {
+            // due in a later rotation of the wheel
+            slot.push_back(entry);
+            continue;
+        }
+        auto &statistics = m_statistics[search.engine];
+        switch (search.stage) {
+        case Stage::Running:
+            ++statistics.stops;
+            actions.push_back(search.actions.stop);
+            search.stage = Stage::Stopped;
+            schedule(entry.id, search, now + m_settings.terminate_after);
+            break;
+        case Stage::Stopped:
+            ++statistics.terminations;
+            actions.push_back(search.actions.terminate);
+            search.stage = Stage::Terminated;
+            schedule(entry.id, search, now + m_settings.kill_after);
+            break;
+        case Stage::Terminated:
+            ++statistics.kills;
+            actions.push_back(search.actions.kill);
+            if (search.expected_end.has_value()) {
+                add_overrun(statistics, now - search.expected_end.value());
+            }
+            m_searches.erase(search_it);
+            break;
+        }
+    }
+}
+
+auto Watchdog::run() -> void {
+    std::vector<std::function<void()>> actions;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            const auto next_tick = m_start + (m_tick + 1) * m_settings.resolution;
+            if (m_condition.wait_until(lock, next_tick, [this] -> bool { return !m_running; })) {
+                return;
+            }
+        }
+
+        std::lock_guard<std::mutex> action_lock{m_action_mutex};
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            const auto elapsed = clock::now() - m_start;
+            const auto current = static_cast<std::uint64_t>(elapsed / clock::duration{m_settings.resolution});
+            while (m_tick < current) {
+                ++m_tick;
+                advance(m_tick, actions);
+            }
+        }
+        for (const auto &action : actions) {
+            if (action) {
+                action();
+            }
+        }
+        actions.clear();
+    }
+}
+
+} // namespace chessuci
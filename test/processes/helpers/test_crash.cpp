@@ -1,16 +1,16 @@
-#include <chrono>
-#include <cstdlib>
-#include <thread>
-
-auto main(int argc, char *argv[]) -> int {
-    int delay_ms = 100;
-    if (argc > 1) {
-        delay_ms = std::atoi(argv[1]);
-    }
-
-    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-
-    std::abort();
-
-    return 1;
-}
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+auto main(int argc, char *argv[]) -> int {
+    int delay_ms = 100;
+    if (argc > 1) {
+        delay_ms = std::atoi(argv[1]);
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+
+    std::abort();
+
+    return 1;
+}
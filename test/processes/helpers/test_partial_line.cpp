@@ -0,0 +1,15 @@
+#include <iostream>
+#include <string>
+
+// writes the start of a line and completes it with the first line of input
+auto main() -> int {
+    std::cout << "partial" << std::flush;
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line == "quit") {
+            break;
+        }
+        std::cout << ' ' << line << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include "chessuci/engine_host.h"
+#include "chessuci/engine_process_socket.h"
+#include "chessuci/process_factory.h"
+#include <atomic>
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+inline auto get_test_binary_path(const std::string &name) -> std::string {
+    fs::path binary_dir(TEST_BINARY_DIR);
+    fs::path binary = binary_dir / name;
+    return binary.string();
+}
+
+class RunningHost {
+public:
+    RunningHost(const chessuci::RemoteEndpoint &endpoint, const std::vector<std::string> &executables) : m_host{endpoint} {
+        for (const auto &executable : executables) {
+            m_host.allow_executable(get_test_binary_path(executable));
+        }
+        REQUIRE(m_host.listen());
+        m_thread = std::thread([this] { m_host.run(); });
+    }
+    ~RunningHost() {
+        m_host.stop();
+        m_thread.join();
+    }
+
+    RunningHost(const RunningHost &) = delete;
+    auto operator=(const RunningHost &) -> RunningHost & = delete;
+
+    auto host() -> chessuci::EngineHost & { return m_host; }
+    auto endpoint() const -> const chessuci::RemoteEndpoint & { return m_host.bound_endpoint(); }
+private:
+    chessuci::EngineHost m_host;
+    std::thread m_thread;
+};
+
+auto local_socket_path(const std::string &name) -> fs::path {
+    return fs::temp_directory_path() / (name + "_" + std::to_string(getpid()) + ".sock");
+}
+
+} // namespace
+
+TEST_CASE("RemoteProcessTests.Echo over Unix-domain socket", "[process][remote]") {
+    RunningHost host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_echo")), {"test_line_echo"}};
+
+    auto process = chessuci::ProcessFactory::create_remote(host.endpoint());
+    REQUIRE(process);
+    REQUIRE(process->start({get_test_binary_path("test_line_echo")}));
+    REQUIRE(process->is_running());
+    REQUIRE(process->pid() > 0);
+
+    REQUIRE(process->write_line("hello"));
+    REQUIRE(process->write_line("position startpos moves e2e4"));
+    std::string line;
+    REQUIRE(process->read_line(line));
+    CHECK(line == "hello");
+    REQUIRE(process->read_line(line));
+    CHECK(line == "position startpos moves e2e4");
+
+    REQUIRE(process->terminate(5000));
+    REQUIRE_FALSE(process->is_running());
+    CHECK(process->wait_for_exit(0) == 0);
+}
+
+TEST_CASE("RemoteProcessTests.Multiplexed sessions over TCP", "[process][remote]") {
+    RunningHost host{chessuci::RemoteEndpoint::tcp("127.0.0.1", 0), {"test_line_echo"}};
+    REQUIRE(host.endpoint().port != 0);
+
+    auto connection = std::make_shared<chessuci::RemoteConnection>(host.endpoint());
+    REQUIRE(connection->connect());
+
+    constexpr int engine_count{16};
+    std::vector<std::unique_ptr<chessuci::EngineProcess>> processes;
+    for (int index = 0; index < engine_count; ++index) {
+        processes.push_back(connection->create_process());
+        REQUIRE(processes.back()->start({get_test_binary_path("test_line_echo")}));
+    }
+    CHECK(host.host().session_count() == engine_count);
+
+    for (int index = 0; index < engine_count; ++index) {
+        REQUIRE(processes[static_cast<std::size_t>(index)]->write_line("engine " + std::to_string(index)));
+    }
+    for (int index = 0; index < engine_count; ++index) {
+        std::string line;
+        REQUIRE(processes[static_cast<std::size_t>(index)]->read_line(line));
+        CHECK(line == "engine " + std::to_string(index));
+    }
+
+    for (auto &process : processes) {
+        REQUIRE(process->terminate(5000));
+    }
+}
+
+TEST_CASE("RemoteProcessTests.Output flood is relayed completely", "[process][remote][stress]") {
+    RunningHost host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_flood")), {"test_output_flood"}};
+
+    auto process = chessuci::ProcessFactory::create_remote(host.endpoint());
+    REQUIRE(process->start({get_test_binary_path("test_output_flood"), {"1000"}}));
+
+    int lines_read = 0;
+    std::string line;
+    while (process->read_line(line)) {
+        ++lines_read;
+        REQUIRE(line.find("Line") != std::string::npos);
+    }
+    CHECK(lines_read == 1000);
+    CHECK(process->wait_for_exit(1000) == 0);
+}
+
+TEST_CASE("RemoteProcessTests.Remote crash and kill are detected", "[process][remote][crash]") {
+    RunningHost host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_crash")), {"test_crash", "test_hang"}};
+
+    auto crashing = chessuci::ProcessFactory::create_remote(host.endpoint());
+    REQUIRE(crashing->start({get_test_binary_path("test_crash"), {"200"}}));
+    const auto exit_code = crashing->wait_for_exit(5000);
+    REQUIRE(exit_code.has_value());
+    CHECK(*exit_code != 0);
+    CHECK_FALSE(crashing->is_running());
+
+    auto hanging = chessuci::ProcessFactory::create_remote(host.endpoint());
+    REQUIRE(hanging->start({get_test_binary_path("test_hang")}));
+    REQUIRE_FALSE(hanging->terminate(100));
+    hanging->kill();
+    CHECK_FALSE(hanging->is_running());
+}
+
+TEST_CASE("RemoteProcessTests.Executables can be restricted", "[process][remote][error]") {
+    RunningHost host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_allow")), {"test_line_echo"}};
+
+    auto process = chessuci::ProcessFactory::create_remote(host.endpoint());
+    REQUIRE_FALSE(process->start({get_test_binary_path("test_hang")}));
+    CHECK_FALSE(process->last_error().empty());
+    REQUIRE(process->start({get_test_binary_path("test_line_echo")}));
+    REQUIRE(process->terminate(5000));
+
+    // a host without allowed executables does not start
+    chessuci::EngineHost open_host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_open"))};
+    CHECK_FALSE(open_host.listen());
+    CHECK_FALSE(open_host.last_error().empty());
+}
+
+TEST_CASE("RemoteProcessTests.Partial lines do not stall other sessions", "[process][remote]") {
+    RunningHost host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_partial")), {"test_partial_line", "test_line_echo"}};
+    auto connection = std::make_shared<chessuci::RemoteConnection>(host.endpoint());
+    REQUIRE(connection->connect());
+
+    auto partial = connection->create_process();
+    REQUIRE(partial->start({get_test_binary_path("test_partial_line")}));
+    auto echo = connection->create_process();
+    REQUIRE(echo->start({get_test_binary_path("test_line_echo")}));
+
+    // the partial line is pending while the echo engine is served
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    for (int index = 0; index < 10; ++index) {
+        REQUIRE(echo->write_line("ping " + std::to_string(index)));
+        std::string line;
+        REQUIRE(echo->read_line(line));
+        CHECK(line == "ping " + std::to_string(index));
+    }
+
+    REQUIRE(partial->write_line("line"));
+    std::string line;
+    REQUIRE(partial->read_line(line));
+    CHECK(line == "partial line");
+
+    REQUIRE(partial->terminate(5000));
+    REQUIRE(echo->terminate(5000));
+    CHECK(partial->wait_for_exit(0) == 0);
+}
+
+TEST_CASE("RemoteProcessTests.An engine that does not read does not stall other sessions", "[process][remote]") {
+    RunningHost host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_stalled")), {"test_hang", "test_line_echo"}};
+    auto connection = std::make_shared<chessuci::RemoteConnection>(host.endpoint());
+    REQUIRE(connection->connect());
+
+    auto hanging = connection->create_process();
+    REQUIRE(hanging->start({get_test_binary_path("test_hang")}));
+    auto echo = connection->create_process();
+    REQUIRE(echo->start({get_test_binary_path("test_line_echo")}));
+
+    // more than the pipe of the hanging engine can take
+    const std::string filler(4096, 'x');
+    for (int index = 0; index < 64; ++index) {
+        REQUIRE(hanging->write_line(filler));
+    }
+    for (int index = 0; index < 10; ++index) {
+        REQUIRE(echo->write_line("ping " + std::to_string(index)));
+        std::string line;
+        REQUIRE(echo->read_line(line));
+        CHECK(line == "ping " + std::to_string(index));
+    }
+
+    hanging->kill();
+    CHECK_FALSE(hanging->is_running());
+    REQUIRE(echo->terminate(5000));
+}
+
+TEST_CASE("RemoteProcessTests.Concurrent starts share one connection", "[process][remote]") {
+    RunningHost host{chessuci::RemoteEndpoint::local(local_socket_path("chessuci_concurrent")), {"test_line_echo"}};
+    auto connection = std::make_shared<chessuci::RemoteConnection>(host.endpoint());
+
+    std::vector<std::unique_ptr<chessuci::EngineProcess>> processes;
+    for (int index = 0; index < 4; ++index) {
+        processes.push_back(connection->create_process());
+    }
+    // every start connects, only the first one establishes the connection
+    std::vector<std::thread> threads;
+    std::atomic<int> started{0};
+    for (auto &process : processes) {
+        threads.emplace_back([&process, &started] -> void {
+            if (process->start({get_test_binary_path("test_line_echo")})) {
+                ++started;
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK(started == 4);
+    CHECK(host.host().session_count() == 4);
+
+    for (auto &process : processes) {
+        REQUIRE(process->terminate(5000));
+    }
+}
@@ -0,0 +1,145 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_handler.h"
+#include "chessuci/gui_handler.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <sstream>
+
+// The global operator new is replaced to count allocations, so these tests
+// run in an executable of their own.
+
+using namespace chessuci;
+
+namespace {
+
+// allocations of the current thread, counted by the replaced operator new
+thread_local std::size_t allocation_count{0};
+
+} // namespace
+
+auto operator new(std::size_t size) -> void * {
+    ++allocation_count;
+    if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc{};
+}
+
+auto operator delete(void *memory) noexcept -> void {
+    std::free(memory);
+}
+
+auto operator delete(void *memory, std::size_t) noexcept -> void {
+    std::free(memory);
+}
+
+TEST_CASE("ObjectPool.GuiHandlerReuse", "[object_pool][gui_handler]") {
+    UCIGuiHandler handler{std::make_unique<test::EngineProcessMock>()};
+    std::size_t moves{0};
+    handler.on_info([&moves](const search_info &info) -> void { moves += info.pv.size() + info.refutation.size(); });
+    const std::vector<std::string> lines{
+        "info depth 12 seldepth 18 multipv 1 score cp 31 nodes 1234567 nps 2000000 hashfull 120 time 617 pv e2e4 e7e5 g1f3 b8c6 f1b5 a7a6 b5a4 g8f6",
+        "info depth 12 currmove d2d4 currmovenumber 2",
+        "info refutation d1h5 g6h5 currline 0 e2e4 e7e5",
+        "info string searching with a small string",
+        "info depth 13 score mate 4 lowerbound pv e2e4",
+    };
+    for (int round = 0; round < 3; ++round) {
+        for (const auto &line : lines) {
+            handler.process_line(line);
+        }
+    }
+
+    const auto allocations = allocation_count;
+    for (int round = 0; round < 100; ++round) {
+        for (const auto &line : lines) {
+            handler.process_line(line);
+        }
+    }
+    const auto steady_allocations = allocation_count - allocations;
+    CHECK(steady_allocations == 0);
+    CHECK(moves == 103 * 11);
+}
+
+TEST_CASE("ObjectPool.GuiHandlerPooledInfo", "[object_pool][gui_handler]") {
+    UCIGuiHandler handler{std::make_unique<test::EngineProcessMock>()};
+    std::vector<UCIGuiHandler::PooledInfo> kept;
+    kept.reserve(4);
+    int regular{0};
+    handler.on_info([&regular](const search_info &) -> void { ++regular; });
+    handler.on_pooled_info([&kept](UCIGuiHandler::PooledInfo info) -> void {
+        // keeps the latest three infos, like a queue to a consumer thread
+        if (kept.size() == 3) {
+            kept.erase(kept.begin());
+        }
+        kept.push_back(std::move(info));
+    });
+
+    for (int depth = 1; depth <= 5; ++depth) {
+        handler.process_line("info depth " + std::to_string(depth) + " score cp 10 pv e2e4 e7e5 g1f3");
+    }
+    REQUIRE(kept.size() == 3);
+    CHECK(kept[0]->depth == 3);
+    CHECK(kept[2]->depth == 5);
+    CHECK(kept[2]->pv.size() == 3);
+    CHECK(regular == 5);
+    CHECK(handler.info_pool().created_count() == 4);
+
+    const std::string line{"info depth 6 score cp 10 pv e2e4 e7e5 g1f3 b8c6"};
+    handler.process_line(line);
+    const auto allocations = allocation_count;
+    for (int round = 0; round < 100; ++round) {
+        handler.process_line(line);
+    }
+    const auto steady_allocations = allocation_count - allocations;
+    CHECK(steady_allocations == 0);
+    CHECK(handler.info_pool().created_count() == 4);
+
+    // a parse error does not reach the callbacks and returns the object
+    handler.process_line("info depth x");
+    CHECK(regular == 106);
+    kept.clear();
+    CHECK(handler.info_pool().idle_count() == 4);
+}
+
+TEST_CASE("ObjectPool.EngineHandlerPosition", "[object_pool][engine_handler]") {
+    std::stringstream input;
+    std::stringstream output;
+    UCIEngineHandler handler{input, output};
+    std::size_t moves{0};
+    handler.on_position([&moves](const position_command &command) -> void { moves += command.moves.size(); });
+    std::optional<UCIEngineHandler::PooledPosition> last;
+    handler.on_pooled_position([&last](UCIEngineHandler::PooledPosition command) -> void { last = std::move(command); });
+
+    const std::vector<std::string> lines{
+        "position startpos moves e2e4 e7e5 g1f3 b8c6 f1b5",
+        "position fen r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3 moves f1b5 a7a6",
+    };
+    for (int round = 0; round < 3; ++round) {
+        for (const auto &line : lines) {
+            handler.process_line(line);
+        }
+    }
+    REQUIRE(last.has_value());
+    CHECK(last.value()->fen == "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3");
+    CHECK(last.value()->moves.size() == 2);
+
+    const auto allocations = allocation_count;
+    for (int round = 0; round < 100; ++round) {
+        for (const auto &line : lines) {
+            handler.process_line(line);
+        }
+    }
+    const auto steady_allocations = allocation_count - allocations;
+    CHECK(steady_allocations == 0);
+    CHECK(moves == 103 * 7);
+}
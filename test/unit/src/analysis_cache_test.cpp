@@ -0,0 +1,199 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/analysis_cache.h"
+#include "chessuci/batch_analysis.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <atomic>
+
+using namespace chessuci;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto fen_hash(const std::string &fen) -> std::optional<std::uint64_t> {
+    return AnalysisCache::position_hash(position_command{.fen = fen, .moves = {}});
+}
+
+auto test_result(int depth, const std::string &move) -> AnalysisResult {
+    AnalysisResult result{};
+    result.info.depth = depth;
+    result.info.nodes = 1000 * depth;
+    result.info.score = score_info{};
+    result.info.score->cp = 25;
+    result.info.pv = {parse_uci_move(move).value()};
+    result.bestmove.bestmove = parse_uci_move(move).value();
+    return result;
+}
+
+auto depth_key(std::uint64_t position, std::uint64_t depth) -> AnalysisKey {
+    return AnalysisKey{.position = position, .engine = AnalysisCache::engine_hash("engine"), .limit = SearchLimit{.kind = SearchLimit::Kind::Depth, .value = depth}};
+}
+
+} // namespace
+
+TEST_CASE("AnalysisCache.Normalize", "[analysis_cache]") {
+    go_command go{};
+    CHECK_FALSE(AnalysisCache::normalize(go).has_value());
+    go.depth = 12;
+    CHECK(AnalysisCache::normalize(go) == SearchLimit{.kind = SearchLimit::Kind::Depth, .value = 12});
+    go.nodes = 100000;
+    CHECK_FALSE(AnalysisCache::normalize(go).has_value());
+    go.depth.reset();
+    CHECK(AnalysisCache::normalize(go) == SearchLimit{.kind = SearchLimit::Kind::Nodes, .value = 100000});
+
+    go_command clock{};
+    clock.wtime = 60000;
+    clock.btime = 60000;
+    CHECK_FALSE(AnalysisCache::normalize(clock).has_value());
+    go_command infinite{};
+    infinite.infinite = true;
+    CHECK_FALSE(AnalysisCache::normalize(infinite).has_value());
+    go_command movetime{};
+    movetime.movetime = 0;
+    CHECK_FALSE(AnalysisCache::normalize(movetime).has_value());
+}
+
+TEST_CASE("AnalysisCache.PositionHash", "[analysis_cache]") {
+    const auto start = AnalysisCache::position_hash(position_command{.fen = position_command::startpos, .moves = {}});
+    REQUIRE(start.has_value());
+    CHECK(fen_hash("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1") == start);
+    CHECK(fen_hash("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 12 40") == start);
+    CHECK(fen_hash("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR b KQkq - 0 1") != start);
+    CHECK(fen_hash("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w Kkq - 0 1") != start);
+    CHECK(fen_hash("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBN1 w KQkq - 0 1") != start);
+    CHECK_FALSE(fen_hash("garbage").has_value());
+
+    CHECK(AnalysisCache::engine_hash("Engine 1.0") == AnalysisCache::engine_hash("Engine 1.0"));
+    CHECK(AnalysisCache::engine_hash("Engine 1.0") != AnalysisCache::engine_hash("Engine 1.1"));
+}
+
+TEST_CASE("AnalysisCache.Persistence", "[analysis_cache]") {
+    const auto path = fs::temp_directory_path() / "chessuci_analysis_cache.bin";
+    fs::remove(path);
+    {
+        AnalysisCache cache{path};
+        REQUIRE(cache.is_open());
+        CHECK_FALSE(cache.lookup(depth_key(1, 10)).has_value());
+        CHECK(cache.store(depth_key(1, 10), test_result(10, "e2e4")));
+        CHECK(cache.store(depth_key(1, 20), test_result(20, "d2d4")));
+        // a shallower result does not replace a deeper one
+        CHECK_FALSE(cache.store(depth_key(1, 15), test_result(15, "c2c4")));
+        CHECK(cache.store(depth_key(2, 8), test_result(8, "g1f3")));
+
+        const auto shallower = cache.lookup(depth_key(1, 12));
+        REQUIRE(shallower.has_value());
+        CHECK(shallower->info.depth == 20);
+        CHECK(to_string(shallower->bestmove.bestmove) == "d2d4");
+        CHECK_FALSE(cache.lookup(depth_key(1, 21)).has_value());
+        auto nodes_key = depth_key(1, 20);
+        nodes_key.limit.kind = SearchLimit::Kind::Nodes;
+        CHECK_FALSE(cache.lookup(nodes_key).has_value());
+        CHECK(cache.size() == 2);
+    }
+
+    // a record that was cut off is dropped
+    const auto complete_size = fs::file_size(path);
+    {
+        std::ofstream stream{path, std::ios::binary | std::ios::app};
+        stream.write("\x01\x02\x03", 3);
+    }
+    {
+        AnalysisCache cache{path};
+        REQUIRE(cache.is_open());
+        CHECK(cache.size() == 2);
+        const auto result = cache.lookup(depth_key(1, 20));
+        REQUIRE(result.has_value());
+        CHECK(result->info.nodes == 20000);
+        REQUIRE(result->info.score.has_value());
+        CHECK(result->info.score->cp == 25);
+        REQUIRE(result->info.pv.size() == 1);
+        CHECK(to_string(result->info.pv[0]) == "d2d4");
+        CHECK(fs::file_size(path) == complete_size);
+        CHECK(cache.store(depth_key(3, 5), test_result(5, "b1c3")));
+    }
+    {
+        AnalysisCache cache{path};
+        CHECK(cache.size() == 3);
+    }
+    fs::remove(path);
+
+    // other files are neither replaced nor appended to
+    const std::string foreign{"not an analysis cache"};
+    {
+        std::ofstream stream{path, std::ios::binary};
+        stream << foreign;
+    }
+    {
+        AnalysisCache cache{path};
+        CHECK_FALSE(cache.is_open());
+        CHECK_FALSE(cache.last_error().empty());
+        CHECK_FALSE(cache.store(depth_key(1, 10), test_result(10, "e2e4")));
+        CHECK(cache.lookup(depth_key(1, 10)).has_value());
+    }
+    CHECK(fs::file_size(path) == foreign.size());
+
+    // an empty file is initialized
+    {
+        std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+    }
+    {
+        AnalysisCache cache{path};
+        REQUIRE(cache.is_open());
+        CHECK(cache.store(depth_key(1, 10), test_result(10, "e2e4")));
+    }
+    {
+        AnalysisCache cache{path};
+        CHECK(cache.size() == 1);
+    }
+    fs::remove(path);
+}
+
+TEST_CASE("AnalysisCache.BatchAnalysis", "[analysis_cache]") {
+    const auto path = fs::temp_directory_path() / "chessuci_batch_cache.bin";
+    fs::remove(path);
+    const std::string input{"8/8/8/8/8/8/8/K6k w - -\n8/8/8/8/8/8/8/K6k b - -\n8/8/8/8/8/8/8/K6k w - - 3 7\n"};
+    AnalysisCache cache{path};
+    std::atomic<int> searches{0};
+
+    auto run = [&](int depth) -> BatchStatistics {
+        BatchSettings settings{};
+        settings.go.depth = depth;
+        settings.cache = &cache;
+        BatchAnalysis analysis{settings};
+        analysis.set_process_creator([&searches]() -> std::unique_ptr<EngineProcess> {
+            auto mock_engine = std::make_unique<test::EngineProcessMock>();
+            mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name mock", "uciok"}; });
+            mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+            for (const auto *go : {"go depth 2", "go depth 4"}) {
+                mock_engine->when_receives(go, [&searches](const std::string &command) -> std::vector<std::string> {
+                    ++searches;
+                    return {"info depth " + command.substr(9) + " score cp 0 pv a1a2", "bestmove a1a2"};
+                });
+            }
+            return mock_engine;
+        });
+        std::vector<BatchResult> results;
+        REQUIRE(analysis.run(input, [&results](const BatchResult &result) -> void { results.push_back(result); }));
+        REQUIRE(results.size() == 3);
+        for (const auto &result : results) {
+            CHECK(result.ok());
+            CHECK(to_string(result.bestmove.bestmove) == "a1a2");
+        }
+        return analysis.statistics();
+    };
+
+    // the third position only differs in the move counters
+    CHECK(run(4).cache_hits == 1);
+    CHECK(searches == 2);
+    CHECK(run(4).cache_hits == 3);
+    CHECK(run(2).cache_hits == 3);
+    CHECK(searches == 2);
+    fs::remove(path);
+}
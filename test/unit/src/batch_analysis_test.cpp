@@ -0,0 +1,78 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/batch_analysis.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+using namespace chessuci;
+
+TEST_CASE("BatchAnalysis.ParseEpd", "[batch_analysis]") {
+    const auto fen = BatchAnalysis::parse_epd_line("rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1", 3);
+    REQUIRE(fen.has_value());
+    CHECK(fen->index == 3);
+    CHECK(fen->fen == "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1");
+    CHECK(fen->id.empty());
+
+    const auto epd = BatchAnalysis::parse_epd_line("1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - - bm Qd1+; id \"BK.01; test\"; hmvc 4;\r", 0);
+    REQUIRE(epd.has_value());
+    CHECK(epd->fen == "1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - - 4 1");
+    CHECK(epd->id == "BK.01; test");
+
+    CHECK_FALSE(BatchAnalysis::parse_epd_line("", 0).has_value());
+    CHECK_FALSE(BatchAnalysis::parse_epd_line("  # comment", 0).has_value());
+    CHECK_FALSE(BatchAnalysis::parse_epd_line("8/8/8 w", 0).has_value());
+
+    BatchResult result{};
+    result.position = epd.value();
+    result.info.depth = 12;
+    result.info.score = score_info{};
+    result.info.score->cp = -35;
+    result.info.pv = {parse_uci_move("d6d1").value(), parse_uci_move("c1d1").value()};
+    result.bestmove.bestmove = parse_uci_move("d6d1").value();
+    CHECK(BatchAnalysis::format_epd_result(result) == "1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - - acd 12; ce -35; bm d6d1; pv d6d1 c1d1; id \"BK.01; test\";");
+}
+
+TEST_CASE("BatchAnalysis.Run", "[batch_analysis]") {
+    constexpr std::size_t position_count{200};
+    std::string input{"# generated positions\n"};
+    for (std::size_t index = 0; index < position_count; ++index) {
+        input += "8/8/8/8/8/8/8/K6k w - - id \"" + std::to_string(index) + "\";\n";
+    }
+
+    BatchSettings settings{};
+    settings.go.depth = 1;
+    settings.engine_count = 4;
+    settings.chunk_size = 3;
+    BatchAnalysis analysis{settings};
+    analysis.set_process_creator([]() -> std::unique_ptr<EngineProcess> {
+        auto mock_engine = std::make_unique<test::EngineProcessMock>();
+        mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name mock", "uciok"}; });
+        mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+        mock_engine->when_receives("go depth 1", [](const std::string &) -> std::vector<std::string> {
+            return {"info depth 1 nodes 20 score cp 0", "info currmove a1a2", "info depth 1 nodes 42 pv a1a2", "bestmove a1a2"};
+        });
+        return mock_engine;
+    });
+
+    std::vector<BatchResult> results;
+    REQUIRE(analysis.run(input, [&results](const BatchResult &result) -> void { results.push_back(result); }));
+    REQUIRE(results.size() == position_count);
+    for (std::size_t index = 0; index < position_count; ++index) {
+        CHECK(results[index].position.index == index);
+        CHECK(results[index].position.id == std::to_string(index));
+        CHECK(results[index].ok());
+    }
+    CHECK(results[0].info.nodes == 42);
+    CHECK(results[0].info.score->cp == 0);
+    REQUIRE(results[0].info.pv.size() == 1);
+    CHECK(to_string(results[0].bestmove.bestmove) == "a1a2");
+
+    const auto statistics = analysis.statistics();
+    CHECK(statistics.positions == position_count);
+    CHECK(statistics.errors == 0);
+    CHECK(statistics.positions_per_second() > 0.0);
+}
@@ -0,0 +1,118 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/compact_info.h"
+#include "chessuci/gui_handler.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <type_traits>
+
+using namespace chessuci;
+
+namespace {
+
+auto parse_info(const std::string &line) -> ParseResult<search_info> {
+    return UCIGuiHandler::try_parse_info_command(UCIHandler::tokenize(line));
+}
+
+} // namespace
+
+TEST_CASE("CompactInfo.PackedMove", "[compact_info]") {
+    for (const std::string move : {"e2e4", "a1h8", "h8a1", "a7a8q", "b2b1n", "g7h8r", "c2c1b"}) {
+        const auto packed = parse_packed_move(move);
+        REQUIRE(packed.has_value());
+        CHECK(to_string(unpack_move(packed.value())) == move);
+        CHECK(pack_move(parse_uci_move(move).value()) == packed.value());
+    }
+    CHECK(parse_packed_move("a1a1") == PackedMove{0});
+    CHECK(parse_packed_move("h8h8") == PackedMove{0x0fff});
+    for (const std::string_view move : {"", "e2e", "e2e4qq", "e9e4", "i2i4", "a7a8k", "a7a8Q"}) {
+        CHECK_FALSE(parse_packed_move(move).has_value());
+    }
+}
+
+TEST_CASE("CompactInfo.Conversion", "[compact_info]") {
+    static_assert(std::is_trivially_copyable_v<CompactSearchInfo>);
+    CHECK(sizeof(CompactSearchInfo) <= 128);
+
+    const std::vector<std::string> lines{
+        "info depth 20 seldepth 25 multipv 2 score cp -35 upperbound nodes 123456789012 nps 3456789 time 35714 hashfull 512 tbhits 7 pv e2e4 e7e5 g1f3 b8c6",
+        "info currmove e7e8q currmovenumber 3 sbhits 2 cpuload 950",
+        "info score mate -3 lowerbound refutation d1h5 g6h5 currline 1 e2e4 e7e5",
+        "info currline f2f4",
+        "info",
+    };
+    for (const auto &line : lines) {
+        const auto info = parse_info(line).value();
+        const auto compact = CompactSearchInfo::from_search_info(info);
+        REQUIRE(compact.has_value());
+        CHECK(to_string(compact->to_search_info()) == to_string(info));
+
+        const auto parsed = CompactSearchInfo::parse(line);
+        REQUIRE(parsed.has_value());
+        CHECK(parsed.value() == compact.value());
+    }
+
+    const auto compact = CompactSearchInfo::parse(lines[0]).value();
+    CHECK(compact.depth() == 20);
+    CHECK(compact.nodes() == 123456789012);
+    CHECK_FALSE(compact.currmove().has_value());
+    CHECK_FALSE(compact.has(InfoField::ScoreMate));
+    REQUIRE(compact.score().has_value());
+    CHECK(compact.score()->cp == -35);
+    CHECK(compact.score()->upperbound);
+    CHECK(compact.pv().size() == 4);
+    CHECK(CompactSearchInfo::parse("info").value().empty());
+}
+
+TEST_CASE("CompactInfo.MoveLists", "[compact_info]") {
+    // moves are appended to their own list, whatever the order of the lists
+    const auto compact = CompactSearchInfo::parse("info refutation d1h5 currline 0 a2a3 pv e2e4 refutation g6h5 pv e7e5 currline 1 b2b3 b7b6").value();
+    CHECK(compact.pv().size() == 2);
+    CHECK(to_string(unpack_move(compact.pv()[1])) == "e7e5");
+    REQUIRE(compact.refutation().size() == 2);
+    CHECK(to_string(unpack_move(compact.refutation()[1])) == "g6h5");
+    REQUIRE(compact.currline().size() == 2);
+    CHECK(to_string(unpack_move(compact.currline()[0])) == "b2b3");
+    CHECK(compact.cpunr() == 1);
+
+    search_info info{};
+    std::string line{"info pv"};
+    for (std::size_t index = 0; index < CompactSearchInfo::max_moves; ++index) {
+        info.pv.push_back(parse_uci_move("g1f3").value());
+        line += " g1f3";
+    }
+    CHECK_FALSE(CompactSearchInfo::from_search_info(info)->has(InfoField::Truncated));
+    CHECK_FALSE(CompactSearchInfo::parse(line)->has(InfoField::Truncated));
+
+    // moves beyond the capacity are dropped
+    info.pv.push_back(parse_uci_move("g8f6").value());
+    info.refutation.push_back(parse_uci_move("d1h5").value());
+    const auto truncated = CompactSearchInfo::from_search_info(info);
+    REQUIRE(truncated.has_value());
+    CHECK(truncated->has(InfoField::Truncated));
+    CHECK(truncated->pv().size() == CompactSearchInfo::max_moves);
+    CHECK(to_string(unpack_move(truncated->pv().back())) == "g1f3");
+    CHECK(truncated->refutation().empty());
+    const auto parsed = CompactSearchInfo::parse(line + " g8f6 refutation d1h5");
+    REQUIRE(parsed.has_value());
+    CHECK(parsed.value() == truncated.value());
+}
+
+TEST_CASE("CompactInfo.Errors", "[compact_info]") {
+    // the same errors as the regular parser
+    for (const std::string line : {"info depth", "info depth x", "info score", "info score cp", "info pv e2e4 e9e5", "info currmove", "info currmove e2", "info nodes 1 score mate z"}) {
+        const auto expected = parse_info(line);
+        REQUIRE_FALSE(expected.has_value());
+        const auto parsed = CompactSearchInfo::parse(line);
+        REQUIRE_FALSE(parsed.has_value());
+        CHECK(parsed.error() == expected.error());
+    }
+
+    search_info info{};
+    info.string = "analysis complete";
+    CHECK_FALSE(CompactSearchInfo::from_search_info(info).has_value());
+    CHECK(CompactSearchInfo::parse("info string analysis complete").error() == ParseError{.type = ParseErrorType::UnexpectedToken, .token = "string"});
+}
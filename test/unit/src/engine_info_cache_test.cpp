@@ -0,0 +1,113 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_info_cache.h"
+#include "chessuci/gui_handler.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <fstream>
+#include <future>
+
+using namespace chessuci;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto write_file(const fs::path &path, const std::string &content) -> void {
+    std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+    stream << content;
+}
+
+auto test_handshake() -> handshake_info {
+    handshake_info info{};
+    info.id = id_info{.name = "Test Engine 1.0", .author = "The Authors"};
+    info.options.push_back(Option{.name = "Hash", .type = Option::Type::Spin, .default_value = "16", .min = 1, .max = 1024, .combo_values = {}});
+    info.options.push_back(Option{.name = "Style", .type = Option::Type::Combo, .default_value = "Normal", .min = std::nullopt, .max = std::nullopt, .combo_values = {"Solid", "Normal"}});
+    info.options.push_back(Option{.name = "Book File", .type = Option::Type::String, .default_value = "", .min = std::nullopt, .max = std::nullopt, .combo_values = {}});
+    info.options.push_back(Option{.name = "Clear Hash", .type = Option::Type::Button, .default_value = std::nullopt, .min = std::nullopt, .max = std::nullopt, .combo_values = {}});
+    return info;
+}
+
+} // namespace
+
+TEST_CASE("EngineInfoCache.Roundtrip", "[engine_info_cache]") {
+    const auto directory = fs::temp_directory_path() / "chessuci_engine_cache";
+    const auto executable = fs::temp_directory_path() / "chessuci_cached_engine";
+    fs::remove_all(directory);
+    write_file(executable, "engine binary");
+
+    EngineInfoCache cache{directory};
+    CHECK_FALSE(cache.lookup(executable).has_value());
+    REQUIRE(cache.store(executable, test_handshake()));
+    const auto cached = cache.lookup(executable);
+    REQUIRE(cached.has_value());
+    CHECK(cached.value() == test_handshake());
+    const auto fingerprint = EngineInfoCache::fingerprint(executable);
+    REQUIRE(fingerprint.has_value());
+    CHECK(cache.lookup(fingerprint.value()) == cached);
+
+    // same size, different content
+    write_file(executable, "engine BINARY");
+    fs::last_write_time(executable, fs::last_write_time(executable) + std::chrono::seconds(1));
+    CHECK_FALSE(cache.lookup(executable).has_value());
+    const auto changed = EngineInfoCache::fingerprint(executable);
+    REQUIRE(changed.has_value());
+    CHECK_FALSE(cache.lookup(changed.value()).has_value());
+    REQUIRE(cache.store(changed.value(), test_handshake()));
+    CHECK(cache.lookup(executable) == test_handshake());
+
+    cache.remove(executable);
+    CHECK(fs::is_empty(directory));
+    fs::remove_all(directory);
+    fs::remove(executable);
+}
+
+TEST_CASE("EngineInfoCache.WarmStart", "[engine_info_cache]") {
+    const auto directory = fs::temp_directory_path() / "chessuci_engine_cache_warm";
+    const auto executable = fs::temp_directory_path() / "chessuci_warm_engine";
+    fs::remove_all(directory);
+    write_file(executable, "engine binary");
+    EngineInfoCache cache{directory};
+    REQUIRE(cache.store(executable, test_handshake()));
+
+    auto lines = std::make_shared<std::vector<std::string>>();
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("uci", [lines](const std::string &line) -> std::vector<std::string> {
+        lines->push_back(line);
+        return {"id name Test Engine 1.1", "id author The Authors", "option name Hash type spin default 16 min 1 max 2048", "uciok"};
+    });
+    mock_engine->when_receives("setoption name Hash value 2000", [lines](const std::string &line) -> std::vector<std::string> {
+        lines->push_back(line);
+        return {};
+    });
+    mock_engine->when_receives("isready", [lines](const std::string &line) -> std::vector<std::string> {
+        lines->push_back(line);
+        return {"readyok"};
+    });
+
+    // the cached option list is used, so the value is rejected before the engine answers
+    UCIGuiHandler handler{std::move(mock_engine)};
+    auto initialized = handler.initialize({executable}, {{.name = "Hash", .value = "2000"}}, cache);
+    REQUIRE(initialized.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    const auto info = initialized.get();
+    CHECK(info.handshake.id.name == "Test Engine 1.1");
+    REQUIRE(info.rejected_options.size() == 1);
+    CHECK(info.cache_outdated);
+    CHECK(*lines == std::vector<std::string>{"uci", "isready"});
+    handler.stop();
+
+    // the engine reported a different handshake, which replaced the entry
+    const auto cached = cache.lookup(executable);
+    REQUIRE(cached.has_value());
+    CHECK(cached->id.name == "Test Engine 1.1");
+    REQUIRE(cached->options.size() == 1);
+    CHECK(cached->options[0].max == 2048);
+
+    fs::remove_all(directory);
+    fs::remove(executable);
+}
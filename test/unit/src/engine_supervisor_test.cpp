@@ -0,0 +1,129 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/batch_analysis.h"
+#include "chessuci/engine_supervisor.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <atomic>
+
+using namespace chessuci;
+
+namespace {
+
+constexpr RestartPolicy fast_restarts{
+    .initial_backoff = std::chrono::milliseconds{1},
+    .max_backoff = std::chrono::milliseconds{4},
+    .max_crashes = 3,
+    .crash_window = std::chrono::milliseconds{60000},
+    .max_replays = 2,
+};
+
+// an engine that crashes on the searches given by crash_search
+auto flaky_engine(std::atomic<int> &searches, std::function<bool(int)> crash_search) -> std::unique_ptr<EngineProcess> {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    auto *process = mock_engine.get();
+    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name flaky", "uciok"}; });
+    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+    mock_engine->when_receives("go depth 5", [process, &searches, crash_search](const std::string &) -> std::vector<std::string> {
+        if (crash_search(searches++)) {
+            process->kill();
+            return {};
+        }
+        return {"info depth 5 score cp 12 pv e2e4", "bestmove e2e4"};
+    });
+    return mock_engine;
+}
+
+auto depth_5() -> go_command {
+    go_command go{};
+    go.depth = 5;
+    return go;
+}
+
+} // namespace
+
+TEST_CASE("EngineSupervisor.Replay", "[engine_supervisor]") {
+    std::atomic<int> searches{0};
+    std::atomic<int> engines{0};
+    EngineProcess *current{nullptr};
+    EngineSupervisor supervisor{ProcessParams{}, {}, fast_restarts};
+    supervisor.set_process_creator([&]() -> std::unique_ptr<EngineProcess> {
+        ++engines;
+        auto engine = flaky_engine(searches, [](int search) -> bool { return search == 0; });
+        current = engine.get();
+        return engine;
+    });
+    std::vector<std::uint64_t> restarts;
+    supervisor.on_restart([&restarts](std::uint64_t count) -> void { restarts.push_back(count); });
+    REQUIRE(supervisor.start());
+    CHECK(supervisor.handshake().id.name == "flaky");
+
+    const auto bestmove = supervisor.search(position_command{.fen = position_command::startpos, .moves = {}}, depth_5());
+    CHECK(to_string(bestmove.bestmove) == "e2e4");
+    CHECK(searches == 2);
+    CHECK(engines == 2);
+    CHECK(supervisor.restarts() == 1);
+    CHECK(supervisor.replays() == 1);
+    CHECK(restarts == std::vector<std::uint64_t>{1});
+
+    // an engine that died between searches is restarted before the next search
+    current->kill();
+    CHECK(to_string(supervisor.search(position_command{.fen = position_command::startpos, .moves = {}}, depth_5()).bestmove) == "e2e4");
+    CHECK(supervisor.restarts() == 2);
+    CHECK(supervisor.replays() == 1);
+}
+
+TEST_CASE("EngineSupervisor.CrashLoop", "[engine_supervisor]") {
+    std::atomic<int> searches{0};
+    EngineSupervisor supervisor{ProcessParams{}, {}, fast_restarts};
+    supervisor.set_process_creator([&searches]() -> std::unique_ptr<EngineProcess> {
+        return flaky_engine(searches, [](int) -> bool { return true; });
+    });
+    REQUIRE(supervisor.start());
+
+    const position_command position{.fen = position_command::startpos, .moves = {}};
+    CHECK_THROWS_AS(supervisor.search(position, depth_5()), UCIError);
+    CHECK(searches == 3);
+    CHECK_FALSE(supervisor.given_up());
+    CHECK_THROWS_AS(supervisor.search(position, depth_5()), UCIError);
+    CHECK(supervisor.given_up());
+    CHECK(supervisor.restarts() == 3);
+
+    const auto searches_before = searches.load();
+    CHECK_THROWS_AS(supervisor.search(position, depth_5()), UCIError);
+    CHECK(searches == searches_before);
+}
+
+TEST_CASE("EngineSupervisor.BatchAnalysis", "[engine_supervisor]") {
+    constexpr std::size_t position_count{20};
+    std::string input;
+    for (std::size_t index = 0; index < position_count; ++index) {
+        input += "8/8/8/8/8/8/8/K6k w - - id \"" + std::to_string(index) + "\";\n";
+    }
+
+    std::atomic<int> searches{0};
+    BatchSettings settings{};
+    settings.go = depth_5();
+    settings.engine_count = 2;
+    settings.restart = fast_restarts;
+    BatchAnalysis analysis{settings};
+    analysis.set_process_creator([&searches]() -> std::unique_ptr<EngineProcess> {
+        return flaky_engine(searches, [](int search) -> bool { return search % 7 == 3; });
+    });
+
+    std::vector<BatchResult> results;
+    REQUIRE(analysis.run(input, [&results](const BatchResult &result) -> void { results.push_back(result); }));
+    REQUIRE(results.size() == position_count);
+    for (const auto &result : results) {
+        CHECK(result.ok());
+        CHECK(result.info.depth == 5);
+    }
+    const auto statistics = analysis.statistics();
+    CHECK(statistics.errors == 0);
+    CHECK(statistics.restarts > 0);
+}
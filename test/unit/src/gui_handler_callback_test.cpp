@@ -1,158 +1,355 @@
-/* ************************************************************************** *
- * Chess UCI                                                                  *
- * Universal Chess Interface for Chess Engines                                *
- * ************************************************************************** */
-
-#include "chessuci/gui_handler.h"
-#include <catch2/catch_test_macros.hpp>
-
-#include "helper/EngineProcessMock.h"
-
-#include <future>
-
-using namespace chessuci;
-
-namespace fs = std::filesystem;
-
-inline auto get_test_binary_path(const std::string &name) -> std::string {
-    fs::path binary_dir(TEST_BINARY_DIR);
-#ifdef _WIN32
-    fs::path binary = binary_dir / (name + ".exe");
-#else
-    fs::path binary = binary_dir / name;
-#endif
-    return binary.string();
-}
-
-TEST_CASE("GuiHandler.Callback.No Callbacks", "[gui_handler]") {
-    UCIGuiHandler handler{};
-    auto binary = get_test_binary_path("test_echo");
-
-    CHECK_FALSE(handler.is_running());
-    handler.start({binary});
-    std::this_thread::sleep_for(std::chrono::milliseconds(10));
-    CHECK(handler.is_running());
-    CHECK(handler.process().is_running());
-    handler.stop();
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    CHECK_FALSE(handler.is_running());
-    CHECK_FALSE(handler.process().is_running());
-}
-
-TEST_CASE("EngineProcessMock", "[engine_process_mock]") {
-    test::EngineProcessMock mock;
-
-    mock.when_receives("test", [](const std::string &) -> std::vector<std::string> { return {"response1", "response2"}; });
-    mock.when_receives("stop", [](const std::string &) -> std::vector<std::string> { return {"stop requested"}; });
-
-    mock.start({});
-
-    REQUIRE_FALSE(mock.can_read());
-
-    mock.write_line("test");
-    REQUIRE(mock.can_read());
-
-    std::string line;
-    REQUIRE(mock.read_line(line));
-    CHECK(line == "response1");
-    REQUIRE(mock.read_line(line));
-    CHECK(line == "response2");
-    CHECK_FALSE(mock.can_read());
-
-    mock.write_line("stop");
-    REQUIRE(mock.read_line(line));
-    CHECK(line == "stop requested");
-    CHECK_FALSE(mock.can_read());
-}
-
-TEST_CASE("GuiHandler.Callback.Quit", "[gui_handler]") {
-    std::promise<void> quit_done;
-    auto quit_future = quit_done.get_future();
-    auto mock_engine = std::make_unique<test::EngineProcessMock>();
-    mock_engine->when_receives("quit", [&quit_done](const std::string &) -> std::vector<std::string> {
-        quit_done.set_value();
-        return {};
-    });
-
-    UCIGuiHandler handler{std::move(mock_engine)};
-
-    handler.start({});
-    handler.send_quit();
-    REQUIRE(quit_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    handler.stop();
-}
-
-TEST_CASE("GuiHandler.Callback.Isready", "[gui_handler]") {
-    auto mock_engine = std::make_unique<test::EngineProcessMock>();
-    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
-
-    UCIGuiHandler handler{std::move(mock_engine)};
-    std::promise<void> isready_done;
-    auto isready_future = isready_done.get_future();
-    handler.on_readyok([&isready_done]() -> void { isready_done.set_value(); });
-
-    REQUIRE(handler.start({}));
-    REQUIRE(handler.send_isready());
-    REQUIRE(isready_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    handler.stop();
-}
-
-TEST_CASE("GuiHandler.Callback.UCI", "[gui_handler]") {
-    auto mock_engine = std::make_unique<test::EngineProcessMock>();
-    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name test_engine", "id author test_author", "uciok"}; });
-
-    UCIGuiHandler handler{std::move(mock_engine)};
-
-    std::promise<std::string> id_name_done;
-    auto id_name_future = id_name_done.get_future();
-    handler.on_id_name([&id_name_done](const std::string &name) -> void { id_name_done.set_value(name); });
-    std::promise<std::string> id_author_done;
-    auto id_author_future = id_author_done.get_future();
-    handler.on_id_author([&id_author_done](const std::string &author) -> void { id_author_done.set_value(author); });
-    std::promise<void> uciok_done;
-    auto uciok_future = uciok_done.get_future();
-    handler.on_uciok([&uciok_done]() -> void { uciok_done.set_value(); });
-
-    REQUIRE(handler.start({}));
-    REQUIRE(handler.send_uci());
-    REQUIRE(id_name_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    CHECK(id_name_future.get() == "test_engine");
-    REQUIRE(id_author_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    CHECK(id_author_future.get() == "test_author");
-    REQUIRE(uciok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-
-    handler.stop();
-}
-
-TEST_CASE("GuiHandler.Callback.Multiple", "[gui_handler]") {
-    auto mock_engine = std::make_unique<test::EngineProcessMock>();
-    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name test_engine", "id author test_author", "uciok"}; });
-    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
-
-    UCIGuiHandler handler{std::move(mock_engine)};
-
-    std::promise<std::string> id_name_done;
-    auto id_name_future = id_name_done.get_future();
-    handler.on_id_name([&id_name_done](const std::string &name) -> void { id_name_done.set_value(name); });
-    std::promise<std::string> id_author_done;
-    auto id_author_future = id_author_done.get_future();
-    handler.on_id_author([&id_author_done](const std::string &author) -> void { id_author_done.set_value(author); });
-    std::promise<void> uciok_done;
-    auto uciok_future = uciok_done.get_future();
-    handler.on_uciok([&uciok_done]() -> void { uciok_done.set_value(); });
-    std::promise<void> readyok_done;
-    auto readyok_future = readyok_done.get_future();
-    handler.on_readyok([&readyok_done]() -> void { readyok_done.set_value(); });
-
-    REQUIRE(handler.start({}));
-    REQUIRE(handler.send_uci());
-    REQUIRE(id_name_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    CHECK(id_name_future.get() == "test_engine");
-    REQUIRE(id_author_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    CHECK(id_author_future.get() == "test_author");
-    REQUIRE(uciok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    REQUIRE(readyok_future.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
-    REQUIRE(handler.send_isready());
-    REQUIRE(readyok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
-    handler.stop();
-}
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <future>
+
+using namespace chessuci;
+
+namespace fs = std::filesystem;
+
+inline auto get_test_binary_path(const std::string &name) -> std::string {
+    fs::path binary_dir(TEST_BINARY_DIR);
+#ifdef _WIN32
+    fs::path binary = binary_dir / (name + ".exe");
+#else
+    fs::path binary = binary_dir / name;
+#endif
+    return binary.string();
+}
+
+TEST_CASE("GuiHandler.Callback.No Callbacks", "[gui_handler]") {
+    UCIGuiHandler handler{};
+    auto binary = get_test_binary_path("test_echo");
+
+    CHECK_FALSE(handler.is_running());
+    handler.start({binary});
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    CHECK(handler.is_running());
+    CHECK(handler.process().is_running());
+    handler.stop();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    CHECK_FALSE(handler.is_running());
+    CHECK_FALSE(handler.process().is_running());
+}
+
+TEST_CASE("EngineProcessMock", "[engine_process_mock]") {
+    test::EngineProcessMock mock;
+
+    mock.when_receives("test", [](const std::string &) -> std::vector<std::string> { return {"response1", "response2"}; });
+    mock.when_receives("stop", [](const std::string &) -> std::vector<std::string> { return {"stop requested"}; });
+
+    mock.start({});
+
+    REQUIRE_FALSE(mock.can_read());
+
+    mock.write_line("test");
+    REQUIRE(mock.can_read());
+
+    std::string line;
+    REQUIRE(mock.read_line(line));
+    CHECK(line == "response1");
+    REQUIRE(mock.read_line(line));
+    CHECK(line == "response2");
+    CHECK_FALSE(mock.can_read());
+
+    mock.write_line("stop");
+    REQUIRE(mock.read_line(line));
+    CHECK(line == "stop requested");
+    CHECK_FALSE(mock.can_read());
+}
+
+TEST_CASE("GuiHandler.Callback.Quit", "[gui_handler]") {
+    std::promise<void> quit_done;
+    auto quit_future = quit_done.get_future();
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("quit", [&quit_done](const std::string &) -> std::vector<std::string> {
+        quit_done.set_value();
+        return {};
+    });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+
+    handler.start({});
+    handler.send_quit();
+    REQUIRE(quit_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    handler.stop();
+}
+
+TEST_CASE("GuiHandler.Callback.Isready", "[gui_handler]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+    std::promise<void> isready_done;
+    auto isready_future = isready_done.get_future();
+    handler.on_readyok([&isready_done]() -> void { isready_done.set_value(); });
+
+    REQUIRE(handler.start({}));
+    REQUIRE(handler.send_isready());
+    REQUIRE(isready_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    handler.stop();
+}
+
+TEST_CASE("GuiHandler.Callback.UCI", "[gui_handler]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name test_engine", "id author test_author", "uciok"}; });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+
+    std::promise<std::string> id_name_done;
+    auto id_name_future = id_name_done.get_future();
+    handler.on_id_name([&id_name_done](const std::string &name) -> void { id_name_done.set_value(name); });
+    std::promise<std::string> id_author_done;
+    auto id_author_future = id_author_done.get_future();
+    handler.on_id_author([&id_author_done](const std::string &author) -> void { id_author_done.set_value(author); });
+    std::promise<void> uciok_done;
+    auto uciok_future = uciok_done.get_future();
+    handler.on_uciok([&uciok_done]() -> void { uciok_done.set_value(); });
+
+    REQUIRE(handler.start({}));
+    REQUIRE(handler.send_uci());
+    REQUIRE(id_name_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(id_name_future.get() == "test_engine");
+    REQUIRE(id_author_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(id_author_future.get() == "test_author");
+    REQUIRE(uciok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+
+    handler.stop();
+}
+
+TEST_CASE("GuiHandler.Callback.Multiple", "[gui_handler]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name test_engine", "id author test_author", "uciok"}; });
+    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+
+    std::promise<std::string> id_name_done;
+    auto id_name_future = id_name_done.get_future();
+    handler.on_id_name([&id_name_done](const std::string &name) -> void { id_name_done.set_value(name); });
+    std::promise<std::string> id_author_done;
+    auto id_author_future = id_author_done.get_future();
+    handler.on_id_author([&id_author_done](const std::string &author) -> void { id_author_done.set_value(author); });
+    std::promise<void> uciok_done;
+    auto uciok_future = uciok_done.get_future();
+    handler.on_uciok([&uciok_done]() -> void { uciok_done.set_value(); });
+    std::promise<void> readyok_done;
+    auto readyok_future = readyok_done.get_future();
+    handler.on_readyok([&readyok_done]() -> void { readyok_done.set_value(); });
+
+    REQUIRE(handler.start({}));
+    REQUIRE(handler.send_uci());
+    REQUIRE(id_name_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(id_name_future.get() == "test_engine");
+    REQUIRE(id_author_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(id_author_future.get() == "test_author");
+    REQUIRE(uciok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    REQUIRE(readyok_future.wait_for(std::chrono::milliseconds(50)) == std::future_status::timeout);
+    REQUIRE(handler.send_isready());
+    REQUIRE(readyok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    handler.stop();
+}
+
+TEST_CASE("GuiHandler.Callback.ParseError", "[gui_handler]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("go", [](const std::string &) -> std::vector<std::string> {
+        return {"info depth x", "id name", "info depth 7", "bestmove e2e4 ponder e7e9", "bestmove e2e4"};
+    });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+
+    std::mutex errors_mutex;
+    std::vector<ParseError> errors;
+    handler.on_parse_error([&](const ParseError &error, const TokenList &) -> void {
+        std::lock_guard<std::mutex> lock{errors_mutex};
+        errors.push_back(error);
+    });
+    std::promise<int> info_done;
+    auto info_future = info_done.get_future();
+    handler.on_info([&info_done](const search_info &info) -> void { info_done.set_value(info.depth.value_or(0)); });
+    std::promise<void> bestmove_done;
+    auto bestmove_future = bestmove_done.get_future();
+    handler.on_bestmove([&bestmove_done](const bestmove_info &) -> void { bestmove_done.set_value(); });
+
+    REQUIRE(handler.start({}));
+    REQUIRE(handler.send_go(go_command{}));
+    REQUIRE(info_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(info_future.get() == 7);
+    REQUIRE(bestmove_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(handler.is_running());
+    CHECK(handler.parse_error_count() == 3);
+    {
+        std::lock_guard<std::mutex> lock{errors_mutex};
+        REQUIRE(errors.size() == 3);
+        CHECK(errors[0].type == ParseErrorType::InvalidInteger);
+        CHECK(errors[1].type == ParseErrorType::MissingValue);
+        CHECK(errors[2].type == ParseErrorType::InvalidMove);
+    }
+    handler.stop();
+}
+
+TEST_CASE("GuiHandler.Callback.InfoCoalescing", "[gui_handler]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("go", [](const std::string &) -> std::vector<std::string> {
+        return {"info depth 1 pv e2e4", "info depth 2 pv e2e4", "info currmove d2d4", "info depth 3 pv d2d4", "bestmove d2d4"};
+    });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+    handler.set_info_coalescing(std::chrono::seconds(10));
+
+    std::vector<int> depths;
+    handler.on_info([&depths](const search_info &info) -> void { depths.push_back(info.depth.value_or(0)); });
+    std::promise<std::size_t> bestmove_done;
+    auto bestmove_future = bestmove_done.get_future();
+    handler.on_bestmove([&](const bestmove_info &) -> void { bestmove_done.set_value(depths.size()); });
+
+    REQUIRE(handler.start({}));
+    REQUIRE(handler.send_go(go_command{}));
+    REQUIRE(bestmove_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(bestmove_future.get() == 2);
+    CHECK(depths == std::vector<int>{1, 3});
+    const auto statistics = handler.info_coalescing_statistics();
+    CHECK(statistics.received == 4);
+    CHECK(statistics.delivered == 2);
+    CHECK(statistics.merged == 1);
+    CHECK(statistics.dropped == 1);
+    handler.stop();
+}
+
+TEST_CASE("GuiHandler.Async.Future", "[gui_handler]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> {
+        return {"id name test_engine", "id author test_author", "option name Hash type spin default 16 min 1 max 1024", "uciok"};
+    });
+    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+    mock_engine->when_receives("go depth 1", [](const std::string &) -> std::vector<std::string> { return {"bestmove e2e4"}; });
+    mock_engine->when_receives("go depth 2", [](const std::string &) -> std::vector<std::string> { return {"bestmove d2d4"}; });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+    REQUIRE(handler.start({}));
+
+    auto handshake = handler.async_handshake();
+    std::vector<std::future<void>> readyoks;
+    for (int i = 0; i < 100; ++i) {
+        readyoks.push_back(handler.async_isready());
+    }
+    go_command depth1{};
+    depth1.depth = 1;
+    go_command depth2{};
+    depth2.depth = 2;
+    auto bestmove1 = handler.async_go(depth1);
+    auto bestmove2 = handler.async_go(depth2);
+
+    REQUIRE(handshake.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    const auto info = handshake.get();
+    CHECK(info.id.name == "test_engine");
+    CHECK(info.id.author == "test_author");
+    REQUIRE(info.options.size() == 1);
+    CHECK(info.options[0].name == "Hash");
+    for (auto &readyok : readyoks) {
+        REQUIRE(readyok.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    }
+    REQUIRE(bestmove1.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(to_string(bestmove1.get().bestmove) == "e2e4");
+    REQUIRE(bestmove2.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(to_string(bestmove2.get().bestmove) == "d2d4");
+
+    // the mock never answers this one, so it fails when the engine stops
+    auto pending = handler.async_go(go_command{});
+    handler.stop();
+    REQUIRE(pending.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK_THROWS_AS(pending.get(), UCIError);
+}
+
+namespace {
+
+struct DetachedTask {
+    struct promise_type {
+        auto get_return_object() -> DetachedTask { return {}; }
+        auto initial_suspend() -> std::suspend_never { return {}; }
+        auto final_suspend() noexcept -> std::suspend_never { return {}; }
+        auto return_void() -> void {}
+        auto unhandled_exception() -> void { std::terminate(); }
+    };
+};
+
+auto analyse(UCIGuiHandler &handler, std::promise<std::string> &result) -> DetachedTask {
+    const auto info = co_await handler.co_handshake();
+    co_await handler.co_isready();
+    go_command command{};
+    command.depth = 1;
+    const auto bestmove = co_await handler.co_go(command);
+    result.set_value(info.id.name + " " + to_string(bestmove.bestmove));
+}
+
+} // namespace
+
+TEST_CASE("GuiHandler.Async.Coroutine", "[gui_handler]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name test_engine", "uciok"}; });
+    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+    mock_engine->when_receives("go depth 1", [](const std::string &) -> std::vector<std::string> { return {"bestmove e2e4"}; });
+
+    UCIGuiHandler handler{std::move(mock_engine)};
+    REQUIRE(handler.start({}));
+
+    std::promise<std::string> result;
+    auto future = result.get_future();
+    analyse(handler, result);
+    REQUIRE(future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(future.get() == "test_engine e2e4");
+    handler.stop();
+}
+
+TEST_CASE("GuiHandler.Async.Initialize", "[gui_handler]") {
+    constexpr std::size_t engine_count{8};
+    std::vector<std::unique_ptr<UCIGuiHandler>> handlers;
+    std::vector<std::shared_ptr<std::vector<std::string>>> received;
+    std::vector<std::future<initialize_info>> initialized;
+    const std::vector<setoption_command> options{
+        {.name = "hash", .value = "64"},
+        {.name = "Threads", .value = "0"},
+        {.name = "Style", .value = "Risky"},
+        {.name = "Ponder", .value = "true"},
+    };
+    for (std::size_t i = 0; i < engine_count; ++i) {
+        auto lines = std::make_shared<std::vector<std::string>>();
+        auto mock_engine = std::make_unique<test::EngineProcessMock>();
+        mock_engine->when_receives("uci", [lines](const std::string &line) -> std::vector<std::string> {
+            lines->push_back(line);
+            return {"id name test_engine", "option name Hash type spin default 16 min 1 max 1024", "option name Threads type spin default 1 min 1 max 64",
+                    "option name Style type combo default Normal var Solid var Normal", "uciok"};
+        });
+        for (const auto *command : {"setoption name hash value 64", "isready"}) {
+            mock_engine->when_receives(command, [lines](const std::string &line) -> std::vector<std::string> {
+                lines->push_back(line);
+                return line == "isready" ? std::vector<std::string>{"readyok"} : std::vector<std::string>{};
+            });
+        }
+        handlers.push_back(std::make_unique<UCIGuiHandler>(std::move(mock_engine)));
+        received.push_back(lines);
+    }
+    for (auto &handler : handlers) {
+        initialized.push_back(handler->initialize({}, options));
+    }
+
+    for (std::size_t i = 0; i < engine_count; ++i) {
+        REQUIRE(initialized[i].wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        const auto info = initialized[i].get();
+        CHECK(info.handshake.id.name == "test_engine");
+        CHECK(info.handshake.options.size() == 3);
+        REQUIRE(info.rejected_options.size() == 3);
+        CHECK(info.rejected_options[0].name == "Threads");
+        CHECK(info.rejected_options[1].name == "Style");
+        CHECK(info.rejected_options[2].name == "Ponder");
+        CHECK(*received[i] == std::vector<std::string>{"uci", "setoption name hash value 64", "isready"});
+        handlers[i]->stop();
+    }
+}
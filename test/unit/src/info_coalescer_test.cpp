@@ -0,0 +1,84 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include "chessuci/info_coalescer.h"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace chessuci;
+
+namespace {
+
+auto info(const std::string &info_str) -> search_info {
+    return UCIGuiHandler::parse_info_command(UCIHandler::tokenize(info_str));
+}
+
+} // namespace
+
+TEST_CASE("InfoCoalescer.Rate", "[info_coalescer]") {
+    using namespace std::chrono_literals;
+    InfoCoalescer coalescer{100ms};
+    std::vector<search_info> delivered;
+    const auto deliver = [&delivered](const search_info &info) -> void { delivered.push_back(info); };
+    const auto start = InfoCoalescer::clock::now();
+
+    coalescer.add(info("info depth 1 score cp 10 pv e2e4"), start, deliver);
+    REQUIRE(delivered.size() == 1);
+    CHECK_FALSE(coalescer.has_pending());
+
+    coalescer.add(info("info depth 2 score cp 20 pv e2e4 e7e5"), start + 10ms, deliver);
+    coalescer.add(info("info currmove d2d4 currmovenumber 2"), start + 20ms, deliver);
+    coalescer.add(info("info depth 3 score cp 15 pv d2d4"), start + 30ms, deliver);
+    coalescer.add(info("info nps 1000"), start + 40ms, deliver);
+    CHECK(delivered.size() == 1);
+    CHECK(coalescer.has_pending());
+
+    coalescer.add(info("info hashfull 5"), start + 100ms, deliver);
+    REQUIRE(delivered.size() == 2);
+    const auto &merged = delivered.back();
+    CHECK(merged.depth == 3);
+    CHECK(merged.score->cp == 15);
+    REQUIRE(merged.pv.size() == 1);
+    CHECK(to_string(merged.pv[0]) == "d2d4");
+    // the currmove was reported for the replaced principal variation
+    CHECK_FALSE(merged.currmovenumber.has_value());
+    CHECK(merged.nps == 1000);
+    CHECK(merged.hashfull == 5);
+
+    const auto statistics = coalescer.statistics();
+    CHECK(statistics.received == 6);
+    CHECK(statistics.delivered == 2);
+    CHECK(statistics.dropped == 1);
+    CHECK(statistics.merged == 3);
+}
+
+TEST_CASE("InfoCoalescer.Multipv", "[info_coalescer]") {
+    using namespace std::chrono_literals;
+    InfoCoalescer coalescer{1s};
+    std::vector<search_info> delivered;
+    const auto deliver = [&delivered](const search_info &info) -> void { delivered.push_back(info); };
+    const auto start = InfoCoalescer::clock::now();
+
+    coalescer.add(info("info depth 1 multipv 1 pv e2e4"), start, deliver);
+    coalescer.add(info("info depth 5 multipv 3 pv g1f3"), start, deliver);
+    coalescer.add(info("info depth 5 multipv 2 pv d2d4"), start, deliver);
+    coalescer.add(info("info depth 5 multipv 1 pv e2e4"), start, deliver);
+    coalescer.add(info("info string hello"), start, deliver);
+    REQUIRE(delivered.size() == 2);
+    CHECK(delivered[1].string == "hello");
+
+    coalescer.flush(deliver);
+    REQUIRE(delivered.size() == 5);
+    CHECK(delivered[2].multipv == 1);
+    CHECK(delivered[3].multipv == 2);
+    CHECK(delivered[4].multipv == 3);
+    CHECK_FALSE(coalescer.has_pending());
+
+    // lines beyond the limit are passed through instead of allocating pending lines
+    coalescer.add(info("info depth 6 multipv 2000000000 pv e2e4"), start, deliver);
+    REQUIRE(delivered.size() == 6);
+    CHECK(delivered[5].multipv == 2000000000);
+    CHECK_FALSE(coalescer.has_pending());
+}
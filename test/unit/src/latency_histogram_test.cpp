@@ -0,0 +1,127 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include "chessuci/latency_histogram.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <thread>
+
+using namespace chessuci;
+
+using namespace std::chrono_literals;
+
+TEST_CASE("LatencyHistogram.Buckets", "[latency_histogram]") {
+    for (std::uint64_t value = 0; value < 64; ++value) {
+        CHECK(LatencyHistogram::bucket_index(value) == value);
+        CHECK(LatencyHistogram::bucket_upper_bound(value) == value);
+    }
+    // every value lies in its bucket, and the bucket is at most 1/32 of the value wide
+    std::uint64_t previous_index{63};
+    for (std::uint64_t value = 64; value < (std::uint64_t{1} << 36); value += value / 7 + 1) {
+        const auto index = LatencyHistogram::bucket_index(value);
+        CHECK(index >= previous_index);
+        CHECK(index < LatencyHistogram::bucket_count);
+        const auto upper = LatencyHistogram::bucket_upper_bound(index);
+        CHECK(upper >= value);
+        CHECK(upper - value <= value / 32);
+        CHECK(LatencyHistogram::bucket_upper_bound(index - 1) < value);
+        previous_index = index;
+    }
+    CHECK(LatencyHistogram::bucket_index(std::numeric_limits<std::uint64_t>::max()) == LatencyHistogram::bucket_count - 1);
+}
+
+TEST_CASE("LatencyHistogram.Statistics", "[latency_histogram]") {
+    LatencyHistogram histogram;
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.percentile(50.0) == 0us);
+    CHECK(histogram.min() == 0us);
+
+    for (int value = 1; value <= 1000; ++value) {
+        histogram.record(std::chrono::microseconds{value});
+    }
+    histogram.record(-5us);
+    CHECK(histogram.count() == 1001);
+    CHECK(histogram.min() == 0us);
+    CHECK(histogram.max() == 1000us);
+    CHECK(histogram.mean() == 500us);
+    CHECK(histogram.percentile(0.0) == 0us);
+    CHECK(histogram.percentile(100.0) == 1000us);
+    const auto median = histogram.percentile(50.0);
+    CHECK(median >= 500us);
+    CHECK(median <= 516us);
+    const auto p99 = histogram.percentile(99.0);
+    CHECK(p99 >= 990us);
+    CHECK(p99 <= 1000us);
+
+    LatencyHistogram total;
+    total.record(2000us);
+    total.add(histogram);
+    CHECK(total.count() == 1002);
+    CHECK(total.max() == 2000us);
+    CHECK(total.min() == 0us);
+
+    histogram.reset();
+    CHECK(histogram.count() == 0);
+    CHECK(histogram.max() == 0us);
+    CHECK(histogram.percentile(99.0) == 0us);
+}
+
+TEST_CASE("LatencyHistogram.Concurrent", "[latency_histogram]") {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([&histogram, thread] -> void {
+            for (int value = 0; value < 10000; ++value) {
+                histogram.record(std::chrono::microseconds{thread * 10000 + value});
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    CHECK(histogram.count() == 40000);
+    CHECK(histogram.max() == 39999us);
+    CHECK(histogram.min() == 0us);
+}
+
+TEST_CASE("LatencyHistogram.GuiHandler", "[latency_histogram]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+    mock_engine->when_receives("go movetime 10", [](const std::string &) -> std::vector<std::string> {
+        return {"info depth 1 score cp 10 pv e2e4", "info depth 2 score cp 12 pv e2e4", "bestmove e2e4"};
+    });
+    mock_engine->when_receives("go infinite", [](const std::string &) -> std::vector<std::string> { return {"info depth 1 score cp 10 pv d2d4"}; });
+    mock_engine->when_receives("stop", [](const std::string &) -> std::vector<std::string> { return {"bestmove d2d4"}; });
+    UCIGuiHandler handler{std::move(mock_engine)};
+    REQUIRE(handler.start({}));
+
+    handler.async_isready().get();
+    handler.async_isready().get();
+    go_command movetime{};
+    movetime.movetime = 10;
+    handler.async_go(movetime).get();
+    go_command infinite{};
+    infinite.infinite = true;
+    auto bestmove = handler.async_go(infinite);
+    handler.send_stop();
+    CHECK(to_string(bestmove.get().bestmove) == "d2d4");
+
+    // pipelined searches are measured from their own go
+    auto first = handler.async_go(movetime);
+    auto second = handler.async_go(movetime);
+    first.get();
+    second.get();
+
+    const auto &latencies = handler.latencies();
+    CHECK(latencies.isready.count() == 2);
+    CHECK(latencies.first_info.count() == 4);
+    CHECK(latencies.bestmove.count() == 4);
+    CHECK(latencies.stop.count() == 1);
+    CHECK(latencies.bestmove.max() >= latencies.first_info.min());
+    CHECK(latencies.bestmove.max() < 5s);
+}
@@ -0,0 +1,124 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include "chessuci/live_analysis.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <thread>
+
+using namespace chessuci;
+
+namespace {
+
+auto info(const std::string &line) -> search_info {
+    return UCIGuiHandler::parse_info_command(UCIHandler::tokenize(line));
+}
+
+} // namespace
+
+TEST_CASE("LiveAnalysis.Lines", "[live_analysis]") {
+    LiveAnalysis analysis;
+    std::vector<int> changes;
+    analysis.on_change([&changes](int multipv) -> void { changes.push_back(multipv); });
+
+    analysis.update(info("info depth 5 seldepth 8 multipv 2 score cp -15 nodes 1000 time 20 pv d2d4 d7d5"));
+    analysis.update(info("info depth 5 score cp 20 pv e2e4 e7e5 g1f3"));
+    analysis.update(info("info currmove e2e4 currmovenumber 1 nodes 2000"));
+    analysis.update(info("info depth 6 multipv 1 score cp 25 lowerbound"));
+    analysis.update(info("info depth 6 multipv 40 score cp 0 pv a2a3"));
+    CHECK(changes == std::vector<int>{2, 1, 1});
+    CHECK(analysis.version() == 3);
+
+    const auto lines = analysis.lines();
+    REQUIRE(lines.size() == 2);
+    CHECK(lines[0].multipv == 1);
+    CHECK(lines[0].depth == 6);
+    CHECK(lines[0].score.cp == 25);
+    CHECK(lines[0].score.lowerbound);
+    // a score without a principal variation keeps the previous one
+    REQUIRE(lines[0].principal_variation().size() == 3);
+    CHECK(to_string(lines[0].principal_variation()[2]) == "g1f3");
+    CHECK(lines[0].version == 3);
+    CHECK(lines[1].multipv == 2);
+    CHECK(lines[1].seldepth == 8);
+    CHECK(lines[1].nodes == 1000);
+    CHECK(lines[1].time == 20);
+    CHECK(lines[1].score.cp == -15);
+
+    CHECK_FALSE(analysis.line(3).has_value());
+    CHECK_FALSE(analysis.line(0).has_value());
+    analysis.clear();
+    CHECK(changes.back() == 0);
+    CHECK(analysis.lines().empty());
+    CHECK_FALSE(analysis.line(1).has_value());
+}
+
+TEST_CASE("LiveAnalysis.ConcurrentReaders", "[live_analysis]") {
+    LiveAnalysis analysis;
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+    std::vector<std::thread> readers;
+    for (int reader = 0; reader < 3; ++reader) {
+        readers.emplace_back([&analysis, &done, &inconsistent] -> void {
+            while (!done) {
+                // every info has a matching depth, nodes and principal variation length
+                for (const auto &line : analysis.lines()) {
+                    if (line.nodes != line.depth * 1000 || line.pv_length != static_cast<std::size_t>(line.depth % 8 + 1)) {
+                        ++inconsistent;
+                    }
+                }
+            }
+        });
+    }
+
+    const std::vector<std::string> moves{"e2e4", "e7e5", "g1f3", "b8c6", "f1b5", "a7a6", "b5a4", "g8f6"};
+    for (int depth = 1; depth <= 20000; ++depth) {
+        search_info update{};
+        update.depth = depth;
+        update.nodes = depth * 1000;
+        update.multipv = depth % 4 + 1;
+        update.score = score_info{.cp = depth, .mate = std::nullopt, .lowerbound = false, .upperbound = false};
+        for (int move = 0; move <= depth % 8; ++move) {
+            update.pv.push_back(parse_uci_move(moves[static_cast<std::size_t>(move)]).value());
+        }
+        analysis.update(update);
+    }
+    done = true;
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    CHECK(inconsistent == 0);
+    CHECK(analysis.lines().size() == 4);
+}
+
+TEST_CASE("LiveAnalysis.GuiHandler", "[live_analysis]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("go depth 2", [](const std::string &) -> std::vector<std::string> {
+        return {"info depth 1 multipv 1 score cp 10 pv e2e4", "info depth 1 multipv 2 score cp 5 pv d2d4", "bestmove e2e4"};
+    });
+    mock_engine->when_receives("go depth 1", [](const std::string &) -> std::vector<std::string> {
+        return {"info depth 1 score cp 30 pv c2c4", "bestmove c2c4"};
+    });
+    UCIGuiHandler handler{std::move(mock_engine)};
+    LiveAnalysis analysis;
+    handler.set_live_analysis(analysis);
+    REQUIRE(handler.start({}));
+
+    go_command go{};
+    go.depth = 2;
+    handler.async_go(go).get();
+    CHECK(analysis.lines().size() == 2);
+
+    // the lines of the previous search are dropped with the first info
+    go.depth = 1;
+    handler.async_go(go).get();
+    const auto lines = analysis.lines();
+    REQUIRE(lines.size() == 1);
+    CHECK(to_string(lines[0].pv[0]) == "c2c4");
+    CHECK(lines[0].score.cp == 30);
+}
@@ -0,0 +1,185 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/match_runner.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+#include "helper/EngineProcessMock.h"
+
+using namespace chessuci;
+using chesscore::Color;
+
+namespace {
+
+auto cp(int value) -> std::optional<score_info> {
+    score_info score{};
+    score.cp = value;
+    return score;
+}
+
+auto count_occurrences(const std::string &text, const std::string &pattern) -> std::size_t {
+    std::size_t count{0};
+    for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("MatchRunner.Adjudication.Resign", "[match_runner]") {
+    AdjudicationSettings settings{};
+    settings.resign_score = 500;
+    settings.resign_move_count = 2;
+    Adjudicator adjudicator{settings};
+
+    CHECK_FALSE(adjudicator.add_score(Color::White, cp(600), 20).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::Black, cp(-700), 20).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::White, cp(650), 21).has_value());
+    // a move without score interrupts the sequence
+    CHECK_FALSE(adjudicator.add_score(Color::Black, std::nullopt, 21).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::White, cp(650), 22).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::Black, cp(-800), 22).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::White, cp(700), 23).has_value());
+    CHECK(adjudicator.add_score(Color::Black, cp(-900), 23) == GameResult::WhiteWins);
+
+    adjudicator.reset();
+    score_info mated{};
+    mated.mate = -3;
+    CHECK_FALSE(adjudicator.add_score(Color::White, mated, 30).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::Black, cp(900), 30).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::White, mated, 31).has_value());
+    CHECK(adjudicator.add_score(Color::Black, cp(1000), 31) == GameResult::BlackWins);
+}
+
+TEST_CASE("MatchRunner.Adjudication.Draw", "[match_runner]") {
+    AdjudicationSettings settings{};
+    settings.draw_score = 10;
+    settings.draw_move_count = 2;
+    settings.draw_move_number = 30;
+    Adjudicator adjudicator{settings};
+
+    // too early in the game
+    for (int move = 27; move < 30; ++move) {
+        CHECK_FALSE(adjudicator.add_score(Color::White, cp(0), move).has_value());
+        CHECK_FALSE(adjudicator.add_score(Color::Black, cp(0), move).has_value());
+    }
+    CHECK_FALSE(adjudicator.add_score(Color::White, cp(5), 30).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::Black, cp(-15), 30).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::White, cp(5), 31).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::Black, cp(-10), 31).has_value());
+    CHECK_FALSE(adjudicator.add_score(Color::White, cp(0), 32).has_value());
+    CHECK(adjudicator.add_score(Color::Black, cp(3), 32) == GameResult::Draw);
+}
+
+TEST_CASE("MatchRunner.Pgn", "[match_runner]") {
+    GameRecord game{};
+    game.round = 3;
+    game.white = "Engine A";
+    game.black = "Engine B";
+    game.opening = "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1";
+    game.black_starts = true;
+    game.moves = {"e5", "Nf3", "Nc6", "Bb5", "a6"};
+    game.result = GameResult::Draw;
+    game.termination = "adjudication";
+    game.reason = "Draw by adjudication";
+
+    CHECK(
+        MatchRunner::format_pgn(game, "Regression") == "[Event \"Regression\"]\n"
+                                                       "[Site \"?\"]\n"
+                                                       "[Date \"????.??.??\"]\n"
+                                                       "[Round \"3\"]\n"
+                                                       "[White \"Engine A\"]\n"
+                                                       "[Black \"Engine B\"]\n"
+                                                       "[Result \"1/2-1/2\"]\n"
+                                                       "[SetUp \"1\"]\n"
+                                                       "[FEN \"rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq e3 0 1\"]\n"
+                                                       "[PlyCount \"5\"]\n"
+                                                       "[Termination \"adjudication\"]\n"
+                                                       "\n"
+                                                       "1... e5 2. Nf3 Nc6 3. Bb5 a6 {Draw by adjudication} 1/2-1/2\n"
+                                                       "\n"
+    );
+
+    game.opening = position_command::startpos;
+    game.black_starts = false;
+    game.moves.assign(40, "Nf3");
+    game.result = GameResult::WhiteWins;
+    game.reason.clear();
+    const auto pgn = MatchRunner::format_pgn(game, "Regression");
+    CHECK(pgn.find("[FEN") == std::string::npos);
+    const auto movetext = pgn.substr(pgn.find("\n\n") + 2);
+    std::istringstream lines{movetext};
+    std::string line;
+    while (std::getline(lines, line)) {
+        CHECK(line.size() <= 80);
+    }
+    CHECK(movetext.ends_with(" 1-0\n\n"));
+}
+
+TEST_CASE("MatchRunner.Run", "[match_runner]") {
+    constexpr std::size_t game_count{12};
+
+    MatchSettings settings{};
+    settings.engines[0].name = "First";
+    settings.games = game_count;
+    settings.concurrency = 4;
+    // stalemate, so the games end without a search
+    settings.openings = {"7k/5Q2/6K1/8/8/8/8/8 b - - 0 1"};
+    settings.sprt = SprtSettings{};
+    MatchRunner runner{settings};
+    runner.set_process_creator([]() -> std::unique_ptr<EngineProcess> {
+        auto mock_engine = std::make_unique<test::EngineProcessMock>();
+        mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name Mock Engine", "uciok"}; });
+        mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+        return mock_engine;
+    });
+
+    std::ostringstream pgn;
+    std::vector<GameRecord> games;
+    REQUIRE(runner.run(pgn, [&games](const GameRecord &game) -> void { games.push_back(game); }));
+    REQUIRE(games.size() == game_count);
+    for (const auto &game : games) {
+        CHECK(game.result == GameResult::Draw);
+        CHECK(game.reason == "Draw by stalemate");
+        CHECK(game.white == (game.round % 2 == 1 ? "First" : "Mock Engine"));
+        CHECK(game.black == (game.round % 2 == 1 ? "Mock Engine" : "First"));
+    }
+    CHECK(count_occurrences(pgn.str(), "[Result \"1/2-1/2\"]") == game_count);
+
+    const auto statistics = runner.statistics();
+    CHECK(statistics.games == game_count);
+    CHECK(statistics.draws == game_count);
+    CHECK(statistics.forfeits == 0);
+    REQUIRE(runner.sprt().has_value());
+    CHECK(runner.sprt()->pentanomial() == std::array<std::uint64_t, 5>{0, 0, game_count / 2, 0, 0});
+    CHECK(runner.sprt()->decision() == SprtDecision::Continue);
+
+    // a cancelled match does not cancel the next one
+    runner.cancel();
+    std::ostringstream second_pgn;
+    REQUIRE(runner.run(second_pgn));
+    CHECK(runner.statistics().games == game_count);
+}
+
+TEST_CASE("MatchRunner.InvalidOpening", "[match_runner]") {
+    MatchSettings settings{};
+    settings.games = 2;
+    settings.openings = {position_command::startpos, "not a fen"};
+    MatchRunner runner{settings};
+    bool engine_created{false};
+    runner.set_process_creator([&engine_created]() -> std::unique_ptr<EngineProcess> {
+        engine_created = true;
+        return std::make_unique<test::EngineProcessMock>();
+    });
+
+    std::ostringstream pgn;
+    CHECK_FALSE(runner.run(pgn));
+    CHECK(runner.last_error() == "Invalid opening not a fen");
+    CHECK_FALSE(engine_created);
+    CHECK(runner.statistics().games == 0);
+}
@@ -0,0 +1,150 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_handler.h"
+#include "chessuci/metrics.h"
+#include <catch2/catch_test_macros.hpp>
+
+#ifndef _WIN32
+#include "chessuci/socket_unix.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+using namespace chessuci;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto count_of(const std::map<std::string, std::uint64_t> &commands, const std::string &name) -> std::uint64_t {
+    const auto command_it = commands.find(name);
+    return command_it != commands.end() ? command_it->second : 0;
+}
+
+auto test_snapshot() -> MetricsSnapshot {
+    return MetricsSnapshot{
+        .lines_read = 10,
+        .lines_written = 4,
+        .bytes_read = 300,
+        .bytes_written = 40,
+        .parse_errors = 1,
+        .unknown_commands = 2,
+        .callback_time = std::chrono::milliseconds{1500},
+        .commands_received = {{"info", 8}, {"bestmove", 1}},
+        .commands_sent = {{"go", 1}},
+    };
+}
+
+} // namespace
+
+TEST_CASE("Metrics.ThreadCounters", "[metrics]") {
+    const auto before = Metrics::snapshot();
+    std::vector<std::thread> threads;
+    for (int thread = 0; thread < 4; ++thread) {
+        threads.emplace_back([] -> void {
+            for (int line = 0; line < 1000; ++line) {
+                Metrics::add(Metric::LinesRead);
+                Metrics::add(Metric::BytesRead, 10);
+                Metrics::count_received("info");
+            }
+            Metrics::count_sent("go depth 10");
+            Metrics::count_sent("frobnicate now");
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // the counts of finished threads are kept
+    const auto after = Metrics::snapshot();
+    CHECK(after.lines_read - before.lines_read == 4000);
+    CHECK(after.bytes_read - before.bytes_read == 40000);
+    CHECK(count_of(after.commands_received, "info") - count_of(before.commands_received, "info") == 4000);
+    CHECK(count_of(after.commands_sent, "go") - count_of(before.commands_sent, "go") == 4);
+    CHECK(count_of(after.commands_sent, "other") - count_of(before.commands_sent, "other") == 4);
+}
+
+TEST_CASE("Metrics.EngineHandler", "[metrics]") {
+    std::stringstream input;
+    std::stringstream output;
+    UCIEngineHandler handler{input, output};
+
+    handler.on_isready([&handler]() -> void { handler.send_readyok(); });
+
+    const auto before = Metrics::snapshot();
+    handler.process_line("isready");
+    handler.process_line("frobnicate");
+    handler.process_line("go depth deep");
+    const auto after = Metrics::snapshot();
+
+    CHECK(count_of(after.commands_received, "isready") - count_of(before.commands_received, "isready") == 1);
+    CHECK(count_of(after.commands_received, "other") - count_of(before.commands_received, "other") == 1);
+    CHECK(count_of(after.commands_sent, "readyok") - count_of(before.commands_sent, "readyok") == 1);
+    CHECK(after.unknown_commands - before.unknown_commands == 1);
+    CHECK(after.parse_errors - before.parse_errors == 1);
+    CHECK(after.lines_written - before.lines_written == 1);
+    CHECK(after.bytes_written - before.bytes_written == 8);
+    CHECK(after.callback_time > before.callback_time);
+}
+
+TEST_CASE("Metrics.Exporters", "[metrics]") {
+    const auto snapshot = test_snapshot();
+
+    const auto prometheus = Metrics::to_prometheus(snapshot);
+    CHECK(prometheus.find("# TYPE chessuci_lines_read_total counter\nchessuci_lines_read_total 10\n") != std::string::npos);
+    CHECK(prometheus.find("chessuci_callback_seconds_total 1.5\n") != std::string::npos);
+    CHECK(prometheus.find("chessuci_commands_total{direction=\"received\",command=\"info\"} 8\n") != std::string::npos);
+    CHECK(prometheus.find("chessuci_commands_total{direction=\"sent\",command=\"go\"} 1\n") != std::string::npos);
+
+    CHECK(Metrics::to_json(snapshot) ==
+          "{\"lines_read\":10,\"lines_written\":4,\"bytes_read\":300,\"bytes_written\":40,\"parse_errors\":1,\"unknown_commands\":2,"
+          "\"callback_nanoseconds\":1500000000,\"commands_received\":{\"bestmove\":1,\"info\":8},\"commands_sent\":{\"go\":1}}\n");
+    CHECK(Metrics::to_json(MetricsSnapshot{}).find("\"commands_received\":{},\"commands_sent\":{}") != std::string::npos);
+
+    const auto path = fs::temp_directory_path() / "chessuci_metrics.json";
+    REQUIRE(Metrics::write_file(path, MetricsFormat::Json));
+    std::ifstream stream{path};
+    std::string text{std::istreambuf_iterator<char>{stream}, std::istreambuf_iterator<char>{}};
+    CHECK(text.starts_with("{\"lines_read\":"));
+    CHECK_FALSE(fs::exists(fs::path{path}.concat(".tmp")));
+    stream.close();
+    fs::remove(path);
+}
+
+#ifndef _WIN32
+TEST_CASE("Metrics.Socket", "[metrics]") {
+    const auto path = fs::temp_directory_path() / "chessuci_metrics.sock";
+    fs::remove(path);
+    std::string error;
+    RemoteEndpoint bound;
+    const auto listener = socket_listen(RemoteEndpoint::local(path), bound, error);
+    REQUIRE(listener != -1);
+
+    std::string received;
+    std::thread collector{[listener, &received] -> void {
+        const auto connection = accept(listener, nullptr, nullptr);
+        char buffer[4096];
+        ssize_t size{0};
+        while ((size = read(connection, buffer, sizeof(buffer))) > 0) {
+            received.append(buffer, static_cast<std::size_t>(size));
+        }
+        close(connection);
+    }};
+    CHECK(Metrics::write_socket(path, MetricsFormat::Prometheus, error));
+    collector.join();
+    close(listener);
+    fs::remove(path);
+
+    CHECK(received.starts_with("# HELP chessuci_lines_read_total"));
+    CHECK_FALSE(Metrics::write_socket(path, MetricsFormat::Json, error));
+    CHECK_FALSE(error.empty());
+}
+#endif
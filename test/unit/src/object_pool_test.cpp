@@ -0,0 +1,90 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/object_pool.h"
+#include "chessuci/uci_handler.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <optional>
+#include <vector>
+
+using namespace chessuci;
+
+namespace {
+
+struct Counted {
+    static inline int alive{0};
+    Counted() { ++alive; }
+    ~Counted() { --alive; }
+    Counted(const Counted &) = delete;
+    auto operator=(const Counted &) -> Counted & = delete;
+};
+
+} // namespace
+
+TEST_CASE("ObjectPool.Reuse", "[object_pool]") {
+    ObjectPool<std::vector<int>> pool;
+    const std::vector<int> *first_address{nullptr};
+    {
+        auto first = pool.acquire();
+        first->assign(100, 7);
+        first_address = first.get();
+        auto second = pool.acquire();
+        CHECK(second.get() != first_address);
+        CHECK(pool.created_count() == 2);
+        CHECK(pool.idle_count() == 0);
+    }
+    CHECK(pool.idle_count() == 2);
+
+    // returned objects keep their state and capacity
+    auto reused = pool.acquire();
+    auto other = pool.acquire();
+    CHECK((reused.get() == first_address || other.get() == first_address));
+    CHECK(pool.created_count() == 2);
+    const auto &kept = reused.get() == first_address ? *reused : *other;
+    CHECK(kept.size() == 100);
+
+    // objects may outlive their pool, they are deleted when they are returned
+    std::optional<ObjectPool<Counted>> short_lived{std::in_place};
+    auto orphan = short_lived->acquire();
+    short_lived->acquire().reset();
+    CHECK(Counted::alive == 2);
+    short_lived.reset();
+    CHECK(Counted::alive == 1);
+    orphan.reset();
+    CHECK(Counted::alive == 0);
+}
+
+TEST_CASE("ObjectPool.Tokenize", "[object_pool][uci_handler]") {
+    UCIHandler::TokenBuffer buffer{.tokens = {"old", "tokens", "that", "are", "replaced", "and", "kept"}, .spare = {}};
+    UCIHandler::tokenize(" info\tdepth  12 \r\n pv e2e4 ", buffer);
+    CHECK(buffer.tokens == TokenList{"info", "depth", "12", "pv", "e2e4"});
+    CHECK(buffer.spare.size() == 2);
+    UCIHandler::tokenize("   ", buffer);
+    CHECK(buffer.tokens.empty());
+    CHECK(buffer.spare.size() == 7);
+
+    // the spare strings are taken again for longer lines
+    UCIHandler::tokenize("go depth 3", buffer);
+    CHECK(buffer.tokens == TokenList{"go", "depth", "3"});
+    CHECK(buffer.spare.size() == 4);
+    CHECK(UCIHandler::tokenize("go\vinfinite\f") == TokenList{"go", "infinite"});
+}
+
+TEST_CASE("ObjectPool.ReentrantProcessLine", "[object_pool][uci_handler]") {
+    UCIHandler handler;
+    std::vector<TokenList> received;
+    handler.on_unknown_command([&handler, &received](const TokenList &tokens) -> void {
+        if (tokens[0] == "outer") {
+            handler.process_line("inner line that is longer than the outer one");
+        }
+        // the tokens of the outer line are not overwritten by the inner line
+        received.push_back(tokens);
+    });
+    handler.process_line("outer line");
+    REQUIRE(received.size() == 2);
+    CHECK(received[0].size() == 9);
+    CHECK(received[1] == TokenList{"outer", "line"});
+}
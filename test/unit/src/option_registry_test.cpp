@@ -0,0 +1,102 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_handler.h"
+#include "chessuci/option_registry.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include <sstream>
+
+using namespace chessuci;
+
+TEST_CASE("OptionRegistry.Types", "[option_registry]") {
+    OptionRegistry registry;
+    std::atomic<bool> ponder{true};
+    std::atomic<int> hash{0};
+    std::atomic<std::size_t> style{9};
+    std::string book;
+    int cleared{0};
+    registry.add_check("Ponder", false, ponder);
+    registry.add_spin("Hash", 16, 1, 1024, hash);
+    registry.add_combo("Style", "Normal", {"Solid", "Normal", "Risky"}, style);
+    registry.add_string("Book File", "", [&book](std::string_view value) -> void { book = value; });
+    registry.add_button("Clear Hash", [&cleared] -> void { ++cleared; });
+
+    // the defaults are applied when the options are added
+    CHECK_FALSE(ponder);
+    CHECK(hash == 16);
+    CHECK(style == 1);
+    REQUIRE(registry.options().size() == 5);
+    CHECK(registry.options()[1].to_uci_string() == "option name Hash type spin default 16 min 1 max 1024");
+    CHECK(registry.options()[3].to_uci_string() == "option name Book File type string default <empty>");
+
+    CHECK(registry.set("ponder", "true") == OptionResult::Applied);
+    CHECK(ponder);
+    CHECK(registry.set("HASH", "256") == OptionResult::Applied);
+    CHECK(hash == 256);
+    CHECK(registry.set("Hash", "2048") == OptionResult::InvalidValue);
+    CHECK(registry.set("Hash", "many") == OptionResult::InvalidValue);
+    CHECK(hash == 256);
+    CHECK(registry.set("style", "risky") == OptionResult::Applied);
+    CHECK(style == 2);
+    CHECK(registry.set("Style", "Wild") == OptionResult::InvalidValue);
+    CHECK(registry.set("book file", "/books/main book.bin") == OptionResult::Applied);
+    CHECK(book == "/books/main book.bin");
+    CHECK(registry.set("Book File", "<empty>") == OptionResult::Applied);
+    CHECK(book.empty());
+    CHECK(registry.set("Clear Hash", std::nullopt) == OptionResult::Applied);
+    CHECK(registry.set("Clear Hash", "now") == OptionResult::InvalidValue);
+    CHECK(cleared == 1);
+    CHECK(registry.set("Threads", "4") == OptionResult::UnknownOption);
+
+    CHECK(registry.find("book FILE") == &registry.options()[3]);
+    CHECK(registry.find("Book") == nullptr);
+    CHECK_THROWS_AS(registry.add_check("PONDER", true, ponder), UCIError);
+    CHECK_THROWS_AS(registry.add_spin("Threads", 0, 1, 64, hash), UCIError);
+    CHECK_THROWS_AS(registry.add_combo("Mode", "Fast", {"Slow"}, style), UCIError);
+}
+
+TEST_CASE("OptionRegistry.Apply", "[option_registry]") {
+    OptionRegistry registry;
+    std::atomic<int> threads{0};
+    std::string book;
+    registry.add_spin("Threads", 1, 1, 64, threads);
+    registry.add_string("Book File", "book.bin", [&book](std::string_view value) -> void { book = value; });
+    CHECK(book == "book.bin");
+
+    CHECK(registry.apply(UCIHandler::tokenize("setoption name threads value 8")) == OptionResult::Applied);
+    CHECK(threads == 8);
+    CHECK(registry.apply(UCIHandler::tokenize("setoption name Book  File value my   books.bin")) == OptionResult::Applied);
+    CHECK(book == "my books.bin");
+    CHECK(registry.apply(UCIHandler::tokenize("setoption name Book value x")) == OptionResult::UnknownOption);
+    CHECK(registry.apply(UCIHandler::tokenize("setoption name Book File Name value x")) == OptionResult::UnknownOption);
+    CHECK(registry.apply(UCIHandler::tokenize("setoption name Threads")) == OptionResult::InvalidValue);
+    CHECK(registry.apply(UCIHandler::tokenize("setoption value 3")) == OptionResult::UnknownOption);
+    CHECK(OptionRegistry::hash_name("Book File") == OptionRegistry::hash_name("BOOK FILE"));
+}
+
+TEST_CASE("OptionRegistry.EngineHandler", "[option_registry][engine_handler]") {
+    std::stringstream input;
+    std::stringstream output;
+    UCIEngineHandler handler{input, output};
+    std::atomic<int> hash{0};
+    handler.options().add_spin("Hash", 16, 1, 1024, hash);
+    std::vector<setoption_command> forwarded;
+    handler.on_setoption([&forwarded](const setoption_command &command) -> void { forwarded.push_back(command); });
+    std::vector<ParseError> errors;
+    handler.on_parse_error([&errors](const ParseError &error, const TokenList &) -> void { errors.push_back(error); });
+
+    handler.send_uciok();
+    CHECK(output.str() == "option name Hash type spin default 16 min 1 max 1024\nuciok\n");
+
+    handler.process_line("setoption name hash value 64");
+    handler.process_line("setoption name Hash value 4096");
+    handler.process_line("setoption name UCI_Chess960 value true");
+    CHECK(hash == 64);
+    REQUIRE(errors.size() == 1);
+    CHECK(errors[0] == ParseError{.type = ParseErrorType::InvalidOptionValue, .token = "Hash"});
+    REQUIRE(forwarded.size() == 1);
+    CHECK(forwarded[0].name == "UCI_Chess960");
+}
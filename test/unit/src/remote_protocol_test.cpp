@@ -0,0 +1,73 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/remote_protocol.h"
+#include <catch2/catch_test_macros.hpp>
+
+using namespace chessuci;
+
+TEST_CASE("Remote.Endpoint.Parse", "[remote]") {
+    const auto tcp = parse_remote_endpoint("tcp://127.0.0.1:4711");
+    REQUIRE(tcp.has_value());
+    CHECK(tcp->kind == RemoteEndpoint::Kind::Tcp);
+    CHECK(tcp->host == "127.0.0.1");
+    CHECK(tcp->port == 4711);
+    CHECK(to_string(tcp.value()) == "tcp://127.0.0.1:4711");
+
+    const auto ipv6 = parse_remote_endpoint("tcp://[::1]:80");
+    REQUIRE(ipv6.has_value());
+    CHECK(ipv6->host == "::1");
+    CHECK(to_string(ipv6.value()) == "tcp://[::1]:80");
+
+    const auto local = parse_remote_endpoint("unix:/tmp/engines.sock");
+    REQUIRE(local.has_value());
+    CHECK(local->kind == RemoteEndpoint::Kind::Local);
+    CHECK(local->path == "/tmp/engines.sock");
+    CHECK(parse_remote_endpoint("unix:///tmp/engines.sock")->path == "/tmp/engines.sock");
+
+    CHECK_FALSE(parse_remote_endpoint("tcp://localhost").has_value());
+    CHECK_FALSE(parse_remote_endpoint("tcp://localhost:99999").has_value());
+    CHECK_FALSE(parse_remote_endpoint("unix:").has_value());
+    CHECK_FALSE(parse_remote_endpoint("http://localhost:80").has_value());
+}
+
+TEST_CASE("Remote.Frame.Roundtrip", "[remote]") {
+    std::string buffer;
+    encode_frame(RemoteFrame{.session = 7, .verb = RemoteFrame::Verb::Line, .payload = "info depth 3 pv e2e4"}, buffer);
+    encode_frame(RemoteFrame{.session = 8, .verb = RemoteFrame::Verb::Kill, .payload = {}}, buffer);
+    CHECK(buffer == "7 line info depth 3 pv e2e4\n8 kill\n");
+
+    const auto line = decode_frame("7 line info depth 3 pv e2e4");
+    REQUIRE(line.has_value());
+    CHECK(line->session == 7);
+    CHECK(line->verb == RemoteFrame::Verb::Line);
+    CHECK(line->payload == "info depth 3 pv e2e4");
+
+    const auto kill = decode_frame("8 kill");
+    REQUIRE(kill.has_value());
+    CHECK(kill->verb == RemoteFrame::Verb::Kill);
+    CHECK(kill->payload.empty());
+
+    CHECK_FALSE(decode_frame("8").has_value());
+    CHECK_FALSE(decode_frame("x line uci").has_value());
+    CHECK_FALSE(decode_frame("8 jump").has_value());
+}
+
+TEST_CASE("Remote.Frame.ProcessParams", "[remote]") {
+    const ProcessParams params{.executable = "/usr/bin/engine", .arguments = {"--threads", "4"}, .working_directory = "/tmp"};
+    const auto decoded = decode_process_params(encode_process_params(params));
+    REQUIRE(decoded.has_value());
+    CHECK(decoded->executable == params.executable);
+    CHECK(decoded->arguments == params.arguments);
+    CHECK(decoded->working_directory == params.working_directory);
+
+    const auto minimal = decode_process_params(encode_process_params(ProcessParams{.executable = "engine"}));
+    REQUIRE(minimal.has_value());
+    CHECK(minimal->executable == "engine");
+    CHECK(minimal->arguments.empty());
+    CHECK_FALSE(minimal->working_directory.has_value());
+
+    CHECK_FALSE(decode_process_params("engine").has_value());
+}
@@ -0,0 +1,81 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/sprt.h"
+#include <catch2/catch_approx.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+
+using namespace chessuci;
+
+namespace {
+
+auto add_pairs(Sprt &sprt, int half_points, int count) -> void {
+    for (int index = 0; index < count; ++index) {
+        sprt.add_pair(half_points);
+    }
+}
+
+} // namespace
+
+TEST_CASE("Sprt.Pentanomial", "[sprt]") {
+    Sprt sprt{SprtSettings{.elo0 = 0.0, .elo1 = 5.0, .alpha = 0.05, .beta = 0.05}};
+    CHECK(sprt.llr() == 0.0);
+    CHECK(sprt.decision() == SprtDecision::Continue);
+    CHECK(sprt.lower_bound() == Catch::Approx(-2.944439));
+    CHECK(sprt.upper_bound() == Catch::Approx(2.944439));
+
+    sprt.add_pair(0.0, 0.5);
+    sprt.add_pair(1.0, 0.0);
+    sprt.add_pair(0.5, 1.0);
+    CHECK(sprt.pentanomial() == std::array<std::uint64_t, 5>{0, 1, 1, 1, 0});
+
+    add_pairs(sprt, 0, 10);
+    add_pairs(sprt, 1, 29);
+    add_pairs(sprt, 2, 49);
+    add_pairs(sprt, 3, 39);
+    add_pairs(sprt, 4, 20);
+    REQUIRE(sprt.pairs() == 150);
+    CHECK(sprt.llr() == Catch::Approx(0.653223));
+    CHECK(sprt.decision() == SprtDecision::Continue);
+
+    const auto estimate = sprt.elo();
+    CHECK(estimate.elo == Catch::Approx(34.86007));
+    CHECK(estimate.lower == Catch::Approx(3.953704));
+    CHECK(estimate.upper == Catch::Approx(66.32778));
+    CHECK(sprt.summary() == "LLR 0.65 (-2.94, 2.94) [0.00, 5.00] Elo 34.9 +/- 31.2 pairs 150 (10, 30, 50, 40, 20) continue");
+}
+
+TEST_CASE("Sprt.Decision", "[sprt]") {
+    Sprt stronger{};
+    auto decision = SprtDecision::Continue;
+    for (int pair = 0; pair < 10000 && decision == SprtDecision::Continue; ++pair) {
+        decision = stronger.add_pair(pair % 4 == 0 ? 1 : 3);
+    }
+    CHECK(decision == SprtDecision::AcceptH1);
+    CHECK(stronger.llr() >= stronger.upper_bound());
+
+    Sprt equal{SprtSettings{.elo0 = 0.0, .elo1 = 10.0, .alpha = 0.05, .beta = 0.05}};
+    decision = SprtDecision::Continue;
+    for (int pair = 0; pair < 10000 && decision == SprtDecision::Continue; ++pair) {
+        decision = equal.add_pair(pair % 2 == 0 ? 1 : 3);
+    }
+    CHECK(decision == SprtDecision::AcceptH0);
+    CHECK(equal.elo().elo == Catch::Approx(0.0).margin(1.0));
+
+    // identical pair scores still carry information
+    Sprt draws{};
+    add_pairs(draws, 2, 2000);
+    CHECK(draws.llr() < 0.0);
+    CHECK(draws.decision() == SprtDecision::AcceptH0);
+
+    // a perfect score has a finite Elo estimate
+    Sprt wins{};
+    add_pairs(wins, 4, 10);
+    CHECK(wins.llr() > 0.0);
+    CHECK(std::isfinite(wins.elo().elo));
+    CHECK(std::isfinite(wins.elo().upper));
+}
@@ -0,0 +1,106 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include "chessuci/trace.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <fstream>
+#include <thread>
+
+using namespace chessuci;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto detail_of(const TraceEvent &event) -> std::string {
+    return event.detail.data();
+}
+
+} // namespace
+
+TEST_CASE("Trace.RingBuffers", "[trace]") {
+    Trace::record(1, "before", TracePhase::Instant);
+    Trace::start(4);
+    REQUIRE(Trace::enabled());
+    for (int index = 0; index < 10; ++index) {
+        Trace::record(1, "main", TracePhase::Instant, std::to_string(index));
+    }
+    std::thread other{[] -> void { Trace::record(2, "other", TracePhase::Instant, std::string(100, 'x')); }};
+    other.join();
+    Trace::stop();
+    Trace::record(1, "after", TracePhase::Instant);
+
+    // only the latest events of every thread are kept
+    const auto events = Trace::events();
+    REQUIRE(events.size() == 5);
+    CHECK(std::ranges::is_sorted(events, {}, &TraceEvent::timestamp));
+    CHECK(detail_of(events[0]) == "6");
+    CHECK(detail_of(events[3]) == "9");
+    CHECK(std::string{events[4].name} == "other");
+    CHECK(events[4].track == 2);
+    CHECK(detail_of(events[4]) == std::string(63, 'x'));
+
+    Trace::start(4);
+    Trace::stop();
+    CHECK(Trace::events().empty());
+}
+
+TEST_CASE("Trace.ChromeFormat", "[trace]") {
+    Trace::start();
+    Trace::name_track(7, "Engine \"7\"");
+    Trace::record(7, "handle", TracePhase::Begin, "go");
+    Trace::record(7, "handle", TracePhase::End);
+    Trace::record(8, "sent", TracePhase::Instant, "position startpos\tmoves");
+    Trace::stop();
+
+    const auto json = Trace::to_json();
+    CHECK(json.starts_with("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    CHECK(json.find("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":7,\"args\":{\"name\":\"Engine \\\"7\\\"\"}}") != std::string::npos);
+    CHECK(json.find("\"tid\":8,\"args\":{\"name\":\"track 8\"}") != std::string::npos);
+    CHECK(json.find("{\"name\":\"handle\",\"ph\":\"B\",\"ts\":") != std::string::npos);
+    CHECK(json.find("\"ph\":\"E\"") != std::string::npos);
+    CHECK(json.find("\"ph\":\"i\",\"s\":\"t\"") != std::string::npos);
+    CHECK(json.find("\"args\":{\"detail\":\"position startpos\\u0009moves\"}") != std::string::npos);
+    CHECK(json.ends_with("\n]}\n"));
+
+    const auto path = fs::temp_directory_path() / "chessuci_trace.json";
+    REQUIRE(Trace::write_file(path));
+    CHECK(fs::file_size(path) == json.size());
+    fs::remove(path);
+}
+
+TEST_CASE("Trace.GuiHandler", "[trace]") {
+    auto mock_engine = std::make_unique<test::EngineProcessMock>();
+    mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name Mock Engine", "uciok"}; });
+    mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+    UCIGuiHandler handler{std::move(mock_engine)};
+    REQUIRE(handler.start({}));
+
+    handler.async_isready().get();
+    Trace::start();
+    handler.async_handshake().get();
+    handler.async_isready().get();
+    Trace::stop();
+
+    // a callback may end after its request completed, so only the begins are checked
+    const auto events = Trace::events();
+    std::vector<std::string> timeline;
+    for (const auto &event : events) {
+        CHECK(event.track == 12);
+        if (event.phase != TracePhase::End) {
+            timeline.push_back(std::string{event.name} + ":" + static_cast<char>(event.phase) + ":" + detail_of(event));
+        }
+    }
+    const std::vector<std::string> expected{
+        "sent:i:uci",       "received:i:id name Mock Engine", "handle:B:id",      "received:i:uciok",
+        "handle:B:uciok",   "sent:i:isready",                 "received:i:readyok", "handle:B:readyok",
+    };
+    CHECK(timeline == expected);
+    CHECK(Trace::to_json().find("\"tid\":12,\"args\":{\"name\":\"Mock Engine\"}") != std::string::npos);
+}
@@ -0,0 +1,148 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_process_transcript.h"
+#include "chessuci/gui_handler.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <algorithm>
+#include <future>
+
+using namespace chessuci;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+auto transcript_path(const std::string &name) -> fs::path {
+    return fs::temp_directory_path() / ("chessuci_" + name + ".trc");
+}
+
+} // namespace
+
+TEST_CASE("Transcript.Roundtrip", "[transcript]") {
+    const auto path = transcript_path("roundtrip");
+    const std::vector<TranscriptEntry> entries{
+        {.direction = TranscriptDirection::ToEngine, .timestamp = std::chrono::nanoseconds{100}, .line = "uci"},
+        {.direction = TranscriptDirection::FromEngine, .timestamp = std::chrono::nanoseconds{1'500'000}, .line = "id name test"},
+        {.direction = TranscriptDirection::FromEngine, .timestamp = std::chrono::nanoseconds{1'500'000}, .line = ""},
+        {.direction = TranscriptDirection::FromEngine, .timestamp = std::chrono::nanoseconds{9'000'000'000}, .line = std::string(300, 'x')},
+    };
+    {
+        TranscriptWriter writer{path};
+        REQUIRE(writer.is_open());
+        for (const auto &entry : entries) {
+            writer.append(entry);
+        }
+    }
+
+    const auto read = TranscriptReader::read_all(path);
+    REQUIRE(read.has_value());
+    CHECK(read.value() == entries);
+
+    // a cut off record is ignored
+    fs::resize_file(path, fs::file_size(path) - 10);
+    const auto truncated = TranscriptReader::read_all(path);
+    REQUIRE(truncated.has_value());
+    CHECK(truncated->size() == entries.size() - 1);
+
+    CHECK_FALSE(TranscriptReader::read_all(transcript_path("does_not_exist")).has_value());
+
+    // a record claiming a huge line is rejected before the line is allocated
+    {
+        TranscriptWriter writer{path};
+        writer.append(entries[0]);
+    }
+    {
+        std::ofstream stream{path, std::ios::binary | std::ios::app};
+        const std::string record{"\x01\x01\xff\xff\xff\xff\xff\xff\xff\x7f", 10};
+        stream << record << "short";
+    }
+    TranscriptReader reader{path};
+    TranscriptEntry entry;
+    REQUIRE(reader.next(entry));
+    CHECK_FALSE(reader.is_corrupt());
+    CHECK_FALSE(reader.next(entry));
+    CHECK(reader.is_corrupt());
+    fs::remove(path);
+}
+
+TEST_CASE("Transcript.Record and replay", "[transcript]") {
+    const auto path = transcript_path("record");
+    {
+        auto mock_engine = std::make_unique<test::EngineProcessMock>();
+        mock_engine->when_receives("uci", [](const std::string &) -> std::vector<std::string> { return {"id name test_engine", "id author test_author", "uciok"}; });
+        mock_engine->when_receives("isready", [](const std::string &) -> std::vector<std::string> { return {"readyok"}; });
+
+        UCIGuiHandler handler{std::make_unique<RecordingEngineProcess>(std::move(mock_engine), path)};
+        std::promise<void> readyok_done;
+        auto readyok_future = readyok_done.get_future();
+        handler.on_readyok([&readyok_done]() -> void { readyok_done.set_value(); });
+        REQUIRE(handler.start({}));
+        REQUIRE(handler.send_uci());
+        REQUIRE(handler.send_isready());
+        REQUIRE(readyok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+        handler.stop();
+    }
+
+    auto transcript = TranscriptReader::read_all(path);
+    REQUIRE(transcript.has_value());
+    REQUIRE(transcript->size() == 7);
+    CHECK(transcript->front().line == "uci");
+    CHECK(transcript->front().direction == TranscriptDirection::ToEngine);
+    CHECK(transcript->back().line == "quit");
+    CHECK(std::ranges::count(transcript.value(), TranscriptDirection::FromEngine, &TranscriptEntry::direction) == 4);
+
+    auto replay = std::make_unique<ReplayEngineProcess>(std::move(transcript.value()));
+    auto *replay_ptr = replay.get();
+    UCIGuiHandler handler{std::move(replay)};
+    std::promise<std::string> id_name_done;
+    auto id_name_future = id_name_done.get_future();
+    handler.on_id_name([&id_name_done](const std::string &name) -> void { id_name_done.set_value(name); });
+    std::promise<void> readyok_done;
+    auto readyok_future = readyok_done.get_future();
+    handler.on_readyok([&readyok_done]() -> void { readyok_done.set_value(); });
+
+    REQUIRE(handler.start({}));
+    REQUIRE(handler.send_uci());
+    REQUIRE(handler.send_isready());
+    REQUIRE(id_name_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(id_name_future.get() == "test_engine");
+    REQUIRE(readyok_future.wait_for(std::chrono::seconds(1)) == std::future_status::ready);
+    CHECK(replay_ptr->mismatches() == 0);
+    go_command go{};
+    go.depth = 3;
+    REQUIRE(handler.send_go(go));
+    CHECK(replay_ptr->mismatches() == 1);
+    handler.stop();
+    fs::remove(path);
+}
+
+TEST_CASE("Transcript.Replay with original timing", "[transcript]") {
+    const std::vector<TranscriptEntry> entries{
+        {.direction = TranscriptDirection::FromEngine, .timestamp = std::chrono::milliseconds{0}, .line = "Engine 1.0"},
+        {.direction = TranscriptDirection::ToEngine, .timestamp = std::chrono::milliseconds{10}, .line = "go movetime 50"},
+        {.direction = TranscriptDirection::FromEngine, .timestamp = std::chrono::milliseconds{60}, .line = "bestmove e2e4"},
+    };
+    ReplayEngineProcess replay{entries, ReplayEngineProcess::Timing::Original};
+    REQUIRE(replay.start({}));
+
+    std::string line;
+    REQUIRE(replay.read_line(line));
+    CHECK(line == "Engine 1.0");
+    CHECK_FALSE(replay.can_read());
+
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(replay.write_line("go movetime 50"));
+    REQUIRE(replay.read_line(line));
+    CHECK(line == "bestmove e2e4");
+    CHECK(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{50});
+
+    CHECK(replay.finished());
+    CHECK_FALSE(replay.read_line(line));
+    CHECK(replay.mismatches() == 0);
+}
@@ -0,0 +1,173 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include "chessuci/watchdog.h"
+#include <catch2/catch_test_macros.hpp>
+
+#include "helper/EngineProcessMock.h"
+
+#include <atomic>
+
+using namespace chessuci;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr WatchdogSettings fast_settings{
+    .resolution = 1ms,
+    .grace = 10ms,
+    .terminate_after = 20ms,
+    .kill_after = 20ms,
+    .default_budget = 0ms,
+};
+
+auto wait_until(const std::function<bool()> &condition) -> bool {
+    const auto end = std::chrono::steady_clock::now() + 5s;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > end) {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+auto movetime(std::int64_t milliseconds) -> go_command {
+    go_command go{};
+    go.movetime = milliseconds;
+    return go;
+}
+
+} // namespace
+
+TEST_CASE("Watchdog.ExpectedDuration", "[watchdog]") {
+    Watchdog watchdog{};
+    CHECK(watchdog.expected_duration(movetime(500)) == 500ms);
+
+    go_command clock{};
+    clock.wtime = 60000;
+    clock.btime = 30000;
+    clock.winc = 1000;
+    CHECK(watchdog.expected_duration(clock) == 61000ms);
+    clock.ponder = true;
+    CHECK_FALSE(watchdog.expected_duration(clock).has_value());
+
+    go_command depth{};
+    depth.depth = 20;
+    CHECK_FALSE(watchdog.expected_duration(depth).has_value());
+    go_command infinite{};
+    infinite.infinite = true;
+    CHECK_FALSE(watchdog.expected_duration(infinite).has_value());
+
+    Watchdog budget{WatchdogSettings{.default_budget = 5000ms}};
+    CHECK(budget.expected_duration(depth) == 5000ms);
+    CHECK_FALSE(budget.expected_duration(infinite).has_value());
+}
+
+TEST_CASE("Watchdog.Escalation", "[watchdog]") {
+    Watchdog watchdog{fast_settings};
+    std::atomic<int> stops{0};
+    std::atomic<int> terminations{0};
+    std::atomic<int> kills{0};
+    const Watchdog::Actions actions{
+        .stop = [&stops] -> void { ++stops; },
+        .terminate = [&terminations] -> void { ++terminations; },
+        .kill = [&kills] -> void { ++kills; },
+    };
+
+    const auto in_time = watchdog.watch("engine", 1000ms, actions);
+    const auto unlimited = watchdog.watch("engine", std::nullopt, actions);
+    watchdog.watch("engine", 5ms, actions);
+    REQUIRE(wait_until([&kills] -> bool { return kills > 0; }));
+    CHECK(stops == 1);
+    CHECK(terminations == 1);
+    CHECK(kills == 1);
+    watchdog.complete(in_time);
+    watchdog.complete(unlimited);
+    CHECK(watchdog.pending() == 0);
+
+    const auto statistics = watchdog.statistics("engine");
+    CHECK(statistics.searches == 3);
+    CHECK(statistics.stops == 1);
+    CHECK(statistics.terminations == 1);
+    CHECK(statistics.kills == 1);
+    CHECK(statistics.overruns == 1);
+    CHECK(statistics.max_overrun >= 50ms);
+    CHECK(watchdog.statistics().size() == 1);
+    CHECK(watchdog.statistics("other").searches == 0);
+}
+
+TEST_CASE("Watchdog.StoppedByCaller", "[watchdog]") {
+    Watchdog watchdog{fast_settings};
+    std::atomic<int> stops{0};
+    std::atomic<int> terminations{0};
+    const auto id = watchdog.watch("engine", std::nullopt,
+                                   Watchdog::Actions{.stop = [&stops] -> void { ++stops; }, .terminate = [&terminations] -> void { ++terminations; }, .kill = nullptr});
+    watchdog.stopped(id);
+    REQUIRE(wait_until([&terminations] -> bool { return terminations > 0; }));
+    watchdog.cancel(id);
+    CHECK(stops == 0);
+    CHECK(watchdog.pending() == 0);
+    CHECK(watchdog.statistics("engine").kills == 0);
+}
+
+TEST_CASE("Watchdog.GuiHandler", "[watchdog]") {
+    Watchdog watchdog{fast_settings};
+
+    SECTION("Engine answers stop") {
+        auto mock_engine = std::make_unique<test::EngineProcessMock>();
+        mock_engine->when_receives("stop", [](const std::string &) -> std::vector<std::string> { return {"bestmove e2e4"}; });
+        UCIGuiHandler handler{std::move(mock_engine)};
+        handler.set_watchdog(watchdog, "slow");
+        REQUIRE(handler.start({}));
+
+        CHECK(to_string(handler.async_go(movetime(5)).get().bestmove) == "e2e4");
+        const auto statistics = watchdog.statistics("slow");
+        CHECK(statistics.searches == 1);
+        CHECK(statistics.stops == 1);
+        CHECK(statistics.terminations == 0);
+        CHECK(statistics.overruns == 1);
+        CHECK(handler.is_running());
+    }
+
+    SECTION("Engine ignores stop") {
+        UCIGuiHandler handler{std::make_unique<test::EngineProcessMock>()};
+        handler.set_watchdog(watchdog, "stuck");
+        REQUIRE(handler.start({}));
+
+        auto bestmove = handler.async_go(movetime(5));
+        CHECK_THROWS_AS(bestmove.get(), UCIError);
+        const auto statistics = watchdog.statistics("stuck");
+        CHECK(statistics.stops == 1);
+        CHECK(statistics.terminations == 1);
+        CHECK(statistics.kills == 0);
+        CHECK(statistics.overruns == 1);
+        CHECK_FALSE(handler.process().is_running());
+    }
+
+    SECTION("Pipelined search is watched from its start") {
+        auto mock_engine = std::make_unique<test::EngineProcessMock>();
+        mock_engine->when_receives("stop", [](const std::string &) -> std::vector<std::string> { return {"bestmove e2e4"}; });
+        UCIGuiHandler handler{std::move(mock_engine)};
+        handler.set_watchdog(watchdog, "pipelined");
+        REQUIRE(handler.start({}));
+
+        // the stop ends the first search only, the second one is not terminated
+        auto first = handler.async_go(movetime(50));
+        auto second = handler.async_go(movetime(50));
+        REQUIRE(handler.send_stop());
+        CHECK(to_string(first.get().bestmove) == "e2e4");
+        CHECK(to_string(second.get().bestmove) == "e2e4");
+        const auto statistics = watchdog.statistics("pipelined");
+        CHECK(statistics.searches == 2);
+        CHECK(statistics.stops == 1);
+        CHECK(statistics.terminations == 0);
+        CHECK(handler.is_running());
+    }
+
+    CHECK(watchdog.pending() == 0);
+}
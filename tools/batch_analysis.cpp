@@ -0,0 +1,106 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/analysis_cache.h"
+#include "chessuci/batch_analysis.h"
+#include "chessuci/string_conversion.h"
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+auto print_usage(const char *program) -> void {
+    std::cerr << "Usage: " << program << " [options] <engine> <file>\n"
+              << "  engine:             path of the engine executable\n"
+              << "  file:               EPD or FEN file, one position per line\n"
+              << "Options:\n"
+              << "  --depth <n>         search every position to depth n\n"
+              << "  --nodes <n>         search every position for n nodes\n"
+              << "  --movetime <ms>     search every position for ms milliseconds\n"
+              << "  --engines <n>       number of engine processes (default: number of cores)\n"
+              << "  --option <name=value>  set an engine option\n"
+              << "  --cache <file>      reuse and store results in an analysis cache\n";
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    chessuci::BatchSettings settings{};
+    settings.engine_count = std::max(1U, std::thread::hardware_concurrency());
+    std::vector<std::string_view> positional;
+    std::unique_ptr<chessuci::AnalysisCache> cache;
+
+    for (int index = 1; index < argc; ++index) {
+        const std::string_view argument{argv[index]};
+        if (!argument.starts_with("--")) {
+            positional.push_back(argument);
+            continue;
+        }
+        if (index + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const std::string_view value{argv[++index]};
+        bool valid = true;
+        if (argument == "--depth") {
+            settings.go.depth = chessuci::str_to_inttype<int>(value);
+            valid = settings.go.depth.has_value();
+        } else if (argument == "--nodes") {
+            settings.go.nodes = chessuci::str_to_inttype<std::int64_t>(value);
+            valid = settings.go.nodes.has_value();
+        } else if (argument == "--movetime") {
+            settings.go.movetime = chessuci::str_to_inttype<std::int64_t>(value);
+            valid = settings.go.movetime.has_value();
+        } else if (argument == "--engines") {
+            const auto engines = chessuci::str_to_inttype<std::size_t>(value);
+            valid = engines.has_value();
+            settings.engine_count = engines.value_or(1);
+        } else if (argument == "--option") {
+            const auto separator = value.find('=');
+            valid = separator != std::string_view::npos;
+            if (valid) {
+                settings.options.push_back({.name = std::string{value.substr(0, separator)}, .value = std::string{value.substr(separator + 1)}});
+            }
+        } else if (argument == "--cache") {
+            cache = std::make_unique<chessuci::AnalysisCache>(std::filesystem::path{value});
+            valid = cache->is_open();
+            if (!valid) {
+                std::cerr << cache->last_error() << '\n';
+            }
+            settings.cache = cache.get();
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "Invalid argument: " << argument << ' ' << value << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (positional.size() != 2) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    settings.engine.executable = positional[0];
+
+    chessuci::BatchAnalysis analysis{settings};
+    const auto success = analysis.run_file(positional[1], [](const chessuci::BatchResult &result) -> void {
+        std::cout << chessuci::BatchAnalysis::format_epd_result(result) << '\n';
+    });
+    std::cout.flush();
+    if (!success) {
+        std::cerr << analysis.last_error() << '\n';
+        return 1;
+    }
+
+    const auto statistics = analysis.statistics();
+    std::cerr << statistics.positions << " positions, " << statistics.errors << " errors, " << statistics.stolen << " stolen, " << statistics.cache_hits
+              << " cached, " << statistics.restarts << " restarts, "
+              << static_cast<std::int64_t>(statistics.positions_per_second()) << " positions/s\n";
+    return statistics.errors == 0 ? 0 : 1;
+}
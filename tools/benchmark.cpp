@@ -0,0 +1,372 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/gui_handler.h"
+#include "chessuci/latency_histogram.h"
+#include "chessuci/process_factory.h"
+#include "chessuci/string_conversion.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string_view>
+
+#include <sys/resource.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkSettings {
+    std::filesystem::path engine;
+    std::vector<std::size_t> engine_counts{1, 8, 64, 256};
+    std::vector<chessuci::WaitStrategy> wait_strategies{chessuci::WaitStrategy::Block};
+    std::chrono::milliseconds duration{1000}; ///< Search time of the throughput run.
+    std::chrono::milliseconds movetime{10};   ///< Search time of the searches that measure the bestmove overhead.
+    int rounds{100};                          ///< Searches and isready round trips per engine.
+    int info_rate{1000};                      ///< Info rate of the synthetic engines.
+    std::optional<std::filesystem::path> output;
+    std::optional<std::filesystem::path> baseline;
+    double tolerance{10.0}; ///< Allowed regression in percent.
+};
+
+// flat result keys, e.g. "block.8.isready_us.p99", so that a baseline is read without a JSON parser
+using Results = std::map<std::string, double>;
+
+struct BenchmarkEngine {
+    std::unique_ptr<chessuci::UCIGuiHandler> handler;
+    std::atomic<std::uint64_t> infos{0};
+};
+
+constexpr std::array<std::pair<std::string_view, chessuci::WaitStrategy>, 3> wait_strategy_names{{
+    {"block", chessuci::WaitStrategy::Block},
+    {"spin", chessuci::WaitStrategy::SpinThenBlock},
+    {"busy", chessuci::WaitStrategy::BusyPoll},
+}};
+
+auto wait_strategy_name(chessuci::WaitStrategy strategy) -> std::string {
+    const auto name_it = std::ranges::find(wait_strategy_names, strategy, &std::pair<std::string_view, chessuci::WaitStrategy>::second);
+    return std::string{name_it->first};
+}
+
+auto cpu_time() -> std::chrono::microseconds {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::seconds{usage.ru_utime.tv_sec + usage.ru_stime.tv_sec} + std::chrono::microseconds{usage.ru_utime.tv_usec + usage.ru_stime.tv_usec};
+}
+
+// every engine needs four descriptors, more than the usual soft limit for 256 engines
+auto raise_descriptor_limit() -> void {
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+// a percentile is only reported, if at least one sample lies above it; with
+// fewer samples it would just be the maximum
+auto add_percentiles(Results &results, const std::string &prefix, const chessuci::LatencyHistogram &histogram) -> void {
+    constexpr std::array<std::pair<std::string_view, double>, 3> percentiles{{{"p50", 50.0}, {"p99", 99.0}, {"p999", 99.9}}};
+    const auto samples = static_cast<double>(histogram.count());
+    for (const auto &[name, percentile] : percentiles) {
+        if (samples * (100.0 - percentile) / 100.0 >= 1.0) {
+            results[prefix + '.' + std::string{name}] = static_cast<double>(histogram.percentile(percentile).count());
+        }
+    }
+}
+
+// runs the function for every engine on a thread of its own
+template<typename F>
+auto for_each_engine(std::vector<std::unique_ptr<BenchmarkEngine>> &engines, F function) -> void {
+    std::vector<std::thread> threads;
+    threads.reserve(engines.size());
+    for (auto &engine : engines) {
+        threads.emplace_back([&function, &engine] -> void { function(*engine->handler); });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+auto run_benchmark(const BenchmarkSettings &settings, chessuci::WaitStrategy strategy, std::size_t count, Results &results) -> bool {
+    const chessuci::ProcessParams params{
+        .executable = settings.engine,
+        .arguments = {"--info-rate", std::to_string(settings.info_rate), "--pv-length", "8"},
+        .working_directory = {},
+    };
+    std::vector<std::unique_ptr<BenchmarkEngine>> engines;
+    std::vector<chessuci::UCIGuiHandler *> handlers;
+    std::vector<std::future<chessuci::initialize_info>> initialized;
+    for (std::size_t index = 0; index < count; ++index) {
+        auto engine = std::make_unique<BenchmarkEngine>();
+        engine->handler = std::make_unique<chessuci::UCIGuiHandler>(chessuci::ProcessFactory::create_local());
+        engine->handler->set_wait_settings({.strategy = strategy, .spin_duration = std::chrono::microseconds{50}, .cpu = std::nullopt});
+        engine->handler->on_info([&infos = engine->infos](const chessuci::search_info &) -> void { infos.fetch_add(1, std::memory_order_relaxed); });
+        initialized.push_back(engine->handler->initialize(params));
+        handlers.push_back(engine->handler.get());
+        engines.push_back(std::move(engine));
+    }
+
+    const auto prefix = wait_strategy_name(strategy) + '.' + std::to_string(count) + '.';
+    bool success = true;
+    try {
+        for (auto &future : initialized) {
+            future.get();
+        }
+
+        chessuci::go_command throughput_go{};
+        throughput_go.movetime = settings.duration.count();
+        for (auto &engine : engines) {
+            engine->infos = 0;
+        }
+        const auto cpu_start = cpu_time();
+        const auto start = Clock::now();
+        std::vector<std::future<chessuci::bestmove_info>> searches;
+        for (auto *handler : handlers) {
+            searches.push_back(handler->async_go(throughput_go));
+        }
+        for (auto &search : searches) {
+            search.get();
+        }
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+        const auto cpu = cpu_time() - cpu_start;
+        std::uint64_t lines{0};
+        for (auto &engine : engines) {
+            lines += engine->infos;
+        }
+        results[prefix + "info_lines_per_second"] = static_cast<double>(lines) / elapsed.count();
+        results[prefix + "cpu_us_per_1000_lines"] = lines > 0 ? static_cast<double>(cpu.count()) * 1000.0 / static_cast<double>(lines) : 0.0;
+
+        chessuci::LatencyHistogram isready;
+        for_each_engine(engines, [&settings, &isready](chessuci::UCIGuiHandler &handler) -> void {
+            for (int round = 0; round < settings.rounds; ++round) {
+                const auto sent = Clock::now();
+                handler.async_isready().get();
+                isready.record(std::chrono::duration_cast<chessuci::LatencyHistogram::duration>(Clock::now() - sent));
+            }
+        });
+        add_percentiles(results, prefix + "isready_us", isready);
+
+        // the search time is subtracted, what remains is the cost of pipes, threads and parsing
+        chessuci::LatencyHistogram overhead;
+        chessuci::go_command overhead_go{};
+        overhead_go.movetime = settings.movetime.count();
+        for_each_engine(engines, [&settings, &overhead, &overhead_go](chessuci::UCIGuiHandler &handler) -> void {
+            for (int round = 0; round < settings.rounds; ++round) {
+                const auto sent = Clock::now();
+                handler.async_go(overhead_go).get();
+                overhead.record(std::chrono::duration_cast<chessuci::LatencyHistogram::duration>(Clock::now() - sent - settings.movetime));
+            }
+        });
+        add_percentiles(results, prefix + "bestmove_overhead_us", overhead);
+    } catch (const std::exception &error) {
+        std::cerr << count << " engines: " << error.what() << '\n';
+        success = false;
+    }
+
+    chessuci::UCIGuiHandler::stop_all(handlers);
+    return success;
+}
+
+auto format_results(const Results &results) -> std::string {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1) << '{';
+    bool first{true};
+    for (const auto &[key, value] : results) {
+        stream << (first ? "\n" : ",\n") << "  \"" << key << "\": " << value;
+        first = false;
+    }
+    stream << "\n}\n";
+    return stream.str();
+}
+
+// reads the flat objects written by format_results(), one value per line
+auto read_results(const std::filesystem::path &path) -> std::optional<Results> {
+    std::ifstream stream{path};
+    if (!stream) {
+        return std::nullopt;
+    }
+    Results results;
+    std::string line;
+    while (std::getline(stream, line)) {
+        const auto key_start = line.find('"');
+        const auto key_end = key_start == std::string::npos ? std::string::npos : line.find('"', key_start + 1);
+        const auto colon = key_end == std::string::npos ? std::string::npos : line.find(':', key_end);
+        if (colon == std::string::npos) {
+            continue;
+        }
+        const auto *value_start = line.c_str() + colon + 1;
+        char *value_end{nullptr};
+        const auto value = std::strtod(value_start, &value_end);
+        if (value_end != value_start) {
+            results[line.substr(key_start + 1, key_end - key_start - 1)] = value;
+        }
+    }
+    return results;
+}
+
+// returns the number of regressions
+auto compare_results(const Results &baseline, const Results &results, double tolerance) -> int {
+    int regressions{0};
+    std::cerr << std::fixed << std::setprecision(1);
+    for (const auto &[key, base] : baseline) {
+        const auto result_it = results.find(key);
+        if (result_it == results.end() || base == 0.0) {
+            continue;
+        }
+        const auto change = (result_it->second - base) / base * 100.0;
+        const auto higher_is_better = key.ends_with("info_lines_per_second");
+        const auto regressed = higher_is_better ? change < -tolerance : change > tolerance;
+        std::cerr << std::left << std::setw(42) << key << std::right << std::setw(14) << base << std::setw(14) << result_it->second << std::setw(9)
+                  << std::showpos << change << std::noshowpos << '%' << (regressed ? "  REGRESSION" : "") << '\n';
+        regressions += regressed ? 1 : 0;
+    }
+    return regressions;
+}
+
+auto parse_engine_counts(std::string_view value) -> std::optional<std::vector<std::size_t>> {
+    std::vector<std::size_t> counts;
+    while (!value.empty()) {
+        const auto separator = value.find(',');
+        const auto count = chessuci::str_to_inttype<std::size_t>(value.substr(0, separator));
+        if (!count.has_value() || count.value() == 0) {
+            return std::nullopt;
+        }
+        counts.push_back(count.value());
+        value = separator == std::string_view::npos ? std::string_view{} : value.substr(separator + 1);
+    }
+    return counts.empty() ? std::nullopt : std::optional{counts};
+}
+
+auto parse_wait_strategies(std::string_view value) -> std::optional<std::vector<chessuci::WaitStrategy>> {
+    std::vector<chessuci::WaitStrategy> strategies;
+    while (!value.empty()) {
+        const auto separator = value.find(',');
+        const auto name_it = std::ranges::find(wait_strategy_names, value.substr(0, separator), &std::pair<std::string_view, chessuci::WaitStrategy>::first);
+        if (name_it == wait_strategy_names.end()) {
+            return std::nullopt;
+        }
+        strategies.push_back(name_it->second);
+        value = separator == std::string_view::npos ? std::string_view{} : value.substr(separator + 1);
+    }
+    return strategies.empty() ? std::nullopt : std::optional{strategies};
+}
+
+auto print_usage(const char *program) -> void {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "End-to-end benchmark of UCIGuiHandler against synthetic engines.\n"
+              << "Options:\n"
+              << "  --engine <path>       synthetic engine (default: chessuci_load_engine next to this program)\n"
+              << "  --engines <n,...>     numbers of engines to run (default: 1,8,64,256)\n"
+              << "  --wait <name,...>     wait strategies of the readers: block, spin, busy (default: block)\n"
+              << "  --duration <ms>       search time of the throughput run (default: 1000)\n"
+              << "  --movetime <ms>       search time of the bestmove overhead runs (default: 10)\n"
+              << "  --rounds <n>          searches and isready round trips per engine (default: 100)\n"
+              << "  --info-rate <n>       infos per second of every engine (default: 1000)\n"
+              << "  --output <file>       write the JSON results to a file instead of stdout\n"
+              << "  --baseline <file>     compare with earlier results, exit with 2 on regressions\n"
+              << "  --tolerance <percent> allowed regression (default: 10)\n";
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    BenchmarkSettings settings{};
+    settings.engine = std::filesystem::path{argv[0]}.parent_path() / "chessuci_load_engine";
+
+    for (int index = 1; index < argc; ++index) {
+        const std::string_view argument{argv[index]};
+        if (index + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const std::string_view value{argv[++index]};
+        const auto number = chessuci::str_to_inttype<int>(value);
+        bool valid = true;
+        if (argument == "--engine") {
+            settings.engine = value;
+        } else if (argument == "--engines") {
+            const auto counts = parse_engine_counts(value);
+            valid = counts.has_value();
+            settings.engine_counts = counts.value_or(settings.engine_counts);
+        } else if (argument == "--wait") {
+            const auto strategies = parse_wait_strategies(value);
+            valid = strategies.has_value();
+            settings.wait_strategies = strategies.value_or(settings.wait_strategies);
+        } else if (argument == "--duration") {
+            valid = number.value_or(0) > 0;
+            settings.duration = std::chrono::milliseconds{number.value_or(0)};
+        } else if (argument == "--movetime") {
+            valid = number.value_or(0) > 0;
+            settings.movetime = std::chrono::milliseconds{number.value_or(0)};
+        } else if (argument == "--rounds") {
+            valid = number.value_or(0) > 0;
+            settings.rounds = number.value_or(0);
+        } else if (argument == "--info-rate") {
+            valid = number.value_or(0) > 0;
+            settings.info_rate = number.value_or(0);
+        } else if (argument == "--output") {
+            settings.output = value;
+        } else if (argument == "--baseline") {
+            settings.baseline = value;
+        } else if (argument == "--tolerance") {
+            valid = number.value_or(-1) >= 0;
+            settings.tolerance = number.value_or(0);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "Invalid argument: " << argument << ' ' << value << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!std::filesystem::exists(settings.engine)) {
+        std::cerr << "Engine not found: " << settings.engine.string() << '\n';
+        return 1;
+    }
+
+    std::optional<Results> baseline;
+    if (settings.baseline.has_value()) {
+        baseline = read_results(settings.baseline.value());
+        if (!baseline.has_value()) {
+            std::cerr << "Failed to read baseline: " << settings.baseline->string() << '\n';
+            return 1;
+        }
+    }
+
+    raise_descriptor_limit();
+    Results results;
+    for (const auto strategy : settings.wait_strategies) {
+        for (const auto count : settings.engine_counts) {
+            std::cerr << "Running " << count << (count == 1 ? " engine, " : " engines, ") << wait_strategy_name(strategy) << '\n';
+            if (!run_benchmark(settings, strategy, count, results)) {
+                return 1;
+            }
+        }
+    }
+
+    const auto json = format_results(results);
+    if (settings.output.has_value()) {
+        std::ofstream stream{settings.output.value(), std::ios::trunc};
+        if (!(stream << json)) {
+            std::cerr << "Failed to write results: " << settings.output->string() << '\n';
+            return 1;
+        }
+    } else {
+        std::cout << json;
+    }
+
+    if (baseline.has_value() && compare_results(baseline.value(), results, settings.tolerance) > 0) {
+        return 2;
+    }
+    return 0;
+}
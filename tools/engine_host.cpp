@@ -0,0 +1,60 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_host.h"
+
+#include <csignal>
+#include <iostream>
+
+namespace {
+
+chessuci::EngineHost *running_host{nullptr};
+
+auto handle_signal(int) -> void {
+    if (running_host != nullptr) {
+        running_host->stop();
+    }
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <endpoint> <engine> [<engine> ...]\n"
+                  << "  endpoint: tcp://<host>:<port> or unix:<path>\n"
+                  << "  engine:   path of an engine executable that clients may start\n";
+        return 1;
+    }
+
+    const auto endpoint = chessuci::parse_remote_endpoint(argv[1]);
+    if (!endpoint.has_value()) {
+        std::cerr << "Invalid endpoint: " << argv[1] << '\n';
+        return 1;
+    }
+
+    chessuci::EngineHost host{endpoint.value()};
+    for (int index = 2; index < argc; ++index) {
+        host.allow_executable(argv[index]);
+    }
+    if (!host.listen()) {
+        std::cerr << host.last_error() << '\n';
+        return 1;
+    }
+
+    running_host = &host;
+    std::signal(SIGPIPE, SIG_IGN);
+    std::signal(SIGINT, handle_signal);
+    std::signal(SIGTERM, handle_signal);
+
+    std::cout << "Listening on " << to_string(host.bound_endpoint()) << std::endl;
+    host.run();
+    running_host = nullptr;
+
+    if (!host.last_error().empty()) {
+        std::cerr << host.last_error() << '\n';
+        return 1;
+    }
+    return 0;
+}
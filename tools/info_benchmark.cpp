@@ -0,0 +1,193 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/compact_info.h"
+#include "chessuci/gui_handler.h"
+#include "chessuci/string_conversion.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Results = std::map<std::string, double>;
+
+// a game-like mix of long principal variations and short currmove infos
+auto make_corpus(std::size_t count) -> std::vector<std::string> {
+    const std::vector<std::string> moves{"e2e4", "e7e5", "g1f3", "b8c6", "f1b5", "a7a6", "b5a4", "g8f6", "e1g1", "f8e7", "f1e1", "b7b5", "a4b3", "d7d6", "c2c3", "e8g8", "h2h3", "c6a5", "b3c2", "c7c5"};
+    std::mt19937 random{42};
+    std::vector<std::string> corpus;
+    corpus.reserve(count);
+    for (std::size_t index = 0; index < count; ++index) {
+        const auto depth = static_cast<int>(index % 30) + 1;
+        std::ostringstream line;
+        if (random() % 8 == 0) {
+            line << "info depth " << depth << " currmove " << moves[random() % moves.size()] << " currmovenumber " << random() % 40 + 1;
+        } else {
+            const auto nodes = static_cast<std::uint64_t>(depth) * 250000 + random() % 1000;
+            line << "info depth " << depth << " seldepth " << depth + 8 << " multipv " << random() % 4 + 1 << " score cp " << static_cast<int>(random() % 200) - 100 << " nodes " << nodes
+                 << " nps 2500000 hashfull " << random() % 1000 << " tbhits 0 time " << nodes / 2500 << " pv";
+            const auto length = random() % moves.size() + 1;
+            for (std::size_t move = 0; move < length; ++move) {
+                line << ' ' << moves[move];
+            }
+        }
+        corpus.push_back(line.str());
+    }
+    return corpus;
+}
+
+// payload of the allocations of an info, without the overhead of the allocator
+auto heap_bytes(const chessuci::search_info &info) -> std::size_t {
+    auto bytes = (info.pv.capacity() + info.refutation.capacity()) * sizeof(chessuci::UCIMove);
+    if (info.currline.has_value()) {
+        bytes += info.currline->line.capacity() * sizeof(chessuci::UCIMove);
+    }
+    if (info.string.capacity() > std::string{}.capacity()) {
+        bytes += info.string.capacity() + 1;
+    }
+    return bytes;
+}
+
+// runs the parser over the corpus and returns the parsed lines per second
+template<typename Parser>
+auto measure(const std::vector<std::string> &corpus, int rounds, Parser parser) -> double {
+    std::int64_t checksum{0};
+    const auto start = Clock::now();
+    for (int round = 0; round < rounds; ++round) {
+        for (const auto &line : corpus) {
+            checksum += parser(line);
+        }
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    if (checksum == 0) {
+        std::cerr << "No infos parsed\n";
+    }
+    return static_cast<double>(corpus.size()) * rounds / elapsed.count();
+}
+
+auto run_benchmark(std::size_t line_count, int rounds) -> std::optional<Results> {
+    const auto corpus = make_corpus(line_count);
+    Results results;
+
+    std::vector<chessuci::search_info> infos;
+    std::vector<chessuci::CompactSearchInfo> compact_infos;
+    infos.reserve(corpus.size());
+    compact_infos.reserve(corpus.size());
+    std::size_t heap{0};
+    for (const auto &line : corpus) {
+        auto info = chessuci::UCIGuiHandler::try_parse_info_command(chessuci::UCIHandler::tokenize(line));
+        auto compact_info = chessuci::CompactSearchInfo::parse(line);
+        if (!info.has_value() || !compact_info.has_value()) {
+            std::cerr << "Failed to parse: " << line << '\n';
+            return std::nullopt;
+        }
+        heap += heap_bytes(info.value());
+        infos.push_back(std::move(info.value()));
+        compact_infos.push_back(compact_info.value());
+    }
+    results["search_info.sizeof"] = sizeof(chessuci::search_info);
+    results["search_info.bytes_per_info"] = static_cast<double>(sizeof(chessuci::search_info)) + static_cast<double>(heap) / static_cast<double>(corpus.size());
+    results["compact_info.sizeof"] = sizeof(chessuci::CompactSearchInfo);
+    results["compact_info.bytes_per_info"] = sizeof(chessuci::CompactSearchInfo);
+
+    results["search_info.parse_lines_per_second"] = measure(corpus, rounds, [](const std::string &line) -> std::int64_t {
+        return chessuci::UCIGuiHandler::try_parse_info_command(chessuci::UCIHandler::tokenize(line))->depth.value_or(0);
+    });
+    chessuci::UCIHandler::TokenBuffer tokens;
+    chessuci::search_info reused_info;
+    results["search_info.reused_parse_lines_per_second"] = measure(corpus, rounds, [&tokens, &reused_info](const std::string &line) -> std::int64_t {
+        chessuci::UCIHandler::tokenize(line, tokens);
+        return chessuci::UCIGuiHandler::try_parse_info_command(tokens.tokens, reused_info).has_value() ? reused_info.depth.value_or(0) : 0;
+    });
+    results["compact_info.parse_lines_per_second"] = measure(corpus, rounds, [](const std::string &line) -> std::int64_t {
+        return chessuci::CompactSearchInfo::parse(line)->depth().value_or(0);
+    });
+    std::size_t index{0};
+    results["compact_info.pack_infos_per_second"] = measure(corpus, rounds, [&infos, &index](const std::string &) -> std::int64_t {
+        const auto &info = infos[index++ % infos.size()];
+        return chessuci::CompactSearchInfo::from_search_info(info)->depth().value_or(0);
+    });
+    results["compact_info.unpack_infos_per_second"] = measure(corpus, rounds, [&compact_infos, &index](const std::string &) -> std::int64_t {
+        const auto &info = compact_infos[index++ % compact_infos.size()];
+        return info.to_search_info().depth.value_or(0);
+    });
+    return results;
+}
+
+auto format_results(const Results &results) -> std::string {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(1) << '{';
+    bool first{true};
+    for (const auto &[key, value] : results) {
+        stream << (first ? "\n" : ",\n") << "  \"" << key << "\": " << value;
+        first = false;
+    }
+    stream << "\n}\n";
+    return stream.str();
+}
+
+auto print_usage(const char *program) -> void {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "Memory and parse throughput of search_info and CompactSearchInfo.\n"
+              << "Options:\n"
+              << "  --lines <n>     number of generated info lines (default: 100000)\n"
+              << "  --rounds <n>    passes over the lines per measurement (default: 5)\n"
+              << "  --output <file> write the JSON results to a file instead of stdout\n";
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    std::size_t line_count{100000};
+    int rounds{5};
+    std::optional<std::string> output;
+    for (int index = 1; index < argc; ++index) {
+        const std::string_view argument{argv[index]};
+        if (index + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const std::string_view value{argv[++index]};
+        const auto number = chessuci::str_to_inttype<int>(value);
+        bool valid = number.value_or(0) > 0;
+        if (argument == "--lines") {
+            line_count = static_cast<std::size_t>(number.value_or(0));
+        } else if (argument == "--rounds") {
+            rounds = number.value_or(0);
+        } else if (argument == "--output") {
+            valid = true;
+            output = value;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    const auto results = run_benchmark(line_count, rounds);
+    if (!results.has_value()) {
+        return 1;
+    }
+    const auto json = format_results(results.value());
+    if (output.has_value()) {
+        std::ofstream stream{output.value(), std::ios::trunc};
+        if (!(stream << json)) {
+            std::cerr << "Failed to write results: " << output.value() << '\n';
+            return 1;
+        }
+    } else {
+        std::cout << json;
+    }
+    return 0;
+}
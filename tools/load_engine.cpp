@@ -0,0 +1,296 @@
+/* ************************************************************************** *
+ * Chess UCI                                                                  *
+ * Universal Chess Interface for Chess Engines                                *
+ * ************************************************************************** */
+
+#include "chessuci/engine_handler.h"
+#include "chessuci/string_conversion.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <iostream>
+#include <random>
+#include <string_view>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * \brief Output profile of the synthetic engine.
+ */
+struct LoadProfile {
+    int info_rate{100};                               ///< Search iterations reported per second.
+    int pv_length{8};                                 ///< Moves in every principal variation.
+    int multipv{1};                                   ///< Lines per iteration, until changed with setoption.
+    std::chrono::milliseconds bestmove_latency{1000}; ///< Search time without movetime, depth or nodes limit.
+    std::chrono::milliseconds jitter{0};              ///< Maximum random deviation of the latency and the info intervals.
+    int burst{1};                                     ///< Iterations sent back to back.
+    int stderr_rate{0};                               ///< Lines written to stderr per second while searching.
+    std::uint32_t seed{1};                            ///< Seed of the jitter.
+};
+
+// the moves are not legal in the searched position, GUIs under test should not care
+constexpr std::array<std::string_view, 16> move_cycle{
+    "e2e4", "e7e5", "g1f3", "b8c6", "f1c4", "g8f6", "d2d3", "f8c5", "c2c3", "d7d6", "b1d2", "a7a6", "h2h3", "h7h6", "a2a4", "c8e6",
+};
+
+/**
+ * \brief UCI engine that produces configurable protocol load.
+ *
+ * Speaks the complete protocol through UCIEngineHandler, so that the engine
+ * side of the library is loaded as well, but searches nothing: every search
+ * sends synthetic infos at the configured rate until its limit is reached or
+ * it is stopped.
+ */
+class LoadEngine {
+public:
+    explicit LoadEngine(const LoadProfile &profile) : m_profile{profile}, m_multipv{profile.multipv}, m_random{profile.seed} {
+        for (const auto move : move_cycle) {
+            m_moves.push_back(chessuci::parse_uci_move(std::string{move}).value());
+        }
+    }
+
+    ~LoadEngine() { stop_search(); }
+
+    LoadEngine(const LoadEngine &) = delete;
+    auto operator=(const LoadEngine &) -> LoadEngine & = delete;
+
+    auto run() -> int {
+        auto &options = m_handler.options();
+        options.add_spin("MultiPV", m_profile.multipv, 1, 256, m_multipv);
+        options.add_spin("Hash", 16, 1, 65536, [](int) -> void {});
+        options.add_spin("Threads", 1, 1, 1024, [](int) -> void {});
+        options.add_check("Ponder", false, [](bool) -> void {});
+
+        m_handler.on_uci([this] -> void {
+            m_handler.send_id({.name = "chessuci load engine", .author = "chessuci"});
+            m_handler.send_uciok();
+        });
+        m_handler.on_isready([this] -> void { m_handler.send_readyok(); });
+        m_handler.on_go([this](const chessuci::go_command &command) -> void { start_search(command); });
+        m_handler.on_stop([this] -> void { stop_search(); });
+        m_handler.on_ponderhit([this] -> void {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_ponderhit = true;
+            m_condition.notify_all();
+        });
+        m_handler.on_quit([this] -> void {
+            stop_search();
+            m_handler.stop();
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_quit = true;
+            m_condition.notify_all();
+        });
+        m_handler.start();
+
+        std::unique_lock<std::mutex> lock{m_mutex};
+        // the handler stops on its own when the input is closed
+        while (!m_quit && m_handler.is_running()) {
+            m_condition.wait_for(lock, std::chrono::milliseconds{50});
+        }
+        lock.unlock();
+        stop_search();
+        return 0;
+    }
+private:
+    LoadProfile m_profile;
+    chessuci::UCIEngineHandler m_handler;
+    std::vector<chessuci::UCIMove> m_moves;
+    std::atomic<int> m_multipv;
+    std::mt19937 m_random;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    bool m_stop{false};
+    bool m_ponderhit{false};
+    bool m_quit{false};
+    std::thread m_search;
+
+    auto start_search(const chessuci::go_command &command) -> void {
+        stop_search();
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stop = false;
+            m_ponderhit = false;
+        }
+        m_search = std::thread{[this, command] -> void { search(command); }};
+    }
+
+    // returns when the bestmove was sent
+    auto stop_search() -> void {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_stop = true;
+            m_condition.notify_all();
+        }
+        if (m_search.joinable() && m_search.get_id() != std::this_thread::get_id()) {
+            m_search.join();
+        }
+    }
+
+    auto jittered(Clock::duration duration) -> Clock::duration {
+        if (m_profile.jitter.count() == 0) {
+            return duration;
+        }
+        const auto jitter = std::chrono::duration_cast<Clock::duration>(m_profile.jitter).count();
+        std::uniform_int_distribution<Clock::rep> distribution{-jitter, jitter};
+        return std::max(duration + Clock::duration{distribution(m_random)}, Clock::duration::zero());
+    }
+
+    auto search(const chessuci::go_command &command) -> void {
+        const auto start = Clock::now();
+        std::optional<Clock::time_point> deadline;
+        if (command.movetime.has_value()) {
+            deadline = start + std::chrono::milliseconds{command.movetime.value()};
+        } else if (!command.infinite && !command.ponder && !command.depth.has_value() && !command.nodes.has_value()) {
+            deadline = start + jittered(m_profile.bestmove_latency);
+        }
+        const auto info_interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{
+            static_cast<double>(m_profile.burst) / std::max(m_profile.info_rate, 1)});
+        const auto noise_interval =
+            m_profile.stderr_rate > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{1.0 / m_profile.stderr_rate}) : Clock::duration::zero();
+
+        int depth{0};
+        auto next_info = start;
+        auto next_noise = start;
+        std::vector<chessuci::UCIMove> best_line;
+        std::unique_lock<std::mutex> lock{m_mutex};
+        while (!m_stop) {
+            if (m_ponderhit) {
+                m_ponderhit = false;
+                deadline = Clock::now() + jittered(m_profile.bestmove_latency);
+            }
+            auto now = Clock::now();
+            if (deadline.has_value() && now >= deadline.value()) {
+                break;
+            }
+            if (now >= next_info) {
+                lock.unlock();
+                for (int iteration = 0; iteration < m_profile.burst; ++iteration) {
+                    best_line = send_iteration(++depth, Clock::now() - start);
+                }
+                lock.lock();
+                const auto nodes = nodes_after(Clock::now() - start);
+                if ((command.depth.has_value() && depth >= command.depth.value()) || (command.nodes.has_value() && nodes >= command.nodes.value())) {
+                    break;
+                }
+                next_info += jittered(info_interval);
+            }
+            if (m_profile.stderr_rate > 0 && now >= next_noise) {
+                std::cerr << "load engine: depth " << depth << " at " << std::chrono::duration_cast<std::chrono::microseconds>(now - start).count()
+                          << "us\n";
+                next_noise += noise_interval;
+            }
+            auto wake = next_info;
+            if (deadline.has_value()) {
+                wake = std::min(wake, deadline.value());
+            }
+            if (m_profile.stderr_rate > 0) {
+                wake = std::min(wake, next_noise);
+            }
+            m_condition.wait_until(lock, wake, [this] -> bool { return m_stop || m_ponderhit; });
+        }
+        lock.unlock();
+
+        if (best_line.empty()) {
+            best_line = {m_moves[0], m_moves[1]};
+        }
+        m_handler.send_bestmove(best_line[0], best_line.size() > 1 ? std::optional<chessuci::UCIMove>{best_line[1]} : std::nullopt);
+    }
+
+    // one simulated node per microsecond
+    static auto nodes_after(Clock::duration elapsed) -> std::int64_t {
+        return std::max<std::int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(), 1);
+    }
+
+    // returns the principal variation of the first line
+    auto send_iteration(int depth, Clock::duration elapsed) -> std::vector<chessuci::UCIMove> {
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+        const auto nodes = nodes_after(elapsed);
+        const auto multipv = m_multipv.load();
+        std::vector<chessuci::UCIMove> best_line;
+        for (int line = 1; line <= multipv; ++line) {
+            chessuci::search_info info{};
+            info.depth = depth;
+            info.seldepth = depth + m_profile.pv_length / 2;
+            info.multipv = line;
+            info.score = chessuci::score_info{.cp = 30 + depth % 7 - 10 * line, .mate = std::nullopt, .lowerbound = false, .upperbound = false};
+            info.nodes = nodes;
+            info.nps = nodes * 1000 / std::max<std::int64_t>(milliseconds, 1);
+            info.time = milliseconds;
+            info.hashfull = std::min(depth * 10, 1000);
+            for (int index = 0; index < m_profile.pv_length; ++index) {
+                info.pv.push_back(m_moves[static_cast<std::size_t>(line - 1 + index) % m_moves.size()]);
+            }
+            if (line == 1) {
+                best_line = info.pv;
+            }
+            m_handler.send_info(info);
+        }
+        return best_line;
+    }
+};
+
+auto print_usage(const char *program) -> void {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "Synthetic UCI engine that sends configurable protocol load.\n"
+              << "Options:\n"
+              << "  --info-rate <n>     search iterations reported per second (default: 100)\n"
+              << "  --pv-length <n>     moves in every principal variation (default: 8)\n"
+              << "  --multipv <n>       lines per iteration, the default of the MultiPV option (default: 1)\n"
+              << "  --latency <ms>      time until bestmove without movetime, depth or nodes limit (default: 1000)\n"
+              << "  --jitter <ms>       maximum random deviation of the latency and the info intervals (default: 0)\n"
+              << "  --burst <n>         iterations sent back to back (default: 1)\n"
+              << "  --stderr-rate <n>   lines written to stderr per second while searching (default: 0)\n"
+              << "  --seed <n>          seed of the jitter (default: 1)\n";
+}
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int {
+    LoadProfile profile{};
+    for (int index = 1; index < argc; ++index) {
+        const std::string_view argument{argv[index]};
+        if (index + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const std::string_view value{argv[++index]};
+        const auto number = chessuci::str_to_inttype<int>(value);
+        bool valid = number.has_value() && number.value() >= 0;
+        if (argument == "--info-rate") {
+            profile.info_rate = number.value_or(0);
+            valid = valid && profile.info_rate > 0;
+        } else if (argument == "--pv-length") {
+            profile.pv_length = number.value_or(0);
+        } else if (argument == "--multipv") {
+            profile.multipv = number.value_or(0);
+            valid = valid && profile.multipv >= 1 && profile.multipv <= 256;
+        } else if (argument == "--latency") {
+            profile.bestmove_latency = std::chrono::milliseconds{number.value_or(0)};
+        } else if (argument == "--jitter") {
+            profile.jitter = std::chrono::milliseconds{number.value_or(0)};
+        } else if (argument == "--burst") {
+            profile.burst = number.value_or(0);
+            valid = valid && profile.burst > 0;
+        } else if (argument == "--stderr-rate") {
+            profile.stderr_rate = number.value_or(0);
+        } else if (argument == "--seed") {
+            profile.seed = static_cast<std::uint32_t>(number.value_or(0));
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "Invalid argument: " << argument << ' ' << value << '\n';
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // every line is flushed when it is sent, reading must not flush from the other thread
+    std::cin.tie(nullptr);
+    LoadEngine engine{profile};
+    return engine.run();
+}